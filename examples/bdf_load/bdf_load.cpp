@@ -0,0 +1,296 @@
+#include "TACSMeshLoader.h"
+#include "TACSCreator.h"
+#include "PlaneStressQuad.h"
+#include <math.h>
+
+/*
+  Load a BDF file through the distributed path of TACSMeshLoader.
+
+  The root processor writes a plate of CQUAD4 elements split into two
+  components. The GRID and element ids are not contiguous and the
+  cards are written out of order, so each processor parses nodes that
+  are owned by other processors. The plate is clamped with SPC cards
+  along the edge x = 0.
+
+  The mesh is loaded three ways: by parsing the BDF file (which also
+  writes the mesh cache), from the mesh cache, and from the same mesh
+  passed to TACSCreator on the root processor. A uniform load is
+  applied and the norm of the solution from each mesh is compared.
+
+  Options: nx=%d
+*/
+
+/*
+  The BDF id of the node with the given index. The ids are spread out
+  and not in the order of the node indices.
+*/
+int nodeId( int node, int num_nodes ){
+  return 10*((7919LL*node) % num_nodes) + 3;
+}
+
+/*
+  Write the BDF file for the nx x nx plate on the root processor
+*/
+void writeBDF( const char *fname, int nx ){
+  FILE *fp = fopen(fname, "w");
+  if (!fp){
+    return;
+  }
+
+  int num_nodes = (nx+1)*(nx+1);
+  int num_elems = nx*nx;
+  fprintf(fp, "SOL 101\nCEND\nBEGIN BULK\n");
+  fprintf(fp, "$       Shell element data for family    %s\n", "LEFT");
+  fprintf(fp, "$       Shell element data for family    %s\n", "RIGHT");
+
+  // Write the elements and nodes in a permuted order, interleaved so
+  // that each processor sees a mix of cards
+  for ( int k = 0; k < num_nodes || k < num_elems; k++ ){
+    if (k < num_elems){
+      int e = (7919LL*k) % num_elems;
+      int i = e % nx, j = e/nx;
+      int n = i + (nx+1)*j;
+      int comp = (i < nx/2 ? 1 : 2);
+      fprintf(fp, "CQUAD4  %8d%8d%8d%8d%8d%8d\n",
+              5*e + 1, comp,
+              nodeId(n, num_nodes), nodeId(n+1, num_nodes),
+              nodeId(n+nx+2, num_nodes), nodeId(n+nx+1, num_nodes));
+    }
+    if (k < num_nodes){
+      int n = num_nodes-1 - k;
+      int i = n % (nx+1), j = n/(nx+1);
+      fprintf(fp, "GRID    %8d%8d%8.5f%8.5f%8.5f\n",
+              nodeId(n, num_nodes), 0,
+              (1.0*i)/nx, (1.0*j)/nx, 0.0);
+    }
+  }
+
+  // Clamp the edge x = 0
+  for ( int j = 0; j <= nx; j++ ){
+    int n = (nx+1)*j;
+    fprintf(fp, "SPC     %8d%8d%8d%8.5f\n", 1, nodeId(n, num_nodes),
+            12, 0.0);
+  }
+  fprintf(fp, "ENDDATA\n");
+  fclose(fp);
+}
+
+/*
+  Create the same mesh on the root processor and pass it to
+  TACSCreator. The nodes are numbered in ascending order of their BDF
+  ids and the elements in the order in which they appear in the file.
+*/
+TACSAssembler *createReference( MPI_Comm comm, int nx,
+                                TACSElement *elems[] ){
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+
+  TACSCreator *creator = new TACSCreator(comm, 2);
+  creator->incref();
+
+  if (rank == 0){
+    int num_nodes = (nx+1)*(nx+1);
+    int num_elems = nx*nx;
+
+    // Find the new node number of each node index
+    int *new_nums = new int[ num_nodes ];
+    int *count = new int[ 10*num_nodes+4 ];
+    memset(count, 0, (10*num_nodes+4)*sizeof(int));
+    for ( int n = 0; n < num_nodes; n++ ){
+      count[nodeId(n, num_nodes)] = 1;
+    }
+    for ( int k = 1; k < 10*num_nodes+4; k++ ){
+      count[k] += count[k-1];
+    }
+    for ( int n = 0; n < num_nodes; n++ ){
+      new_nums[n] = count[nodeId(n, num_nodes)] - 1;
+    }
+    delete [] count;
+
+    TacsScalar *Xpts = new TacsScalar[ 3*num_nodes ];
+    for ( int n = 0; n < num_nodes; n++ ){
+      int i = n % (nx+1), j = n/(nx+1);
+      Xpts[3*new_nums[n]] = (1.0*i)/nx;
+      Xpts[3*new_nums[n]+1] = (1.0*j)/nx;
+      Xpts[3*new_nums[n]+2] = 0.0;
+    }
+
+    int *ptr = new int[ num_elems+1 ];
+    int *conn = new int[ 4*num_elems ];
+    int *ids = new int[ num_elems ];
+    ptr[0] = 0;
+    for ( int k = 0; k < num_elems; k++ ){
+      int e = (7919LL*k) % num_elems;
+      int i = e % nx, j = e/nx;
+      int n = i + (nx+1)*j;
+      ids[k] = (i < nx/2 ? 0 : 1);
+      conn[4*k] = new_nums[n];
+      conn[4*k+1] = new_nums[n+1];
+      conn[4*k+2] = new_nums[n+nx+1];
+      conn[4*k+3] = new_nums[n+nx+2];
+      ptr[k+1] = 4*(k+1);
+    }
+
+    int *bc_nodes = new int[ nx+1 ];
+    for ( int j = 0; j <= nx; j++ ){
+      bc_nodes[j] = new_nums[(nx+1)*j];
+    }
+
+    creator->setGlobalConnectivity(num_nodes, num_elems, ptr, conn, ids);
+    creator->setBoundaryConditions(nx+1, bc_nodes);
+    creator->setNodes(Xpts);
+
+    delete [] new_nums;
+    delete [] Xpts;
+    delete [] ptr;
+    delete [] conn;
+    delete [] ids;
+    delete [] bc_nodes;
+  }
+
+  creator->setElements(elems, 2);
+  TACSAssembler *tacs = creator->createTACS();
+  creator->decref();
+
+  return tacs;
+}
+
+/*
+  Solve the problem with a uniform load and return the norm of the
+  solution
+*/
+TacsScalar solveProblem( TACSAssembler *tacs ){
+  TACSBVec *res = tacs->createVec();
+  TACSBVec *ans = tacs->createVec();
+  FEMat *mat = tacs->createFEMat();
+  res->incref();
+  ans->incref();
+  mat->incref();
+
+  int lev = 10000;
+  double fill = 10.0;
+  int reorder_schur = 1;
+  PcScMat *pc = new PcScMat(mat, lev, fill, reorder_schur);
+  pc->incref();
+
+  int gmres_iters = 20;
+  int nrestart = 2;
+  int is_flexible = 0;
+  TACSKsm *ksm = new GMRES(mat, pc, gmres_iters, nrestart, is_flexible);
+  ksm->incref();
+  ksm->setTolerances(1e-12, 1e-30);
+
+  double alpha = 1.0, beta = 0.0, gamma = 0.0;
+  tacs->assembleJacobian(alpha, beta, gamma, res, mat);
+  pc->factor();
+
+  res->set(1.0);
+  tacs->applyBCs(res);
+  ksm->solve(res, ans);
+  TacsScalar norm = ans->norm();
+
+  ksm->decref();
+  pc->decref();
+  mat->decref();
+  ans->decref();
+  res->decref();
+
+  return norm;
+}
+
+/*
+  Load the BDF file and solve the problem
+*/
+TacsScalar loadAndSolve( MPI_Comm comm, const char *fname,
+                         const char *cache, TACSElement *elems[],
+                         int *fail ){
+  TACSMeshLoader *mesh = new TACSMeshLoader(comm);
+  mesh->incref();
+  mesh->setMeshCache(cache);
+  *fail = mesh->scanBDFFile(fname);
+
+  TacsScalar norm = 0.0;
+  if (!(*fail) && mesh->getNumComponents() == 2){
+    for ( int k = 0; k < 2; k++ ){
+      mesh->setElement(k, elems[k]);
+    }
+    TACSAssembler *tacs = mesh->createTACS(2);
+    tacs->incref();
+    norm = solveProblem(tacs);
+    tacs->decref();
+  }
+  else {
+    *fail = 1;
+  }
+  mesh->decref();
+
+  return norm;
+}
+
+int main( int argc, char *argv[] ){
+  MPI_Init(&argc, &argv);
+
+  MPI_Comm comm = MPI_COMM_WORLD;
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+
+  int nx = 40;
+  for ( int k = 0; k < argc; k++ ){
+    if (sscanf(argv[k], "nx=%d", &nx) == 1){
+      if (nx < 2){ nx = 2; }
+    }
+  }
+
+  const char *fname = "bdf_load.bdf";
+  const char *cache = "bdf_load.cache";
+  if (rank == 0){
+    writeBDF(fname, nx);
+    remove(cache);
+  }
+  MPI_Barrier(comm);
+
+  // Create the elements for the two components
+  PlaneStressStiffness *stiff = new PlaneStressStiffness(1.0, 70e3, 0.3);
+  stiff->incref();
+  TACSElement *elems[2];
+  for ( int k = 0; k < 2; k++ ){
+    elems[k] = new PlaneStressQuad<2>(stiff);
+    elems[k]->incref();
+  }
+
+  // Parse the file (writing the cache), then load from the cache
+  int fail_parse = 0, fail_cache = 0;
+  TacsScalar norm_parse = loadAndSolve(comm, fname, cache,
+                                       elems, &fail_parse);
+  TacsScalar norm_cache = loadAndSolve(comm, fname, cache,
+                                       elems, &fail_cache);
+
+  // Create the reference mesh on the root processor
+  TACSAssembler *tacs = createReference(comm, nx, elems);
+  tacs->incref();
+  TacsScalar norm_ref = solveProblem(tacs);
+  tacs->decref();
+
+  double err_parse = fabs(TacsRealPart(norm_parse - norm_ref))/
+    fabs(TacsRealPart(norm_ref));
+  double err_cache = fabs(TacsRealPart(norm_cache - norm_ref))/
+    fabs(TacsRealPart(norm_ref));
+  int fail = (fail_parse || fail_cache ||
+              err_parse > 1e-8 || err_cache > 1e-8);
+  if (rank == 0){
+    printf("Reference ||u||:  %15.8e\n", TacsRealPart(norm_ref));
+    printf("BDF ||u||:        %15.8e  rel. err: %10.3e\n",
+           TacsRealPart(norm_parse), err_parse);
+    printf("Cache ||u||:      %15.8e  rel. err: %10.3e\n",
+           TacsRealPart(norm_cache), err_cache);
+    printf("Distributed BDF load: %s\n", (fail ? "FAILED" : "PASSED"));
+  }
+
+  for ( int k = 0; k < 2; k++ ){
+    elems[k]->decref();
+  }
+  stiff->decref();
+
+  MPI_Finalize();
+  return fail;
+}
@@ -0,0 +1,196 @@
+#include "FH5.h"
+#include <math.h>
+
+/*
+  Check the encodings of the FH5 zone data with a round trip through
+  a file.
+
+  Each processor writes a block of rows of smooth data with a range
+  of magnitudes. The file is read back on the root processor and the
+  error in each zone is checked against the bound for the encoding:
+
+  FH5_HALF:      relative error of 2^-11 (or 2^-25 absolute for the
+                 subnormal values)
+  FH5_QUANTIZE:  absolute error of tol, plus the rounding of the
+                 decoded value to float for float data
+
+  A zone with values beyond the range of the half-precision floats is
+  also written with FH5_HALF to check that the values are stored with
+  full precision. The size of the file is reported for each encoding.
+
+  Options: rows=%d tol=%f
+*/
+
+/*
+  The value of the entry in the global row and column
+*/
+double dataValue( int row, int col, double scale ){
+  return scale*(col+1)*sin(0.001*row*(col+1)) + 1e-3*col;
+}
+
+/*
+  Write the zone with the codec and check the values on the root
+*/
+int checkCodec( MPI_Comm comm, const char *name,
+                FH5File::FH5DataType dtype, int codec, double tol,
+                int rows, double scale, double rel_bound,
+                double abs_bound ){
+  int rank, size;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
+
+  // Set the rows owned by this processor
+  const int ncols = 6;
+  int start = (rank*rows)/size;
+  int end = ((rank+1)*rows)/size;
+  int n = ncols*(end - start);
+  float *fdata = new float[ n+1 ];
+  double *ddata = new double[ n+1 ];
+  for ( int i = start; i < end; i++ ){
+    for ( int j = 0; j < ncols; j++ ){
+      ddata[ncols*(i - start) + j] = dataValue(i, j, scale);
+      fdata[ncols*(i - start) + j] = dataValue(i, j, scale);
+    }
+  }
+  void *data = fdata;
+  if (dtype == FH5File::FH5_DOUBLE){
+    data = ddata;
+  }
+
+  // Write the file with the encoded zone
+  const char *fname = "fh5_codec.f5";
+  char comp[] = "component";
+  char *comp_names[] = {comp};
+  char zone[] = "data t=0.0";
+  char vars[] = "a,b,c,d,e,f";
+  FH5File *file = new FH5File(comm);
+  file->incref();
+  file->createFile(fname, comp_names, 1);
+  file->writeZoneData(zone, vars, dtype, data,
+                      end - start, ncols, codec, tol);
+  file->close();
+  file->decref();
+  delete [] fdata;
+  delete [] ddata;
+
+  // Read the file back and compute the error on the root
+  int fail = 0;
+  if (rank == 0){
+    FILE *fp = fopen(fname, "rb");
+    long fsize = 0;
+    if (fp){
+      fseek(fp, 0, SEEK_END);
+      fsize = ftell(fp);
+      fclose(fp);
+    }
+
+    FH5File *load = new FH5File(MPI_COMM_SELF);
+    load->incref();
+    double max_err = 0.0;
+    if (load->openFile(fname)){
+      load->firstZone();
+      const char *zone_name, *var_names;
+      FH5File::FH5DataType rtype;
+      void *vals;
+      int dim1, dim2;
+      load->getZoneData(&zone_name, &var_names, &rtype,
+                        &vals, &dim1, &dim2);
+
+      // Half-precision data is returned as float, otherwise the
+      // original type is returned
+      FH5File::FH5DataType expect = dtype;
+      if ((codec & ~FH5File::FH5_LOSSLESS) == FH5File::FH5_HALF){
+        expect = FH5File::FH5_FLOAT;
+      }
+      if (rtype != expect || dim1 != rows || dim2 != ncols){
+        fail = 1;
+      }
+      else {
+        for ( int i = 0; i < rows; i++ ){
+          for ( int j = 0; j < ncols; j++ ){
+            double x = (dtype == FH5File::FH5_FLOAT ?
+                        (float)dataValue(i, j, scale) :
+                        dataValue(i, j, scale));
+            double y = (rtype == FH5File::FH5_FLOAT ?
+                        ((float*)vals)[ncols*i + j] :
+                        ((double*)vals)[ncols*i + j]);
+            double err = fabs(y - x);
+            if (err > max_err){
+              max_err = err;
+            }
+            if (err > rel_bound*fabs(x) + abs_bound){
+              fail = 1;
+            }
+          }
+        }
+      }
+    }
+    else {
+      fail = 1;
+    }
+    load->decref();
+
+    printf("%-24s %12ld %12.4e %8s\n", name, fsize, max_err,
+           (fail ? "FAIL" : "PASS"));
+  }
+
+  MPI_Bcast(&fail, 1, MPI_INT, 0, comm);
+  return fail;
+}
+
+int main( int argc, char *argv[] ){
+  MPI_Init(&argc, &argv);
+
+  MPI_Comm comm = MPI_COMM_WORLD;
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+
+  int rows = 5000;
+  double tol = 1e-3;
+  for ( int k = 0; k < argc; k++ ){
+    if (sscanf(argv[k], "rows=%d", &rows) == 1){}
+    if (sscanf(argv[k], "tol=%lf", &tol) == 1){}
+  }
+
+  if (rank == 0){
+    printf("%-24s %12s %12s %8s\n", "codec", "file size", "max error",
+           "status");
+  }
+
+  // The bounds for the float and half-precision round off
+  const double float_eps = 1.2e-7;
+  const double half_eps = 1.0/2048.0;
+  const double half_min = 1.0/33554432.0;
+
+  // FH5_QUANTIZE is always compressed, so both quantized cases
+  // should give the same file size
+  const FH5File::FH5DataType ftype = FH5File::FH5_FLOAT;
+  const FH5File::FH5DataType dtype = FH5File::FH5_DOUBLE;
+  int fail = 0;
+  fail |= checkCodec(comm, "RAW", ftype, FH5File::FH5_RAW, 0.0,
+                     rows, 100.0, 0.0, 0.0);
+  fail |= checkCodec(comm, "HALF", ftype, FH5File::FH5_HALF, 0.0,
+                     rows, 100.0, half_eps, half_min);
+  fail |= checkCodec(comm, "HALF+LOSSLESS", ftype,
+                     FH5File::FH5_HALF | FH5File::FH5_LOSSLESS, 0.0,
+                     rows, 100.0, half_eps, half_min);
+  fail |= checkCodec(comm, "QUANTIZE", ftype, FH5File::FH5_QUANTIZE, tol,
+                     rows, 100.0, float_eps, tol);
+  fail |= checkCodec(comm, "QUANTIZE+LOSSLESS", ftype,
+                     FH5File::FH5_QUANTIZE | FH5File::FH5_LOSSLESS, tol,
+                     rows, 100.0, float_eps, tol);
+
+  // Double data is decoded as double, so the bound is tol
+  fail |= checkCodec(comm, "RAW (double)", dtype, FH5File::FH5_RAW, 0.0,
+                     rows, 100.0, 0.0, 0.0);
+  fail |= checkCodec(comm, "QUANTIZE (double)", dtype,
+                     FH5File::FH5_QUANTIZE, tol,
+                     rows, 100.0, 1e-15, tol*(1.0 + 1e-12));
+
+  // Values beyond the range of FH5_HALF are written in full precision
+  fail |= checkCodec(comm, "HALF (out of range)", ftype,
+                     FH5File::FH5_HALF, 0.0, rows, 1e6, 0.0, 0.0);
+
+  MPI_Finalize();
+  return fail;
+}
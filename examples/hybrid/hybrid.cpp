@@ -0,0 +1,279 @@
+#include "TACSCreator.h"
+#include "isoFSDTStiffness.h"
+#include "MITCShell.h"
+#include "KSFailure.h"
+#include "KSM.h"
+#include "TACSProfiler.h"
+
+/*
+  Benchmark the hybrid MPI/thread mode against the pure MPI mode.
+
+  The same plate problem is solved with a fixed number of cores per
+  node split between the MPI processes and the threads within each
+  process. For instance, on a node with two sockets of 32 cores, the
+  pure MPI and hybrid configurations are run with:
+
+  mpirun -np 64 --map-by core --bind-to core ./hybrid num_threads=1
+  mpirun -np 2 --map-by socket --bind-to socket ./hybrid num_threads=32
+
+  Binding each process to a socket keeps its threads, and the memory
+  they first touch, on that socket. The code reports the maximum time
+  over all the processors for each phase:
+
+  res:      residual assembly
+  mat:      Jacobian assembly
+  func:     function evaluation
+  mult:     matrix-vector product including the halo exchange
+  vec:      vector operations of one GMRES(m) cycle (mdot, axpy, norm)
+  factor:   factorization of the additive Schwarz ILU(k) preconditioner
+  apply:    application of the preconditioner
+  solve:    preconditioned GMRES solution
+
+  Options: nx=%d ny=%d num_threads=%d iters=%d levfill=%d profile
+*/
+
+/*
+  Create the TACSAssembler object for a clamped plate
+*/
+TACSAssembler *createPlate( MPI_Comm comm, int nx, int ny ){
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+
+  // Create the shell element
+  TacsScalar rho = 2750.0, E = 70e9, nu = 0.3, kcorr = 5.0/6.0;
+  TacsScalar ys = 350e6, t = 0.01;
+  FSDTStiffness *stiff = new isoFSDTStiffness(rho, E, nu, kcorr, ys, t);
+  TACSElement *elem = new MITCShell<2>(stiff);
+
+  TACSCreator *creator = new TACSCreator(comm, 6);
+  creator->incref();
+  creator->setLocalityOrdering(TACSCreator::HILBERT_ORDER);
+
+  if (rank == 0){
+    int nnx = nx+1, nny = ny+1;
+    int num_nodes = nnx*nny;
+    int num_elements = nx*ny;
+
+    // Set the connectivity
+    int *ptr = new int[ num_elements+1 ];
+    int *conn = new int[ 4*num_elements ];
+    int *ids = new int[ num_elements ];
+    ptr[0] = 0;
+    for ( int j = 0; j < ny; j++ ){
+      for ( int i = 0; i < nx; i++ ){
+        int k = i + nx*j;
+        conn[4*k] = i + nnx*j;
+        conn[4*k+1] = i+1 + nnx*j;
+        conn[4*k+2] = i + nnx*(j+1);
+        conn[4*k+3] = i+1 + nnx*(j+1);
+        ptr[k+1] = 4*(k+1);
+        ids[k] = 0;
+      }
+    }
+    creator->setGlobalConnectivity(num_nodes, num_elements,
+                                   ptr, conn, ids);
+    delete [] ptr;
+    delete [] conn;
+    delete [] ids;
+
+    // Clamp the edges of the plate
+    int num_bcs = 2*nnx + 2*nny - 4;
+    int *bc_nodes = new int[ num_bcs ];
+    int n = 0;
+    for ( int j = 0; j < nny; j++ ){
+      for ( int i = 0; i < nnx; i++ ){
+        if (i == 0 || j == 0 || i == nnx-1 || j == nny-1){
+          bc_nodes[n] = i + nnx*j;
+          n++;
+        }
+      }
+    }
+    creator->setBoundaryConditions(num_bcs, bc_nodes);
+    delete [] bc_nodes;
+
+    // Set the node locations
+    TacsScalar *Xpts = new TacsScalar[ 3*num_nodes ];
+    for ( int j = 0; j < nny; j++ ){
+      for ( int i = 0; i < nnx; i++ ){
+        int node = i + nnx*j;
+        Xpts[3*node] = (1.0*i)/(nnx-1);
+        Xpts[3*node+1] = (1.0*j)/(nny-1);
+        Xpts[3*node+2] = 0.0;
+      }
+    }
+    creator->setNodes(Xpts);
+    delete [] Xpts;
+  }
+
+  creator->setElements(&elem, 1);
+  TACSAssembler *tacs = creator->createTACS();
+  creator->decref();
+
+  return tacs;
+}
+
+int main( int argc, char *argv[] ){
+  MPI_Init(&argc, &argv);
+
+  MPI_Comm comm = MPI_COMM_WORLD;
+  int rank, size;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
+
+  int nx = 400, ny = 400, num_threads = 1, iters = 10, levfill = 1;
+  int profile = 0;
+  for ( int k = 0; k < argc; k++ ){
+    if (sscanf(argv[k], "nx=%d", &nx) == 1){}
+    if (sscanf(argv[k], "ny=%d", &ny) == 1){}
+    if (sscanf(argv[k], "num_threads=%d", &num_threads) == 1){}
+    if (sscanf(argv[k], "iters=%d", &iters) == 1){}
+    if (sscanf(argv[k], "levfill=%d", &levfill) == 1){}
+    if (strcmp(argv[k], "profile") == 0){ profile = 1; }
+  }
+
+  TACSAssembler *tacs = createPlate(comm, nx, ny);
+  tacs->incref();
+
+  // Set the number of threads before the vectors and matrices are
+  // created so that they are first touched by the threads
+  tacs->setNumThreads(num_threads);
+
+  TACSBVec *res = tacs->createVec();
+  TACSBVec *ans = tacs->createVec();
+  TACSDistMat *mat = tacs->createMat();
+  res->incref();
+  ans->incref();
+  mat->incref();
+
+  // The vectors used for the vector operations
+  const int m = 20;
+  TACSBVec *W[m];
+  TACSVec *V[m];
+  TacsScalar h[m];
+  for ( int i = 0; i < m; i++ ){
+    W[i] = tacs->createVec();
+    W[i]->incref();
+    W[i]->setRand(-1.0, 1.0);
+    V[i] = W[i];
+  }
+
+  // Set the displacements so that the functions are not trivial
+  ans->setRand(-1e-3, 1e-3);
+  tacs->applyBCs(ans);
+  tacs->setVariables(ans);
+
+  TACSFunction *func = new TACSKSFailure(tacs, 100.0);
+  func->incref();
+
+  TACSPc *pc = new TACSAdditiveSchwarz(mat, levfill, 10.0);
+  pc->incref();
+  GMRES *gmres = new GMRES(mat, pc, m, 0, 0);
+  gmres->incref();
+  gmres->setOrthoType(GMRES::CLASSICAL_GRAM_SCHMIDT);
+  gmres->setTolerances(1e-30, 1e-30);
+
+  // Assemble once so that the memory is touched before timing
+  tacs->assembleJacobian(1.0, 0.0, 0.0, res, mat);
+  pc->factor();
+
+  if (profile){
+    TACSProfiler::setEnabled(1);
+  }
+
+  const int nphases = 8;
+  const char *names[] = {"res", "mat", "func", "mult", "vec",
+                         "factor", "apply", "solve"};
+  double t[nphases];
+  memset(t, 0, nphases*sizeof(double));
+
+  for ( int i = 0; i < iters; i++ ){
+    MPI_Barrier(comm);
+    double t0 = MPI_Wtime();
+    tacs->assembleRes(res);
+    t[0] += MPI_Wtime() - t0;
+
+    MPI_Barrier(comm);
+    t0 = MPI_Wtime();
+    tacs->assembleJacobian(1.0, 0.0, 0.0, res, mat);
+    t[1] += MPI_Wtime() - t0;
+
+    MPI_Barrier(comm);
+    t0 = MPI_Wtime();
+    TacsScalar fval;
+    tacs->evalFunctions(&func, 1, &fval);
+    t[2] += MPI_Wtime() - t0;
+
+    MPI_Barrier(comm);
+    t0 = MPI_Wtime();
+    for ( int j = 0; j < m; j++ ){
+      mat->mult(W[j], res);
+    }
+    t[3] += (MPI_Wtime() - t0)/m;
+
+    // The vector operations for one cycle of classical Gram-Schmidt
+    MPI_Barrier(comm);
+    t0 = MPI_Wtime();
+    for ( int j = 1; j < m; j++ ){
+      res->mdot(V, h, j);
+      for ( int k = 0; k < j; k++ ){
+        res->axpy(-1e-3*h[k], W[k]);
+      }
+      res->scale(1.0/res->norm());
+    }
+    t[4] += MPI_Wtime() - t0;
+
+    MPI_Barrier(comm);
+    t0 = MPI_Wtime();
+    pc->factor();
+    t[5] += MPI_Wtime() - t0;
+
+    MPI_Barrier(comm);
+    t0 = MPI_Wtime();
+    for ( int j = 0; j < m; j++ ){
+      pc->applyFactor(W[j], res);
+    }
+    t[6] += (MPI_Wtime() - t0)/m;
+
+    MPI_Barrier(comm);
+    t0 = MPI_Wtime();
+    res->set(1.0);
+    tacs->applyBCs(res);
+    gmres->solve(res, ans);
+    t[7] += MPI_Wtime() - t0;
+  }
+
+  for ( int k = 0; k < nphases; k++ ){
+    t[k] /= iters;
+  }
+  MPI_Allreduce(MPI_IN_PLACE, t, nphases, MPI_DOUBLE, MPI_MAX, comm);
+
+  if (rank == 0){
+    printf("%8s %8s %10s", "ranks", "threads", "nodes");
+    for ( int k = 0; k < nphases; k++ ){
+      printf(" %10s", names[k]);
+    }
+    printf("\n%8d %8d %10d", size, num_threads, (nx+1)*(ny+1));
+    for ( int k = 0; k < nphases; k++ ){
+      printf(" %10.4e", t[k]);
+    }
+    printf("\n");
+  }
+
+  if (profile){
+    TACSProfiler::printReport(comm);
+  }
+
+  for ( int i = 0; i < m; i++ ){
+    W[i]->decref();
+  }
+  gmres->decref();
+  pc->decref();
+  func->decref();
+  res->decref();
+  ans->decref();
+  mat->decref();
+  tacs->decref();
+
+  MPI_Finalize();
+  return (0);
+}
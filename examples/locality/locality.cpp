@@ -0,0 +1,377 @@
+#include "TACSCreator.h"
+#include "isoFSDTStiffness.h"
+#include "MITCShell.h"
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+/*
+  Benchmark the effect of the element and node order on the time
+  required for residual and Jacobian assembly.
+
+  A structured shell mesh is created with a random numbering of the
+  elements and nodes to mimic the ordering from a mesh generator. The
+  mesh is then distributed using TACSCreator with and without a
+  locality ordering along a space-filling curve.
+
+  For each ordering, the code reports two measures of the locality:
+
+  span:   the average difference between the largest and smallest
+          node numbers within an element
+  jump:   the average difference between the first node of an element
+          and the first node of the previous element in the loop
+
+  followed by the assembly times and the hardware cache misses per
+  assembly, summed over all processors. The miss counts are read from
+  the Linux perf_event interface around the timed loops. They include
+  the threads created during assembly. When the counters are not
+  available (another OS, a virtual machine without a PMU, or a
+  restrictive perf_event_paranoid setting), n/a is printed.
+
+  Options: nx=%d ny=%d order=%d iters=%d NONE HILBERT MORTON
+*/
+
+/*
+  Hardware counters for the last-level cache references and misses
+  of this process and the threads it creates
+*/
+class CacheCounters {
+ public:
+  CacheCounters(){
+    fd[0] = fd[1] = -1;
+#ifdef __linux__
+    unsigned long long config[2] = {PERF_COUNT_HW_CACHE_REFERENCES,
+                                    PERF_COUNT_HW_CACHE_MISSES};
+    for ( int k = 0; k < 2; k++ ){
+      struct perf_event_attr attr;
+      memset(&attr, 0, sizeof(attr));
+      attr.size = sizeof(attr);
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.config = config[k];
+      attr.disabled = 1;
+      attr.inherit = 1;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      fd[k] = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+#endif
+    if (fd[0] < 0 || fd[1] < 0){
+      close();
+    }
+  }
+  ~CacheCounters(){ close(); }
+
+  // Are the counters available on this processor?
+  int isAvailable(){ return (fd[0] >= 0 && fd[1] >= 0); }
+
+  // Reset and start the counters
+  void start(){
+#ifdef __linux__
+    for ( int k = 0; k < 2 && isAvailable(); k++ ){
+      ioctl(fd[k], PERF_EVENT_IOC_RESET, 0);
+      ioctl(fd[k], PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+  }
+
+  // Stop the counters and retrieve the references and misses
+  void stop( double *refs, double *misses ){
+    long long count[2] = {0, 0};
+#ifdef __linux__
+    for ( int k = 0; k < 2 && isAvailable(); k++ ){
+      ioctl(fd[k], PERF_EVENT_IOC_DISABLE, 0);
+      if (read(fd[k], &count[k], sizeof(long long)) != sizeof(long long)){
+        count[k] = 0;
+      }
+    }
+#endif
+    *refs = 1.0*count[0];
+    *misses = 1.0*count[1];
+  }
+
+ private:
+  void close(){
+#ifdef __linux__
+    for ( int k = 0; k < 2; k++ ){
+      if (fd[k] >= 0){
+        ::close(fd[k]);
+      }
+    }
+#endif
+    fd[0] = fd[1] = -1;
+  }
+
+  int fd[2];
+};
+
+/*
+  Create the TACSAssembler object for a plate with a scrambled
+  element and node order
+*/
+TACSAssembler *createPlate( MPI_Comm comm, int nx, int ny, int order,
+                            TACSCreator::LocalityOrderType curve ){
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+
+  // Create the shell element
+  TacsScalar rho = 2750.0, E = 70e9, nu = 0.3, kcorr = 5.0/6.0;
+  TacsScalar ys = 350e6, t = 0.01;
+  FSDTStiffness *stiff = new isoFSDTStiffness(rho, E, nu, kcorr, ys, t);
+  TACSElement *elem = NULL;
+  if (order == 2){
+    elem = new MITCShell<2>(stiff);
+  }
+  else if (order == 3){
+    elem = new MITCShell<3>(stiff);
+  }
+  else {
+    elem = new MITCShell<4>(stiff);
+  }
+
+  TACSCreator *creator = new TACSCreator(comm, 6);
+  creator->incref();
+  creator->setLocalityOrdering(curve);
+
+  if (rank == 0){
+    int nnx = (order-1)*nx+1, nny = (order-1)*ny+1;
+    int num_nodes = nnx*nny;
+    int num_elements = nx*ny;
+
+    // Create a random permutation of the nodes and elements. Use
+    // the same seed so that each ordering starts from the same mesh.
+    srand(0);
+    int *node_perm = new int[ num_nodes ];
+    int *elem_perm = new int[ num_elements ];
+    for ( int i = 0; i < num_nodes; i++ ){
+      node_perm[i] = i;
+    }
+    for ( int i = 0; i < num_elements; i++ ){
+      elem_perm[i] = i;
+    }
+    for ( int i = num_nodes-1; i > 0; i-- ){
+      int j = rand() % (i+1);
+      int tmp = node_perm[i]; node_perm[i] = node_perm[j]; node_perm[j] = tmp;
+    }
+    for ( int i = num_elements-1; i > 0; i-- ){
+      int j = rand() % (i+1);
+      int tmp = elem_perm[i]; elem_perm[i] = elem_perm[j]; elem_perm[j] = tmp;
+    }
+
+    // Set the scrambled connectivity
+    int *ptr = new int[ num_elements+1 ];
+    int *conn = new int[ order*order*num_elements ];
+    int *ids = new int[ num_elements ];
+    ptr[0] = 0;
+    for ( int k = 0; k < num_elements; k++ ){
+      int i = elem_perm[k] % nx;
+      int j = elem_perm[k]/nx;
+      for ( int jj = 0; jj < order; jj++ ){
+        for ( int ii = 0; ii < order; ii++ ){
+          int node = (order-1)*i + ii + nnx*((order-1)*j + jj);
+          conn[ptr[k] + ii + order*jj] = node_perm[node];
+        }
+      }
+      ptr[k+1] = ptr[k] + order*order;
+      ids[k] = 0;
+    }
+    creator->setGlobalConnectivity(num_nodes, num_elements,
+                                   ptr, conn, ids);
+    delete [] ptr;
+    delete [] conn;
+    delete [] ids;
+
+    // Clamp the edges of the plate
+    int num_bcs = 2*nnx + 2*nny - 4;
+    int *bc_nodes = new int[ num_bcs ];
+    int n = 0;
+    for ( int j = 0; j < nny; j++ ){
+      for ( int i = 0; i < nnx; i++ ){
+        if (i == 0 || j == 0 || i == nnx-1 || j == nny-1){
+          bc_nodes[n] = node_perm[i + nnx*j];
+          n++;
+        }
+      }
+    }
+    creator->setBoundaryConditions(num_bcs, bc_nodes);
+    delete [] bc_nodes;
+
+    // Set the node locations
+    TacsScalar *Xpts = new TacsScalar[ 3*num_nodes ];
+    for ( int j = 0; j < nny; j++ ){
+      for ( int i = 0; i < nnx; i++ ){
+        int node = node_perm[i + nnx*j];
+        Xpts[3*node] = (1.0*i)/(nnx-1);
+        Xpts[3*node+1] = (1.0*j)/(nny-1);
+        Xpts[3*node+2] = 0.0;
+      }
+    }
+    creator->setNodes(Xpts);
+    delete [] Xpts;
+
+    delete [] node_perm;
+    delete [] elem_perm;
+  }
+
+  creator->setElements(&elem, 1);
+  TACSAssembler *tacs = creator->createTACS();
+  creator->decref();
+
+  return tacs;
+}
+
+/*
+  Compute the average element node span and the average jump between
+  consecutive elements in the element loop
+*/
+void computeLocality( TACSAssembler *tacs, double *span, double *jump ){
+  int num_elements = tacs->getNumElements();
+  double s = 0.0, d = 0.0;
+  int prev = -1;
+  for ( int k = 0; k < num_elements; k++ ){
+    const int *nodes;
+    int len;
+    tacs->getElement(k, &nodes, &len);
+    if (len > 0){
+      int nmin = nodes[0], nmax = nodes[0];
+      for ( int i = 1; i < len; i++ ){
+        if (nodes[i] < nmin){ nmin = nodes[i]; }
+        if (nodes[i] > nmax){ nmax = nodes[i]; }
+      }
+      s += nmax - nmin;
+      if (prev >= 0){
+        d += (nodes[0] > prev ? nodes[0] - prev : prev - nodes[0]);
+      }
+      prev = nodes[0];
+    }
+  }
+
+  double local[3] = {s, d, 1.0*num_elements};
+  double all[3];
+  MPI_Allreduce(local, all, 3, MPI_DOUBLE, MPI_SUM, tacs->getMPIComm());
+  *span = all[0]/all[2];
+  *jump = all[1]/all[2];
+}
+
+int main( int argc, char *argv[] ){
+  MPI_Init(&argc, &argv);
+
+  MPI_Comm comm = MPI_COMM_WORLD;
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+
+  int nx = 200, ny = 200, order = 2, iters = 10;
+  int run[3] = {1, 1, 1};
+  int select = 0;
+  for ( int k = 0; k < argc; k++ ){
+    if (sscanf(argv[k], "nx=%d", &nx) == 1){}
+    if (sscanf(argv[k], "ny=%d", &ny) == 1){}
+    if (sscanf(argv[k], "iters=%d", &iters) == 1){}
+    if (sscanf(argv[k], "order=%d", &order) == 1){
+      if (order < 2){ order = 2; }
+      if (order > 4){ order = 4; }
+    }
+    if (strcmp(argv[k], "NONE") == 0 ||
+        strcmp(argv[k], "HILBERT") == 0 ||
+        strcmp(argv[k], "MORTON") == 0){
+      if (!select){
+        run[0] = run[1] = run[2] = 0;
+        select = 1;
+      }
+      if (strcmp(argv[k], "NONE") == 0){ run[0] = 1; }
+      if (strcmp(argv[k], "HILBERT") == 0){ run[1] = 1; }
+      if (strcmp(argv[k], "MORTON") == 0){ run[2] = 1; }
+    }
+  }
+
+  const char *names[] = {"NONE", "HILBERT", "MORTON"};
+  TACSCreator::LocalityOrderType curves[] =
+    {TACSCreator::NO_LOCALITY_ORDER,
+     TACSCreator::HILBERT_ORDER,
+     TACSCreator::MORTON_ORDER};
+
+  // Open the counters and check that they work on every processor
+  CacheCounters counters;
+  int avail = counters.isAvailable(), all_avail = 0;
+  MPI_Allreduce(&avail, &all_avail, 1, MPI_INT, MPI_MIN, comm);
+
+  if (rank == 0){
+    printf("%8s %10s %10s %12s %12s %12s %12s %12s %12s\n",
+           "order", "span", "jump", "res time", "res miss",
+           "res rate", "mat time", "mat miss", "mat rate");
+  }
+
+  for ( int c = 0; c < 3; c++ ){
+    if (!run[c]){
+      continue;
+    }
+
+    TACSAssembler *tacs = createPlate(comm, nx, ny, order, curves[c]);
+    tacs->incref();
+
+    double span, jump;
+    computeLocality(tacs, &span, &jump);
+
+    TACSBVec *res = tacs->createVec();
+    TACSDistMat *mat = tacs->createMat();
+    res->incref();
+    mat->incref();
+
+    // Assemble once so that the memory is touched before timing
+    tacs->assembleJacobian(1.0, 0.0, 0.0, res, mat);
+
+    // The references and misses for the residual and Jacobian
+    double counts[4];
+
+    MPI_Barrier(comm);
+    double t0 = MPI_Wtime();
+    counters.start();
+    for ( int i = 0; i < iters; i++ ){
+      tacs->assembleRes(res);
+    }
+    counters.stop(&counts[0], &counts[1]);
+    MPI_Barrier(comm);
+    double tres = (MPI_Wtime() - t0)/iters;
+
+    t0 = MPI_Wtime();
+    counters.start();
+    for ( int i = 0; i < iters; i++ ){
+      tacs->assembleJacobian(1.0, 0.0, 0.0, res, mat);
+    }
+    counters.stop(&counts[2], &counts[3]);
+    MPI_Barrier(comm);
+    double tmat = (MPI_Wtime() - t0)/iters;
+
+    double all_counts[4];
+    MPI_Reduce(counts, all_counts, 4, MPI_DOUBLE, MPI_SUM, 0, comm);
+
+    if (rank == 0){
+      printf("%8s %10.1f %10.1f %12.4e ", names[c], span, jump, tres);
+      if (all_avail && all_counts[0] > 0.0){
+        printf("%12.4e %12.4f ", all_counts[1]/iters,
+               all_counts[1]/all_counts[0]);
+      }
+      else {
+        printf("%12s %12s ", "n/a", "n/a");
+      }
+      printf("%12.4e ", tmat);
+      if (all_avail && all_counts[2] > 0.0){
+        printf("%12.4e %12.4f\n", all_counts[3]/iters,
+               all_counts[3]/all_counts[2]);
+      }
+      else {
+        printf("%12s %12s\n", "n/a", "n/a");
+      }
+    }
+
+    res->decref();
+    mat->decref();
+    tacs->decref();
+  }
+
+  MPI_Finalize();
+  return (0);
+}
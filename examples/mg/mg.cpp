@@ -170,6 +170,19 @@ int main( int argc, char *argv[] ){
   // Set whether to use the direct solver or not
   int use_direct_lanczos = 0;
 
+  // Set whether to form the coarse matrices with the Galerkin
+  // product, and the number of procs for the coarse direct solve
+  int use_galerkin = 0;
+  int coarse_procs = -1;
+
+  // The degree of the Chebyshev smoother (0 uses Gauss-Seidel)
+  int cheb_degree = 0;
+
+  // Use the multicolor Gauss-Seidel smoother and the number of
+  // threads on each level
+  int multicolor = 0;
+  int num_threads = 1;
+
   // Set the dimension of the largest meshes
   int nx = 128;
   int ny = 128;
@@ -190,6 +203,15 @@ int main( int argc, char *argv[] ){
     if (strcmp(argv[k], "use_direct_lanczos") == 0){
       use_direct_lanczos = 1;
     }
+    if (strcmp(argv[k], "use_galerkin") == 0){
+      use_galerkin = 1;
+    }
+    if (sscanf(argv[k], "coarse_procs=%d", &coarse_procs) == 1){}
+    if (sscanf(argv[k], "cheb_degree=%d", &cheb_degree) == 1){}
+    if (strcmp(argv[k], "multicolor") == 0){
+      multicolor = 1;
+    }
+    if (sscanf(argv[k], "num_threads=%d", &num_threads) == 1){}
   }
 
   // Create the multigrid object
@@ -198,6 +220,10 @@ int main( int argc, char *argv[] ){
   int sor_symm = 0;
   TACSMg *mg = new TACSMg(comm, nlevels, omega, sor_iters, sor_symm);
   mg->incref();
+  mg->setUseGalerkin(use_galerkin);
+  mg->setCoarseSolverProcs(coarse_procs);
+  mg->setChebyshevSmoother(cheb_degree);
+  mg->setMultiColorSmoother(multicolor);
 
   // Create the TACS/Creator objects for all levels
   for ( int i = 0; i < nlevels; i++ ){
@@ -205,6 +231,7 @@ int main( int argc, char *argv[] ){
     createTACS(comm, Nx, Ny, &tacs[i], &creator[i]);
     tacs[i]->incref();
     creator[i]->incref();
+    tacs[i]->setNumThreads(num_threads);
   }
 
   // Create the interpolation operators
@@ -306,6 +333,7 @@ int main( int argc, char *argv[] ){
 
   // Assemble the Jacobian matrix for each level
   mg->assembleJacobian(1.0, 0.0, 0.0, res);
+  TacsScalar res0_norm = res->norm();
 
   // "Factor" the preconditioner
   mg->factor();
@@ -329,6 +357,15 @@ int main( int argc, char *argv[] ){
     printf("Solution time: %e\n", t0);
   }
 
+  // Check that the residual of the linear system has been reduced
+  // to near the GMRES tolerance with the chosen smoother
+  int fail = (TacsRealPart(res_norm) > 1e-6*TacsRealPart(res0_norm));
+  if (rank == 0){
+    printf("Convergence check: ||R||/||R0||: %15.5e %s\n",
+           TacsRealPart(res_norm)/TacsRealPart(res0_norm),
+           (fail ? "FAILED" : "PASSED"));
+  }
+
   // Output for visualization
   unsigned int write_flag = (TACSElement::OUTPUT_NODES |
                              TACSElement::OUTPUT_DISPLACEMENTS |
@@ -423,5 +460,5 @@ int main( int argc, char *argv[] ){
   }
 
   MPI_Finalize();
-  return (0);
+  return fail;
 }
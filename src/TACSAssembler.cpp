@@ -17,6 +17,7 @@
 */
 
 #include "TACSAssembler.h"
+#include "TACSProfiler.h"
 
 // Reordering implementation
 #include "FElibrary.h"
@@ -117,6 +118,9 @@ Total elements = %d\n", mpiRank, varsPerNode*recv_info[0],
   varMap = new TACSVarMap(tacs_comm, numOwnedNodes);
   varMap->incref();
 
+  // The vectors created with the variable map share the thread info
+  varMap->setThreadInfo(thread_info);
+
   // Estimate 100 bcs at first, but this is expanded as required
   int nbc_est = 100;
   bcMap = new TACSBcMap(varsPerNode, nbc_est);
@@ -2736,6 +2740,12 @@ void TACSAssembler::getDesignVarRange( TacsScalar lb[],
 
 /*!
   Set the number of threads to use in the computation
+
+  The threads are used for the assembly, the function evaluation and
+  the operations on the vectors and matrices created by this object.
+  For the hybrid MPI/thread mode, set the number of threads before
+  the vectors and matrices are created so that their memory is first
+  touched by the threads that will use it.
 */
 void TACSAssembler::setNumThreads( int t ){
   thread_info->setNumThreads(t);
@@ -2746,6 +2756,10 @@ void TACSAssembler::setNumThreads( int t ){
 
   Vector classes initialized by one TACS object, cannot be used by a
   second, unless they share are exactly the parallel layout.
+
+  The storage is taken from the memory pool owned by the variable
+  map, so vectors that are created and destroyed between solves reuse
+  the same aligned arrays.
 */
 TACSBVec *TACSAssembler::createVec(){
   if (!meshInitializedFlag){
@@ -2791,7 +2805,8 @@ void TACSAssembler::setBCs( TACSVec *vec ){
   This code creates a local array of global indices that is used to
   determine the destination for each entry in the sparse matrix.  This
   TACSBVecIndices object is reused if any subsequent DistMat objects
-  are created.
+  are created. The matrix also stores the location of each element
+  matrix block so that assembly does not require a search.
 */
 TACSDistMat *TACSAssembler::createMat(){
   if (!meshInitializedFlag){
@@ -2825,6 +2840,9 @@ TACSDistMat *TACSAssembler::createMat(){
   delete [] rowp;
   delete [] cols;
 
+  // Compute the element assembly map
+  dmat->initElementMap(numElements, elementNodeIndex, elementTacsNodes);
+
   // Return the resulting matrix object
   return dmat;
 }
@@ -3193,6 +3211,9 @@ FEMat *TACSAssembler::createFEMat( OrderingType order_type ){
   delete [] rowp;
   delete [] cols;
 
+  // Compute the element assembly map
+  fmat->initElementMap(numElements, elementNodeIndex, elementTacsNodes);
+
   return fmat;
 }
 
@@ -3422,6 +3443,9 @@ void TACSAssembler::evalEnergies( TacsScalar *Te, TacsScalar *Pe ){
   residual:      the residual evaluated at the current point
 */
 void TACSAssembler::assembleRes( TACSBVec *residual ){
+  TACSProfileTimer timer(TACSProfiler::ASSEMBLE_RES);
+  TACSProfiler::addCount(TACSProfiler::ELEMENT_COUNT, numElements);
+
   // Sort the list of auxiliary elements - this only performs the
   // sort if it is required (if new elements are added)
   if (auxElements){
@@ -3528,6 +3552,9 @@ void TACSAssembler::assembleJacobian( double alpha, double beta,
                                       TACSBVec *residual,
                                       TACSMat *A,
                                       MatrixOrientation matOr ){
+  TACSProfileTimer timer(TACSProfiler::ASSEMBLE_JACOBIAN);
+  TACSProfiler::addCount(TACSProfiler::ELEMENT_COUNT, numElements);
+
   // Zero the residual and the matrix
   if (residual){
     residual->zeroEntries();
@@ -3660,6 +3687,9 @@ void TACSAssembler::assembleJacobian( double alpha, double beta,
 void TACSAssembler::assembleMatType( ElementMatrixType matType,
                                      TACSMat *A,
                                      MatrixOrientation matOr ){
+  TACSProfileTimer timer(TACSProfiler::ASSEMBLE_MAT_TYPE);
+  TACSProfiler::addCount(TACSProfiler::ELEMENT_COUNT, numElements);
+
   // Zero the matrix
   A->zeroEntries();
 
@@ -3734,6 +3764,9 @@ void TACSAssembler::assembleMatCombo( ElementMatrixType matTypes[],
                                       int nmats,
                                       TACSMat *A,
                                       MatrixOrientation matOr ){
+  TACSProfileTimer timer(TACSProfiler::ASSEMBLE_MAT_TYPE);
+  TACSProfiler::addCount(TACSProfiler::ELEMENT_COUNT, numElements);
+
   // Zero the matrix
   A->zeroEntries();
 
@@ -3791,6 +3824,8 @@ void TACSAssembler::assembleMatCombo( ElementMatrixType matTypes[],
 void TACSAssembler::evalFunctions( TACSFunction **funcs,
                                    int numFuncs,
                                    TacsScalar *funcVals ){
+  TACSProfileTimer timer(TACSProfiler::EVAL_FUNCTIONS);
+
   // Here we will use time-independent formulation
   double tcoef = 1.0;
 
@@ -3862,6 +3897,50 @@ void TACSAssembler::integrateFunctions( double tcoef,
   getDataPointers(elementData, &vars, &dvars, &ddvars, NULL,
                     &elemXpts, NULL, NULL, NULL);
 
+  if (thread_info->getNumThreads() > 1){
+    tacsPInfo->tacs = this;
+    tacsPInfo->coef = tcoef;
+    tacsPInfo->ftype = ftype;
+    tacsPInfo->numFuncs = 1;
+
+    // Create the joinable attribute
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
+
+    // Integrate each function in turn with all the threads
+    for ( int k = 0; k < numFuncs; k++ ){
+      if (funcs[k]){
+        numCompletedElements = 0;
+        tacsPInfo->functions = &funcs[k];
+
+        for ( int j = 0; j < thread_info->getNumThreads(); j++ ){
+          pthread_create(&threads[j], &attr,
+                         TACSAssembler::integrateFunctions_thread,
+                         (void*)tacsPInfo);
+        }
+
+        // Join all the threads
+        for ( int j = 0; j < thread_info->getNumThreads(); j++ ){
+          pthread_join(threads[j], NULL);
+        }
+
+        // Record the number of element evaluations
+        int count = numElements;
+        if (funcs[k]->getDomainType() == TACSFunction::SUB_DOMAIN){
+          const int *elementNums;
+          count = funcs[k]->getElementNums(&elementNums);
+        }
+        TACSProfiler::addCount(TACSProfiler::ELEMENT_COUNT, count);
+      }
+    }
+
+    // Destroy the attribute
+    pthread_attr_destroy(&attr);
+
+    return;
+  }
+
   for ( int k = 0; k < numFuncs; k++ ){
     if (funcs[k]){
       TACSFunctionCtx *ctx =
@@ -3886,6 +3965,7 @@ void TACSAssembler::integrateFunctions( double tcoef,
           funcs[k]->elementWiseEval(ftype, elements[i], i,
                                     elemXpts, vars, dvars, ddvars, ctx);
         }
+        TACSProfiler::addCount(TACSProfiler::ELEMENT_COUNT, numElements);
       }
       else if (funcs[k]->getDomainType() == TACSFunction::SUB_DOMAIN){
         const int *elementNums;
@@ -3910,6 +3990,7 @@ void TACSAssembler::integrateFunctions( double tcoef,
                                       elemXpts, vars, dvars, ddvars, ctx);
           }
         }
+        TACSProfiler::addCount(TACSProfiler::ELEMENT_COUNT, subDomainSize);
       }
 
       // Record the local values stored in the context
@@ -3958,6 +4039,9 @@ void TACSAssembler::integrateFunctions( double tcoef,
 void TACSAssembler::addDVSens( double coef,
                                TACSFunction **funcs, int numFuncs,
                                TacsScalar *fdvSens, int numDVs ){
+  TACSProfileTimer timer(TACSProfiler::EVAL_SENSITIVITIES);
+  TACSProfiler::addCount(TACSProfiler::ELEMENT_COUNT, numElements);
+
   // Retrieve pointers to temporary storage
   TacsScalar *vars, *dvars, *ddvars, *elemXpts;
   getDataPointers(elementData, &vars, &dvars, &ddvars, NULL,
@@ -4035,6 +4119,9 @@ void TACSAssembler::addDVSens( double coef,
 void TACSAssembler::addXptSens( double coef,
                                 TACSFunction **funcs, int numFuncs,
                                 TACSBVec **fXptSens ){
+  TACSProfileTimer timer(TACSProfiler::EVAL_SENSITIVITIES);
+  TACSProfiler::addCount(TACSProfiler::ELEMENT_COUNT, numElements);
+
   // First check if this is the right assembly object
   for ( int k = 0; k < numFuncs; k++ ){
     if (funcs[k] && this != funcs[k]->getTACS()){
@@ -4123,6 +4210,9 @@ void TACSAssembler::addSVSens( double alpha, double beta,
                                double gamma,
                                TACSFunction **funcs, int numFuncs,
                                TACSBVec **vec ){
+  TACSProfileTimer timer(TACSProfiler::EVAL_SENSITIVITIES);
+  TACSProfiler::addCount(TACSProfiler::ELEMENT_COUNT, numElements);
+
   // First check if this is the right assembly object
   for ( int k = 0; k < numFuncs; k++ ){
     if (funcs[k] && this != funcs[k]->getTACS()){
@@ -4224,6 +4314,9 @@ void TACSAssembler::addAdjointResProducts( double scale,
                                            int numAdjoints,
                                            TacsScalar *fdvSens,
                                            int numDVs ){
+  TACSProfileTimer timer(TACSProfiler::EVAL_SENSITIVITIES);
+  TACSProfiler::addCount(TACSProfiler::ELEMENT_COUNT, numElements);
+
   for ( int k = 0; k < numAdjoints; k++ ){
     adjoint[k]->beginDistributeValues();
   }
@@ -4300,6 +4393,9 @@ void TACSAssembler::addAdjointResXptSensProducts( double scale,
                                                   TACSBVec **adjoint,
                                                   int numAdjoints,
                                                   TACSBVec **adjXptSens ){
+  TACSProfileTimer timer(TACSProfiler::EVAL_SENSITIVITIES);
+  TACSProfiler::addCount(TACSProfiler::ELEMENT_COUNT, numElements);
+
   for ( int k = 0; k < numAdjoints; k++ ){
     adjoint[k]->beginDistributeValues();
   }
@@ -4377,6 +4473,9 @@ void TACSAssembler::addMatDVSensInnerProduct( double scale,
                                               ElementMatrixType matType,
                                               TACSBVec *psi, TACSBVec *phi,
                                               TacsScalar *fdvSens, int numDVs ){
+  TACSProfileTimer timer(TACSProfiler::EVAL_SENSITIVITIES);
+  TACSProfiler::addCount(TACSProfiler::ELEMENT_COUNT, numElements);
+
   psi->beginDistributeValues();
   if (phi != psi){
     phi->beginDistributeValues();
@@ -4411,6 +4510,120 @@ void TACSAssembler::addMatDVSensInnerProduct( double scale,
   }
 }
 
+/*
+  Evaluate the derivatives of several inner products with a linear
+  combination of matrix types in a single pass over the elements.
+
+  This computes the derivative of
+
+  psi[k]^{T}*(sum_{j} scale[k*nmats + j]*A[j])*phi[k]
+
+  for k = 0, ..., numVecs-1, where A[j] is the matrix of type
+  matTypes[j]. The result for the k-th pair of vectors is added to
+  dvSens[k*numDVs]. This is used to evaluate the derivatives of
+  several eigenvalues at once: the element node locations and state
+  variables are retrieved once per element and the work is split
+  between threads when more than one thread is set.
+
+  input:
+  nmats:     the number of matrix types
+  matTypes:  the matrix types
+  scale:     the scaling factors (length nmats*numVecs)
+  numVecs:   the number of vector pairs
+  psi:       the left-multiplying vectors
+  phi:       the right-multiplying vectors
+  numDVs:    the length of the design variable array
+
+  output:
+  dvSens:    the derivatives of the inner products (numVecs*numDVs)
+*/
+void TACSAssembler::addMatDVSensInnerProducts( int nmats,
+                                               ElementMatrixType matTypes[],
+                                               const double scale[],
+                                               int numVecs,
+                                               TACSBVec **psi,
+                                               TACSBVec **phi,
+                                               TacsScalar *fdvSens,
+                                               int numDVs ){
+  TACSProfileTimer timer(TACSProfiler::EVAL_SENSITIVITIES);
+  TACSProfiler::addCount(TACSProfiler::ELEMENT_COUNT, numElements);
+
+  for ( int k = 0; k < numVecs; k++ ){
+    psi[k]->beginDistributeValues();
+    if (phi[k] != psi[k]){
+      phi[k]->beginDistributeValues();
+    }
+  }
+  for ( int k = 0; k < numVecs; k++ ){
+    psi[k]->endDistributeValues();
+    if (phi[k] != psi[k]){
+      phi[k]->endDistributeValues();
+    }
+  }
+
+  if (thread_info->getNumThreads() > 1){
+    // Set the number of completed elements to zero
+    numCompletedElements = 0;
+    tacsPInfo->tacs = this;
+    tacsPInfo->numMats = nmats;
+    tacsPInfo->matTypes = matTypes;
+    tacsPInfo->matScale = scale;
+    tacsPInfo->numVecs = numVecs;
+    tacsPInfo->psi = psi;
+    tacsPInfo->phi = phi;
+    tacsPInfo->numDesignVars = numDVs;
+    tacsPInfo->fdvSens = fdvSens;
+
+    // Create the joinable attribute
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
+
+    for ( int k = 0; k < thread_info->getNumThreads(); k++ ){
+      pthread_create(&threads[k], &attr,
+                     TACSAssembler::addMatDVSensInnerProducts_thread,
+                     (void*)tacsPInfo);
+    }
+
+    // Join all the threads
+    for ( int k = 0; k < thread_info->getNumThreads(); k++ ){
+      pthread_join(threads[k], NULL);
+    }
+
+    // Destroy the attribute
+    pthread_attr_destroy(&attr);
+  }
+  else {
+    // Retrieve pointers to temporary storage
+    TacsScalar *elemVars, *elemPsi, *elemPhi, *elemXpts;
+    getDataPointers(elementData, &elemVars, &elemPsi, &elemPhi, NULL,
+                    &elemXpts, NULL, NULL, NULL);
+
+    for ( int i = 0; i < numElements; i++ ){
+      // Find the variables and nodes
+      int ptr = elementNodeIndex[i];
+      int len = elementNodeIndex[i+1] - ptr;
+      const int *nodes = &elementTacsNodes[ptr];
+      xptVec->getValues(len, nodes, elemXpts);
+      varsVec->getValues(len, nodes, elemVars);
+
+      for ( int k = 0; k < numVecs; k++ ){
+        psi[k]->getValues(len, nodes, elemPsi);
+        phi[k]->getValues(len, nodes, elemPhi);
+
+        // Add the contribution from each matrix type
+        for ( int j = 0; j < nmats; j++ ){
+          elements[i]->addMatDVSensInnerProduct(matTypes[j],
+                                                scale[k*nmats + j],
+                                                &fdvSens[k*numDVs], numDVs,
+                                                elemPsi, elemPhi, elemXpts,
+                                                elemVars);
+        }
+      }
+    }
+  }
+}
+
 /*
   Evaluate the derivative of the inner product of two vectors with a
   matrix with respect to the state variables. This is only defined for
@@ -4430,6 +4643,9 @@ void TACSAssembler::addMatDVSensInnerProduct( double scale,
 void TACSAssembler::evalMatSVSensInnerProduct( ElementMatrixType matType,
                                                TACSBVec *psi, TACSBVec *phi,
                                                TACSBVec *res ){
+  TACSProfileTimer timer(TACSProfiler::EVAL_SENSITIVITIES);
+  TACSProfiler::addCount(TACSProfiler::ELEMENT_COUNT, numElements);
+
   // Zero the entries in the residual vector
   res->zeroEntries();
 
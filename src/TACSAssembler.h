@@ -244,6 +244,10 @@ class TACSAssembler : public TACSObject {
                                  ElementMatrixType matType, 
                                  TACSBVec *psi, TACSBVec *phi,
                                  TacsScalar *dvSens, int numDVs );
+  void addMatDVSensInnerProducts( int nmats, ElementMatrixType matTypes[],
+                                  const double scale[], int numVecs,
+                                  TACSBVec **psi, TACSBVec **phi,
+                                  TacsScalar *dvSens, int numDVs );
   void evalMatSVSensInnerProduct( ElementMatrixType matType, 
                                   TACSBVec *psi, TACSBVec *phi, 
                                   TACSBVec *res );
@@ -273,6 +277,7 @@ class TACSAssembler : public TACSObject {
   // Set the number of threads to work with
   // --------------------------------------
   void setNumThreads( int t );
+  TACSThreadInfo *getThreadInfo(){ return thread_info; }
 
   // Get information about the output files; For use by TACSToFH5
   // ------------------------------------------------------------
@@ -421,6 +426,8 @@ class TACSAssembler : public TACSObject {
   static void *assembleRes_thread( void *t );
   static void *assembleJacobian_thread( void *t );
   static void *assembleMatType_thread( void *t );
+  static void *integrateFunctions_thread( void *t );
+  static void *addMatDVSensInnerProducts_thread( void *t );
 
   // Class to store specific information about the threaded
   // operations to perform. Note that assembly operations are
@@ -444,6 +451,11 @@ class TACSAssembler : public TACSObject {
       fdvSens = NULL;
       fXptSens = NULL;
       adjoints = NULL;
+      numMats = 0;
+      matTypes = NULL;
+      matScale = NULL;
+      numVecs = 0;
+      psi = phi = NULL;
     }
 
     // The data required to perform most of the matrix
@@ -472,6 +484,13 @@ class TACSAssembler : public TACSObject {
     // Information for adjoint-dR/dx products
     int numAdjoints;
     TACSBVec **adjoints;
+
+    // Information for the derivative of matrix inner products
+    int numMats;
+    ElementMatrixType *matTypes;
+    const double *matScale;
+    int numVecs;
+    TACSBVec **psi, **phi;
   } *tacsPInfo;
 
   // The pthread data required to pthread tacs operations
@@ -489,10 +508,13 @@ class TACSAssembler : public TACSObject {
 /*
   Add the values of the element matrix to the provided TACSMat. 
 
-  This code takes into account dependent-nodes (when they exist) by
-  adding the inner product of the dependent weights with the element
-  matrix.  Note that the integer and scalar temporary storage should
-  be allocated once for all elements for efficiency purposes. The
+  The matrices created by TACSAssembler store a pre-computed map from
+  the element matrix blocks to the matrix entries, which is used
+  whenever it is available for the element. Otherwise, this code
+  takes into account dependent-nodes (when they exist) by adding the
+  inner product of the dependent weights with the element matrix.
+  Note that the integer and scalar temporary storage should be
+  allocated once for all elements for efficiency purposes. The
   maximum weight length can be determined by finding the maximum
   number of nodes + max total number of dependent->local nodes in any
   local element.
@@ -516,6 +538,11 @@ inline void TACSAssembler::addMatValues( TACSMat *A,
   int nnodes = end - start;
   int nvars = varsPerNode*nnodes;
 
+  // Add the values using the pre-computed assembly map, if any
+  if (A->addElementValues(elemNum, nvars, mat, matOr)){
+    return;
+  }
+
   // Add the element values to the matrix
   const int *nodeNums = &elementTacsNodes[start];
 
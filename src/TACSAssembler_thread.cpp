@@ -55,11 +55,13 @@ void *TACSAssembler::assembleRes_thread( void *t ){
   TACSAssembler *tacs = pinfo->tacs;
   TACSBVec *res = pinfo->res;
 
-  // Allocate a temporary array large enough to store everything required  
+  // Get the temporary arrays for the element data from the pool
   int s = tacs->maxElementSize;
   int sx = 3*tacs->maxElementNodes;
   int dataSize = 4*s + sx;
-  TacsScalar *data = new TacsScalar[ dataSize ];
+  TACSMemoryPool *pool = tacs->varMap->getMemoryPool();
+  TacsScalar *data =
+    (TacsScalar*)pool->allocate(dataSize*sizeof(TacsScalar));
   
   // Set pointers to the allocate memory
   TacsScalar *vars = &data[0];
@@ -116,7 +118,7 @@ void *TACSAssembler::assembleRes_thread( void *t ){
     }
   }
 
-  delete [] data;
+  pool->release(data);
 
   pthread_exit(NULL);
 }
@@ -143,14 +145,16 @@ void *TACSAssembler::assembleJacobian_thread( void *t ){
   double gamma = pinfo->gamma;
   MatrixOrientation matOr = pinfo->matOr;
 
-  // Allocate a temporary array large enough to store everything
-  // required
+  // Get the temporary arrays for the element data from the pool
   int s = tacs->maxElementSize;
   int sx = 3*tacs->maxElementNodes;
   int sw = tacs->maxElementIndepNodes;
   int dataSize = 4*s + sx + s*s + sw;
-  TacsScalar *data = new TacsScalar[ dataSize ];
-  int *idata = new int[ sw + tacs->maxElementNodes + 1 ];
+  TACSMemoryPool *pool = tacs->varMap->getMemoryPool();
+  TacsScalar *data =
+    (TacsScalar*)pool->allocate(dataSize*sizeof(TacsScalar));
+  int *idata =
+    (int*)pool->allocate((sw + tacs->maxElementNodes + 1)*sizeof(int));
 
   // Set pointers to the allocate memory
   TacsScalar *vars = &data[0];
@@ -227,8 +231,8 @@ void *TACSAssembler::assembleJacobian_thread( void *t ){
     }
   }
 
-  delete [] data;
-  delete [] idata;
+  pool->release(data);
+  pool->release(idata);
 
   pthread_exit(NULL);
 }
@@ -254,13 +258,16 @@ void *TACSAssembler::assembleMatType_thread( void *t ){
   ElementMatrixType matType = pinfo->matType;
   MatrixOrientation matOr = pinfo->matOr;
 
-  // Allocate a temporary array large enough to store everything required  
+  // Get the temporary arrays for the element data from the pool
   int s = tacs->maxElementSize;
   int sx = 3*tacs->maxElementNodes;
   int sw = tacs->maxElementIndepNodes;
   int dataSize = s + sx + s*s + sw;
-  TacsScalar *data = new TacsScalar[ dataSize ];
-  int *idata = new int[ sw + tacs->maxElementNodes + 1 ];
+  TACSMemoryPool *pool = tacs->varMap->getMemoryPool();
+  TacsScalar *data =
+    (TacsScalar*)pool->allocate(dataSize*sizeof(TacsScalar));
+  int *idata =
+    (int*)pool->allocate((sw + tacs->maxElementNodes + 1)*sizeof(int));
   
   TacsScalar *vars = &data[0];
   TacsScalar *elemXpts = &data[s];
@@ -293,8 +300,189 @@ void *TACSAssembler::assembleMatType_thread( void *t ){
     }
   }
 
-  delete [] data;
+  pool->release(data);
+  pool->release(idata);
 
   pthread_exit(NULL);
 }
 
+
+/*!
+  The threaded-implementation of the function integration
+
+  Each thread evaluates the function over its elements using its own
+  function context. The contributions from each context are added to
+  the function in the mutex-protected call to finalThread(). This
+  function uses the following information from the
+  TACSAssemblerPthreadInfo class:
+
+  coef:       the integration coefficient
+  ftype:      the type of evaluation
+  functions:  the pointer to the function to integrate
+*/
+void *TACSAssembler::integrateFunctions_thread( void *t ){
+  TACSAssemblerPthreadInfo *pinfo =
+    static_cast<TACSAssemblerPthreadInfo*>(t);
+
+  // Un-pack information for this computation
+  TACSAssembler *tacs = pinfo->tacs;
+  TACSFunction *func = pinfo->functions[0];
+  double tcoef = pinfo->coef;
+  TACSFunction::EvaluationType ftype = pinfo->ftype;
+
+  // Get the temporary arrays for the element data from the pool
+  int s = tacs->maxElementSize;
+  int sx = 3*tacs->maxElementNodes;
+  int dataSize = 3*s + sx;
+  TACSMemoryPool *pool = tacs->varMap->getMemoryPool();
+  TacsScalar *data =
+    (TacsScalar*)pool->allocate(dataSize*sizeof(TacsScalar));
+
+  TacsScalar *vars = &data[0];
+  TacsScalar *dvars = &data[s];
+  TacsScalar *ddvars = &data[2*s];
+  TacsScalar *elemXpts = &data[3*s];
+
+  // Determine the elements in the domain of the function
+  const int *elementNums = NULL;
+  int size = tacs->numElements;
+  if (func->getDomainType() == TACSFunction::SUB_DOMAIN){
+    size = func->getElementNums(&elementNums);
+  }
+
+  // Initialize the function evaluation context for this thread
+  TACSFunctionCtx *ctx = func->createFunctionCtx();
+  func->initThread(tcoef, ftype, ctx);
+
+  while (tacs->numCompletedElements < size){
+    int index = -1;
+    TACSAssembler::schedPthreadJob(tacs, &index, size);
+
+    if (index >= 0){
+      int elemIndex = index;
+      if (elementNums){
+        elemIndex = elementNums[index];
+        if (elemIndex < 0 || elemIndex >= tacs->numElements){
+          continue;
+        }
+      }
+
+      // Retrieve the variable values
+      int ptr = tacs->elementNodeIndex[elemIndex];
+      int len = tacs->elementNodeIndex[elemIndex+1] - ptr;
+      const int *nodes = &tacs->elementTacsNodes[ptr];
+      tacs->xptVec->getValues(len, nodes, elemXpts);
+      tacs->varsVec->getValues(len, nodes, vars);
+      tacs->dvarsVec->getValues(len, nodes, dvars);
+      tacs->ddvarsVec->getValues(len, nodes, ddvars);
+
+      // Evaluate the element-wise component of the function
+      func->elementWiseEval(ftype, tacs->elements[elemIndex], elemIndex,
+                            elemXpts, vars, dvars, ddvars, ctx);
+    }
+  }
+
+  // Add the values stored in the context to the function
+  pthread_mutex_lock(&tacs->tacs_mutex);
+  func->finalThread(tcoef, ftype, ctx);
+  pthread_mutex_unlock(&tacs->tacs_mutex);
+
+  if (ctx){ delete ctx; }
+  pool->release(data);
+
+  pthread_exit(NULL);
+}
+
+/*!
+  The threaded-implementation of the derivative of the matrix inner
+  products
+
+  Each thread accumulates the contribution from its elements into a
+  private array that is added to the result once all of its elements
+  have been processed. This function uses the following information
+  from the TACSAssemblerPthreadInfo class:
+
+  numMats:        the number of matrix types
+  matTypes:       the matrix types
+  matScale:       the scaling factors (numVecs*numMats)
+  numVecs:        the number of vector pairs
+  psi:            the left-multiplying vectors
+  phi:            the right-multiplying vectors
+  numDesignVars:  the number of design variables
+  fdvSens:        the derivatives (output)
+*/
+void *TACSAssembler::addMatDVSensInnerProducts_thread( void *t ){
+  TACSAssemblerPthreadInfo *pinfo =
+    static_cast<TACSAssemblerPthreadInfo*>(t);
+
+  // Un-pack information for this computation
+  TACSAssembler *tacs = pinfo->tacs;
+  int nmats = pinfo->numMats;
+  ElementMatrixType *matTypes = pinfo->matTypes;
+  const double *scale = pinfo->matScale;
+  int numVecs = pinfo->numVecs;
+  TACSBVec **psi = pinfo->psi;
+  TACSBVec **phi = pinfo->phi;
+  int numDVs = pinfo->numDesignVars;
+
+  // Get the temporary arrays for the element data from the pool
+  int s = tacs->maxElementSize;
+  int sx = 3*tacs->maxElementNodes;
+  int dataSize = 3*s + sx;
+  TACSMemoryPool *pool = tacs->varMap->getMemoryPool();
+  TacsScalar *data =
+    (TacsScalar*)pool->allocate(dataSize*sizeof(TacsScalar));
+
+  TacsScalar *vars = &data[0];
+  TacsScalar *elemPsi = &data[s];
+  TacsScalar *elemPhi = &data[2*s];
+  TacsScalar *elemXpts = &data[3*s];
+
+  // Allocate the thread-local design variable sensitivities
+  TacsScalar *fdvSens =
+    (TacsScalar*)pool->allocate(numVecs*numDVs*sizeof(TacsScalar));
+  memset(fdvSens, 0, numVecs*numDVs*sizeof(TacsScalar));
+
+  while (tacs->numCompletedElements < tacs->numElements){
+    int elemIndex = -1;
+    TACSAssembler::schedPthreadJob(tacs, &elemIndex, tacs->numElements);
+
+    if (elemIndex >= 0){
+      // Get the element
+      TACSElement *element = tacs->elements[elemIndex];
+
+      // Retrieve the variable values
+      int ptr = tacs->elementNodeIndex[elemIndex];
+      int len = tacs->elementNodeIndex[elemIndex+1] - ptr;
+      const int *nodes = &tacs->elementTacsNodes[ptr];
+      tacs->xptVec->getValues(len, nodes, elemXpts);
+      tacs->varsVec->getValues(len, nodes, vars);
+
+      for ( int k = 0; k < numVecs; k++ ){
+        psi[k]->getValues(len, nodes, elemPsi);
+        phi[k]->getValues(len, nodes, elemPhi);
+
+        // Add the contribution from each matrix type
+        for ( int j = 0; j < nmats; j++ ){
+          element->addMatDVSensInnerProduct(matTypes[j],
+                                            scale[k*nmats + j],
+                                            &fdvSens[k*numDVs], numDVs,
+                                            elemPsi, elemPhi, elemXpts,
+                                            vars);
+        }
+      }
+    }
+  }
+
+  // Add the contributions from this thread to the result
+  pthread_mutex_lock(&tacs->tacs_mutex);
+  for ( int i = 0; i < numVecs*numDVs; i++ ){
+    pinfo->fdvSens[i] += fdvSens[i];
+  }
+  pthread_mutex_unlock(&tacs->tacs_mutex);
+
+  pool->release(data);
+  pool->release(fdvSens);
+
+  pthread_exit(NULL);
+}
@@ -169,6 +169,24 @@ void TACSLinearBuckling::setSigma( TacsScalar _sigma ){
   ep_op->setSigma(sigma);
 }
 
+/*
+  Use a block Lanczos method with thick restarts to solve the
+  eigenproblem. In this case, max_lanczos_vecs is the size of the
+  subspace retained between restarts.
+*/
+void TACSLinearBuckling::setKrylovSchur( int block_size, int max_restarts ){
+  sep->setKrylovSchur(block_size, max_restarts);
+}
+
+/*
+  Start each solve from the eigenvectors of the previous solve. This
+  reduces the cost of re-solving the eigenproblem after small changes
+  in the design.
+*/
+void TACSLinearBuckling::setRecycle( int num_recycle ){
+  sep->setRecycle(num_recycle);
+}
+
 /*
   Solve the linearized buckling problem about x = 0.
 
@@ -368,50 +386,99 @@ void TACSLinearBuckling::checkEigenvector( int n ){
 void TACSLinearBuckling::evalEigenDVSens( int n,
                                           TacsScalar fdvSens[],
                                           int numDVs ){
+  evalEigenDVSens(1, &n, fdvSens, numDVs);
+}
+
+/*
+  Compute the derivatives of several buckling eigenvalues at once.
+
+  The derivative of the k-th eigenvalue eig_nums[k] is stored in
+  fdvSens[k*numDVs]. If eig_nums is NULL, the derivatives of the first
+  neigs eigenvalues are computed.
+
+  The inner products for all the eigenvectors are evaluated in a
+  single (threaded) pass over the elements. The stiffness matrix is
+  factored once and the factorization is re-used for all of the
+  adjoint solves for the load path, and the adjoint-residual products
+  are evaluated together in one pass over the elements.
+*/
+void TACSLinearBuckling::evalEigenDVSens( int neigs,
+                                          const int eig_nums[],
+                                          TacsScalar fdvSens[],
+                                          int numDVs ){
   // Zero the derivative
-  memset(fdvSens, 0, numDVs*sizeof(TacsScalar));
+  memset(fdvSens, 0, neigs*numDVs*sizeof(TacsScalar));
 
   // Copy over the values of the stiffness matrix, factor
   // the stiffness matrix.
   aux_mat->copyValues(kmat);
   pc->factor();
 
-  // Get the eigenvalue and eigenvector
-  TacsScalar error;
-  TacsScalar eig = extractEigenvector(n, eigvec, &error);
-
-  // Evaluate the partial derivative for the stiffness matrix
-  tacs->addMatDVSensInnerProduct(1.0, STIFFNESS_MATRIX,
-                                 eigvec, eigvec, fdvSens, numDVs);
-  int mpi_rank;
-  MPI_Comm_rank(tacs->getMPIComm(),&mpi_rank);
-
-  // Evaluate the derivative of the geometric stiffness matrix
-  tacs->addMatDVSensInnerProduct(TacsRealPart(eig), GEOMETRIC_STIFFNESS_MATRIX,
-                                 eigvec, eigvec, fdvSens, numDVs);
-
-  // Evaluate derivative of the inner product with respect to
-  // the path variables
-  tacs->evalMatSVSensInnerProduct(GEOMETRIC_STIFFNESS_MATRIX,
-                                  eigvec, eigvec, res);
-
-  // Solve for the adjoint vector and evaluate the derivative of
-  // the adjoint-residual inner product
-  solver->solve(res, update);
-  tacs->addAdjointResProducts(-TacsRealPart(eig), &update, 1,
+  // Allocate space for the eigenvectors and the adjoint vectors
+  TacsScalar *eigs = new TacsScalar[ neigs ];
+  double *scale = new double[ 2*neigs ];
+  TACSBVec **vecs = new TACSBVec*[ neigs ];
+  TACSBVec **adjoints = new TACSBVec*[ neigs ];
+
+  // Get the eigenvalues and eigenvectors
+  for ( int k = 0; k < neigs; k++ ){
+    int n = k;
+    if (eig_nums){
+      n = eig_nums[k];
+    }
+
+    vecs[k] = tacs->createVec();
+    vecs[k]->incref();
+    adjoints[k] = tacs->createVec();
+    adjoints[k]->incref();
+
+    TacsScalar error;
+    eigs[k] = extractEigenvector(n, vecs[k], &error);
+    scale[2*k] = 1.0;
+    scale[2*k+1] = TacsRealPart(eigs[k]);
+  }
+
+  // Evaluate the partial derivative for the stiffness matrix and the
+  // geometric stiffness matrix for all the eigenvectors at once
+  ElementMatrixType matTypes[2] = {STIFFNESS_MATRIX,
+                                   GEOMETRIC_STIFFNESS_MATRIX};
+  tacs->addMatDVSensInnerProducts(2, matTypes, scale, neigs,
+                                  vecs, vecs, fdvSens, numDVs);
+
+  for ( int k = 0; k < neigs; k++ ){
+    // Evaluate derivative of the inner product with respect to
+    // the path variables
+    tacs->evalMatSVSensInnerProduct(GEOMETRIC_STIFFNESS_MATRIX,
+                                    vecs[k], vecs[k], res);
+
+    // Solve for the adjoint vector using the existing factorization
+    // and include the eigenvalue in the scaling
+    solver->solve(res, adjoints[k]);
+    adjoints[k]->scale(-TacsRealPart(eigs[k]));
+  }
+
+  // Evaluate the derivative of the adjoint-residual inner products
+  tacs->addAdjointResProducts(1.0, adjoints, neigs,
                               fdvSens, numDVs);
 
-  // Now compute the inner product: u^{T}*G*u
-  gmat->mult(eigvec, res);
-  TacsScalar scale = res->dot(eigvec);
+  for ( int k = 0; k < neigs; k++ ){
+    // Now compute the inner product: u^{T}*G*u
+    gmat->mult(vecs[k], res);
+    TacsScalar s = -1.0/res->dot(vecs[k]);
 
-  // Prepare to scale the final result
-  scale = -1.0/scale;
+    // Scale the gradient to complete the calculation
+    for ( int i = 0; i < numDVs; i++ ){
+      fdvSens[k*numDVs + i] *= s;
+    }
 
-  // Scale the gradient to complete the calculation
-  for ( int i = 0; i < numDVs; i++ ){
-    fdvSens[i] *= scale;
+    vecs[k]->decref();
+    adjoints[k]->decref();
   }
+
+  delete [] eigs;
+  delete [] scale;
+  delete [] vecs;
+  delete [] adjoints;
 }
 
 /*!
@@ -486,6 +553,8 @@ stiffness matrix\n");
   sep->incref();
   sep->setTolerances(eig_tol, SEP::SMALLEST_MAGNITUDE,
                      num_eigvals);
+  num_eigs = num_eigvals;
+  this->eig_tol = eig_tol;
 
   // Set unallocated objects to NULL
   pcmat = NULL;
@@ -578,6 +647,8 @@ TACSFrequencyAnalysis::TACSFrequencyAnalysis( TACSAssembler *_tacs,
   ep_op = NULL;
   sep = NULL;
   solver = NULL;
+  num_eigs = num_eigvals;
+  eig_tol = eigtol;
 
   // Set the tolerance to the Jacobi-Davidson solver
   jd->setTolerances(eigtol, eig_rtol, eig_atol);
@@ -624,6 +695,63 @@ void TACSFrequencyAnalysis::setSigma( TacsScalar _sigma ){
   }
 }
 
+/*
+  Use a block Lanczos method with thick restarts to solve the
+  eigenproblem. This only applies when the Lanczos method is used.
+*/
+void TACSFrequencyAnalysis::setKrylovSchur( int block_size,
+                                            int max_restarts ){
+  if (sep){
+    sep->setKrylovSchur(block_size, max_restarts);
+  }
+}
+
+/*
+  Start each solve from the eigenvectors of the previous solve. With
+  the Jacobi-Davidson method, the previous eigenvectors are used to
+  form the initial search space.
+*/
+void TACSFrequencyAnalysis::setRecycle( int num_recycle ){
+  if (sep){
+    sep->setRecycle(num_recycle);
+  }
+  else if (jd){
+    jd->setRecycle(num_recycle, JD_NUM_RECYCLE);
+  }
+}
+
+/*
+  Set the number of correction vectors added to the Jacobi-Davidson
+  search space per iteration. This only applies when the
+  Jacobi-Davidson method is used.
+*/
+void TACSFrequencyAnalysis::setJDBlockSize( int block_size ){
+  if (jd){
+    jd->setBlockSize(block_size);
+  }
+}
+
+/*
+  Re-use the Jacobi-Davidson preconditioner between calls to
+  setSigma() and between solves. The preconditioner is only
+  refactored when the residual is not reduced by a factor of
+  stall_rtol within stall_iters iterations. This is effective when
+  the eigenproblem is re-solved after small design changes.
+*/
+void TACSFrequencyAnalysis::setJDFactorReuse( int reuse,
+                                              int stall_iters,
+                                              double stall_rtol ){
+  if (jd){
+    jd_op->setFactorReuse(reuse);
+    if (reuse){
+      jd->setRefactorPolicy(stall_iters, stall_rtol);
+    }
+    else {
+      jd->setRefactorPolicy(0, stall_rtol);
+    }
+  }
+}
+
 /*
   Solve the eigenvalue problem
 */
@@ -665,30 +793,8 @@ void TACSFrequencyAnalysis::solve( KSMPrint *ksm_print,
     } 
   }
   else{
-    if (mg){
-      // Assemble the mass matrix
-      ElementMatrixType matTypes[2] = {STIFFNESS_MATRIX, 
-                                       MASS_MATRIX};
-      TacsScalar scale[2] = {1.0, -sigma};
-
-      // Assemble the mass matrix
-      tacs->assembleMatType(MASS_MATRIX, mmat);
-
-      // Assemble the linear combination
-      mg->assembleMatCombo(matTypes, scale, 2);
-    }
-    else {
-      // Assemble the stiffness and mass matrices
-      tacs->assembleMatType(STIFFNESS_MATRIX, kmat);
-      tacs->assembleMatType(MASS_MATRIX, mmat);
-
-      // Form the shifted operator and factor it
-      kmat->axpy(-sigma, mmat);
-      kmat->applyBCs(tacs->getBcMap());
-    }
-
-    // Factor the preconditioner
-    pc->factor();
+    // Assemble and factor the shifted operator
+    factorShiftedOperator();
     
     // Solve the symmetric eigenvalue problem
     double t0 = MPI_Wtime();
@@ -702,6 +808,73 @@ void TACSFrequencyAnalysis::solve( KSMPrint *ksm_print,
   }
 }
 
+/*
+  Assemble the shifted operator K - sigma*M and factor the
+  preconditioner
+*/
+void TACSFrequencyAnalysis::factorShiftedOperator(){
+  if (mg){
+    // Assemble the mass matrix
+    ElementMatrixType matTypes[2] = {STIFFNESS_MATRIX, 
+                                     MASS_MATRIX};
+    TacsScalar scale[2] = {1.0, -sigma};
+
+    // Assemble the mass matrix
+    tacs->assembleMatType(MASS_MATRIX, mmat);
+
+    // Assemble the linear combination
+    mg->assembleMatCombo(matTypes, scale, 2);
+  }
+  else {
+    // Assemble the stiffness and mass matrices
+    tacs->assembleMatType(STIFFNESS_MATRIX, kmat);
+    tacs->assembleMatType(MASS_MATRIX, mmat);
+
+    // Form the shifted operator and factor it
+    kmat->axpy(-sigma, mmat);
+    kmat->applyBCs(tacs->getBcMap());
+  }
+
+  // Factor the preconditioner
+  pc->factor();
+}
+
+/*
+  Set the shift, factor the shifted operator K - sigma*M and return
+  the number of eigenvalues below the shift from the inertia of the
+  factorization. This is only available for the Lanczos method and
+  returns -1 if the preconditioner cannot provide the inertia.
+*/
+int TACSFrequencyAnalysis::factorAndCountEigs( TacsScalar _sigma ){
+  if (!sep){
+    fprintf(stderr, "TACSFrequency: Eigenvalue counts are only available "
+            "with the Lanczos method\n");
+    return -1;
+  }
+
+  setSigma(_sigma);
+  factorShiftedOperator();
+
+  return pc->getNumNegEigs();
+}
+
+/*
+  Solve for the neigs eigenvalues immediately below the shift using
+  the operator factored in the last call to factorAndCountEigs().
+  The eigenvalues are ordered by decreasing value.
+*/
+void TACSFrequencyAnalysis::solveFactored( int neigs, 
+                                           KSMPrint *ksm_print ){
+  if (!sep){
+    return;
+  }
+
+  tacs->zeroVariables();
+  sep->setTolerances(eig_tol, SEP::SMALLEST_TRANSFORMED, neigs);
+  sep->solve(ksm_print);
+  sep->setTolerances(eig_tol, SEP::SMALLEST_MAGNITUDE, num_eigs);
+}
+
 /*!
   Extract the eigenvalue from the analysis
 */
@@ -767,29 +940,65 @@ TacsScalar TACSFrequencyAnalysis::checkOrthogonality(){
 void TACSFrequencyAnalysis::evalEigenDVSens( int n,
                                              TacsScalar fdvSens[],
                                              int numDVs ){
+  evalEigenDVSens(1, &n, fdvSens, numDVs);
+}
+
+/*
+  Compute the derivatives of several eigenvalues at once.
+
+  The derivative of the k-th eigenvalue eig_nums[k] is stored in
+  fdvSens[k*numDVs]. If eig_nums is NULL, the derivatives of the first
+  neigs eigenvalues are computed. The inner products for all the
+  eigenvectors are evaluated in a single (threaded) pass over the
+  elements.
+*/
+void TACSFrequencyAnalysis::evalEigenDVSens( int neigs,
+                                             const int eig_nums[],
+                                             TacsScalar fdvSens[],
+                                             int numDVs ){
   // Zero the derivative
-  memset(fdvSens, 0, numDVs*sizeof(TacsScalar));
+  memset(fdvSens, 0, neigs*numDVs*sizeof(TacsScalar));
+
+  // Allocate space for the eigenvectors
+  double *scale = new double[ 2*neigs ];
+  TACSBVec **vecs = new TACSBVec*[ neigs ];
 
-  // Extract the eigenvalue and eigenvector
-  TacsScalar error;
-  TacsScalar eig = extractEigenvector(n, eigvec, &error);
+  // Extract the eigenvalues and eigenvectors
+  for ( int k = 0; k < neigs; k++ ){
+    int n = k;
+    if (eig_nums){
+      n = eig_nums[k];
+    }
+
+    vecs[k] = tacs->createVec();
+    vecs[k]->incref();
 
-  // Evaluate the partial derivative for the stiffness matrix
-  tacs->addMatDVSensInnerProduct(1.0, STIFFNESS_MATRIX,
-                                 eigvec, eigvec, fdvSens, numDVs);
+    TacsScalar error;
+    TacsScalar eig = extractEigenvector(n, vecs[k], &error);
+    scale[2*k] = 1.0;
+    scale[2*k+1] = -TacsRealPart(eig);
+  }
 
-  // Evaluate the derivative of the geometric stiffness matrix
-  tacs->addMatDVSensInnerProduct(-TacsRealPart(eig), MASS_MATRIX,
-                                 eigvec, eigvec, fdvSens, numDVs);
+  // Evaluate the partial derivative for the stiffness and mass
+  // matrices for all the eigenvectors at once
+  ElementMatrixType matTypes[2] = {STIFFNESS_MATRIX, MASS_MATRIX};
+  tacs->addMatDVSensInnerProducts(2, matTypes, scale, neigs,
+                                  vecs, vecs, fdvSens, numDVs);
 
-  // Finish computing the derivative
-  mmat->mult(eigvec, res);
-  TacsScalar scale = 1.0/res->dot(eigvec);
+  for ( int k = 0; k < neigs; k++ ){
+    // Finish computing the derivative
+    mmat->mult(vecs[k], res);
+    TacsScalar s = 1.0/res->dot(vecs[k]);
 
-  // Finish computing the derivative
-  for ( int i = 0; i < numDVs; i++ ){
-    fdvSens[i] *= scale;
+    for ( int i = 0; i < numDVs; i++ ){
+      fdvSens[k*numDVs + i] *= s;
+    }
+
+    vecs[k]->decref();
   }
+
+  delete [] scale;
+  delete [] vecs;
 }
 
 /*!
@@ -827,3 +1036,225 @@ void TACSFrequencyAnalysis::checkEigenvector( int n ){
   t1->decref();
   t2->decref();
 }
+
+/*
+  Create the spectrum slicing object.
+
+  Each processor in the global communicator passes in the frequency
+  analysis object for its group. The groups are identified by the
+  processors with rank zero in each sub-communicator.
+
+  input:
+  comm:  the global communicator containing all groups
+  freq:  the Lanczos frequency analysis object for this group
+*/
+TACSSpectrumSlicing::TACSSpectrumSlicing( MPI_Comm _comm,
+                                          TACSFrequencyAnalysis *_freq ){
+  comm = _comm;
+  freq = _freq;
+  freq->incref();
+
+  // Find the rank within the group
+  MPI_Comm sub_comm = freq->getTACS()->getMPIComm();
+  int sub_rank;
+  MPI_Comm_rank(sub_comm, &sub_rank);
+
+  // Number the groups by the rank of their root processor
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm root_comm;
+  MPI_Comm_split(comm, (sub_rank == 0 ? 0 : MPI_UNDEFINED),
+                 rank, &root_comm);
+
+  group = num_groups = 0;
+  if (root_comm != MPI_COMM_NULL){
+    MPI_Comm_rank(root_comm, &group);
+    MPI_Comm_size(root_comm, &num_groups);
+    MPI_Comm_free(&root_comm);
+  }
+  MPI_Bcast(&group, 1, MPI_INT, 0, sub_comm);
+  MPI_Bcast(&num_groups, 1, MPI_INT, 0, sub_comm);
+
+  num_eigs = 0;
+  eigs = NULL;
+  num_local = max_local = local_offset = 0;
+  vecs = NULL;
+}
+
+TACSSpectrumSlicing::~TACSSpectrumSlicing(){
+  clear();
+  freq->decref();
+}
+
+/*
+  Free the eigenvalues and the locally stored eigenvectors
+*/
+void TACSSpectrumSlicing::clear(){
+  for ( int i = 0; i < num_local; i++ ){
+    vecs[i]->decref();
+  }
+  if (vecs){ delete [] vecs; }
+  if (eigs){ delete [] eigs; }
+  num_eigs = 0;
+  eigs = NULL;
+  num_local = max_local = local_offset = 0;
+  vecs = NULL;
+}
+
+/*
+  Compute all the eigenvalues in the interval [lower, upper).
+
+  The interval is divided into nslices equal slices that are
+  distributed in contiguous chunks to the groups. Each group factors
+  the shifted matrix at the slice end points in ascending order, so
+  that each factorization is used both for the inertia count and the
+  eigenvalue solve for the slice below the shift.
+
+  This call is collective on the global communicator. The function
+  returns the number of eigenvalues found, or -1 if the inertia could
+  not be computed.
+*/
+int TACSSpectrumSlicing::solve( TacsScalar lower, TacsScalar upper,
+                                int nslices, KSMPrint *ksm_print ){
+  clear();
+  if (nslices < 1){
+    nslices = 1;
+  }
+
+  // Determine the slices owned by this group
+  int start = (group*nslices)/num_groups;
+  int end = ((group+1)*nslices)/num_groups;
+  TacsScalar h = (upper - lower)/(1.0*nslices);
+
+  // The eigenvalues computed by this group
+  TacsScalar *local_eigs = NULL;
+
+  int fail = 0;
+  if (start < end){
+    int nprev = freq->factorAndCountEigs(lower + (1.0*start)*h);
+    if (nprev < 0){
+      fail = 1;
+    }
+
+    for ( int k = start; k < end && !fail; k++ ){
+      int ncount = freq->factorAndCountEigs(lower + (1.0*(k+1))*h);
+      if (ncount < 0){
+        fail = 1;
+        break;
+      }
+
+      int n = ncount - nprev;
+      nprev = ncount;
+      if (n <= 0){
+        continue;
+      }
+
+      freq->solveFactored(n, ksm_print);
+
+      // Extend the arrays of eigenvalues/eigenvectors if required
+      if (num_local + n > max_local){
+        max_local = 2*max_local + n;
+        TACSBVec **tmp = new TACSBVec*[ max_local ];
+        TacsScalar *etmp = new TacsScalar[ max_local ];
+        if (vecs){
+          memcpy(tmp, vecs, num_local*sizeof(TACSBVec*));
+          memcpy(etmp, local_eigs, num_local*sizeof(TacsScalar));
+          delete [] vecs;
+          delete [] local_eigs;
+        }
+        vecs = tmp;
+        local_eigs = etmp;
+      }
+
+      // The eigenvalues are returned in decreasing order from the
+      // shift, so store them in reverse order
+      for ( int i = n-1; i >= 0; i-- ){
+        TacsScalar error;
+        vecs[num_local] = freq->getTACS()->createVec();
+        vecs[num_local]->incref();
+        local_eigs[num_local] = 
+          freq->extractEigenvector(i, vecs[num_local], &error);
+        num_local++;
+      }
+    }
+  }
+
+  // Check if any group failed
+  int fail_all = 0;
+  MPI_Allreduce(&fail, &fail_all, 1, MPI_INT, MPI_MAX, comm);
+  if (fail_all){
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+    if (rank == 0){
+      fprintf(stderr, "TACSSpectrumSlicing: Error, the preconditioner "
+              "cannot compute the matrix inertia\n");
+    }
+    if (local_eigs){ delete [] local_eigs; }
+    clear();
+    return -1;
+  }
+
+  // Gather the eigenvalues from the root of each group. The slices
+  // are assigned in group order, so the result is in ascending order
+  MPI_Comm sub_comm = freq->getTACS()->getMPIComm();
+  int sub_rank;
+  MPI_Comm_rank(sub_comm, &sub_rank);
+
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm root_comm;
+  MPI_Comm_split(comm, (sub_rank == 0 ? 0 : MPI_UNDEFINED),
+                 rank, &root_comm);
+
+  int *counts = new int[ num_groups ];
+  int *ptr = new int[ num_groups+1 ];
+  if (root_comm != MPI_COMM_NULL){
+    MPI_Allgather(&num_local, 1, MPI_INT, counts, 1, MPI_INT, root_comm);
+  }
+  MPI_Bcast(counts, num_groups, MPI_INT, 0, sub_comm);
+
+  ptr[0] = 0;
+  for ( int i = 0; i < num_groups; i++ ){
+    ptr[i+1] = ptr[i] + counts[i];
+  }
+  num_eigs = ptr[num_groups];
+  local_offset = ptr[group];
+
+  eigs = new TacsScalar[ num_eigs ];
+  if (root_comm != MPI_COMM_NULL){
+    MPI_Allgatherv(local_eigs, num_local, TACS_MPI_TYPE,
+                   eigs, counts, ptr, TACS_MPI_TYPE, root_comm);
+    MPI_Comm_free(&root_comm);
+  }
+  MPI_Bcast(eigs, num_eigs, TACS_MPI_TYPE, 0, sub_comm);
+
+  delete [] counts;
+  delete [] ptr;
+  if (local_eigs){ delete [] local_eigs; }
+
+  return num_eigs;
+}
+
+/*
+  Extract the n-th eigenvalue in ascending order
+*/
+TacsScalar TACSSpectrumSlicing::extractEigenvalue( int n ){
+  if (n < 0 || n >= num_eigs){
+    fprintf(stderr, "TACSSpectrumSlicing: Eigenvalue out of range\n");
+    return 0.0;
+  }
+  return eigs[n];
+}
+
+/*
+  Copy the n-th eigenvector into ans if it was computed by this
+  group. The function returns 1 if the eigenvector was copied and 0
+  otherwise.
+*/
+int TACSSpectrumSlicing::extractEigenvector( int n, TACSBVec *ans ){
+  if (n >= local_offset && n < local_offset + num_local){
+    ans->copyValues(vecs[n - local_offset]);
+    return 1;
+  }
+  return 0;
+}
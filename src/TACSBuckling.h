@@ -59,10 +59,17 @@ class TACSLinearBuckling : public TACSObject {
   TacsScalar getSigma();
   void setSigma( TacsScalar sigma );
 
+  // Use the block Krylov-Schur eigensolver
+  // --------------------------------------
+  void setKrylovSchur( int block_size, int max_restarts );
+  void setRecycle( int num_recycle );
+
   // Solve the eigenvalue problem
   // ----------------------------
   void solve( TACSVec *rhs=NULL, KSMPrint *ksm_print=NULL );
   void evalEigenDVSens( int n, TacsScalar fdvSens[], int numDVs );
+  void evalEigenDVSens( int neigs, const int eig_nums[],
+                        TacsScalar fdvSens[], int numDVs );
 
   // Extract the eigenvalue or check the solution
   // --------------------------------------------
@@ -151,8 +158,15 @@ class TACSFrequencyAnalysis : public TACSObject {
   // ----------------------------------------
   TacsScalar getSigma();
   void setSigma( TacsScalar _sigma );
+  void setKrylovSchur( int block_size, int max_restarts );
+  void setRecycle( int num_recycle );
+  void setJDBlockSize( int block_size );
+  void setJDFactorReuse( int reuse, int stall_iters=3, 
+                         double stall_rtol=0.5 );
   void solve( KSMPrint *ksm_print=NULL, KSMPrint *ksm_file=NULL );
   void evalEigenDVSens( int n, TacsScalar fdvSens[], int numDVs );
+  void evalEigenDVSens( int neigs, const int eig_nums[],
+                        TacsScalar fdvSens[], int numDVs );
 
   // Extract and check the solution
   // ------------------------------
@@ -161,7 +175,15 @@ class TACSFrequencyAnalysis : public TACSObject {
   void checkEigenvector( int n );
   TacsScalar checkOrthogonality();
 
+  // Factor K - sigma*M and solve for eigenvalues below the shift
+  // ------------------------------------------------------------
+  int factorAndCountEigs( TacsScalar _sigma );
+  void solveFactored( int neigs, KSMPrint *ksm_print=NULL );
+
  private:
+  // Assemble and factor the shifted operator K - sigma*M
+  void factorShiftedOperator();
+
   // The TACS assembler object
   TACSAssembler *tacs;
 
@@ -180,6 +202,8 @@ class TACSFrequencyAnalysis : public TACSObject {
   TacsScalar sigma;
   EPGeneralizedShiftInvert *ep_op;
   SEP *sep;
+  int num_eigs;
+  double eig_tol;
 
   // Objects associated with the Jacobi-Davidson method
   TACSJDFrequencyOperator *jd_op;
@@ -189,4 +213,61 @@ class TACSFrequencyAnalysis : public TACSObject {
   TACSBVec *eigvec, *res;
 };
 
+/*
+  Spectrum slicing for the natural frequency problem.
+
+  The interval [lower, upper] is divided into slices. The number of
+  eigenvalues in each slice is determined from the inertia of the
+  factored shifted matrix K - sigma*M at the slice end points
+  (Sylvester's law of inertia), and the eigenvalues within each slice
+  are computed using a shift and invert Lanczos method with the shift
+  placed at the upper end of the slice. The factorization used for
+  counting is re-used for the eigenvalue solve.
+
+  The slices are distributed between groups of processors. Each group
+  owns a separate frequency analysis object defined on its own
+  sub-communicator of the global communicator. The eigenvalues are
+  shared between all groups after the solve, while the eigenvectors
+  remain with the group that computed them.
+
+  Note that the inertia count requires a preconditioner that provides
+  an exact factorization of the shifted matrix (e.g. PcScMat with
+  sufficient fill).
+*/
+class TACSSpectrumSlicing : public TACSObject {
+ public:
+  TACSSpectrumSlicing( MPI_Comm _comm, TACSFrequencyAnalysis *_freq );
+  ~TACSSpectrumSlicing();
+
+  // Solve for all eigenvalues within the interval
+  // ---------------------------------------------
+  int solve( TacsScalar lower, TacsScalar upper, int nslices,
+             KSMPrint *ksm_print=NULL );
+
+  // Extract the solution
+  // --------------------
+  int getNumEigenvalues(){ return num_eigs; }
+  TacsScalar extractEigenvalue( int n );
+  int extractEigenvector( int n, TACSBVec *ans );
+
+ private:
+  // Free the local eigenvectors
+  void clear();
+
+  // The global communicator and the group information
+  MPI_Comm comm;
+  int group, num_groups;
+
+  // The frequency analysis object on the sub-communicator
+  TACSFrequencyAnalysis *freq;
+
+  // All eigenvalues in ascending order
+  int num_eigs;
+  TacsScalar *eigs;
+
+  // The eigenvectors computed by this group
+  int num_local, max_local, local_offset;
+  TACSBVec **vecs;
+};
+
 #endif // TACS_BUCKLING_H
@@ -46,6 +46,230 @@ static int compare_arg_sort( const void * a, const void * b ){
   return aval - bval;
 }
 
+/*
+  Exchange data between all processors.
+
+  Each processor sends send_count[k] records to processor k and
+  receives recv_count[k] records from processor k, where each record
+  consists of 'factor' entries. The received data is ordered by the
+  sending processor.
+*/
+template <class T>
+static T *exchange_data( MPI_Comm comm, MPI_Datatype dtype, int factor,
+                         const T *send, const int *send_count, 
+                         const int *recv_count ){
+  int size;
+  MPI_Comm_size(comm, &size);
+
+  int *sc = new int[ size ];
+  int *sp = new int[ size ];
+  int *rc = new int[ size ];
+  int *rp = new int[ size ];
+  int ns = 0, nr = 0;
+  for ( int k = 0; k < size; k++ ){
+    sc[k] = factor*send_count[k];
+    sp[k] = ns;  ns += sc[k];
+    rc[k] = factor*recv_count[k];
+    rp[k] = nr;  nr += rc[k];
+  }
+
+  T *recv = new T[ nr ];
+  MPI_Alltoallv((void*)send, sc, sp, dtype, recv, rc, rp, dtype, comm);
+
+  delete [] sc;
+  delete [] sp;
+  delete [] rc;
+  delete [] rp;
+
+  return recv;
+}
+
+/*
+  Compute the key of a point along a 3D Hilbert curve.
+
+  The coordinates are integers with the given number of bits. The
+  key is computed using Skilling's transpose algorithm and has 3*bits
+  bits.
+*/
+static unsigned long long hilbert_key( unsigned int x[], int bits ){
+  const int n = 3;
+  unsigned int M = 1U << (bits-1);
+
+  // Inverse undo excess work
+  for ( unsigned int Q = M; Q > 1; Q >>= 1 ){
+    unsigned int P = Q-1;
+    for ( int i = 0; i < n; i++ ){
+      if (x[i] & Q){
+        x[0] ^= P;
+      }
+      else {
+        unsigned int t = (x[0] ^ x[i]) & P;
+        x[0] ^= t;
+        x[i] ^= t;
+      }
+    }
+  }
+
+  // Gray encode
+  for ( int i = 1; i < n; i++ ){
+    x[i] ^= x[i-1];
+  }
+  unsigned int t = 0;
+  for ( unsigned int Q = M; Q > 1; Q >>= 1 ){
+    if (x[n-1] & Q){
+      t ^= Q-1;
+    }
+  }
+  for ( int i = 0; i < n; i++ ){
+    x[i] ^= t;
+  }
+
+  // Interleave the bits of the transposed coordinates
+  unsigned long long key = 0;
+  for ( int b = bits-1; b >= 0; b-- ){
+    for ( int i = 0; i < n; i++ ){
+      key = (key << 1) | ((x[i] >> b) & 1);
+    }
+  }
+
+  return key;
+}
+
+/*
+  Compute the key of a point along a 3D Morton (Z-order) curve by
+  interleaving the bits of the integer coordinates.
+*/
+static unsigned long long morton_key( const unsigned int x[], int bits ){
+  unsigned long long key = 0;
+  for ( int b = bits-1; b >= 0; b-- ){
+    for ( int i = 0; i < 3; i++ ){
+      key = (key << 1) | ((x[i] >> b) & 1);
+    }
+  }
+
+  return key;
+}
+
+/*
+  Compute the keys of a set of points along a space-filling curve.
+
+  The points are scaled by the largest extent of the bounding box so
+  that the aspect ratio is preserved.
+
+  input:
+  curve:    the type of curve (HILBERT_ORDER or MORTON_ORDER)
+  npts:     the number of points
+  X:        the point locations
+  lower:    the lower bounds of the box containing the points
+  extent:   the largest extent of the box
+
+  output:
+  keys:     the keys of the points along the curve
+*/
+static void compute_curve_keys( int curve, int npts, const double *X, 
+                                const double lower[], double extent,
+                                unsigned long long *keys ){
+  const int bits = 21;
+  const unsigned int max_coord = (1U << bits)-1;
+  if (extent <= 0.0){
+    extent = 1.0;
+  }
+
+  for ( int k = 0; k < npts; k++ ){
+    unsigned int x[3];
+    for ( int i = 0; i < 3; i++ ){
+      double t = (X[3*k+i] - lower[i])/extent;
+      if (t < 0.0){ t = 0.0; }
+      if (t > 1.0){ t = 1.0; }
+      x[i] = (unsigned int)(max_coord*t);
+    }
+    if (curve == TACSCreator::MORTON_ORDER){
+      keys[k] = morton_key(x, bits);
+    }
+    else {
+      keys[k] = hilbert_key(x, bits);
+    }
+  }
+}
+
+/*
+  Find the lower bounds and the largest extent of the box containing
+  the given points
+*/
+static double compute_bounds( int npts, const double *X, 
+                              double lower[] ){
+  double upper[3];
+  lower[0] = lower[1] = lower[2] = 1e300;
+  upper[0] = upper[1] = upper[2] = -1e300;
+  for ( int k = 0; k < npts; k++ ){
+    for ( int i = 0; i < 3; i++ ){
+      if (X[3*k+i] < lower[i]){ lower[i] = X[3*k+i]; }
+      if (X[3*k+i] > upper[i]){ upper[i] = X[3*k+i]; }
+    }
+  }
+
+  double extent = 0.0;
+  for ( int i = 0; i < 3; i++ ){
+    if (upper[i] - lower[i] > extent){
+      extent = upper[i] - lower[i];
+    }
+  }
+  return extent;
+}
+
+/*
+  Compare two (key, index) pairs of unsigned 64-bit integers
+*/
+static int compare_key_pairs( const void *a, const void *b ){
+  const unsigned long long *pa = (const unsigned long long*)a;
+  const unsigned long long *pb = (const unsigned long long*)b;
+  if (pa[0] < pb[0]){ return -1; }
+  else if (pa[0] > pb[0]){ return 1; }
+  else if (pa[1] < pb[1]){ return -1; }
+  else if (pa[1] > pb[1]){ return 1; }
+  return 0;
+}
+
+/*
+  Sort a list of indices so that keys[list[i]] is in ascending
+  order. Entries with equal keys retain their relative order.
+*/
+static void sort_by_keys( int n, int *list, 
+                          const unsigned long long *keys ){
+  unsigned long long *pairs = new unsigned long long[ 2*n ];
+  for ( int i = 0; i < n; i++ ){
+    pairs[2*i] = keys[list[i]];
+    pairs[2*i+1] = i;
+  }
+  qsort(pairs, n, 2*sizeof(unsigned long long), compare_key_pairs);
+
+  int *temp = new int[ n ];
+  for ( int i = 0; i < n; i++ ){
+    temp[i] = list[pairs[2*i+1]];
+  }
+  memcpy(list, temp, n*sizeof(int));
+  delete [] temp;
+  delete [] pairs;
+}
+
+/*
+  Find the most frequent entry in a sorted list of integers. Ties are
+  broken in favor of the smallest entry.
+*/
+static int find_most_frequent( const int *list, int len ){
+  int value = -1, count = 0;
+  for ( int i = 0; i < len; ){
+    int j = i+1;
+    while (j < len && list[j] == list[i]){ j++; }
+    if (j - i > count){
+      value = list[i];
+      count = j - i;
+    }
+    i = j;
+  }
+  return value;
+}
+
 /*
   Allocate the TACSCreator object
 */
@@ -105,6 +329,18 @@ TACSCreator::TACSCreator( MPI_Comm _comm,
   num_owned_elements = 0;
   num_owned_nodes = 0;
   local_elem_id_nums = NULL;
+
+  // By default, the mesh is set on the root processor
+  dist_mesh = 0;
+  num_local_elements = 0;
+  node_range = NULL;
+
+  // Do not refine the geometric partition by default
+  refine_sweeps = 0;
+  refine_imbalance = 0.05;
+
+  // Keep the element and node order from the input mesh
+  locality_order = NO_LOCALITY_ORDER;
 }
 
 /*
@@ -127,6 +363,7 @@ TACSCreator::~TACSCreator(){
   if (owned_elements){ delete [] owned_elements; }
   if (owned_nodes){ delete [] owned_nodes; }
   if (local_elem_id_nums){ delete [] local_elem_id_nums; }
+  if (node_range){ delete [] node_range; }
 
   if (elements){
     for ( int i = 0; i < num_elem_ids; i++ ){
@@ -184,6 +421,9 @@ void TACSCreator::setDependentNodes( int num_dep_nodes,
 
 /*
   Set the boundary condition data
+
+  For a distributed mesh, each processor may set any subset of the
+  boundary conditions in terms of the global node numbers.
 */
 void TACSCreator::setBoundaryConditions( int _num_bcs, 
                                          const int *_bc_nodes, 
@@ -263,6 +503,103 @@ void TACSCreator::setNodes( const TacsScalar *_Xpts ){
   memcpy(Xpts, _Xpts, 3*num_nodes*sizeof(TacsScalar));
 }
 
+/*
+  Set the element connectivity for a distributed mesh.
+
+  This is an alternative to setGlobalConnectivity() that avoids
+  storing the global mesh on the root processor. Each processor
+  passes in a contiguous block of the global elements, such that the
+  blocks are ordered by processor rank. The connectivity is given in
+  terms of the global node numbers, which must be non-negative since
+  dependent nodes are not supported with a distributed mesh.
+
+  This call is collective on all processors in the communicator.
+
+  input:
+  _num_nodes:        the global number of nodes
+  _num_elements:     the number of elements on this processor
+  _elem_node_ptr:    the local element->node pointer
+  _elem_node_conn:   the local element->node connectivity
+  _elem_id_nums:     the element id numbers of the local elements
+*/
+void TACSCreator::setDistributedConnectivity( int _num_nodes,
+                                              int _num_elements,
+                                              const int *_elem_node_ptr,
+                                              const int *_elem_node_conn,
+                                              const int *_elem_id_nums ){
+  // Set the global number of nodes/elements
+  num_nodes = _num_nodes;
+  num_local_elements = _num_elements;
+  MPI_Allreduce(&num_local_elements, &num_elements, 1, MPI_INT,
+                MPI_SUM, comm);
+  dist_mesh = 1;
+
+  // Copy over the local part of the connectivity
+  if (elem_node_ptr){ delete [] elem_node_ptr; }
+  elem_node_ptr = new int[ num_local_elements+1 ];
+  memcpy(elem_node_ptr, _elem_node_ptr, 
+         (num_local_elements+1)*sizeof(int));
+
+  if (elem_node_conn){ delete [] elem_node_conn; }
+  elem_node_conn = new int[ elem_node_ptr[num_local_elements] ];
+  memcpy(elem_node_conn, _elem_node_conn,
+         elem_node_ptr[num_local_elements]*sizeof(int));
+
+  if (elem_id_nums){ delete [] elem_id_nums; }
+  elem_id_nums = new int[ num_local_elements ];
+  memcpy(elem_id_nums, _elem_id_nums, num_local_elements*sizeof(int));
+}
+
+/*
+  Set the node locations for a distributed mesh.
+
+  Each processor passes in the locations of a contiguous block of the
+  global nodes, such that the blocks are ordered by processor rank.
+  This call is collective on all processors in the communicator.
+
+  input:
+  num_local_nodes:  the number of nodes on this processor
+  _Xpts:            the locations of the local nodes
+*/
+void TACSCreator::setDistributedNodes( int num_local_nodes,
+                                       const TacsScalar *_Xpts ){
+  int size;
+  MPI_Comm_size(comm, &size);
+
+  // Find the ranges of nodes on each processor
+  if (node_range){ delete [] node_range; }
+  node_range = new int[ size+1 ];
+  node_range[0] = 0;
+  MPI_Allgather(&num_local_nodes, 1, MPI_INT, 
+                &node_range[1], 1, MPI_INT, comm);
+  for ( int k = 0; k < size; k++ ){
+    node_range[k+1] += node_range[k];
+  }
+
+  if (Xpts){ delete [] Xpts; }
+  Xpts = new TacsScalar[ 3*num_local_nodes ];
+  memcpy(Xpts, _Xpts, 3*num_local_nodes*sizeof(TacsScalar));
+}
+
+/*
+  Set the number of refinement sweeps applied to the geometric
+  partition of a distributed mesh.
+
+  During each sweep, elements on the boundary of a partition are
+  moved to the partition that owns the majority of their nodes, as
+  long as the size of the receiving partition does not exceed the
+  average size by more than the given fraction.
+
+  input:
+  num_sweeps:   the number of refinement sweeps
+  imbalance:    the allowable load imbalance
+*/
+void TACSCreator::setPartitionRefinement( int num_sweeps, 
+                                          double imbalance ){
+  refine_sweeps = num_sweeps;
+  refine_imbalance = imbalance;
+}
+
 /*
   Set the type of ordering to use
 */
@@ -273,6 +610,29 @@ void TACSCreator::setReorderingType( TACSAssembler::OrderingType _order_type,
   mat_type = _mat_type;
 }
 
+/*
+  Set the space-filling curve used to order the elements and nodes
+  on each processor.
+
+  The elements on each processor are ordered along the curve through
+  their centroids and the owned nodes are numbered along the curve
+  through their locations. This improves the locality of the element
+  loops in TACSAssembler since elements that are adjacent in the loop
+  share nodes that are stored close together.
+
+  This ordering is applied before the ordering set by
+  setReorderingType(). The element order is kept, but a reordering
+  computed by TACSAssembler renumbers the nodes. The fill-reducing
+  orderings used within the matrix factorizations (e.g. in FEMat) are
+  computed independently and do not modify either ordering.
+
+  input:
+  curve:   the type of space-filling curve
+*/
+void TACSCreator::setLocalityOrdering( LocalityOrderType curve ){
+  locality_order = curve;
+}
+
 /*
   Get the new node numbers
 */
@@ -401,6 +761,11 @@ TACSAssembler* TACSCreator::createTACS(){
   MPI_Comm_size(comm, &size);
   MPI_Comm_rank(comm, &rank);
 
+  // Use the parallel path if the mesh is distributed
+  if (dist_mesh){
+    return createDistributedTACS();
+  }
+
   if (rank == root_rank && !partition){   
     // Partition the mesh using the serial code on the root
     // processor.
@@ -438,6 +803,66 @@ TACSAssembler* TACSCreator::createTACS(){
 
   // For each processor, send the information to the owner
   if (rank == root_rank){
+    // Order the nodes owned by each partition along the space-filling
+    // curve and compute the keys used to order the elements
+    unsigned long long *elem_keys = NULL;
+    if (locality_order != NO_LOCALITY_ORDER && Xpts){
+      double *X = new double[ 3*num_nodes ];
+      for ( int i = 0; i < 3*num_nodes; i++ ){
+        X[i] = TacsRealPart(Xpts[i]);
+      }
+      double lower[3];
+      double extent = compute_bounds(num_nodes, X, lower);
+
+      unsigned long long *keys = new unsigned long long[ num_nodes ];
+      compute_curve_keys(locality_order, num_nodes, X, 
+                         lower, extent, keys);
+
+      // Find the nodes in the current order, sort the nodes owned by
+      // each partition and assign the new node numbers
+      int *node_order = new int[ num_nodes ];
+      for ( int i = 0; i < num_nodes; i++ ){
+        if (new_nodes[i] >= 0){
+          node_order[new_nodes[i]] = i;
+        }
+      }
+      int offset = 0;
+      for ( int k = 0; k < size; k++ ){
+        sort_by_keys(owned_nodes[k], &node_order[offset], keys);
+        offset += owned_nodes[k];
+      }
+      for ( int i = 0; i < offset; i++ ){
+        new_nodes[node_order[i]] = i;
+      }
+      delete [] node_order;
+      delete [] keys;
+
+      // Compute the element centroids from the independent nodes
+      double *Xc = new double[ 3*num_elements ];
+      for ( int k = 0; k < num_elements; k++ ){
+        double xc[3] = {0.0, 0.0, 0.0};
+        int nn = 0;
+        for ( int i = elem_node_ptr[k]; i < elem_node_ptr[k+1]; i++ ){
+          int node = elem_node_conn[i];
+          if (node >= 0){
+            xc[0] += X[3*node];
+            xc[1] += X[3*node+1];
+            xc[2] += X[3*node+2];
+            nn++;
+          }
+        }
+        for ( int j = 0; j < 3; j++ ){
+          Xc[3*k+j] = (nn > 0 ? xc[j]/nn : lower[j]);
+        }
+      }
+      delete [] X;
+
+      elem_keys = new unsigned long long[ num_elements ];
+      compute_curve_keys(locality_order, num_elements, Xc, 
+                         lower, extent, elem_keys);
+      delete [] Xc;
+    }
+
     // Reset the nodes for the boundary conditions so that they
     // correspond to the new ordering
     for ( int j = 0; j < num_bcs; j++ ){
@@ -463,6 +888,16 @@ TACSAssembler* TACSCreator::createTACS(){
     qsort(elem_part, num_elements, sizeof(int), compare_arg_sort);
     arg_sort_list = NULL;
 
+    // Order the elements within each partition along the curve
+    if (elem_keys){
+      int offset = 0;
+      for ( int k = 0; k < size; k++ ){
+        sort_by_keys(owned_elements[k], &elem_part[offset], elem_keys);
+        offset += owned_elements[k];
+      }
+      delete [] elem_keys;
+    }
+
     // Determine a sorted ordering of the new dependent nodes
     // that can be used to map depedent nodes to process owners
     int *dep_nodes_part = NULL;
@@ -735,6 +1170,30 @@ TACSAssembler* TACSCreator::createTACS(){
     MPI_Bcast(bc_vals, bc_ptr[num_bcs], TACS_MPI_TYPE, root_rank, comm);
   }
 
+  return createAssembler(num_local_dep_nodes, local_dep_node_ptr,
+                         local_dep_node_conn, local_dep_node_weights,
+                         local_elem_node_ptr, local_elem_node_conn,
+                         Xpts_local);
+}
+
+/*
+  Create the TACSAssembler object from the part of the mesh owned by
+  this processor.
+
+  The connectivity and boundary conditions are in terms of the new
+  global node numbers. The local element connectivity and node
+  locations are freed before returning.
+*/
+TACSAssembler *TACSCreator::createAssembler( int num_local_dep_nodes,
+                                             int *local_dep_node_ptr,
+                                             int *local_dep_node_conn,
+                                             double *local_dep_node_weights,
+                                             int *local_elem_node_ptr,
+                                             int *local_elem_node_conn,
+                                             TacsScalar *Xpts_local ){
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+
   TACSAssembler * tacs = 
     new TACSAssembler(comm, vars_per_node, num_owned_nodes,
                       num_owned_elements, num_local_dep_nodes);
@@ -860,6 +1319,831 @@ TACSAssembler* TACSCreator::createTACS(){
   return tacs;
 }
 
+/*
+  Send requests for information about a sorted list of nodes to the
+  processors that own the blocks of the distributed nodes.
+
+  input:
+  comm:         the communicator
+  node_range:   the ranges of the blocks of nodes
+  num_nodes:    the number of nodes in the sorted list
+  nodes:        the sorted list of nodes
+
+  output:
+  send_count:   the number of requests sent to each processor
+  recv_count:   the number of requests received from each processor
+  num_req:      the total number of requests received
+
+  returns:
+  the requested nodes ordered by the sending processor
+*/
+static int *send_node_requests( MPI_Comm comm, const int *node_range,
+                                int num_nodes, const int *nodes,
+                                int *send_count, int *recv_count,
+                                int *num_req ){
+  int size;
+  MPI_Comm_size(comm, &size);
+
+  int *ext_ptr = new int[ size+1 ];
+  FElibrary::matchIntervals(size, node_range, num_nodes, nodes, ext_ptr);
+  for ( int k = 0; k < size; k++ ){
+    send_count[k] = ext_ptr[k+1] - ext_ptr[k];
+  }
+  delete [] ext_ptr;
+
+  MPI_Alltoall(send_count, 1, MPI_INT, recv_count, 1, MPI_INT, comm);
+  *num_req = 0;
+  for ( int k = 0; k < size; k++ ){
+    *num_req += recv_count[k];
+  }
+
+  return exchange_data(comm, MPI_INT, 1, nodes, send_count, recv_count);
+}
+
+/*
+  Compare two unsigned 64-bit keys
+*/
+static int compare_keys( const void *a, const void *b ){
+  unsigned long long ka = *(const unsigned long long*)a;
+  unsigned long long kb = *(const unsigned long long*)b;
+  if (ka < kb){ return -1; }
+  else if (ka > kb){ return 1; }
+  return 0;
+}
+
+/*
+  Partition a distributed mesh in parallel.
+
+  The elements are ordered along a Hilbert space-filling curve
+  through their centroids and the curve is split into segments with
+  an equal number of elements. The splitting keys are found with a
+  parallel bisection on the key values so that the elements never
+  have to be sorted globally. The partition can then be improved by
+  a number of refinement sweeps (see setPartitionRefinement()).
+
+  output:
+  part:       the partition of each of the local elements
+  elem_keys:  (optional) the keys of the elements along the locality
+              ordering curve
+*/
+void TACSCreator::partitionDistributedMesh( int *part,
+                                            unsigned long long *elem_keys ){
+  int rank, size;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
+
+  // Find the unique nodes referenced by the local elements
+  int conn_size = elem_node_ptr[num_local_elements];
+  int *nodes = new int[ conn_size ];
+  memcpy(nodes, elem_node_conn, conn_size*sizeof(int));
+  int num_elem_nodes = FElibrary::uniqueSort(nodes, conn_size);
+
+  // Retrieve the node locations from the processors that own them
+  int *send_count = new int[ size ];
+  int *recv_count = new int[ size ];
+  int num_req = 0;
+  int *req = send_node_requests(comm, node_range, num_elem_nodes, nodes,
+                                send_count, recv_count, &num_req);
+
+  TacsScalar *Xreq = new TacsScalar[ 3*num_req ];
+  for ( int i = 0; i < num_req; i++ ){
+    int n = req[i] - node_range[rank];
+    for ( int j = 0; j < 3; j++ ){
+      Xreq[3*i+j] = Xpts[3*n+j];
+    }
+  }
+  TacsScalar *X = exchange_data(comm, TACS_MPI_TYPE, 3, Xreq,
+                                recv_count, send_count);
+  delete [] Xreq;
+
+  // Replace the connectivity with indices into the list of nodes
+  int *elem_nodes = new int[ conn_size ];
+  for ( int j = 0; j < conn_size; j++ ){
+    int *item = (int*)bsearch(&elem_node_conn[j], nodes, num_elem_nodes,
+                              sizeof(int), FElibrary::comparator);
+    elem_nodes[j] = item - nodes;
+  }
+
+  // Compute the element centroids and the bounding box
+  double *Xc = new double[ 3*num_local_elements ];
+  double box[6] = {1e300, 1e300, 1e300, 1e300, 1e300, 1e300};
+  for ( int e = 0; e < num_local_elements; e++ ){
+    double xc[3] = {0.0, 0.0, 0.0};
+    int nn = elem_node_ptr[e+1] - elem_node_ptr[e];
+    for ( int j = elem_node_ptr[e]; j < elem_node_ptr[e+1]; j++ ){
+      for ( int i = 0; i < 3; i++ ){
+        xc[i] += TacsRealPart(X[3*elem_nodes[j]+i]);
+      }
+    }
+    for ( int i = 0; i < 3; i++ ){
+      Xc[3*e+i] = (nn > 0 ? xc[i]/nn : 0.0);
+      if (Xc[3*e+i] < box[i]){ box[i] = Xc[3*e+i]; }
+      if (-Xc[3*e+i] < box[3+i]){ box[3+i] = -Xc[3*e+i]; }
+    }
+  }
+  delete [] X;
+
+  double bounds[6];
+  MPI_Allreduce(box, bounds, 6, MPI_DOUBLE, MPI_MIN, comm);
+
+  // Compute the Hilbert key of each element centroid. Use the same
+  // scaling in each direction to preserve the aspect ratio.
+  const int bits = 21;
+  double extent = 0.0;
+  for ( int i = 0; i < 3; i++ ){
+    if (-bounds[3+i] - bounds[i] > extent){
+      extent = -bounds[3+i] - bounds[i];
+    }
+  }
+
+  unsigned long long *keys = new unsigned long long[ num_local_elements ];
+  compute_curve_keys(HILBERT_ORDER, num_local_elements, Xc, 
+                     bounds, extent, keys);
+
+  // Compute the keys used to order the elements on each processor
+  if (elem_keys){
+    if (locality_order == HILBERT_ORDER){
+      memcpy(elem_keys, keys, 
+             num_local_elements*sizeof(unsigned long long));
+    }
+    else {
+      compute_curve_keys(locality_order, num_local_elements, Xc,
+                         bounds, extent, elem_keys);
+    }
+  }
+  delete [] Xc;
+
+  unsigned long long *sorted = new unsigned long long[ num_local_elements ];
+  memcpy(sorted, keys, num_local_elements*sizeof(unsigned long long));
+  qsort(sorted, num_local_elements, sizeof(unsigned long long), 
+        compare_keys);
+
+  // Find the splitting keys such that the number of elements with a
+  // key less than split[p] is at least p*num_elements/size
+  unsigned long long *low = new unsigned long long[ size ];
+  unsigned long long *high = new unsigned long long[ size ];
+  long long *count = new long long[ size ];
+  long long *all_count = new long long[ size ];
+  for ( int p = 0; p < size; p++ ){
+    low[p] = 0;
+    high[p] = 1ULL << (3*bits);
+  }
+
+  for ( int iter = 0; iter <= 3*bits; iter++ ){
+    for ( int p = 1; p < size; p++ ){
+      unsigned long long mid = low[p] + (high[p] - low[p])/2;
+      
+      // Count the local keys less than mid
+      int lo = 0, hi = num_local_elements;
+      while (lo < hi){
+        int m = lo + (hi - lo)/2;
+        if (sorted[m] < mid){ lo = m+1; }
+        else { hi = m; }
+      }
+      count[p] = lo;
+    }
+    count[0] = 0;
+    MPI_Allreduce(count, all_count, size, MPI_LONG_LONG_INT, 
+                  MPI_SUM, comm);
+
+    for ( int p = 1; p < size; p++ ){
+      unsigned long long mid = low[p] + (high[p] - low[p])/2;
+      long long target = ((long long)p*num_elements)/size;
+      if (all_count[p] >= target){
+        high[p] = mid;
+      }
+      else {
+        low[p] = mid+1;
+      }
+    }
+  }
+
+  // Assign the elements to the partitions
+  for ( int e = 0; e < num_local_elements; e++ ){
+    int p = 0;
+    while (p+1 < size && keys[e] >= low[p+1]){
+      p++;
+    }
+    part[e] = p;
+  }
+
+  delete [] keys;
+  delete [] sorted;
+  delete [] low;
+  delete [] high;
+  delete [] count;
+  delete [] all_count;
+
+  // Refine the partition by moving elements on the boundary to the
+  // partition that owns the majority of their nodes
+  int num_block = node_range[rank+1] - node_range[rank];
+  int *pair_count = new int[ size ];
+  int *pair_recv_count = new int[ size ];
+  int *pair_ptr = new int[ size+1 ];
+  int *pairs = new int[ 2*conn_size ];
+  int *node_part = new int[ num_block ];
+  int *node_ptr = new int[ num_block+1 ];
+  int *part_size = new int[ 2*size ];
+  int *all_part_size = new int[ 2*size ];
+
+  int max_elem_size = 0;
+  for ( int e = 0; e < num_local_elements; e++ ){
+    if (elem_node_ptr[e+1] - elem_node_ptr[e] > max_elem_size){
+      max_elem_size = elem_node_ptr[e+1] - elem_node_ptr[e];
+    }
+  }
+  int *row = new int[ max_elem_size ];
+  int *move = new int[ num_local_elements ];
+
+  for ( int sweep = 0; sweep < refine_sweeps; sweep++ ){
+    // Send the (node, partition) pairs to the owners of the nodes
+    memset(pair_count, 0, size*sizeof(int));
+    for ( int j = 0; j < conn_size; j++ ){
+      int owner = FElibrary::findInterval(elem_node_conn[j], 
+                                          node_range, size+1);
+      pair_count[owner]++;
+    }
+    pair_ptr[0] = 0;
+    for ( int k = 0; k < size; k++ ){
+      pair_ptr[k+1] = pair_ptr[k] + pair_count[k];
+    }
+    for ( int e = 0; e < num_local_elements; e++ ){
+      for ( int j = elem_node_ptr[e]; j < elem_node_ptr[e+1]; j++ ){
+        int owner = FElibrary::findInterval(elem_node_conn[j], 
+                                            node_range, size+1);
+        pairs[2*pair_ptr[owner]] = elem_node_conn[j];
+        pairs[2*pair_ptr[owner]+1] = part[e];
+        pair_ptr[owner]++;
+      }
+    }
+    MPI_Alltoall(pair_count, 1, MPI_INT, 
+                 pair_recv_count, 1, MPI_INT, comm);
+    int *recv_pairs = exchange_data(comm, MPI_INT, 2, pairs,
+                                    pair_count, pair_recv_count);
+    int num_pairs = 0;
+    for ( int k = 0; k < size; k++ ){
+      num_pairs += pair_recv_count[k];
+    }
+
+    // Find the partition with the most elements adjacent to each
+    // node within the local block
+    memset(node_ptr, 0, (num_block+1)*sizeof(int));
+    for ( int i = 0; i < num_pairs; i++ ){
+      node_ptr[recv_pairs[2*i] - node_range[rank] + 1]++;
+    }
+    for ( int i = 0; i < num_block; i++ ){
+      node_ptr[i+1] += node_ptr[i];
+    }
+    int *node_parts = new int[ num_pairs ];
+    for ( int i = 0; i < num_pairs; i++ ){
+      int n = recv_pairs[2*i] - node_range[rank];
+      node_parts[node_ptr[n]] = recv_pairs[2*i+1];
+      node_ptr[n]++;
+    }
+    for ( int i = num_block; i > 0; i-- ){
+      node_ptr[i] = node_ptr[i-1];
+    }
+    node_ptr[0] = 0;
+    for ( int i = 0; i < num_block; i++ ){
+      int len = node_ptr[i+1] - node_ptr[i];
+      qsort(&node_parts[node_ptr[i]], len, sizeof(int), 
+            FElibrary::comparator);
+      node_part[i] = find_most_frequent(&node_parts[node_ptr[i]], len);
+    }
+    delete [] recv_pairs;
+    delete [] node_parts;
+
+    // Send the node partitions back to the processors that requested
+    // them with the original node locations
+    int *resp = new int[ num_req ];
+    for ( int i = 0; i < num_req; i++ ){
+      resp[i] = node_part[req[i] - node_range[rank]];
+    }
+    int *parts = exchange_data(comm, MPI_INT, 1, resp, 
+                               recv_count, send_count);
+    delete [] resp;
+
+    // Find the elements that should move to another partition
+    memset(part_size, 0, 2*size*sizeof(int));
+    for ( int e = 0; e < num_local_elements; e++ ){
+      int len = 0;
+      for ( int j = elem_node_ptr[e]; j < elem_node_ptr[e+1]; j++ ){
+        row[len] = parts[elem_nodes[j]];
+        len++;
+      }
+      qsort(row, len, sizeof(int), FElibrary::comparator);
+      int new_part = find_most_frequent(row, len);
+
+      // Only move the element if strictly more of its nodes are
+      // owned by the new partition
+      int new_count = 0, old_count = 0;
+      for ( int j = 0; j < len; j++ ){
+        if (row[j] == new_part){ new_count++; }
+        else if (row[j] == part[e]){ old_count++; }
+      }
+      part_size[part[e]]++;
+      move[e] = -1;
+      if (new_count > old_count){
+        part_size[size + new_part]++;
+        move[e] = new_part;
+      }
+    }
+    MPI_Allreduce(part_size, all_part_size, 2*size, MPI_INT, 
+                  MPI_SUM, comm);
+
+    // Only accept the moves that keep the receiving partitions
+    // within the allowable imbalance
+    double max_size = (1.0 + refine_imbalance)*num_elements/size;
+    int num_moves = 0;
+    for ( int e = 0; e < num_local_elements; e++ ){
+      int p = move[e];
+      if (p >= 0 && all_part_size[p] + all_part_size[size + p] <= max_size){
+        part[e] = p;
+        num_moves++;
+      }
+    }
+    delete [] parts;
+
+    int all_moves = 0;
+    MPI_Allreduce(&num_moves, &all_moves, 1, MPI_INT, MPI_SUM, comm);
+    if (all_moves == 0){
+      break;
+    }
+  }
+
+  delete [] pair_count;
+  delete [] pair_recv_count;
+  delete [] pair_ptr;
+  delete [] pairs;
+  delete [] node_part;
+  delete [] node_ptr;
+  delete [] part_size;
+  delete [] all_part_size;
+  delete [] row;
+  delete [] move;
+
+  delete [] nodes;
+  delete [] elem_nodes;
+  delete [] req;
+  delete [] send_count;
+  delete [] recv_count;
+}
+
+/*
+  Create the TACSAssembler object from a distributed mesh.
+
+  The mesh is partitioned in parallel and the elements, node
+  locations and boundary conditions are sent directly to the
+  processors that own them using all-to-all exchanges. The nodes are
+  assigned to the lowest-ranked processor that owns an element that
+  references them and are numbered contiguously on each processor in
+  ascending order of their original node numbers.
+*/
+TACSAssembler *TACSCreator::createDistributedTACS(){
+  int size, rank;
+  MPI_Comm_size(comm, &size);
+  MPI_Comm_rank(comm, &rank);
+
+  if (num_dependent_nodes > 0){
+    fprintf(stderr, "[%d] TACSCreator: Dependent nodes are not supported "
+            "with a distributed mesh\n", rank);
+    MPI_Abort(comm, 1);
+    return NULL;
+  }
+  if (!node_range){
+    fprintf(stderr, "[%d] TACSCreator: Nodes not defined for the "
+            "distributed mesh\n", rank);
+    MPI_Abort(comm, 1);
+    return NULL;
+  }
+
+  // Partition the mesh in parallel. If required, compute the keys
+  // that are used to order the elements on the receiving processor.
+  int *part = new int[ num_local_elements ];
+  unsigned long long *elem_keys = NULL;
+  if (locality_order != NO_LOCALITY_ORDER){
+    elem_keys = new unsigned long long[ num_local_elements ];
+  }
+  partitionDistributedMesh(part, elem_keys);
+
+  // Order the local elements by partition. Within each partition, the
+  // elements remain in ascending global order.
+  int *elem_count = new int[ size ];
+  int *conn_count = new int[ size ];
+  int *recv_elem_count = new int[ size ];
+  int *recv_conn_count = new int[ size ];
+  int *elem_ptr = new int[ size+1 ];
+  memset(elem_count, 0, size*sizeof(int));
+  memset(conn_count, 0, size*sizeof(int));
+  for ( int e = 0; e < num_local_elements; e++ ){
+    elem_count[part[e]]++;
+    conn_count[part[e]] += elem_node_ptr[e+1] - elem_node_ptr[e];
+  }
+  elem_ptr[0] = 0;
+  for ( int k = 0; k < size; k++ ){
+    elem_ptr[k+1] = elem_ptr[k] + elem_count[k];
+  }
+
+  int *order = new int[ num_local_elements ];
+  for ( int e = 0; e < num_local_elements; e++ ){
+    order[elem_ptr[part[e]]] = e;
+    elem_ptr[part[e]]++;
+  }
+  delete [] part;
+
+  int conn_size = elem_node_ptr[num_local_elements];
+  int *send_ids = new int[ num_local_elements ];
+  int *send_sizes = new int[ num_local_elements ];
+  int *send_conn = new int[ conn_size ];
+  unsigned long long *send_keys = NULL;
+  if (elem_keys){
+    send_keys = new unsigned long long[ num_local_elements ];
+  }
+  for ( int i = 0, n = 0; i < num_local_elements; i++ ){
+    int e = order[i];
+    send_ids[i] = elem_id_nums[e];
+    if (elem_keys){
+      send_keys[i] = elem_keys[e];
+    }
+    send_sizes[i] = elem_node_ptr[e+1] - elem_node_ptr[e];
+    for ( int j = elem_node_ptr[e]; j < elem_node_ptr[e+1]; j++, n++ ){
+      send_conn[n] = elem_node_conn[j];
+    }
+  }
+  delete [] order;
+
+  // Send the elements to the processors that own them
+  MPI_Alltoall(elem_count, 1, MPI_INT, recv_elem_count, 1, MPI_INT, comm);
+  MPI_Alltoall(conn_count, 1, MPI_INT, recv_conn_count, 1, MPI_INT, comm);
+  if (local_elem_id_nums){ delete [] local_elem_id_nums; }
+  local_elem_id_nums = exchange_data(comm, MPI_INT, 1, send_ids,
+                                     elem_count, recv_elem_count);
+  int *recv_sizes = exchange_data(comm, MPI_INT, 1, send_sizes,
+                                  elem_count, recv_elem_count);
+  int *local_elem_node_conn = exchange_data(comm, MPI_INT, 1, send_conn,
+                                            conn_count, recv_conn_count);
+  unsigned long long *recv_keys = NULL;
+  if (elem_keys){
+    recv_keys = exchange_data(comm, MPI_UNSIGNED_LONG_LONG, 1, send_keys,
+                              elem_count, recv_elem_count);
+    delete [] elem_keys;
+    delete [] send_keys;
+  }
+  delete [] send_ids;
+  delete [] send_sizes;
+  delete [] send_conn;
+
+  num_owned_elements = 0;
+  for ( int k = 0; k < size; k++ ){
+    num_owned_elements += recv_elem_count[k];
+  }
+  int *local_elem_node_ptr = new int[ num_owned_elements+1 ];
+  local_elem_node_ptr[0] = 0;
+  for ( int i = 0; i < num_owned_elements; i++ ){
+    local_elem_node_ptr[i+1] = local_elem_node_ptr[i] + recv_sizes[i];
+  }
+  delete [] recv_sizes;
+
+  // Order the received elements along the space-filling curve
+  if (recv_keys){
+    int *elem_order = new int[ num_owned_elements ];
+    for ( int i = 0; i < num_owned_elements; i++ ){
+      elem_order[i] = i;
+    }
+    sort_by_keys(num_owned_elements, elem_order, recv_keys);
+    delete [] recv_keys;
+
+    int *ids = new int[ num_owned_elements ];
+    int *ptr = new int[ num_owned_elements+1 ];
+    int *conn = new int[ local_elem_node_ptr[num_owned_elements] ];
+    ptr[0] = 0;
+    for ( int i = 0; i < num_owned_elements; i++ ){
+      int e = elem_order[i];
+      ids[i] = local_elem_id_nums[e];
+      ptr[i+1] = ptr[i];
+      for ( int j = local_elem_node_ptr[e]; 
+            j < local_elem_node_ptr[e+1]; j++ ){
+        conn[ptr[i+1]] = local_elem_node_conn[j];
+        ptr[i+1]++;
+      }
+    }
+    delete [] elem_order;
+    delete [] local_elem_id_nums;
+    delete [] local_elem_node_ptr;
+    delete [] local_elem_node_conn;
+    local_elem_id_nums = ids;
+    local_elem_node_ptr = ptr;
+    local_elem_node_conn = conn;
+  }
+  delete [] elem_count;
+  delete [] conn_count;
+  delete [] recv_elem_count;
+  delete [] recv_conn_count;
+  delete [] elem_ptr;
+
+  // Find the unique nodes referenced by the elements on this
+  // processor and send them to the owners of the node blocks
+  int local_conn_size = local_elem_node_ptr[num_owned_elements];
+  int *nodes = new int[ local_conn_size ];
+  memcpy(nodes, local_elem_node_conn, local_conn_size*sizeof(int));
+  int num_elem_nodes = FElibrary::uniqueSort(nodes, local_conn_size);
+
+  int *send_count = new int[ size ];
+  int *recv_count = new int[ size ];
+  int num_req = 0;
+  int *req = send_node_requests(comm, node_range, num_elem_nodes, nodes,
+                                send_count, recv_count, &num_req);
+
+  // Assign each node in the local block to the lowest-ranked
+  // processor that references it. The requests are ordered by rank.
+  int num_block = node_range[rank+1] - node_range[rank];
+  int *node_owner = new int[ num_block ];
+  for ( int i = 0; i < num_block; i++ ){
+    node_owner[i] = -1;
+  }
+  for ( int k = 0, i = 0; k < size; k++ ){
+    for ( int iend = i + recv_count[k]; i < iend; i++ ){
+      int n = req[i] - node_range[rank];
+      if (node_owner[n] < 0){
+        node_owner[n] = k;
+      }
+    }
+  }
+
+  // Send the owned nodes and their locations to each processor in
+  // ascending order
+  int *own_count = new int[ size ];
+  int *recv_own_count = new int[ size ];
+  int *own_ptr = new int[ size+1 ];
+  memset(own_count, 0, size*sizeof(int));
+  for ( int i = 0; i < num_block; i++ ){
+    if (node_owner[i] >= 0){
+      own_count[node_owner[i]]++;
+    }
+  }
+  own_ptr[0] = 0;
+  for ( int k = 0; k < size; k++ ){
+    own_ptr[k+1] = own_ptr[k] + own_count[k];
+  }
+  int num_assigned = own_ptr[size];
+  int *own_nodes = new int[ num_assigned ];
+  TacsScalar *own_Xpts = new TacsScalar[ 3*num_assigned ];
+  for ( int i = 0; i < num_block; i++ ){
+    int owner = node_owner[i];
+    if (owner >= 0){
+      int n = own_ptr[owner];
+      own_nodes[n] = i;
+      own_Xpts[3*n] = Xpts[3*i];
+      own_Xpts[3*n+1] = Xpts[3*i+1];
+      own_Xpts[3*n+2] = Xpts[3*i+2];
+      own_ptr[owner]++;
+    }
+  }
+
+  MPI_Alltoall(own_count, 1, MPI_INT, recv_own_count, 1, MPI_INT, comm);
+  TacsScalar *Xpts_local = exchange_data(comm, TACS_MPI_TYPE, 3, own_Xpts,
+                                         own_count, recv_own_count);
+  delete [] own_Xpts;
+
+  num_owned_nodes = 0;
+  for ( int k = 0; k < size; k++ ){
+    num_owned_nodes += recv_own_count[k];
+  }
+
+  // Record the number of owned nodes and elements on each processor
+  if (owned_nodes){ delete [] owned_nodes; }
+  if (owned_elements){ delete [] owned_elements; }
+  owned_nodes = new int[ size ];
+  owned_elements = new int[ size ];
+  MPI_Allgather(&num_owned_nodes, 1, MPI_INT, 
+                owned_nodes, 1, MPI_INT, comm);
+  MPI_Allgather(&num_owned_elements, 1, MPI_INT, 
+                owned_elements, 1, MPI_INT, comm);
+
+  // Compute the new node numbers and send them back to the owners
+  // of the node blocks. The owned nodes are either numbered in the
+  // order they are received or along the space-filling curve.
+  int node_offset = 0;
+  for ( int k = 0; k < rank; k++ ){
+    node_offset += owned_nodes[k];
+  }
+  int *node_order = new int[ num_owned_nodes ];
+  for ( int i = 0; i < num_owned_nodes; i++ ){
+    node_order[i] = i;
+  }
+  if (locality_order != NO_LOCALITY_ORDER){
+    double *X = new double[ 3*num_owned_nodes ];
+    for ( int i = 0; i < 3*num_owned_nodes; i++ ){
+      X[i] = TacsRealPart(Xpts_local[i]);
+    }
+    double lower[3];
+    double extent = compute_bounds(num_owned_nodes, X, lower);
+    unsigned long long *keys = new unsigned long long[ num_owned_nodes ];
+    compute_curve_keys(locality_order, num_owned_nodes, X, 
+                       lower, extent, keys);
+    sort_by_keys(num_owned_nodes, node_order, keys);
+    delete [] keys;
+    delete [] X;
+
+    // Permute the node locations to the new order
+    TacsScalar *Xtemp = new TacsScalar[ 3*num_owned_nodes ];
+    for ( int i = 0; i < num_owned_nodes; i++ ){
+      for ( int j = 0; j < 3; j++ ){
+        Xtemp[3*i+j] = Xpts_local[3*node_order[i]+j];
+      }
+    }
+    delete [] Xpts_local;
+    Xpts_local = Xtemp;
+  }
+
+  int *new_nums = new int[ num_owned_nodes ];
+  for ( int i = 0; i < num_owned_nodes; i++ ){
+    new_nums[node_order[i]] = node_offset + i;
+  }
+  delete [] node_order;
+  int *block_nums = exchange_data(comm, MPI_INT, 1, new_nums,
+                                  recv_own_count, own_count);
+  delete [] new_nums;
+
+  int *block_new_nodes = new int[ num_block ];
+  for ( int i = 0; i < num_block; i++ ){
+    block_new_nodes[i] = -1;
+  }
+  for ( int i = 0; i < num_assigned; i++ ){
+    block_new_nodes[own_nodes[i]] = block_nums[i];
+  }
+  delete [] block_nums;
+  delete [] own_nodes;
+  delete [] own_ptr;
+  delete [] own_count;
+  delete [] recv_own_count;
+
+  // Respond to the node requests with the new node numbers and
+  // renumber the local connectivity
+  int *resp = new int[ num_req ];
+  for ( int i = 0; i < num_req; i++ ){
+    resp[i] = block_new_nodes[req[i] - node_range[rank]];
+  }
+  int *new_elem_nodes = exchange_data(comm, MPI_INT, 1, resp,
+                                      recv_count, send_count);
+  delete [] resp;
+  delete [] req;
+
+  for ( int j = 0; j < local_conn_size; j++ ){
+    int *item = (int*)bsearch(&local_elem_node_conn[j], nodes, 
+                              num_elem_nodes, sizeof(int), 
+                              FElibrary::comparator);
+    local_elem_node_conn[j] = new_elem_nodes[item - nodes];
+  }
+  delete [] new_elem_nodes;
+  delete [] nodes;
+
+  // Send the boundary conditions to the owners of the node blocks
+  int *bc_order = new int[ num_bcs ];
+  int *bc_ptr_block = new int[ size+1 ];
+  memset(send_count, 0, size*sizeof(int));
+  for ( int k = 0; k < num_bcs; k++ ){
+    if (bc_nodes[k] >= 0 && bc_nodes[k] < num_nodes){
+      send_count[FElibrary::findInterval(bc_nodes[k], node_range, 
+                                         size+1)]++;
+    }
+  }
+  bc_ptr_block[0] = 0;
+  for ( int k = 0; k < size; k++ ){
+    bc_ptr_block[k+1] = bc_ptr_block[k] + send_count[k];
+  }
+  int num_send_bcs = bc_ptr_block[size];
+  int *send_bc_nodes = new int[ num_send_bcs ];
+  for ( int k = 0; k < num_bcs; k++ ){
+    if (bc_nodes[k] >= 0 && bc_nodes[k] < num_nodes){
+      int owner = FElibrary::findInterval(bc_nodes[k], node_range, 
+                                          size+1);
+      bc_order[bc_ptr_block[owner]] = k;
+      send_bc_nodes[bc_ptr_block[owner]] = bc_nodes[k];
+      bc_ptr_block[owner]++;
+    }
+  }
+  MPI_Alltoall(send_count, 1, MPI_INT, recv_count, 1, MPI_INT, comm);
+  int *req_bc_nodes = exchange_data(comm, MPI_INT, 1, send_bc_nodes,
+                                    send_count, recv_count);
+  int num_req_bcs = 0;
+  for ( int k = 0; k < size; k++ ){
+    num_req_bcs += recv_count[k];
+  }
+
+  // Respond with the new node number and owner of each node
+  int *bc_resp = new int[ 2*num_req_bcs ];
+  for ( int i = 0; i < num_req_bcs; i++ ){
+    int n = req_bc_nodes[i] - node_range[rank];
+    bc_resp[2*i] = block_new_nodes[n];
+    bc_resp[2*i+1] = node_owner[n];
+  }
+  int *bc_info = exchange_data(comm, MPI_INT, 2, bc_resp,
+                               recv_count, send_count);
+  delete [] bc_resp;
+  delete [] req_bc_nodes;
+  delete [] send_bc_nodes;
+  delete [] block_new_nodes;
+  delete [] node_owner;
+
+  // Forward the boundary conditions to the processors that own the
+  // nodes. Boundary conditions on nodes that are not referenced by
+  // any element are dropped.
+  int *bc_count = new int[ size ];
+  int *bc_var_count = new int[ size ];
+  int *recv_bc_count = new int[ size ];
+  int *recv_bc_var_count = new int[ size ];
+  memset(bc_count, 0, size*sizeof(int));
+  memset(bc_var_count, 0, size*sizeof(int));
+  for ( int i = 0; i < num_send_bcs; i++ ){
+    int owner = bc_info[2*i+1];
+    if (owner >= 0){
+      int k = bc_order[i];
+      bc_count[owner]++;
+      bc_var_count[owner] += bc_ptr[k+1] - bc_ptr[k];
+    }
+  }
+
+  int *send_ptr = new int[ size+1 ];
+  int *send_var_ptr = new int[ size+1 ];
+  send_ptr[0] = send_var_ptr[0] = 0;
+  for ( int k = 0; k < size; k++ ){
+    send_ptr[k+1] = send_ptr[k] + bc_count[k];
+    send_var_ptr[k+1] = send_var_ptr[k] + bc_var_count[k];
+  }
+  int *send_nodes = new int[ send_ptr[size] ];
+  int *send_nvars = new int[ send_ptr[size] ];
+  int *send_vars = new int[ send_var_ptr[size] ];
+  TacsScalar *send_vals = new TacsScalar[ send_var_ptr[size] ];
+  for ( int i = 0; i < num_send_bcs; i++ ){
+    int owner = bc_info[2*i+1];
+    if (owner >= 0){
+      int k = bc_order[i];
+      int n = send_ptr[owner];
+      send_nodes[n] = bc_info[2*i];
+      send_nvars[n] = bc_ptr[k+1] - bc_ptr[k];
+      for ( int j = bc_ptr[k]; j < bc_ptr[k+1]; j++ ){
+        send_vars[send_var_ptr[owner]] = bc_vars[j];
+        send_vals[send_var_ptr[owner]] = bc_vals[j];
+        send_var_ptr[owner]++;
+      }
+      send_ptr[owner]++;
+    }
+  }
+  delete [] bc_info;
+  delete [] bc_order;
+  delete [] bc_ptr_block;
+
+  MPI_Alltoall(bc_count, 1, MPI_INT, recv_bc_count, 1, MPI_INT, comm);
+  MPI_Alltoall(bc_var_count, 1, MPI_INT, 
+               recv_bc_var_count, 1, MPI_INT, comm);
+  int *new_bc_nodes = exchange_data(comm, MPI_INT, 1, send_nodes,
+                                    bc_count, recv_bc_count);
+  int *new_bc_nvars = exchange_data(comm, MPI_INT, 1, send_nvars,
+                                    bc_count, recv_bc_count);
+  int *new_bc_vars = exchange_data(comm, MPI_INT, 1, send_vars,
+                                   bc_var_count, recv_bc_var_count);
+  TacsScalar *new_bc_vals = exchange_data(comm, TACS_MPI_TYPE, 1, 
+                                          send_vals, bc_var_count, 
+                                          recv_bc_var_count);
+  delete [] send_nodes;
+  delete [] send_nvars;
+  delete [] send_vars;
+  delete [] send_vals;
+  delete [] send_ptr;
+  delete [] send_var_ptr;
+
+  // Replace the boundary conditions with the local ones
+  num_bcs = 0;
+  for ( int k = 0; k < size; k++ ){
+    num_bcs += recv_bc_count[k];
+  }
+  if (bc_nodes){ delete [] bc_nodes; }
+  if (bc_ptr){ delete [] bc_ptr; }
+  if (bc_vars){ delete [] bc_vars; }
+  if (bc_vals){ delete [] bc_vals; }
+  bc_nodes = new_bc_nodes;
+  bc_vars = new_bc_vars;
+  bc_vals = new_bc_vals;
+  bc_ptr = new int[ num_bcs+1 ];
+  bc_ptr[0] = 0;
+  for ( int k = 0; k < num_bcs; k++ ){
+    bc_ptr[k+1] = bc_ptr[k] + new_bc_nvars[k];
+  }
+  delete [] new_bc_nvars;
+  delete [] bc_count;
+  delete [] bc_var_count;
+  delete [] recv_bc_count;
+  delete [] recv_bc_var_count;
+  delete [] send_count;
+  delete [] recv_count;
+
+  return createAssembler(0, NULL, NULL, NULL,
+                         local_elem_node_ptr, local_elem_node_conn,
+                         Xpts_local);
+}
+
+
 /*
   Partition the mesh stored on the root processor for parallel
   computations.
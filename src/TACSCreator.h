@@ -25,6 +25,14 @@
   handle extremely large meshes, but is useful for many moderate-scale 
   applications.
 
+  For large meshes, the connectivity, nodes and boundary conditions
+  can instead be set in blocks on each processor using
+  setDistributedConnectivity()/setDistributedNodes(). In this case,
+  the mesh is partitioned in parallel along a space-filling curve and
+  redistributed without gathering it on the root processor. Dependent
+  nodes are not supported and the partition and new node numbers are
+  not available from getElementPartition()/getNodeNums().
+
   The user must specify the connectivity, boundary conditions,
   elements, node locations and optionally any dependent nodes that are
   defined.  The elements may be provided in a list, or a callback
@@ -40,9 +48,19 @@
   Note that it is guaranteed that on each partiton, the elements will
   be numbered in ascending global order. This can be used to remap the
   distributed element order back to the original element order.
+
+  This guarantee does not hold when a locality ordering is set with
+  setLocalityOrdering(). In this case, the elements and owned nodes on
+  each processor are ordered along a space-filling curve through the
+  node locations to improve the memory locality of the element loops.
+  Use getElementIdNums() to find the local element numbers.
 */
 class TACSCreator : public TACSObject {
  public:
+  enum LocalityOrderType { NO_LOCALITY_ORDER, 
+                           HILBERT_ORDER,
+                           MORTON_ORDER };
+
   TACSCreator( MPI_Comm comm, int _vars_per_node );
   ~TACSCreator();
 
@@ -72,10 +90,21 @@ class TACSCreator : public TACSObject {
   // -----------------------
   void setNodes( const TacsScalar *_Xpts );
 
+  // Set a distributed mesh in blocks on each processor
+  // ---------------------------------------------------
+  void setDistributedConnectivity( int _num_nodes, int _num_elements,
+                                   const int *_elem_node_ptr, 
+                                   const int *_elem_node_conn,
+                                   const int *_elem_id_nums );
+  void setDistributedNodes( int num_local_nodes, 
+                            const TacsScalar *_Xpts );
+  void setPartitionRefinement( int num_sweeps, double imbalance=0.05 );
+
   // Set the type of ordering to use
   // -------------------------------
   void setReorderingType( TACSAssembler::OrderingType _order_type,
                           TACSAssembler::MatrixOrderingType _mat_type );
+  void setLocalityOrdering( LocalityOrderType curve );
 
   // Partition the mesh 
   // ------------------
@@ -109,6 +138,20 @@ class TACSCreator : public TACSObject {
   void getNumOwnedElements( int **_owned_elements );
 
  private:  
+  // Create TACS from a distributed mesh
+  void partitionDistributedMesh( int *part, 
+                                 unsigned long long *elem_keys );
+  TACSAssembler *createDistributedTACS();
+
+  // Create TACSAssembler from the local part of the mesh
+  TACSAssembler *createAssembler( int num_local_dep_nodes,
+                                  int *local_dep_node_ptr,
+                                  int *local_dep_node_conn,
+                                  double *local_dep_node_weights,
+                                  int *local_elem_node_ptr,
+                                  int *local_elem_node_conn,
+                                  TacsScalar *Xpts_local );
+
   // The magic element-generator function pointer
   TACSElement* (*element_creator)( int local, int elem_id );
 
@@ -117,6 +160,9 @@ class TACSCreator : public TACSObject {
   TACSAssembler::OrderingType order_type;
   TACSAssembler::MatrixOrderingType mat_type;
 
+  // The space-filling curve used to order elements and nodes
+  LocalityOrderType locality_order;
+
   // The number of variables per node in the mesh
   int vars_per_node;
 
@@ -159,6 +205,16 @@ class TACSCreator : public TACSObject {
   // The element partition
   int *partition;
 
+  // Information for a distributed mesh: the number of elements
+  // on this processor and the ranges of the nodes on each processor
+  int dist_mesh;
+  int num_local_elements;
+  int *node_range;
+
+  // The refinement options for the geometric partition
+  int refine_sweeps;
+  double refine_imbalance;
+
   // Local information about the partitioned mesh
   int num_owned_elements, num_owned_nodes;
   int *local_elem_id_nums;
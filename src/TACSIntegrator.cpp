@@ -16,6 +16,7 @@
 #include <math.h>
 #include "tacslapack.h"
 #include "TACSMg.h"
+#include "TACSProfiler.h"
 
 /*
   Base class constructor for integration schemes.
@@ -39,6 +40,7 @@ TACSIntegrator::TACSIntegrator( TACSAssembler *_tacs,
 
   // Allocate the total number of time steps
   num_time_steps = int(num_steps);
+  max_time_steps = num_time_steps;
 
   // Store physical time of simulation
   time = new double[ num_time_steps+1 ];
@@ -99,6 +101,16 @@ TACSIntegrator::TACSIntegrator( TACSAssembler *_tacs,
   init_newton_delta = 0.0;
   jac_comp_freq = 1;
 
+  // Adaptive reuse of the Jacobian factorization
+  jac_reuse = 0;
+  jac_max_rate = 0.5;
+  jac_factored = 0;
+  jac_alpha = jac_beta = jac_gamma = 0.0;
+
+  // Inexact Newton forcing terms
+  use_ew = 0;
+  ew_eta_max = 0.9;
+
   // Set the default LINEAR solver
   use_lapack = 0;
   use_femat = 1;
@@ -114,8 +126,17 @@ TACSIntegrator::TACSIntegrator( TACSAssembler *_tacs,
   num_restarts = 0;
   is_flexible  = 0;
 
+  // Use a fixed time step by default
+  adaptive = 0;
+  lte_rtol = 1e-3;
+  lte_atol = 0.0;
+  hmin = 0.0;
+  hmax = 0.0;
+  lte_vec = NULL;
+
   // Tecplot solution export
   f5_write_freq = 0;
+  f5_time_series = 0;
 
   // Set the rigid and shell visualization objects to NULL
   rigidf5 = NULL;
@@ -137,7 +158,7 @@ TACSIntegrator::~TACSIntegrator(){
   }
 
   // Dereference position, velocity and acceleration states
-  for ( int k = 0; k < num_time_steps+1; k++ ) {
+  for ( int k = 0; k < max_time_steps+1; k++ ) {
     q[k]->decref();
     qdot[k]->decref();
     qddot[k]->decref();
@@ -146,6 +167,7 @@ TACSIntegrator::~TACSIntegrator(){
   // Dereference Newton's method objects
   res->decref();
   update->decref();
+  if (lte_vec){ lte_vec->decref(); }
   if (mat){ mat->decref(); }
   if (pc){ pc->decref(); }
   if (ksm){ ksm->decref(); }
@@ -218,6 +240,38 @@ void TACSIntegrator::setJacAssemblyFreq( int _jac_comp_freq ){
   jac_comp_freq = _jac_comp_freq;
 }
 
+/*
+  Reuse the factored Jacobian across Newton iterations and time steps.
+
+  The factorization is retained as long as the residual norm
+  contracts by at least the factor max_rate at each Newton iteration.
+  The Jacobian is refactored when the contraction stagnates, when the
+  coefficients alpha, beta and gamma change significantly, or after a
+  failed nonlinear solve. This setting overrides the fixed schedule
+  set by setJacAssemblyFreq().
+*/
+void TACSIntegrator::setJacobianReuse( int _jac_reuse,
+                                       double _jac_max_rate ){
+  jac_reuse = _jac_reuse;
+  jac_factored = 0;
+  if (_jac_max_rate > 0.0 && _jac_max_rate < 1.0){
+    jac_max_rate = _jac_max_rate;
+  }
+}
+
+/*
+  Use the Eisenstat-Walker forcing terms to set the relative tolerance
+  of the Krylov method at each Newton iteration. This only affects
+  iterative methods: it has no effect when LAPACK is used or when the
+  Krylov method only applies the preconditioner.
+*/
+void TACSIntegrator::setEisenstatWalker( int _use_ew, double _ew_eta_max ){
+  use_ew = _use_ew;
+  if (_ew_eta_max > 0.0 && _ew_eta_max < 1.0){
+    ew_eta_max = _ew_eta_max;
+  }
+}
+
 /*
   Set whether or not to use LAPACK for linear solve
 */
@@ -262,6 +316,38 @@ void TACSIntegrator::setKrylovSubspaceMethod( TACSKsm *_ksm ){
     ksm->decref();
   }
   ksm = _ksm;
+  jac_factored = 0;
+}
+
+/*
+  Use adaptive time stepping based on an estimate of the local
+  truncation error.
+
+  The step is accepted when the error estimate satisfies
+
+  ||e|| <= lte_atol + lte_rtol*||q||
+
+  and the next step size is selected based on the order of the error
+  estimate. The number of time steps set in the constructor is used
+  to select the initial step size. Storage for the time history is
+  extended as required, and the non-uniform time history is used for
+  the adjoint.
+
+  input:
+  lte_rtol:  the relative tolerance for the local error
+  lte_atol:  the absolute tolerance for the local error
+  hmin:      the minimum time step (if > 0)
+  hmax:      the maximum time step (if > 0)
+*/
+void TACSIntegrator::setAdaptiveTimeStepping( double _lte_rtol,
+                                              double _lte_atol,
+                                              double _hmin,
+                                              double _hmax ){
+  adaptive = 1;
+  lte_rtol = _lte_rtol;
+  lte_atol = _lte_atol;
+  hmin = _hmin;
+  hmax = _hmax;
 }
 
 /*
@@ -333,7 +419,8 @@ void TACSIntegrator::setFunctions( TACSFunction **_funcs, int _num_funcs,
   Set the output directory prefix
 */
 void TACSIntegrator::setOutputPrefix( const char *_prefix ){
-  strncpy(prefix, _prefix, sizeof(prefix));
+  strncpy(prefix, _prefix, sizeof(prefix)-1);
+  prefix[sizeof(prefix)-1] = '\0';
 }
 
 /*
@@ -427,46 +514,102 @@ void TACSIntegrator::writeRawSolution( const char *filename, int format ){
 
 /*
   Creates f5 files for each time step.
+
+  When the output objects write asynchronously, the steps are queued
+  and this call waits until all the files have been written.
 */
 void TACSIntegrator::writeSolutionToF5(){
   for ( int k = 0; k < num_time_steps + 1; k++ ){
     writeStepToF5(k);
   }
+
+  // Close the time series files
+  if (f5_time_series){
+    if (rigidf5){ rigidf5->closeTimeSeries(); }
+    if (shellf5){ shellf5->closeTimeSeries(); }
+    if (beamf5){ beamf5->closeTimeSeries(); }
+    if (solidf5){ solidf5->closeTimeSeries(); }
+  }
+
+  // Wait for any pending writes to complete
+  if (rigidf5){ rigidf5->flush(); }
+  if (shellf5){ shellf5->flush(); }
+  if (beamf5){ beamf5->flush(); }
+  if (solidf5){ solidf5->flush(); }
 }
 
 /*
   Creates an f5 file for each time step and writes the data.
+
+  When time series output is set, the steps are appended to a single
+  file for each type of output instead. The file is created at step 0.
 */
 void TACSIntegrator::writeStepToF5( int step_num ){
   // Set the current states into TACS
   tacs->setVariables(q[step_num], qdot[step_num], qddot[step_num]);
   tacs->setSimulationTime(time[step_num]);
 
+  if (f5_time_series){
+    if (rigidf5){
+      if (step_num == 0){
+        char fname[sizeof(prefix) + 32];
+        snprintf(fname, sizeof(fname), "%s/rigid.f5", prefix);
+        rigidf5->createTimeSeries(fname);
+      }
+      rigidf5->writeTimeStep();
+    }
+    if (shellf5){
+      if (step_num == 0){
+        char fname[sizeof(prefix) + 32];
+        snprintf(fname, sizeof(fname), "%s/shell.f5", prefix);
+        shellf5->createTimeSeries(fname);
+      }
+      shellf5->writeTimeStep();
+    }
+    if (beamf5){
+      if (step_num == 0){
+        char fname[sizeof(prefix) + 32];
+        snprintf(fname, sizeof(fname), "%s/beam.f5", prefix);
+        beamf5->createTimeSeries(fname);
+      }
+      beamf5->writeTimeStep();
+    }
+    if (solidf5){
+      if (step_num == 0){
+        char fname[sizeof(prefix) + 32];
+        snprintf(fname, sizeof(fname), "%s/solid.f5", prefix);
+        solidf5->createTimeSeries(fname);
+      }
+      solidf5->writeTimeStep();
+    }
+    return;
+  }
+
   // Write RIGID body if set
   if (rigidf5){
-    char fname[256];
-    sprintf(fname, "%s/rigid_%06d.f5", prefix, step_num);
+    char fname[sizeof(prefix) + 32];
+    snprintf(fname, sizeof(fname), "%s/rigid_%06d.f5", prefix, step_num);
     rigidf5->writeToFile(fname);
   }
 
   // Write SHELL body if set
   if (shellf5){
-    char fname[256];
-    sprintf(fname, "%s/shell_%06d.f5", prefix, step_num);
+    char fname[sizeof(prefix) + 32];
+    snprintf(fname, sizeof(fname), "%s/shell_%06d.f5", prefix, step_num);
     shellf5->writeToFile(fname);
   }
 
   // Write BEAM body if set
   if (beamf5){
-    char fname[256];
-    sprintf(fname, "%s/beam_%06d.f5", prefix, step_num);
+    char fname[sizeof(prefix) + 32];
+    snprintf(fname, sizeof(fname), "%s/beam_%06d.f5", prefix, step_num);
     beamf5->writeToFile(fname);
   }
 
   // Write solid body if set
   if (solidf5){
-    char fname[256];
-    sprintf(fname, "%s/solid_%06d.f5", prefix, step_num);
+    char fname[sizeof(prefix) + 32];
+    snprintf(fname, sizeof(fname), "%s/solid_%06d.f5", prefix, step_num);
     solidf5->writeToFile(fname);
   }
 }
@@ -478,6 +621,14 @@ void TACSIntegrator::setOutputFrequency( int _write_freq ){
   f5_write_freq = _write_freq;
 }
 
+/*
+  Write the output steps to a single time series file for each type
+  of output, rather than one file per step
+*/
+void TACSIntegrator::setOutputTimeSeries( int _f5_time_series ){
+  f5_time_series = _f5_time_series;
+}
+
 /*
   Set whether RIGID body components are a part of the output
 */
@@ -598,6 +749,9 @@ void TACSIntegrator::printOptionSummary(){
     fprintf(logfp, "%-30s %15g\n", "absolute_tolerance", atol);
     fprintf(logfp, "%-30s %15g\n", "relative_tolerance", rtol);
     fprintf(logfp, "%-30s %15d\n", "jac_comp_freq", jac_comp_freq);
+    fprintf(logfp, "%-30s %15d\n", "jac_reuse", jac_reuse);
+    fprintf(logfp, "%-30s %15g\n", "jac_max_rate", jac_max_rate);
+    fprintf(logfp, "%-30s %15d\n", "use_eisenstat_walker", use_ew);
 
     fprintf(logfp, "===============================================\n");
     fprintf(logfp, "Linear Solver: Parameter values\n");
@@ -719,6 +873,7 @@ int TACSIntegrator::initAccelerationSolve(TACSBVec *forces){
     // LU Factor the matrix when needed
     if ((niter % jac_comp_freq) == 0){
       pc->factor();
+      jac_factored = 0;
     }
 
     // Solve for update using KSM
@@ -740,6 +895,8 @@ int TACSIntegrator::initAccelerationSolve(TACSBVec *forces){
   if (mg){
     mg->decref();
   };
+
+  return 0;
 }
 
 /*
@@ -777,12 +934,39 @@ int TACSIntegrator::newtonSolve( double alpha, double beta, double gamma,
   // Create KSM
   initializeLinearSolver();
 
+  // Check whether the Krylov method is iterative. When it only
+  // applies the preconditioner, the matrix is not used.
+  int iterative_ksm = 0;
+  if (!use_lapack && !dynamic_cast<KsmPreconditioner*>(ksm)){
+    iterative_ksm = 1;
+  }
+
+  // Save the tolerances of the Krylov method so that they can be
+  // restored once the Eisenstat-Walker forcing terms have been used
+  double ksm_rtol = 0.1*rtol, ksm_atol = 1.0e-30;
+  if (use_ew && iterative_ksm){
+    ksm->getTolerances(&ksm_rtol, &ksm_atol);
+  }
+
+  // Discard the factorization if the coefficients of the Jacobian
+  // have changed significantly since it was computed
+  if (jac_reuse && jac_factored){
+    const double max_change = 0.25;
+    if (fabs(alpha - jac_alpha) > max_change*fabs(jac_alpha) ||
+        fabs(beta - jac_beta) > max_change*fabs(jac_beta) ||
+        fabs(gamma - jac_gamma) > max_change*fabs(jac_gamma)){
+      jac_factored = 0;
+    }
+  }
+
   // Initialize the update norms
   update_norm = 1.0e99;
 
   // Initialize the residual norms
   init_res_norm = 0.0;
   res_norm = 0.0;
+  TacsScalar prev_res_norm = 0.0;
+  double eta = ew_eta_max;
   int newton_exit_flag = 0;
 
   if (logfp && print_level >= 2){
@@ -801,9 +985,23 @@ int TACSIntegrator::newtonSolve( double alpha, double beta, double gamma,
     tacs->setSimulationTime(t);
     tacs->setVariables(u, udot, uddot);
 
+    // Decide whether to assemble and factor the Jacobian. When the
+    // factorization is reused with an iterative method, the matrix
+    // is still assembled so that only the preconditioner lags.
+    int factor_jac = 0, assemble_jac = 0;
+    if (jac_reuse){
+      factor_jac = !jac_factored;
+      assemble_jac = (factor_jac || iterative_ksm);
+    }
+    else {
+      factor_jac = ((niter % jac_comp_freq) == 0);
+      assemble_jac = factor_jac;
+    }
+
     // Assemble the Jacobian matrix once in Newton iterations
     double t0 = MPI_Wtime();
-    if ((niter % jac_comp_freq) == 0){
+    TACSProfiler::begin(TACSProfiler::INTEGRATOR_ASSEMBLY);
+    if (assemble_jac){
       delta = init_newton_delta*gamma;
       if (niter > 0 &&
           (TacsRealPart(res_norm) < TacsRealPart(init_res_norm))){
@@ -832,9 +1030,11 @@ int TACSIntegrator::newtonSolve( double alpha, double beta, double gamma,
       tacs->applyBCs(res);
     }
 
+    TACSProfiler::end(TACSProfiler::INTEGRATOR_ASSEMBLY);
     time_fwd_assembly += MPI_Wtime() - t0;
 
     // Compute the L2-norm of the residual
+    prev_res_norm = res_norm;
     res_norm = res->norm();
 
     // Record the residual norm at the first Newton iteration
@@ -893,6 +1093,57 @@ int TACSIntegrator::newtonSolve( double alpha, double beta, double gamma,
       break;
     }
 
+    // Refactor the Jacobian if the contraction of the residual has
+    // stagnated with the reused factorization
+    double rate = 0.0;
+    if (niter > 0){
+      rate = TacsRealPart(res_norm)/TacsRealPart(prev_res_norm);
+    }
+    if (jac_reuse && !factor_jac && rate > jac_max_rate){
+      factor_jac = 1;
+      if (!assemble_jac){
+        double t1 = MPI_Wtime();
+        TACSProfiler::begin(TACSProfiler::INTEGRATOR_ASSEMBLY);
+        TACSMg *mg = dynamic_cast<TACSMg*>(pc);
+        if (mg){
+          mg->assembleJacobian(alpha, beta, gamma + delta,
+                               NULL, NORMAL);
+        }
+        else {
+          tacs->assembleJacobian(alpha, beta, gamma + delta,
+                                 NULL, mat, NORMAL);
+        }
+        TACSProfiler::end(TACSProfiler::INTEGRATOR_ASSEMBLY);
+        time_fwd_assembly += MPI_Wtime() - t1;
+      }
+    }
+
+    // Compute the Eisenstat-Walker forcing term (choice 2) with the
+    // safeguards against over-solving the linear system
+    if (use_ew && iterative_ksm){
+      if (niter > 0){
+        const double ew_gamma = 0.9;
+        double eta_safe = ew_gamma*eta*eta;
+        eta = ew_gamma*rate*rate;
+        if (eta_safe > 0.1 && eta_safe > eta){
+          eta = eta_safe;
+        }
+      }
+
+      // Do not solve beyond what is needed for the Newton tolerance
+      double tol = atol;
+      if (tol < rtol*TacsRealPart(rtol + init_res_norm)){
+        tol = rtol*TacsRealPart(rtol + init_res_norm);
+      }
+      if (eta < 0.5*tol/TacsRealPart(res_norm)){
+        eta = 0.5*tol/TacsRealPart(res_norm);
+      }
+      if (eta > ew_eta_max){
+        eta = ew_eta_max;
+      }
+      ksm->setTolerances(eta, 1.0e-30);
+    }
+
     if (use_lapack){
       if (mpiSize > 1){
         fprintf(stderr, "TACSIntegrator:: Using LAPACK in parallel!\n");
@@ -903,14 +1154,22 @@ int TACSIntegrator::newtonSolve( double alpha, double beta, double gamma,
     else {
       // LU Factor the matrix when needed
       double t1 = MPI_Wtime();
-      if ((niter % jac_comp_freq) == 0){
+      TACSProfiler::begin(TACSProfiler::INTEGRATOR_FACTOR);
+      if (factor_jac){
         pc->factor();
+        jac_factored = 1;
+        jac_alpha = alpha;
+        jac_beta = beta;
+        jac_gamma = gamma;
       }
+      TACSProfiler::end(TACSProfiler::INTEGRATOR_FACTOR);
       time_fwd_factor += MPI_Wtime() - t1;
 
       // Solve for update using KSM
       double t2 = MPI_Wtime();
+      TACSProfiler::begin(TACSProfiler::INTEGRATOR_SOLVE);
       ksm->solve(res, update);
+      TACSProfiler::end(TACSProfiler::INTEGRATOR_SOLVE);
       time_fwd_apply_factor += MPI_Wtime() - t2;
     }
 
@@ -928,6 +1187,16 @@ int TACSIntegrator::newtonSolve( double alpha, double beta, double gamma,
     newton_exit_flag = -1;
   }
 
+  // Do not reuse the factorization after a failed solution
+  if (newton_exit_flag < 0){
+    jac_factored = 0;
+  }
+
+  // Restore the tolerances of the Krylov method
+  if (use_ew && iterative_ksm){
+    ksm->setTolerances(ksm_rtol, ksm_atol);
+  }
+
   // Record the time taken for nonlinear solution
   time_newton = MPI_Wtime() - tnewton;
 
@@ -1326,6 +1595,189 @@ double TACSIntegrator::getStates( int step_num,
   return time[step_num];
 }
 
+/*
+  Extend the storage for the time history so that it can hold at
+  least nsteps time steps
+*/
+void TACSIntegrator::extendHistory( int nsteps ){
+  if (nsteps <= max_time_steps){
+    return;
+  }
+
+  double *t = new double[ nsteps+1 ];
+  TACSBVec **qnew = new TACSBVec*[ nsteps+1 ];
+  TACSBVec **qdotnew = new TACSBVec*[ nsteps+1 ];
+  TACSBVec **qddotnew = new TACSBVec*[ nsteps+1 ];
+
+  // Copy over the existing values
+  memset(t, 0, (nsteps+1)*sizeof(double));
+  memcpy(t, time, (max_time_steps+1)*sizeof(double));
+  memcpy(qnew, q, (max_time_steps+1)*sizeof(TACSBVec*));
+  memcpy(qdotnew, qdot, (max_time_steps+1)*sizeof(TACSBVec*));
+  memcpy(qddotnew, qddot, (max_time_steps+1)*sizeof(TACSBVec*));
+
+  // Create the new state vectors
+  for ( int k = max_time_steps+1; k < nsteps+1; k++ ){
+    qnew[k] = tacs->createVec(); qnew[k]->incref();
+    qdotnew[k] = tacs->createVec(); qdotnew[k]->incref();
+    qddotnew[k] = tacs->createVec(); qddotnew[k]->incref();
+  }
+
+  delete [] time;
+  delete [] q;
+  delete [] qdot;
+  delete [] qddot;
+  time = t;
+  q = qnew;
+  qdot = qdotnew;
+  qddot = qddotnew;
+
+  // Extend any storage required by the integration scheme
+  extendStageHistory(max_time_steps, nsteps);
+  max_time_steps = nsteps;
+}
+
+/*
+  Compute the weighted norm of the local error estimate
+
+  ||e||/(lte_atol + lte_rtol*||q||)
+
+  so that the step is acceptable when the value is less than one.
+*/
+double TACSIntegrator::computeErrorNorm( TACSBVec *err, TACSBVec *qk ){
+  tacs->applyBCs(err);
+  double enorm = TacsRealPart(err->norm());
+  double qnorm = TacsRealPart(qk->norm());
+  double scale = lte_atol + lte_rtol*qnorm;
+  if (scale <= 0.0){
+    scale = 1e-30;
+  }
+  return enorm/scale;
+}
+
+/*
+  Integrate the equations of motion forward in time using an adaptive
+  time step.
+
+  After each step, the local truncation error is estimated by the
+  integration scheme. If the error is too large, the step is repeated
+  with a smaller step size. The step size is updated using the
+  standard controller
+
+  h_new = h*safety*(1/err)^(1/(p+1))
+
+  where p is the order of the scheme used for the estimate, so that
+  the local error is O(h^{p+1}). The growth and reduction of the step
+  are limited. The output for each step is only written and logged
+  once the step is accepted. When completed, num_time_steps is set to
+  the number of accepted steps.
+*/
+int TACSIntegrator::integrateAdaptive(){
+  const double safety = 0.9;
+  const double max_growth = 5.0;
+  const double max_reduction = 0.2;
+
+  // Set the time interval and the initial step size
+  const double tinit = time[0];
+  const double tfinal = time[num_time_steps];
+  const int nsteps = num_time_steps;
+  double h = (tfinal - tinit)/num_time_steps;
+  if (hmax > 0.0 && h > hmax){
+    h = hmax;
+  }
+
+  if (!lte_vec){
+    lte_vec = tacs->createVec();
+    lte_vec->incref();
+  }
+
+  double t0 = MPI_Wtime();
+  int flag = iterate(0, NULL);
+  if (flag != 0){
+    return flag;
+  }
+
+  int k = 1, nreject = 0;
+  while (tfinal - time[k-1] > 1e-12*(tfinal - tinit)){
+    if (k > max_time_steps){
+      extendHistory(2*max_time_steps);
+    }
+
+    // Do not step past the final time
+    if (h > tfinal - time[k-1]){
+      h = tfinal - time[k-1];
+    }
+    time[k] = time[k-1] + h;
+
+    // Take the step and estimate the local error
+    int p = 1;
+    double err = 0.0;
+    flag = iterate(k, NULL);
+    if (flag == 0){
+      err = estimateError(k, &p);
+      if (err < 0.0){
+        fprintf(stderr, "TACSIntegrator: Error estimates are not "
+                "available for this scheme\n");
+        return 1;
+      }
+    }
+
+    // Compute the factor for the new step size
+    double factor = max_reduction;
+    if (flag == 0){
+      factor = max_growth;
+      if (err > 0.0){
+        factor = safety*pow(err, -1.0/(p + 1.0));
+      }
+      if (factor > max_growth){ factor = max_growth; }
+      if (factor < max_reduction){ factor = max_reduction; }
+    }
+
+    if (flag == 0 && (err <= 1.0 || h <= hmin)){
+      // Accept the step and write the output for it
+      logTimeStep(k);
+      k++;
+      h *= factor;
+    }
+    else {
+      // Reject the step and repeat it with a smaller step size
+      nreject++;
+      if (factor > safety){
+        factor = safety;
+      }
+      h *= factor;
+      if (h < 1e-12*(tfinal - tinit)){
+        fprintf(stderr, "TACSIntegrator: Time step too small at t = %e\n",
+                time[k-1]);
+        return 1;
+      }
+    }
+
+    // Enforce the bounds on the step size
+    if (hmax > 0.0 && h > hmax){
+      h = hmax;
+    }
+    if (h < hmin){
+      h = hmin;
+    }
+  }
+
+  // Set the number of time steps that were taken
+  num_time_steps = k-1;
+  time[num_time_steps] = tfinal;
+  if (end_plane == nsteps || end_plane > num_time_steps){
+    end_plane = num_time_steps;
+  }
+  time_forward = MPI_Wtime() - t0;
+
+  if (logfp && print_level >= 1){
+    fprintf(logfp, "Adaptive time stepping: %d steps accepted, "
+            "%d steps rejected\n", num_time_steps, nreject);
+  }
+
+  return 0;
+}
+
 /*
   Creates mat, ksm and pc objects
 */
@@ -1366,13 +1818,20 @@ void TACSIntegrator::initializeLinearSolver( ){
     // The Krylov subspace method (KSM) associated with the solver
     ksm = new GMRES(mat, pc, gmres_iters, num_restarts, is_flexible);
     ksm->incref();
+
+    // ksm->setMonitor(new KSMPrintStdout("GMRES", 0, 1));
+    ksm->setTolerances(0.1*rtol, 1.0e-30);
   }
   else {
     ksm->getOperators(&mat, &pc);
-  }
 
-  // ksm->setMonitor(new KSMPrintStdout("GMRES", 0, 1));
-  ksm->setTolerances(0.1*rtol, 1.0e-30);
+    // Use the baseline tolerances unless the Eisenstat-Walker forcing
+    // terms are used. In that case, the tolerances set by the caller
+    // are saved and restored within newtonSolve().
+    if (!use_ew){
+      ksm->setTolerances(0.1*rtol, 1.0e-30);
+    }
+  }
 
   // Set the global variable to initialize linear solver
   linear_solver_initialized = 1;
@@ -1749,8 +2208,11 @@ int TACSBDFIntegrator::iterate( int k, TACSBVec *forces ){
                                 time[k], q[k], qdot[k], qddot[k],
                                 forces);
 
-  // Tecplot output and print related stuff as configured
-  logTimeStep(k);
+  // Tecplot output and print related stuff as configured. With
+  // adaptive time stepping, this is done once the step is accepted.
+  if (!adaptive){
+    logTimeStep(k);
+  }
 
   // Return a non-zero flag when the Newton iteration fails
   int fail = 0;
@@ -1760,6 +2222,46 @@ int TACSBDFIntegrator::iterate( int k, TACSBVec *forces ){
   return fail;
 }
 
+/*
+  Estimate the local truncation error for the step k.
+
+  The error is estimated from the difference between the solution and
+  a predictor that extrapolates the polynomial through the previous
+  p+1 states to the new time, where p is the order of the BDF scheme.
+  For constant steps, the error of the BDF scheme is approximately
+  1/p times this difference. For the first step, the predictor is the
+  Taylor series extrapolation from the initial conditions.
+*/
+double TACSBDFIntegrator::estimateError( int k, int *order ){
+  double h = time[k] - time[k-1];
+  lte_vec->copyValues(q[k]);
+
+  int p = (k-1 < max_bdf_order ? k-1 : max_bdf_order);
+  if (p < 1){
+    // Use the difference with the Taylor series extrapolation
+    lte_vec->axpy(-1.0, q[k-1]);
+    lte_vec->axpy(-h, qdot[k-1]);
+    lte_vec->axpy(-0.5*h*h, qddot[k-1]);
+    *order = 1;
+    return computeErrorNorm(lte_vec, q[k]);
+  }
+
+  // Subtract the Lagrange extrapolation through the previous states
+  for ( int j = 0; j <= p; j++ ){
+    double lj = 1.0;
+    for ( int m = 0; m <= p; m++ ){
+      if (m != j){
+        lj *= (time[k] - time[k-1-m])/(time[k-1-j] - time[k-1-m]);
+      }
+    }
+    lte_vec->axpy(-lj, q[k-1-j]);
+  }
+  lte_vec->scale(1.0/p);
+
+  *order = p;
+  return computeErrorNorm(lte_vec, q[k]);
+}
+
 /*
   Evaluate the functions of interest
 */
@@ -1946,6 +2448,7 @@ void TACSBDFIntegrator::initAdjoint( int k ){
 
     // Setup the Jacobian
     double tassembly = MPI_Wtime();
+    TACSProfiler::begin(TACSProfiler::INTEGRATOR_ASSEMBLY);
 
     // Try to downcast to a multigrid pc
     TACSMg *mg = dynamic_cast<TACSMg*>(pc);
@@ -1955,11 +2458,15 @@ void TACSBDFIntegrator::initAdjoint( int k ){
     else {
       tacs->assembleJacobian(alpha, beta, gamma, NULL, mat, TRANSPOSE);
     }
+    TACSProfiler::end(TACSProfiler::INTEGRATOR_ASSEMBLY);
     time_rev_assembly += MPI_Wtime() - tassembly;
 
     // LU factorization of the Jacobian
     double tfactor = MPI_Wtime();
+    TACSProfiler::begin(TACSProfiler::INTEGRATOR_FACTOR);
     pc->factor();
+    jac_factored = 0;
+    TACSProfiler::end(TACSProfiler::INTEGRATOR_FACTOR);
     time_rev_factor += MPI_Wtime() - tfactor;
   }
 }
@@ -1975,6 +2482,7 @@ void TACSBDFIntegrator::iterateAdjoint( int k, TACSBVec **adj_rhs ){
   // Apply the factorization for all right hand sides and solve for
   // the adjoint variables
   double tapply = MPI_Wtime();
+  TACSProfiler::begin(TACSProfiler::INTEGRATOR_SOLVE);
   for ( int n = 0; n < num_funcs; n++ ){
     if (adj_rhs){
       // Use the residual vector as a temp vector for the purposes
@@ -1988,6 +2496,7 @@ void TACSBDFIntegrator::iterateAdjoint( int k, TACSBVec **adj_rhs ){
       ksm->solve(rhs[adj_index*num_funcs + n], psi[n]);
     }
   }
+  TACSProfiler::end(TACSProfiler::INTEGRATOR_SOLVE);
   time_rev_apply_factor += MPI_Wtime() - tapply;
 }
 
@@ -2034,6 +2543,7 @@ void TACSBDFIntegrator::postAdjoint( int k ){
 
     // Drop the contributions from this step to other right hand sides
     double tassembly2 = MPI_Wtime();
+    TACSProfiler::begin(TACSProfiler::INTEGRATOR_ASSEMBLY);
     for ( int ii = 1; (ii < nbdf || ii < nbddf); ii++ ){
       int rhs_index = (k - ii) % num_adjoint_rhs;
       double beta = 0.0, gamma = 0.0;
@@ -2049,6 +2559,7 @@ void TACSBDFIntegrator::postAdjoint( int k ){
                                     TRANSPOSE);
       }
     }
+    TACSProfiler::end(TACSProfiler::INTEGRATOR_ASSEMBLY);
     time_rev_assembly += MPI_Wtime() - tassembly2;
   }
 
@@ -2124,6 +2635,8 @@ TACSIntegrator(_tacs, _tinit, _tfinal, _num_steps){
   c = new double[num_stages];
   A = new double[num_stages*(num_stages+1)/2];
   B = new double[num_stages];
+  bhat = new double[num_stages];
+  embedded_order = 0;
 
   // Set the Butcher tableau entries to zero
   memset(a, 0, num_stages*(num_stages+1)/2*sizeof(double));
@@ -2131,6 +2644,7 @@ TACSIntegrator(_tacs, _tinit, _tfinal, _num_steps){
   memset(c, 0, num_stages*sizeof(double));
   memset(A, 0, num_stages*(num_stages+1)/2*sizeof(double));
   memset(B, 0, num_stages*sizeof(double));
+  memset(bhat, 0, num_stages*sizeof(double));
 
   // Add entries into the Butcher tableau
   setupDefaultCoeffs();
@@ -2157,9 +2671,10 @@ TACSDIRKIntegrator::~TACSDIRKIntegrator(){
   delete [] c;
   delete [] A;
   delete [] B;
+  delete [] bhat;
 
   // Cleanup stage states
-  for ( int i = 0; i < num_stages*num_time_steps; i++ ){
+  for ( int i = 0; i < num_stages*max_time_steps; i++ ){
     qS[i]->decref();
     qdotS[i]->decref();
     qddotS[i]->decref();
@@ -2214,6 +2729,11 @@ void TACSDIRKIntegrator::setupDefaultCoeffs(){
 
     c[0] = 0.5 + tmp;
     c[1] = 0.5 - tmp;
+
+    // First-order embedded weights
+    bhat[0] = 1.0;
+    bhat[1] = 0.0;
+    embedded_order = 1;
   }
   else if (num_stages == 3){
     // Crouzeix formula (A-stable)
@@ -2233,6 +2753,12 @@ void TACSDIRKIntegrator::setupDefaultCoeffs(){
     c[0] = 0.5*(1.0+alpha);
     c[1] = 0.5;
     c[2] = 0.5*(1.0-alpha);
+
+    // Second-order embedded weights using the mid-point stage
+    bhat[0] = 0.0;
+    bhat[1] = 1.0;
+    bhat[2] = 0.0;
+    embedded_order = 2;
   }
   else {
     fprintf(stderr, "ERROR: Invalid number of stages %d\n", num_stages);
@@ -2244,6 +2770,76 @@ void TACSDIRKIntegrator::setupDefaultCoeffs(){
   checkButcherTableau();
 }
 
+/*
+  Estimate the local truncation error for the step k.
+
+  The error is estimated from the difference between the solution and
+  the solution computed with the lower-order embedded weights. For
+  the single-stage scheme, which has no embedded weights, the
+  difference with the Taylor series extrapolation from the previous
+  step is used instead.
+*/
+double TACSDIRKIntegrator::estimateError( int k, int *order ){
+  double h = time[k] - time[k-1];
+
+  if (embedded_order == 0){
+    lte_vec->copyValues(q[k]);
+    lte_vec->axpy(-1.0, q[k-1]);
+    lte_vec->axpy(-h, qdot[k-1]);
+    lte_vec->axpy(-0.5*h*h, qddot[k-1]);
+    *order = 2;
+    return computeErrorNorm(lte_vec, q[k]);
+  }
+
+  // Compute the difference between the solutions
+  // e = h^2*sum_{i} (B[i] - Bhat[i])*qddotS[i]
+  // where Bhat[i] = sum_{j} bhat[j]*a[j,i]
+  lte_vec->zeroEntries();
+  for ( int i = 0; i < num_stages; i++ ){
+    double Bhat = 0.0;
+    for ( int j = 0; j < num_stages; j++ ){
+      Bhat += bhat[j]*getACoeff(j, i);
+    }
+    int offset = (k-1)*num_stages + i;
+    lte_vec->axpy(h*h*(B[i] - Bhat), qddotS[offset]);
+  }
+
+  *order = embedded_order;
+  return computeErrorNorm(lte_vec, q[k]);
+}
+
+/*
+  Extend the storage for the stage variables
+*/
+void TACSDIRKIntegrator::extendStageHistory( int old_steps,
+                                             int new_steps ){
+  TACSBVec **qSnew = new TACSBVec*[ num_stages*new_steps ];
+  TACSBVec **qdotSnew = new TACSBVec*[ num_stages*new_steps ];
+  TACSBVec **qddotSnew = new TACSBVec*[ num_stages*new_steps ];
+
+  memcpy(qSnew, qS, num_stages*old_steps*sizeof(TACSBVec*));
+  memcpy(qdotSnew, qdotS, num_stages*old_steps*sizeof(TACSBVec*));
+  memcpy(qddotSnew, qddotS, num_stages*old_steps*sizeof(TACSBVec*));
+
+  for ( int k = num_stages*old_steps; k < num_stages*new_steps; k++ ){
+    qSnew[k] = tacs->createVec();
+    qSnew[k]->incref();
+
+    qdotSnew[k] = tacs->createVec();
+    qdotSnew[k]->incref();
+
+    qddotSnew[k] = tacs->createVec();
+    qddotSnew[k]->incref();
+  }
+
+  delete [] qS;
+  delete [] qdotS;
+  delete [] qddotS;
+  qS = qSnew;
+  qdotS = qdotSnew;
+  qddotS = qddotSnew;
+}
+
 /*
   Get the stage coefficient from the tableau using the full index
 */
@@ -2433,8 +3029,11 @@ int TACSDIRKIntegrator::iterate( int k, TACSBVec *forces ){
     qddot[k]->axpy(b[stage], qddotS[offset]);
   }
 
-  // Perform logging, tecplot export, etc.
-  logTimeStep(k);
+  // Perform logging, tecplot export, etc. With adaptive time
+  // stepping, this is done once the step is accepted.
+  if (!adaptive){
+    logTimeStep(k);
+  }
 
   return 0;
 }
@@ -2638,6 +3237,7 @@ void TACSDIRKIntegrator::iterateAdjoint( int k, TACSBVec **adj_rhs ){
 
     // Factor the preconditioner
     pc->factor();
+    jac_factored = 0;
 
     // Compute the derivatives and store them
     if (k > start_plane && k <= end_plane){
@@ -46,10 +46,14 @@ class TACSIntegrator : public TACSObject {
   void setMaxNewtonIters( int _max_newton_iters );
   void setPrintLevel( int _print_level, const char *logfilename=NULL );
   void setJacAssemblyFreq( int _jac_comp_freq );
+  void setJacobianReuse( int _jac_reuse, double _jac_max_rate=0.5 );
+  void setEisenstatWalker( int _use_ew, double _ew_eta_max=0.9 );
   void setUseLapack( int _use_lapack );
   void setUseFEMat( int _use_femat, TACSAssembler::OrderingType _type );
   void setInitNewtonDeltaFraction( double frac );
   void setKrylovSubspaceMethod( TACSKsm *_ksm );
+  void setAdaptiveTimeStepping( double _lte_rtol, double _lte_atol=0.0,
+                                double _hmin=0.0, double _hmax=0.0 );
 
   // Set (or reset) the time interval
   // --------------------------------
@@ -66,6 +70,9 @@ class TACSIntegrator : public TACSObject {
 
   // Integrate the equations of motion forward in time
   virtual int integrate(){
+    if (adaptive){
+      return integrateAdaptive();
+    }
     for ( int i = 0; i < num_time_steps+1; i++ ){
       int flag = iterate(i, NULL);
       if (flag != 0) return flag;
@@ -127,6 +134,7 @@ class TACSIntegrator : public TACSObject {
   //-----------------------------------------------------------------
   void setOutputPrefix( const char *prefix );
   void setOutputFrequency( int _write_step );
+  void setOutputTimeSeries( int _f5_time_series );
   void setRigidOutput( TACSToFH5 *_rigidf5 );
   void setShellOutput( TACSToFH5 *_shellf5 );
   void setBeamOutput( TACSToFH5 *_beamf5 );
@@ -155,6 +163,24 @@ class TACSIntegrator : public TACSObject {
   int initAccelerationSolve( TACSBVec *forces=NULL );
   void lapackLinearSolve( TACSBVec *res, TACSMat *mat, TACSBVec *update );
 
+  // Functions for adaptive time stepping
+  int integrateAdaptive();
+  void extendHistory( int nsteps );
+  double computeErrorNorm( TACSBVec *err, TACSBVec *qk );
+
+  // Estimate the weighted norm of the local truncation error of step
+  // k and the order p of the scheme used for the estimate, so that the
+  // local error is O(h^{p+1}). Returns a negative value if no estimate
+  // is available.
+  virtual double estimateError( int k, int *order ){
+    *order = 0;
+    return -1.0;
+  }
+
+  // Extend the storage for stage variables when the number of
+  // steps is increased during adaptive time stepping
+  virtual void extendStageHistory( int old_steps, int new_steps ){}
+
   // Variables that keep track of time
   double time_fwd_assembly;
   double time_fwd_factor;
@@ -176,6 +202,7 @@ class TACSIntegrator : public TACSObject {
 
   // The step information
   int num_time_steps;         // Total number of time steps
+  int max_time_steps;         // Number of steps allocated
   double *time;               // Stores the time values
   TACSBVec **q;               // state variables across all time steps
   TACSBVec **qdot;            // first time derivative of ''
@@ -206,10 +233,25 @@ class TACSIntegrator : public TACSObject {
   double rtol;              // Relative tolerance
   double init_newton_delta; // Initial value of delta for globalization
   int jac_comp_freq;        // Frequency of Jacobian factorization
+  int jac_reuse;            // Reuse the factorization while converging
+  double jac_max_rate;      // Max residual contraction rate for reuse
+  int jac_factored;         // Flag for a valid factorization to reuse
+  double jac_alpha;         // Coefficients of the factored Jacobian
+  double jac_beta;
+  double jac_gamma;
+  int use_ew;               // Use Eisenstat-Walker forcing terms
+  double ew_eta_max;        // Maximum forcing term
   int use_femat;            // use femet for parallel execution
   TACSAssembler::OrderingType order_type;
   int use_lapack;           // Flag to switch to LAPACK for linear solve
 
+  // Adaptive time step parameters
+  int adaptive;             // Flag to indicate adaptive time stepping
+  double lte_rtol;          // Relative tolerance for the local error
+  double lte_atol;          // Absolute tolerance for the local error
+  double hmin, hmax;        // Bounds on the time step (if > 0)
+  TACSBVec *lte_vec;        // Temporary vector for the error estimate
+
   int lev;
   double fill;
   int reorder_schur;
@@ -229,6 +271,7 @@ class TACSIntegrator : public TACSObject {
   TACSToFH5 *beamf5;        // F5 file for beam visualization
   TACSToFH5 *solidf5;        // F5 file for solid visualization
   int f5_write_freq;        // Frequency for output during time marching
+  int f5_time_series;       // Write all steps to a single file
 
   int niter;                // Newton iteration number
   TacsScalar res_norm;      // residual norm
@@ -269,6 +312,10 @@ class TACSBDFIntegrator : public TACSIntegrator {
   // Evaluate the functions of interest
   void evalFunctions( TacsScalar *fvals );
 
+ protected:
+  // Estimate the local error from the predictor-corrector difference
+  double estimateError( int k, int *order );
+
  private:
   void get2ndBDFCoeff( const int k, double bdf[], int *nbdf,
                        double bddf[], int *nbddf,
@@ -314,6 +361,13 @@ class TACSDIRKIntegrator : public TACSIntegrator {
   // Evaluate the functions of interest
   void evalFunctions( TacsScalar *fvals );
 
+ protected:
+  // Estimate the local error using the embedded weights
+  double estimateError( int k, int *order );
+
+  // Extend the storage for the stage variables
+  void extendStageHistory( int old_steps, int new_steps );
+
  private:
   // Set the default coefficients
   void setupDefaultCoeffs();
@@ -343,6 +397,10 @@ class TACSDIRKIntegrator : public TACSIntegrator {
   // The Butcher coefficients for the integration scheme
   double *a, *b, *c;
 
+  // The embedded weights and their order (zero if not defined)
+  double *bhat;
+  int embedded_order;
+
   // The second-order coefficients for the integration scheme
   double *A, *B;
 
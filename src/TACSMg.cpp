@@ -48,6 +48,13 @@ TACSMg::TACSMg( MPI_Comm _comm, int _nlevels,
   sor_iters = _sor_iters;
   sor_symmetric = _sor_symmetric;
 
+  // Use the Gauss-Seidel smoother by default
+  cheb_degree = 0;
+  cheb_lower = 1.0/30.0;
+  cheb_upper = 1.1;
+  cheb_reuse_tol = 0.0;
+  sor_multicolor = 0;
+
   if (nlevels < 2){
     fprintf(stderr, "Multigrid with fewer than 2 levels does \
 not make any sense!\n");
@@ -89,6 +96,15 @@ not make any sense!\n");
   monitor = NULL;
   root_mat = NULL;
   root_pc = NULL;
+  root_pc_default = 0;
+  coarse_procs = -1;
+
+  // The Galerkin products are created when they are first required
+  use_galerkin = 0;
+  galerkin = new TACSGalerkinProduct*[ nlevels-1 ];
+  for ( int i = 0; i < nlevels-1; i++ ){
+    galerkin[i] = NULL;
+  }
 
   // Total time for smoothing and interpolation for each level
   cumulative_level_time = new double[ nlevels ];
@@ -110,6 +126,7 @@ TACSMg::~TACSMg(){
     if (mat[i]){ mat[i]->decref(); }
     if (interp[i]){ interp[i]->decref(); }
     if (pc[i]){ pc[i]->decref(); }
+    if (galerkin[i]){ galerkin[i]->decref(); }
   }
 
   if (monitor){ monitor->decref(); }
@@ -124,6 +141,7 @@ TACSMg::~TACSMg(){
   delete [] b;
   delete [] interp;
   delete [] pc;
+  delete [] galerkin;
   delete [] cumulative_level_time;
 }
 
@@ -187,10 +205,7 @@ void TACSMg::setLevel( int level, TACSAssembler *_tacs,
       mat[level] = pmat;
       mat[level]->incref();
 
-      // Do not zero the initial guess for the PSOR object
-      int zero_guess = 0;
-      pc[level] = new TACSGaussSeidel(pmat, zero_guess, sor_omega,
-                                      sor_iters, sor_symmetric);
+      pc[level] = createSmoother(pmat);
       pc[level]->incref();
     }
   }
@@ -207,6 +222,7 @@ void TACSMg::setLevel( int level, TACSAssembler *_tacs,
         root_pc->decref();
       }
       root_pc = _smoother;
+      root_pc_default = 0;
     }
     else {
       // Set up the root matrix
@@ -218,11 +234,13 @@ void TACSMg::setLevel( int level, TACSAssembler *_tacs,
       int lev = 10000;
       double fill = 15.0;
       int reorder_schur = 1;
-      PcScMat *_pc = new PcScMat(femat, lev, fill, reorder_schur);
+      PcScMat *_pc = new PcScMat(femat, lev, fill, reorder_schur,
+                                 coarse_procs);
       // _pc->setMonitorFactorFlag(1);
       // _pc->setMonitorBackSolveFlag(1);
       root_pc = _pc;
       root_pc->incref();
+      root_pc_default = 1;
     }
   }
 
@@ -302,6 +320,12 @@ void TACSMg::assembleJacobian( double alpha, double beta, double gamma,
                               res, mat[0], matOr);
   }
 
+  // Form the coarse matrices from the finest matrix
+  if (use_galerkin){
+    computeGalerkin();
+    return;
+  }
+
   for ( int i = 1; i < nlevels-1; i++ ){
     if (tacs[i]){
       tacs[i]->assembleJacobian(alpha, beta, gamma,
@@ -328,6 +352,12 @@ void TACSMg::assembleMatType( ElementMatrixType matType,
     if (tacs[i]){
       tacs[i]->assembleMatType(matType, mat[i], matOr);
     }
+
+    // Form the coarse matrices from the finest matrix
+    if (use_galerkin){
+      computeGalerkin();
+      return;
+    }
   }
 
   // Assemble the coarsest problem
@@ -347,6 +377,12 @@ void TACSMg::assembleMatCombo( ElementMatrixType matTypes[],
     if (tacs[i]){
       tacs[i]->assembleMatCombo(matTypes, scale, nmats, mat[i], matOr);
     }
+
+    // Form the coarse matrices from the finest matrix
+    if (use_galerkin){
+      computeGalerkin();
+      return;
+    }
   }
 
   // Assemble the coarsest problem
@@ -408,6 +444,182 @@ void TACSMg::setMonitor( KSMPrint *_monitor ){
   monitor = _monitor;
 }
 
+/*
+  Set the flag to form the coarse matrices with the Galerkin product
+  P^{T}*A*P instead of assembling them from the coarse models.
+
+  When this flag is set, only the matrix on the finest level is
+  assembled. The coarse matrices are computed from the fine matrix
+  and the interpolation operators, so the fine matrices on each level
+  (except the coarsest) must be TACSPMat objects. The coarse models
+  are still required for the vectors and the boundary conditions.
+
+  The matrices and smoothers on the coarse levels are replaced the
+  first time the Galerkin product is computed: Gauss-Seidel smoothers
+  are used on the intermediate levels and the parallel direct solver
+  is used on the coarsest level.
+
+  input:
+  flag:   flag to indicate whether to use the Galerkin product
+*/
+void TACSMg::setUseGalerkin( int flag ){
+  use_galerkin = flag;
+}
+
+/*
+  Set the number of processors used for the direct solve on the
+  coarsest level.
+
+  The coarse problem is small, so the parallel direct solver does not
+  scale to a large number of processors. Limiting the number of
+  processors agglomerates the coarse problem onto a subset of the
+  processors which perform the factorization and the back-solves.
+  This only applies to the default coarse solver created by TACSMg.
+
+  input:
+  nprocs:  the number of processors (nprocs <= 0 uses all processors)
+*/
+void TACSMg::setCoarseSolverProcs( int nprocs ){
+  coarse_procs = nprocs;
+
+  // Re-create the default coarse solver with the new number of procs
+  if (root_pc_default && root_mat){
+    FEMat *femat = dynamic_cast<FEMat*>(root_mat);
+    if (femat){
+      int lev = 10000;
+      double fill = 15.0;
+      int reorder_schur = 1;
+      TACSPc *_pc = new PcScMat(femat, lev, fill, reorder_schur,
+                                coarse_procs);
+      _pc->incref();
+      root_pc->decref();
+      root_pc = _pc;
+    }
+  }
+}
+
+/*
+  Use a Chebyshev polynomial smoother in place of Gauss-Seidel for the
+  smoothers created by TACSMg. This must be called before the levels
+  are set.
+
+  The Chebyshev smoother is applied to the matrix scaled by the
+  inverse of its block diagonal. It only requires matrix-vector
+  products and the block-diagonal inverse, so it does not have the
+  sequential dependency of the Gauss-Seidel sweeps, and the residual
+  for the restriction is computed as a by-product of the smoothing.
+
+  input:
+  degree:        the degree of the polynomial (degree <= 0 uses SOR)
+  lower_factor:  the lower end of the interval relative to the max
+  upper_factor:  the factor applied to the max eigenvalue estimate
+  reuse_tol:     the tolerance for reusing the eigenvalue estimate
+*/
+void TACSMg::setChebyshevSmoother( int degree, double lower_factor,
+                                   double upper_factor,
+                                   double reuse_tol ){
+  cheb_degree = degree;
+  cheb_lower = lower_factor;
+  cheb_upper = upper_factor;
+  cheb_reuse_tol = reuse_tol;
+}
+
+/*
+  Use the multicolor ordering for the Gauss-Seidel smoother on each
+  level. Each color is a threaded sweep, using the threads from the
+  TACSAssembler object on each level. This must be called before the
+  levels are set.
+*/
+void TACSMg::setMultiColorSmoother( int flag ){
+  sor_multicolor = flag;
+}
+
+/*
+  Create the default smoother for the given matrix
+*/
+TACSPc *TACSMg::createSmoother( TACSPMat *pmat ){
+  if (cheb_degree > 0){
+    TACSChebyshevSmoother *cheb = 
+      new TACSChebyshevSmoother(pmat, cheb_degree, cheb_lower,
+                                cheb_upper, sor_iters);
+    cheb->setEigenBoundsReuse(cheb_reuse_tol);
+    return cheb;
+  }
+
+  // Do not zero the initial guess for the PSOR object
+  int zero_guess = 0;
+  TACSGaussSeidel *gs = new TACSGaussSeidel(pmat, zero_guess, sor_omega,
+                                            sor_iters, sor_symmetric);
+  gs->setMultiColor(sor_multicolor);
+  return gs;
+}
+
+/*
+  Compute the coarse matrices from the Galerkin product P^{T}*A*P on
+  each level.
+
+  The Galerkin product objects are created the first time this is
+  called. At this point, the coarse matrices and smoothers are
+  replaced with matrices that have the non-zero pattern of the
+  product.
+*/
+void TACSMg::computeGalerkin(){
+  for ( int i = 0; i < nlevels-1; i++ ){
+    TACSPMat *pmat = dynamic_cast<TACSPMat*>(mat[i]);
+    if (!pmat || !interp[i] || !tacs[i+1]){
+      fprintf(stderr, "TACSMg: Galerkin product requires a TACSPMat "
+              "and interpolation on level %d\n", i);
+      return;
+    }
+
+    if (!galerkin[i]){
+      galerkin[i] = new TACSGalerkinProduct(interp[i], pmat);
+      galerkin[i]->incref();
+      TACSThreadInfo *thread_info = tacs[i+1]->getThreadInfo();
+
+      if (i < nlevels-2){
+        // Replace the matrix and smoother on the intermediate level
+        TACSDistMat *dmat = galerkin[i]->createMat(thread_info);
+        dmat->incref();
+        if (mat[i+1]){ mat[i+1]->decref(); }
+        mat[i+1] = dmat;
+
+        TACSPc *_pc = createSmoother(dmat);
+        _pc->incref();
+        if (pc[i+1]){ pc[i+1]->decref(); }
+        pc[i+1] = _pc;
+      }
+      else {
+        // Replace the matrix and direct solver on the coarsest level
+        FEMat *femat = galerkin[i]->createFEMat(thread_info);
+        femat->incref();
+        if (root_mat){ root_mat->decref(); }
+        root_mat = femat;
+
+        int lev = 10000;
+        double fill = 15.0;
+        int reorder_schur = 1;
+        TACSPc *_pc = new PcScMat(femat, lev, fill, reorder_schur,
+                                  coarse_procs);
+        _pc->incref();
+        if (root_pc){ root_pc->decref(); }
+        root_pc = _pc;
+        root_pc_default = 1;
+      }
+    }
+
+    // Compute the product and apply the boundary conditions
+    if (i < nlevels-2){
+      galerkin[i]->computeProduct(mat[i+1]);
+      mat[i+1]->applyBCs(tacs[i+1]->getBcMap());
+    }
+    else {
+      galerkin[i]->computeProduct(root_mat);
+      root_mat->applyBCs(tacs[i+1]->getBcMap());
+    }
+  }
+}
+
 /*
   Repeatedly apply the multi-grid method until the problem is solved
 */
@@ -419,7 +631,11 @@ void TACSMg::solve( TACSBVec *bvec, TACSBVec *xvec, int max_iters,
   // Compute the initial residual and multiply
   TacsScalar rhs_norm = 0.0;
   for ( int i = 0; i < max_iters; i++ ){
-    applyMg(0);
+    applyMg(0, 0);
+
+    // Compute the residual r[0] = b[0] - A*x[0]
+    mat[0]->mult(x[0], r[0]);
+    r[0]->axpby(1.0, -1.0, b[0]);
     TacsScalar norm = r[0]->norm();
     if (monitor){ monitor->printResidual(i, norm); }
     if (i == 0){
@@ -454,7 +670,7 @@ void TACSMg::applyFactor( TACSVec *bvec, TACSVec *xvec ){
     if (monitor){
       memset(cumulative_level_time, 0, nlevels*sizeof(double));
     }
-    applyMg(0);
+    applyMg(0, 1);
     if (monitor){
       for ( int k = 0; k < nlevels; k++ ){
         char descript[128];
@@ -479,8 +695,18 @@ void TACSMg::applyFactor( TACSVec *bvec, TACSVec *xvec ){
   This function applies multigrid recursively by smoothing the
   residual, restricting to the next level, applying multigrid, then
   post-smoothing.
+
+  The residual after pre-smoothing is restricted without a separate
+  pass to form it: smoothers that compute the residual as a by-product
+  of the last step (Chebyshev) store it in r[level], otherwise the
+  residual is computed and restricted in a single pass through the
+  matrix with TACSBVecInterp::multTransposeResidual().
+
+  input:
+  level:       the multigrid level
+  zero_guess:  flag to indicate that x[level] is zero on input
 */
-void TACSMg::applyMg( int level ){
+void TACSMg::applyMg( int level, int zero_guess ){
   // If we've made it to the lowest level, apply the direct solver
   // otherwise, perform multigrid on the next-lowest level
   if (level == nlevels-1){
@@ -496,19 +722,29 @@ void TACSMg::applyMg( int level ){
   if (monitor){ t1 = MPI_Wtime(); }
   for ( int k = 0; k < iters[level]; k++ ){
     // Pre-smooth at the current level
-    pc[level]->applyFactor(b[level], x[level]);
-
-    // Compute r[level] = b[level] - A*x[level]
-    mat[level]->mult(x[level], r[level]);
-    r[level]->axpby(1.0, -1.0, b[level]);
+    int has_res = pc[level]->applySmoother(b[level], x[level], r[level],
+                                           (zero_guess && k == 0));
 
     // Restrict the residual to the next lowest level
     // to form the RHS at that level
-    interp[level]->multTranspose(r[level], b[level+1]);
+    TACSPMat *pmat = dynamic_cast<TACSPMat*>(mat[level]);
+    if (has_res){
+      interp[level]->multTranspose(r[level], b[level+1]);
+    }
+    else if (pmat){
+      interp[level]->multTransposeResidual(pmat, b[level], x[level],
+                                           b[level+1]);
+    }
+    else {
+      // Compute r[level] = b[level] - A*x[level]
+      mat[level]->mult(x[level], r[level]);
+      r[level]->axpby(1.0, -1.0, b[level]);
+      interp[level]->multTranspose(r[level], b[level+1]);
+    }
     b[level+1]->applyBCs(tacs[level+1]->getBcMap());
     x[level+1]->zeroEntries();
 
-    applyMg(level+1);
+    applyMg(level+1, 1);
 
     // Interpolate back from the next lowest level
     interp[level]->multAdd(x[level+1], x[level], x[level]);
@@ -104,9 +104,24 @@ class TACSMg : public TACSPc {
   // --------------------------------
   void setMonitor( KSMPrint *_monitor );
 
+  // Set the options for forming and solving the coarse problems
+  // -----------------------------------------------------------
+  void setUseGalerkin( int flag );
+  void setCoarseSolverProcs( int nprocs );
+  void setChebyshevSmoother( int degree, double lower_factor=1.0/30.0,
+                             double upper_factor=1.1,
+                             double reuse_tol=0.0 );
+  void setMultiColorSmoother( int flag );
+
  private:
   // Recursive function to apply multi-grid at each level
-  void applyMg( int level ); 
+  void applyMg( int level, int zero_guess ); 
+
+  // Create the default smoother for a level
+  TACSPc *createSmoother( TACSPMat *pmat );
+
+  // Compute the coarse operators with the Galerkin product
+  void computeGalerkin();
 
   // The MPI communicator for this object
   MPI_Comm comm;
@@ -115,9 +130,13 @@ class TACSMg : public TACSPc {
   KSMPrint *monitor;
 
   // The SOR data 
-  int sor_iters, sor_symmetric;
+  int sor_iters, sor_symmetric, sor_multicolor;
   double sor_omega;
 
+  // The Chebyshev smoother data (used if cheb_degree > 0)
+  int cheb_degree;
+  double cheb_lower, cheb_upper, cheb_reuse_tol;
+
   // The number of multi-grid levels
   int nlevels;
 
@@ -139,6 +158,15 @@ class TACSMg : public TACSPc {
   TACSPc *root_pc; // The root direct solver
   TACSMat **mat; // The matrices associated with each level
   TACSPc **pc; // The smoothers for all but the lowest level
+
+  // Form the coarse matrices with the Galerkin product P^{T}*A*P
+  int use_galerkin;
+  TACSGalerkinProduct **galerkin;
+
+  // The number of processors used for the coarse direct solve and a
+  // flag to indicate whether the root solver was created internally
+  int coarse_procs;
+  int root_pc_default;
 };
 
 #endif // TACS_MG_H
@@ -17,6 +17,7 @@
 */
 
 #include "TACSObject.h"
+#include "pthread.h"
 
 /*
   Implementation of the reference counting TACSObject as well as
@@ -174,3 +175,238 @@ void TACSThreadInfo::setNumThreads( int _num_threads ){
 int TACSThreadInfo::getNumThreads(){
   return num_threads; 
 }
+
+/*
+  Get the contiguous range of entries [start, end) of an array of
+  length size that is assigned to the given thread
+
+  input:
+  thread:       the thread index 0 <= thread < num_threads
+  num_threads:  the number of threads
+  size:         the length of the array
+
+  output:
+  start:        the first entry assigned to the thread
+  end:          one past the last entry assigned to the thread
+*/
+void TACSThreadInfo::getThreadRange( int thread, int num_threads, int size,
+                                     int *start, int *end ){
+  *start = (int)((1L*size*thread)/num_threads);
+  *end = (int)((1L*size*(thread+1))/num_threads);
+}
+
+/*
+  The data passed to each thread for the threaded zeroArray call
+*/
+class TACSThreadZeroData {
+ public:
+  int thread, num_threads, size;
+  TacsScalar *array;
+};
+
+static void *TACSThreadZeroArray_thread( void *t ){
+  TACSThreadZeroData *data = static_cast<TACSThreadZeroData*>(t);
+  int start, end;
+  TACSThreadInfo::getThreadRange(data->thread, data->num_threads,
+                                 data->size, &start, &end);
+  memset(&data->array[start], 0, (end - start)*sizeof(TacsScalar));
+  pthread_exit(NULL);
+}
+
+/*
+  Zero the array using the static partition from getThreadRange()
+
+  When the array has just been allocated, this is the first touch of
+  the memory, so that on a NUMA system each page is placed on the
+  memory of the socket that runs the thread that will access it.
+
+  input:
+  num_threads:  the number of threads
+  array:        the array to zero
+  size:         the length of the array
+*/
+void TACSThreadInfo::zeroArray( int num_threads, TacsScalar *array,
+                                int size ){
+  if (num_threads <= 1){
+    memset(array, 0, size*sizeof(TacsScalar));
+    return;
+  }
+  if (num_threads > TACS_MAX_NUM_THREADS){
+    num_threads = TACS_MAX_NUM_THREADS;
+  }
+
+  pthread_t threads[TACS_MAX_NUM_THREADS];
+  TACSThreadZeroData data[TACS_MAX_NUM_THREADS];
+
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
+
+  for ( int k = 0; k < num_threads; k++ ){
+    data[k].thread = k;
+    data[k].num_threads = num_threads;
+    data[k].size = size;
+    data[k].array = array;
+    pthread_create(&threads[k], &attr,
+                   TACSThreadZeroArray_thread, (void*)&data[k]);
+  }
+
+  for ( int k = 0; k < num_threads; k++ ){
+    pthread_join(threads[k], NULL);
+  }
+
+  pthread_attr_destroy(&attr);
+}
+
+/*
+  Allocate memory aligned on TACS_MEMORY_ALIGNMENT bytes
+
+  input:
+  bytes:  the number of bytes to allocate
+
+  returns: the aligned pointer or NULL if the allocation fails
+*/
+void *TacsAlignedAlloc( size_t bytes ){
+  void *ptr = NULL;
+  if (bytes == 0){
+    bytes = TACS_MEMORY_ALIGNMENT;
+  }
+  if (posix_memalign(&ptr, TACS_MEMORY_ALIGNMENT, bytes) != 0){
+    fprintf(stderr, "TacsAlignedAlloc: Failed to allocate %ld bytes\n",
+            (long)bytes);
+    return NULL;
+  }
+  return ptr;
+}
+
+/*
+  Free memory allocated with TacsAlignedAlloc
+*/
+void TacsAlignedFree( void *ptr ){
+  if (ptr){ free(ptr); }
+}
+
+TACSMemoryPool::TACSMemoryPool(){
+  pthread_mutex_init(&mutex, NULL);
+  free_list = NULL;
+  in_use_bytes = 0;
+  cached_bytes = 0;
+  num_allocs = 0;
+  num_reuses = 0;
+}
+
+TACSMemoryPool::~TACSMemoryPool(){
+  freeCachedMemory();
+  pthread_mutex_destroy(&mutex);
+}
+
+/*
+  Get an aligned array from the pool
+
+  The array is taken from the free list if an array of the same
+  (rounded) length is cached, otherwise it is allocated.
+
+  input:
+  bytes:  the number of bytes required
+
+  returns: the aligned array
+*/
+void *TACSMemoryPool::allocate( size_t bytes ){
+  // Round the length up to a multiple of the alignment
+  size_t len = TACS_MEMORY_ALIGNMENT*
+    ((bytes + TACS_MEMORY_ALIGNMENT-1)/TACS_MEMORY_ALIGNMENT);
+  if (len == 0){
+    len = TACS_MEMORY_ALIGNMENT;
+  }
+
+  // Search the free list for an array of the same length
+  pthread_mutex_lock(&mutex);
+  PoolHeader *header = NULL;
+  PoolHeader **prev = &free_list;
+  while (*prev){
+    if ((*prev)->bytes == len){
+      header = *prev;
+      *prev = header->next;
+      cached_bytes -= len;
+      num_reuses++;
+      break;
+    }
+    prev = &(*prev)->next;
+  }
+  if (header){
+    in_use_bytes += len;
+  }
+  pthread_mutex_unlock(&mutex);
+
+  if (!header){
+    char *ptr = (char*)TacsAlignedAlloc(TACS_MEMORY_ALIGNMENT + len);
+    if (!ptr){
+      return NULL;
+    }
+    header = (PoolHeader*)ptr;
+    header->bytes = len;
+
+    // Only count the array once the allocation has succeeded
+    pthread_mutex_lock(&mutex);
+    num_allocs++;
+    in_use_bytes += len;
+    pthread_mutex_unlock(&mutex);
+  }
+  header->next = NULL;
+
+  return (void*)((char*)header + TACS_MEMORY_ALIGNMENT);
+}
+
+/*
+  Return an array from allocate() to the pool
+
+  input:
+  ptr:  the array (may be NULL)
+*/
+void TACSMemoryPool::release( void *ptr ){
+  if (ptr){
+    PoolHeader *header =
+      (PoolHeader*)((char*)ptr - TACS_MEMORY_ALIGNMENT);
+
+    pthread_mutex_lock(&mutex);
+    header->next = free_list;
+    free_list = header;
+    in_use_bytes -= header->bytes;
+    cached_bytes += header->bytes;
+    pthread_mutex_unlock(&mutex);
+  }
+}
+
+/*
+  Free the arrays on the free list. The arrays that are in use are
+  not affected.
+*/
+void TACSMemoryPool::freeCachedMemory(){
+  pthread_mutex_lock(&mutex);
+  while (free_list){
+    PoolHeader *header = free_list;
+    free_list = header->next;
+    TacsAlignedFree(header);
+  }
+  cached_bytes = 0;
+  pthread_mutex_unlock(&mutex);
+}
+
+/*
+  Retrieve the memory usage of the pool
+
+  output:
+  in_use:      the bytes in the arrays that are in use
+  cached:      the bytes in the arrays on the free list
+  num_allocs:  (optional) the number of arrays allocated from the system
+  num_reuses:  (optional) the number of arrays taken from the free list
+*/
+void TACSMemoryPool::getMemoryUsage( size_t *in_use, size_t *cached,
+                                     int *_num_allocs, int *_num_reuses ){
+  pthread_mutex_lock(&mutex);
+  if (in_use){ *in_use = in_use_bytes; }
+  if (cached){ *cached = cached_bytes; }
+  if (_num_allocs){ *_num_allocs = num_allocs; }
+  if (_num_reuses){ *_num_reuses = num_reuses; }
+  pthread_mutex_unlock(&mutex);
+}
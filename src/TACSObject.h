@@ -35,6 +35,7 @@
 #include <stdio.h>
 #include <string.h>
 #include "mpi.h"
+#include "pthread.h"
 #include "TacsComplexStep.h"
 
 extern MPI_Op TACS_MPI_MIN;
@@ -178,10 +179,18 @@ class TACSOptObject : public TACSObject {
   This should only be allocated by the TACSAssembler object. The
   number of threads is volitile in the sense that it can change
   between subsequent calls.
+
+  In the hybrid mode, with one MPI process per socket and one thread
+  per core, the arrays that are traversed by all the threads are
+  partitioned statically with getThreadRange(). Arrays that are zeroed
+  with zeroArray() are first touched using the same partition so that
+  the memory pages are placed close to the threads that use them. The
+  number of threads should therefore be set before the vectors and
+  matrices are created.
 */
 class TACSThreadInfo : public TACSObject {
  public:
-  static const int TACS_MAX_NUM_THREADS = 16;
+  static const int TACS_MAX_NUM_THREADS = 64;
 
   TACSThreadInfo( int _num_threads );
   ~TACSThreadInfo(){}
@@ -189,8 +198,77 @@ class TACSThreadInfo : public TACSObject {
   void setNumThreads( int _num_threads );
   int getNumThreads();
 
+  // Static partition of an array and the threaded first touch
+  // ---------------------------------------------------------
+  static void getThreadRange( int thread, int num_threads, int size,
+                              int *start, int *end );
+  static void zeroArray( int num_threads, TacsScalar *array, int size );
+
  private:
   int num_threads;  
 };
 
+/*
+  Allocate and free memory aligned on TACS_MEMORY_ALIGNMENT bytes. The
+  alignment is a multiple of the cache line size and the SIMD register
+  width. Memory from TacsAlignedAlloc() must be freed with
+  TacsAlignedFree(), not delete or free().
+*/
+static const int TACS_MEMORY_ALIGNMENT = 64;
+void *TacsAlignedAlloc( size_t bytes );
+void TacsAlignedFree( void *ptr );
+
+/*!
+  A pool of aligned arrays that are reused instead of returned to the
+  system.
+
+  Each array is preceded by a header of TACS_MEMORY_ALIGNMENT bytes
+  that records its length. The length is rounded up to a multiple of
+  the alignment. When an array is released it is placed on a free
+  list, and the next request for an array of the same length takes it
+  from the list. The vectors created with the same TACSVarMap and
+  block size therefore reuse the same memory, and the temporary
+  vectors or scratch space allocated during repeated solves do not
+  go back to the system allocator.
+
+  The contents of an array from allocate() are not initialized. The
+  cached arrays are only freed by freeCachedMemory() or when the pool
+  is deleted. Arrays are only reused for requests of the same rounded
+  length, so the pool keeps, for each distinct length, the largest
+  number of arrays of that length that were in use at one time. Code
+  that allocates many different lengths should call
+  freeCachedMemory() to release them. The pool is thread-safe.
+*/
+class TACSMemoryPool : public TACSObject {
+ public:
+  TACSMemoryPool();
+  ~TACSMemoryPool();
+
+  // Get an array from the pool and return it to the pool
+  // ----------------------------------------------------
+  void *allocate( size_t bytes );
+  void release( void *ptr );
+
+  // Free the cached arrays and retrieve the memory usage
+  // ----------------------------------------------------
+  void freeCachedMemory();
+  void getMemoryUsage( size_t *in_use, size_t *cached,
+                       int *_num_allocs=NULL, int *_num_reuses=NULL );
+
+ private:
+  // The header stored before each array
+  class PoolHeader {
+   public:
+    size_t bytes;
+    PoolHeader *next;
+  };
+
+  pthread_mutex_t mutex;  // Lock for the free list and counters
+  PoolHeader *free_list;  // The list of cached arrays
+  size_t in_use_bytes;    // The memory currently allocated from the pool
+  size_t cached_bytes;    // The memory on the free list
+  int num_allocs;         // The number of arrays from the system
+  int num_reuses;         // The number of arrays from the free list
+};
+
 #endif
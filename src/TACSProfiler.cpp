@@ -0,0 +1,318 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2014 Georgia Tech Research Corporation
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#include "TACSProfiler.h"
+
+/*
+  The names of the events and counters used in the report and trace
+*/
+static const char *tacs_event_names[] = {
+  "assembleRes",
+  "assembleJacobian",
+  "assembleMatType",
+  "evalFunctions",
+  "evalSensitivities",
+  "vecScatter",
+  "matMult",
+  "matFactor",
+  "matApplyFactor",
+  "denseFactor",
+  "denseApplyFactor",
+  "ksmSolve",
+  "integratorAssembly",
+  "integratorFactor",
+  "integratorSolve"};
+
+static const char *tacs_counter_names[] = {
+  "flops", "bytes", "messages", "elements"};
+
+// The maximum depth of nested events
+static const int TACS_PROFILE_MAX_DEPTH = 32;
+
+// The accumulated data for each event
+static int event_calls[TACSProfiler::NUM_EVENTS];
+static double event_time[TACSProfiler::NUM_EVENTS];
+static double event_counts[TACSProfiler::NUM_EVENTS*TACSProfiler::NUM_COUNTERS];
+
+// The stack of active events and their start times
+static int stack_depth = 0;
+static int stack_event[TACS_PROFILE_MAX_DEPTH];
+static double stack_start[TACS_PROFILE_MAX_DEPTH];
+
+// The origin of the time stamps
+static double time_origin = 0.0;
+
+// The trace records: the event, start and end time of each interval
+static int trace_flag = 0;
+static int max_trace_records = 0;
+static int num_trace_records = 0;
+static int *trace_event = NULL;
+static double *trace_times = NULL;
+
+int TACSProfiler::enabled = 0;
+
+/*
+  Enable or disable the profiler. The data is reset when the profiler
+  is enabled.
+*/
+void TACSProfiler::setEnabled( int flag ){
+  if (flag && !enabled){
+    reset();
+  }
+  enabled = flag;
+}
+
+/*
+  Set whether to record the trace of each event interval
+
+  input:
+  flag:         flag to indicate whether to record the trace
+  max_records:  the maximum number of intervals to record
+*/
+void TACSProfiler::setTrace( int flag, int max_records ){
+  trace_flag = flag;
+  if (trace_event){ delete [] trace_event; }
+  if (trace_times){ delete [] trace_times; }
+  trace_event = NULL;
+  trace_times = NULL;
+  max_trace_records = 0;
+  num_trace_records = 0;
+
+  if (flag && max_records > 0){
+    max_trace_records = max_records;
+    trace_event = new int[ max_trace_records ];
+    trace_times = new double[ 2*max_trace_records ];
+  }
+}
+
+/*
+  Zero the accumulated data and the trace
+*/
+void TACSProfiler::reset(){
+  memset(event_calls, 0, NUM_EVENTS*sizeof(int));
+  memset(event_time, 0, NUM_EVENTS*sizeof(double));
+  memset(event_counts, 0, NUM_EVENTS*NUM_COUNTERS*sizeof(double));
+  stack_depth = 0;
+  num_trace_records = 0;
+  time_origin = MPI_Wtime();
+}
+
+/*
+  Push the event onto the stack of active events
+*/
+void TACSProfiler::beginEvent( EventType event ){
+  if (stack_depth < TACS_PROFILE_MAX_DEPTH){
+    stack_event[stack_depth] = event;
+    stack_start[stack_depth] = MPI_Wtime();
+  }
+  stack_depth++;
+}
+
+/*
+  Pop the event from the stack and add the elapsed time. Events that
+  were begun before the profiler was enabled are ignored.
+*/
+void TACSProfiler::endEvent( EventType event ){
+  if (stack_depth <= 0){
+    return;
+  }
+  stack_depth--;
+  if (stack_depth >= TACS_PROFILE_MAX_DEPTH ||
+      stack_event[stack_depth] != event){
+    return;
+  }
+
+  double t = MPI_Wtime();
+  event_calls[event]++;
+  event_time[event] += t - stack_start[stack_depth];
+
+  if (trace_flag && num_trace_records < max_trace_records){
+    int n = num_trace_records;
+    trace_event[n] = event;
+    trace_times[2*n] = stack_start[stack_depth] - time_origin;
+    trace_times[2*n+1] = t - time_origin;
+    num_trace_records++;
+  }
+}
+
+/*
+  Add the value to the counter of the innermost active event
+*/
+void TACSProfiler::addCounter( CounterType counter, double value ){
+  if (stack_depth > 0 && stack_depth <= TACS_PROFILE_MAX_DEPTH){
+    int event = stack_event[stack_depth-1];
+    event_counts[NUM_COUNTERS*event + counter] += value;
+  }
+}
+
+/*
+  Get the name of the event
+*/
+const char *TACSProfiler::getEventName( EventType event ){
+  if (event >= 0 && event < NUM_EVENTS){
+    return tacs_event_names[event];
+  }
+  return NULL;
+}
+
+/*
+  Retrieve the data for the event from this processor
+
+  output:
+  calls:   the number of calls
+  time:    the accumulated wall time
+  counts:  (optional) the value of each of the counters
+*/
+void TACSProfiler::getEventData( EventType event, int *calls,
+                                 double *time, double counts[] ){
+  if (event >= 0 && event < NUM_EVENTS){
+    if (calls){ *calls = event_calls[event]; }
+    if (time){ *time = event_time[event]; }
+    if (counts){
+      memcpy(counts, &event_counts[NUM_COUNTERS*event],
+             NUM_COUNTERS*sizeof(double));
+    }
+  }
+}
+
+/*
+  Print the min/avg/max of the event data over all processors.
+
+  This call is collective on the communicator and the report is
+  printed on the root processor only.
+*/
+void TACSProfiler::printReport( MPI_Comm comm, FILE *fp ){
+  int rank, size;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
+
+  // Collect the calls, time and counters for each event
+  const int nvals = 2 + NUM_COUNTERS;
+  double local[NUM_EVENTS*nvals];
+  for ( int i = 0; i < NUM_EVENTS; i++ ){
+    local[nvals*i] = event_calls[i];
+    local[nvals*i+1] = event_time[i];
+    for ( int j = 0; j < NUM_COUNTERS; j++ ){
+      local[nvals*i+2+j] = event_counts[NUM_COUNTERS*i + j];
+    }
+  }
+
+  double vmin[NUM_EVENTS*nvals];
+  double vmax[NUM_EVENTS*nvals];
+  double vsum[NUM_EVENTS*nvals];
+  MPI_Reduce(local, vmin, NUM_EVENTS*nvals, MPI_DOUBLE, MPI_MIN, 0, comm);
+  MPI_Reduce(local, vmax, NUM_EVENTS*nvals, MPI_DOUBLE, MPI_MAX, 0, comm);
+  MPI_Reduce(local, vsum, NUM_EVENTS*nvals, MPI_DOUBLE, MPI_SUM, 0, comm);
+
+  if (rank == 0 && fp){
+    fprintf(fp, "TACSProfiler: %d processors\n", size);
+    fprintf(fp, "%-20s %10s %12s %12s %12s %8s\n",
+            "event", "calls", "min time", "avg time", "max time",
+            "max/avg");
+    for ( int i = 0; i < NUM_EVENTS; i++ ){
+      if (vmax[nvals*i] > 0.0){
+        double avg = vsum[nvals*i+1]/size;
+        fprintf(fp, "%-20s %10.0f %12.4e %12.4e %12.4e %8.3f\n",
+                tacs_event_names[i], vsum[nvals*i]/size,
+                vmin[nvals*i+1], avg, vmax[nvals*i+1],
+                (avg > 0.0 ? vmax[nvals*i+1]/avg : 1.0));
+      }
+    }
+
+    fprintf(fp, "\n%-20s %-10s %12s %12s %12s %12s\n",
+            "event", "counter", "min", "avg", "max", "total");
+    for ( int i = 0; i < NUM_EVENTS; i++ ){
+      for ( int j = 0; j < NUM_COUNTERS; j++ ){
+        int k = nvals*i+2+j;
+        if (vmax[k] > 0.0){
+          fprintf(fp, "%-20s %-10s %12.4e %12.4e %12.4e %12.4e\n",
+                  tacs_event_names[i], tacs_counter_names[j],
+                  vmin[k], vsum[k]/size, vmax[k], vsum[k]);
+        }
+      }
+    }
+  }
+}
+
+/*
+  Write the recorded trace in the Chrome trace-event JSON format.
+
+  The records from each processor are gathered to the root processor
+  which writes the file. This call is collective on the communicator.
+
+  returns: zero on success, one if the file could not be opened
+*/
+int TACSProfiler::writeTrace( MPI_Comm comm, const char *filename ){
+  int rank, size;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
+
+  // Print the records from this processor into a buffer
+  const int max_line_len = 160;
+  int max_len = max_line_len*(num_trace_records+1);
+  char *buffer = new char[ max_len ];
+  int len = sprintf(buffer,
+                    "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,"
+                    "\"args\":{\"name\":\"rank %d\"}}", rank, rank);
+  for ( int i = 0; i < num_trace_records; i++ ){
+    len += sprintf(&buffer[len],
+                   ",\n{\"name\":\"%s\",\"cat\":\"tacs\",\"ph\":\"X\","
+                   "\"pid\":%d,\"tid\":0,\"ts\":%.3f,\"dur\":%.3f}",
+                   tacs_event_names[trace_event[i]], rank,
+                   1e6*trace_times[2*i],
+                   1e6*(trace_times[2*i+1] - trace_times[2*i]));
+  }
+
+  // Gather the buffers to the root processor
+  int *lens = NULL, *ptr = NULL;
+  char *all = NULL;
+  if (rank == 0){
+    lens = new int[ size ];
+    ptr = new int[ size+1 ];
+  }
+  MPI_Gather(&len, 1, MPI_INT, lens, 1, MPI_INT, 0, comm);
+  if (rank == 0){
+    ptr[0] = 0;
+    for ( int k = 0; k < size; k++ ){
+      ptr[k+1] = ptr[k] + lens[k];
+    }
+    all = new char[ ptr[size] ];
+  }
+  MPI_Gatherv(buffer, len, MPI_CHAR, all, lens, ptr, MPI_CHAR, 0, comm);
+  delete [] buffer;
+
+  int fail = 0;
+  if (rank == 0){
+    FILE *fp = fopen(filename, "w");
+    if (fp){
+      fprintf(fp, "{\"traceEvents\":[\n");
+      for ( int k = 0; k < size; k++ ){
+        fwrite(&all[ptr[k]], 1, lens[k], fp);
+        fprintf(fp, (k < size-1 ? ",\n" : "\n"));
+      }
+      fprintf(fp, "],\n\"displayTimeUnit\":\"ms\"}\n");
+      fclose(fp);
+    }
+    else {
+      fprintf(stderr, "TACSProfiler: Could not open file %s\n", filename);
+      fail = 1;
+    }
+    delete [] lens;
+    delete [] ptr;
+    delete [] all;
+  }
+
+  MPI_Bcast(&fail, 1, MPI_INT, 0, comm);
+  return fail;
+}
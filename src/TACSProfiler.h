@@ -0,0 +1,123 @@
+/*
+  This file is part of TACS: The Toolkit for the Analysis of Composite
+  Structures, a parallel finite-element code for structural and
+  multidisciplinary design optimization.
+
+  Copyright (C) 2014 Georgia Tech Research Corporation
+
+  TACS is licensed under the Apache License, Version 2.0 (the
+  "License"); you may not use this software except in compliance with
+  the License.  You may obtain a copy of the License at
+
+  http://www.apache.org/licenses/LICENSE-2.0
+*/
+
+#ifndef TACS_PROFILER_H
+#define TACS_PROFILER_H
+
+#include "TACSObject.h"
+
+/*
+  Instrumentation of the main computational phases within TACS.
+
+  Each phase is recorded as an event with the accumulated wall time
+  and the number of calls. Events may be nested, in which case the
+  time for the outer event includes the time of the inner events.
+  Counters for the floating point operations, bytes moved, messages
+  sent and element calls are added to the innermost active event.
+
+  Profiling is disabled by default. When it is disabled, the cost of
+  each event is a test of a static flag. The event data is collected
+  without locks, so events must only be recorded from the main thread
+  (not from within the pthread workers).
+
+  The per-event data is reduced across all processors with
+  printReport(), which reports the min/avg/max over the ranks. When
+  tracing is active, each event interval is also recorded and can be
+  written in the Chrome trace-event JSON format with writeTrace(). The
+  file can be loaded in chrome://tracing or Perfetto, with one process
+  per rank. The time stamps are relative to the last call to reset()
+  on each processor.
+*/
+class TACSProfiler {
+ public:
+  enum EventType { ASSEMBLE_RES,
+                   ASSEMBLE_JACOBIAN,
+                   ASSEMBLE_MAT_TYPE,
+                   EVAL_FUNCTIONS,
+                   EVAL_SENSITIVITIES,
+                   VEC_SCATTER,
+                   MAT_MULT,
+                   MAT_FACTOR,
+                   MAT_APPLY_FACTOR,
+                   DENSE_FACTOR,
+                   DENSE_APPLY_FACTOR,
+                   KSM_SOLVE,
+                   INTEGRATOR_ASSEMBLY,
+                   INTEGRATOR_FACTOR,
+                   INTEGRATOR_SOLVE,
+                   NUM_EVENTS };
+  enum CounterType { FLOP_COUNT,
+                     BYTE_COUNT,
+                     MESSAGE_COUNT,
+                     ELEMENT_COUNT,
+                     NUM_COUNTERS };
+
+  // Enable/disable the profiler and the recording of the trace
+  // ----------------------------------------------------------
+  static void setEnabled( int flag );
+  static void setTrace( int flag, int max_records=1000000 );
+  static int isEnabled(){ return enabled; }
+  static void reset();
+
+  // Record the beginning/end of an event and add to a counter
+  // ---------------------------------------------------------
+  static inline void begin( EventType event ){
+    if (enabled){ beginEvent(event); }
+  }
+  static inline void end( EventType event ){
+    if (enabled){ endEvent(event); }
+  }
+  static inline void addCount( CounterType counter, double value ){
+    if (enabled){ addCounter(counter, value); }
+  }
+
+  // Retrieve the data from this processor
+  // -------------------------------------
+  static const char *getEventName( EventType event );
+  static void getEventData( EventType event, int *calls, double *time,
+                            double counts[]=NULL );
+
+  // Report the reduced data and write the trace
+  // -------------------------------------------
+  static void printReport( MPI_Comm comm, FILE *fp=stdout );
+  static int writeTrace( MPI_Comm comm, const char *filename );
+
+ private:
+  static void beginEvent( EventType event );
+  static void endEvent( EventType event );
+  static void addCounter( CounterType counter, double value );
+
+  // Flag to indicate whether the profiler is active
+  static int enabled;
+};
+
+/*
+  Record an event for the lifetime of the timer object. This ensures
+  that the event is ended on every return path.
+*/
+class TACSProfileTimer {
+ public:
+  TACSProfileTimer( TACSProfiler::EventType _event ){
+    event = _event;
+    TACSProfiler::begin(event);
+  }
+  ~TACSProfileTimer(){
+    TACSProfiler::end(event);
+  }
+
+ private:
+  TACSProfiler::EventType event;
+};
+
+#endif // TACS_PROFILER_H
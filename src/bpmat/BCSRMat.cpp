@@ -22,11 +22,32 @@
 #include "MatUtils.h"
 #include "FElibrary.h"
 #include "tacslapack.h"
+#include "TACSProfiler.h"
 
 /*
   BCSR matrix implementation
 */
 
+/*
+  The minimum number of matrix entries zeroed by each thread
+*/
+static const int BCSR_MAT_ZERO_MIN_SIZE = 32768;
+
+/*
+  Zero the values of the matrix with the threads. The entries are split
+  into contiguous, equal ranges for each thread. Note that the threaded
+  matrix kernels schedule groups of rows dynamically, so this does not
+  place the pages near the threads that later use them.
+*/
+static void BCSRMatZeroValues( TACSThreadInfo *thread_info,
+                               TacsScalar *A, int length ){
+  int num_threads = thread_info->getNumThreads();
+  if (num_threads > length/BCSR_MAT_ZERO_MIN_SIZE){
+    num_threads = length/BCSR_MAT_ZERO_MIN_SIZE;
+  }
+  TACSThreadInfo::zeroArray(num_threads, A, length);
+}
+
 /*
   Merge two uniquely sorted arrays with levels associated with them. 
 
@@ -159,7 +180,7 @@ BCSRMat::BCSRMat( MPI_Comm _comm, BCSRMat *mat,
   length *= bsize*bsize;
 
   data->A = new TacsScalar[ length ];
-  memset(data->A, 0, length*sizeof(TacsScalar));
+  BCSRMatZeroValues(thread_info, data->A, length);
 
   // Go through and print out the nz-pattern of the matrix
   if (fname != NULL){
@@ -224,7 +245,7 @@ BCSRMat::BCSRMat( MPI_Comm _comm, TACSThreadInfo *_thread_info,
   // Find the size of the array
   int length = bsize*bsize*data->rowp[nrows];
   data->A = new TacsScalar[ length ];
-  memset(data->A, 0, length*sizeof(TacsScalar));
+  BCSRMatZeroValues(thread_info, data->A, length);
 }
 
 /*!
@@ -293,7 +314,7 @@ BCSRMat::BCSRMat( MPI_Comm _comm,
   int length = data->rowp[data->nrows];
   length *= bsize*bsize;
   data->A = new TacsScalar[ length ];
-  memset(data->A, 0, length*sizeof(TacsScalar));
+  BCSRMatZeroValues(thread_info, data->A, length);
 }
 
 /*!
@@ -445,7 +466,7 @@ must agree ncol(A) != nrow(B)\n");
   length *= bsize*bsize;
 
   data->A = new TacsScalar[ length ];
-  memset(data->A, 0, length*sizeof(TacsScalar));
+  BCSRMatZeroValues(thread_info, data->A, length);
 }
 
 /*
@@ -577,7 +598,7 @@ BCSRMat::BCSRMat( MPI_Comm _comm, BCSRMat *B, double fill ){
   length *= bsize*bsize;
 
   data->A = new TacsScalar[ length ];
-  memset(data->A, 0, length*sizeof(TacsScalar));
+  BCSRMatZeroValues(thread_info, data->A, length);
 }
 
 BCSRMat::~BCSRMat(){
@@ -1140,12 +1161,30 @@ void BCSRMat::initBlockImpl(){
 // Functions related to solving the system of equations
 // ----------------------------------------------------
 
+/*
+  Add the flops and bytes for a single pass through the non-zero
+  blocks of the matrix to the profiler counters
+*/
+static void add_profile_counts( BCSRMatData *data ){
+  if (TACSProfiler::isEnabled()){
+    double nnz = data->rowp[data->nrows];
+    double b = data->bsize;
+    double vec_size = (data->nrows + data->ncols)*b;
+    TACSProfiler::addCount(TACSProfiler::FLOP_COUNT, 2.0*nnz*b*b);
+    TACSProfiler::addCount(TACSProfiler::BYTE_COUNT,
+                           nnz*(b*b*sizeof(TacsScalar) + sizeof(int)) +
+                           vec_size*sizeof(TacsScalar));
+  }
+}
+
 /*!  
   Perform an ILU factorization of the matrix using the existing
   non-zero pattern. The entries are over-written, all operations are
   performed in place.
 */
 void BCSRMat::factor(){
+  TACSProfileTimer timer(TACSProfiler::MAT_FACTOR);
+
   if (!data->diag){
     setUpDiag();
   }
@@ -1180,10 +1219,42 @@ void BCSRMat::factor(){
   }
 }
 
+/*!
+  Count the number of negative eigenvalues of the factored matrix.
+
+  This must be called after factor(). When the factorization is
+  complete and the matrix is symmetric, the factorization is
+  equivalent to a block LDL^{T} factorization. By Sylvester's law of
+  inertia, the number of negative eigenvalues of the matrix is equal
+  to the number of negative eigenvalues of the diagonal blocks. Note
+  that the diagonal blocks are stored in inverted form, which does not
+  change their inertia. The result is only meaningful when the
+  factorization is exact (no dropped fill-in).
+*/
+int BCSRMat::getNumNegEigs(){
+  const int nrows = data->nrows;
+  const int bsize = data->bsize;
+  const int b2 = bsize*bsize;
+  const int *diag = data->diag;
+  const TacsScalar *A = data->A;
+
+  int nneg = 0;
+  if (diag){
+    for ( int i = 0; i < nrows; i++ ){
+      nneg += matutils::CountNegativeEigs(bsize, &A[b2*diag[i]]);
+    }
+  }
+
+  return nneg;
+}
+
 /*!
   Compute y = A*x
 */
 void BCSRMat::mult( TacsScalar *xvec, TacsScalar *yvec ){
+  TACSProfileTimer timer(TACSProfiler::MAT_MULT);
+  add_profile_counts(data);
+
   if (bmultadd_thread && thread_info->getNumThreads() > 1){
     // If not allocated, allocate the threaded data
     if (!tdata){
@@ -1224,6 +1295,9 @@ void BCSRMat::mult( TacsScalar *xvec, TacsScalar *yvec ){
 */
 void BCSRMat::multAdd( TacsScalar *xvec, TacsScalar *zvec, 
                        TacsScalar *yvec ){
+  TACSProfileTimer timer(TACSProfiler::MAT_MULT);
+  add_profile_counts(data);
+
   if (bmultadd_thread && thread_info->getNumThreads() > 1){
     // If not allocated, allocate the threaded data
     if (!tdata){
@@ -1267,6 +1341,9 @@ void BCSRMat::multAdd( TacsScalar *xvec, TacsScalar *zvec,
   Compute y = A^{T}*x
 */
 void BCSRMat::multTranspose( TacsScalar *xvec, TacsScalar *yvec ){
+  TACSProfileTimer timer(TACSProfiler::MAT_MULT);
+  add_profile_counts(data);
+
   memset(yvec, 0, data->bsize*data->ncols*sizeof(TacsScalar));
   bmulttrans(data, xvec, yvec);
 }
@@ -1279,6 +1356,9 @@ void BCSRMat::multTranspose( TacsScalar *xvec, TacsScalar *yvec ){
   y = U^{-1} L^{-1} x
 */
 void BCSRMat::applyFactor( TacsScalar *xvec, TacsScalar *yvec ){
+  TACSProfileTimer timer(TACSProfiler::MAT_APPLY_FACTOR);
+  add_profile_counts(data);
+
   if (!data->diag){
     fprintf(stderr, "BCSRMat applyFactor error: matrix not factored\n");
   }
@@ -1345,6 +1425,9 @@ void BCSRMat::applyFactor( TacsScalar *xvec, TacsScalar *yvec ){
   x = U^{-1} L^{-1} x 
 */
 void BCSRMat::applyFactor( TacsScalar *xvec ){
+  TACSProfileTimer timer(TACSProfiler::MAT_APPLY_FACTOR);
+  add_profile_counts(data);
+
     if (!data->diag){
       fprintf(stderr, "BCSRMat applyFactor error: matrix not factored\n");
   }
@@ -1557,6 +1640,120 @@ void BCSRMat::applySOR( BCSRMat *B, int start, int end,
   }
 }
 
+/*
+  The number of rows in the list taken by each thread at a time when
+  applying SOR to a list of independent rows
+*/
+static const int BCSR_MAT_SOR_GROUP_SIZE = 32;
+
+/*
+  The thread function for SOR applied to a list of rows. The rows
+  are independent, so each thread takes the next group of rows and
+  applies the block-specific SOR update to each row in turn.
+*/
+static void *BCSRMatApplyListSOR_thread( void *t ){
+  BCSRMatThread *tdata = static_cast<BCSRMatThread*>(t);
+  const int nrows = tdata->sor_nrows;
+  const int *rows = tdata->sor_rows;
+  const int group_size = BCSR_MAT_SOR_GROUP_SIZE;
+
+  while (tdata->num_completed_rows < nrows){
+    int index = -1;
+    tdata->mat_mult_sched_job_size(group_size, &index, nrows);
+
+    if (index >= 0){
+      for ( int ii = index; ii < nrows && ii < index + group_size; ii++ ){
+        int i = rows[ii];
+        tdata->applysor(tdata->mat, tdata->Bmat, i, i+1,
+                        tdata->sor_var_offset, tdata->sor_Adiag,
+                        tdata->sor_omega, tdata->sor_b,
+                        tdata->sor_xext, (TacsScalar*)tdata->output);
+      }
+    }
+  }
+
+  pthread_exit(NULL);
+}
+
+/*!
+  Apply SOR to the rows of the matrix in the given list.
+
+  The rows in the list must not be coupled to one another through the
+  matrix, for instance the rows of a single color in a multicolor
+  ordering. The result is then independent of the order in which the
+  rows are updated, and the rows are updated in parallel when more
+  than one thread is available.
+*/
+void BCSRMat::applySOR( BCSRMat *B, int nrows, const int *rows,
+                        int var_offset, TacsScalar omega, 
+                        const TacsScalar *b, const TacsScalar *xext, 
+                        TacsScalar *x ){
+  if (!Adiag){
+    fprintf(stderr, "Cannot apply SOR: diagonal has not been factored\n");
+    return;
+  }
+
+  BCSRMatData *Bdata = NULL;
+  if (B){
+    Bdata = B->data;
+  }
+
+  int num_threads = thread_info->getNumThreads();
+  if (num_threads > nrows/BCSR_MAT_SOR_GROUP_SIZE){
+    num_threads = nrows/BCSR_MAT_SOR_GROUP_SIZE;
+  }
+
+  if (num_threads > 1){
+    // If not allocated, allocate the threaded data
+    if (!tdata){
+      tdata = new BCSRMatThread(data);
+      tdata->incref();
+    }
+
+    // Set the data for the SOR update
+    tdata->init_mat_mult_sched();
+    tdata->applysor = applysor;
+    tdata->Bmat = Bdata;
+    tdata->output = x;
+    tdata->sor_nrows = nrows;
+    tdata->sor_rows = rows;
+    tdata->sor_var_offset = var_offset;
+    tdata->sor_Adiag = Adiag;
+    tdata->sor_omega = omega;
+    tdata->sor_b = b;
+    tdata->sor_xext = xext;
+
+    // Create the joinable attribute
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
+
+    // Go through and run the threads
+    for ( int k = 0; k < num_threads; k++ ){
+      pthread_create(&tdata->threads[k], &attr,
+                     BCSRMatApplyListSOR_thread, (void*)tdata);
+    }
+
+    // Destroy the attribute and join all the threads
+    pthread_attr_destroy(&attr);
+    for ( int k = 0; k < num_threads; k++ ){
+      pthread_join(tdata->threads[k], NULL);
+    }
+
+    tdata->Bmat = NULL;
+    tdata->output = NULL;
+    tdata->sor_rows = NULL;
+    tdata->sor_Adiag = tdata->sor_b = tdata->sor_xext = NULL;
+  }
+  else {
+    for ( int ii = 0; ii < nrows; ii++ ){
+      int i = rows[ii];
+      applysor(data, Bdata, i, i+1, var_offset,
+               Adiag, omega, b, xext, x);
+    }
+  }
+}
+
 /*!
   Compute the matrix-matrix product. 
   
@@ -1737,7 +1934,7 @@ void BCSRMat::zeroEntries(){
   int length = data->rowp[data->nrows];
   length *= bsize*bsize;
 
-  memset(data->A, 0, length*sizeof(TacsScalar));
+  BCSRMatZeroValues(thread_info, data->A, length);
 }
 
 /*!
@@ -1941,6 +2138,93 @@ void BCSRMat::addRowWeightValues( TacsScalar alpha, int row,
   }
 }
 
+/*!
+  Find the index of the (row, col) block within the array of values.
+
+  This is used to pre-compute the destination of element matrix
+  entries so that repeated assembly does not require a search.
+
+  returns: the block index such that the entries are stored in
+  A[b2*index], or -1 if the entry is not in the non-zero pattern
+*/
+int BCSRMat::findBlock( int row, int col ){
+  if (row >= 0 && row < data->nrows &&
+      col >= 0 && col < data->ncols){
+    const int *rowp = data->rowp;
+    const int *cols = data->cols;
+    int row_size = rowp[row+1] - rowp[row];
+    const int *col_array = &cols[rowp[row]];
+
+    int *item = (int*)bsearch(&col, col_array, row_size,
+                              sizeof(int), FElibrary::comparator);
+    if (item){
+      return item - cols;
+    }
+  }
+  return -1;
+}
+
+/*!
+  Add the blocks of a dense element matrix using a pre-computed
+  assembly map.
+
+  The assembly map contains one entry for each (i, j) block in the
+  element matrix, stored row-wise. Each entry encodes both the
+  destination array and the block index within that array as 
+  4*index + dest, where A[dest] is the array of values. Negative
+  entries are skipped.
+
+  input:
+  bsize:    the block size
+  nnodes:   the number of block rows/columns in the element matrix
+  emap:     the assembly map for the element
+  A:        the destination arrays of values (at most four)
+  nv:       the number of columns in the element matrix
+  values:   the dense element matrix
+  matOr:    the orientation of the element matrix
+*/
+void BCSRMat::addElementBlocks( int bsize, int nnodes, const int *emap,
+                                TacsScalar *A[], int nv,
+                                const TacsScalar *values,
+                                MatrixOrientation matOr ){
+  const int b2 = bsize*bsize;
+
+  if (matOr == NORMAL){
+    for ( int i = 0; i < nnodes; i++ ){
+      for ( int j = 0; j < nnodes; j++, emap++ ){
+        if (emap[0] >= 0){
+          TacsScalar *a = &A[emap[0] & 3][b2*(emap[0] >> 2)];
+          const TacsScalar *v = &values[nv*bsize*i + bsize*j];
+
+          for ( int ii = 0; ii < bsize; ii++, v += nv ){
+            for ( int jj = 0; jj < bsize; jj++ ){
+              a[jj] += v[jj];
+            }
+            a += bsize;
+          }
+        }
+      }
+    }
+  }
+  else {
+    for ( int i = 0; i < nnodes; i++ ){
+      for ( int j = 0; j < nnodes; j++, emap++ ){
+        if (emap[0] >= 0){
+          TacsScalar *a = &A[emap[0] & 3][b2*(emap[0] >> 2)];
+          const TacsScalar *v = &values[nv*bsize*j + bsize*i];
+
+          for ( int ii = 0; ii < bsize; ii++ ){
+            for ( int jj = 0; jj < bsize; jj++ ){
+              a[jj] += v[nv*jj + ii];
+            }
+            a += bsize;
+          }
+        }
+      }
+    }
+  }
+}
+
 /*!
   Add values into the matrix row.  The values may only be added into
   parts of the matrix that have existing non-zero pattern. Trying to
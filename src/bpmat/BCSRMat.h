@@ -71,6 +71,11 @@ class BCSRMat : public TACSObject {
                            MatrixOrientation matOr=NORMAL );
   void addBlockRowValues( int row, int ncol, 
                           const int *col, const TacsScalar *a );
+  int findBlock( int row, int col );
+  static void addElementBlocks( int bsize, int nnodes, const int *emap,
+                                TacsScalar *A[], int nv,
+                                const TacsScalar *values,
+                                MatrixOrientation matOr=NORMAL );
   void zeroRow( int row, int vars, int ident=0 );
   void getArrays( int *_bsize, int *nrows, int *ncols, 
                   const int **rowp, const int **cols, TacsScalar **Avals );
@@ -85,6 +90,7 @@ class BCSRMat : public TACSObject {
   // Functions related to solving the system of equations
   // ----------------------------------------------------
   void factor();
+  int getNumNegEigs();
   void mult( TacsScalar *xvec, TacsScalar *yvec );
   void multAdd( TacsScalar *xvec, TacsScalar *zvec, TacsScalar *yvec );
   void multTranspose( TacsScalar *xvec, TacsScalar *yvec );
@@ -96,12 +102,16 @@ class BCSRMat : public TACSObject {
   void applyPartialUpper( TacsScalar *xvec, int var_offset );
   void applyFactorSchur( TacsScalar *x, int var_offset );
   void setDiagPairs( const int *_pairs, int _npairs );
+  void setUpDiag(); // Set up the diagonal entry pointer 'diag'
   void factorDiag( const TacsScalar *diag=NULL );
   void applySOR( TacsScalar *x, TacsScalar *y, 
                  TacsScalar omega, int iters );
   void applySOR( BCSRMat *B, int start, int end,
                  int var_offset, TacsScalar omega, 
                  const TacsScalar *b, const TacsScalar *xext, TacsScalar *x );
+  void applySOR( BCSRMat *B, int nrows, const int *rows,
+                 int var_offset, TacsScalar omega, 
+                 const TacsScalar *b, const TacsScalar *xext, TacsScalar *x );
                 
   void matMultAdd( double alpha, BCSRMat *amat, BCSRMat *bmat );
   void applyLowerFactor( BCSRMat *emat );
@@ -117,6 +127,8 @@ class BCSRMat : public TACSObject {
   int getRowDim(){ return data->nrows; }
   int getColDim(){ return data->ncols; }
   BCSRMatData* getMatData(){ return data; }
+  const TacsScalar* getDiagInverse(){ return Adiag; } // From factorDiag()
+  TACSThreadInfo* getThreadInfo(){ return thread_info; }
 
   // Extract the matrix in a  LAPACK format
   // --------------------------------------
@@ -140,7 +152,6 @@ class BCSRMat : public TACSObject {
   void initBlockImpl();
 
  private:
-  void setUpDiag(); // Set up the diagonal entry pointer 'diag'
   void computeILUk( BCSRMat *mat, int levFill, double fill, int **_levs );
   BCSRMat *computeILUkEpc( BCSRMat *EMat, const int *levs, 
                            int levFill, double fill, int **_elevs );
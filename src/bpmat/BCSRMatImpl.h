@@ -89,6 +89,17 @@ class BCSRMatThread : public TACSObject {
   BCSRMatData *Amat;
   BCSRMatData *Bmat; 
 
+  // Data required for SOR applied to a list of independent rows
+  void (*applysor)( BCSRMatData *Adata, BCSRMatData *Bdata,
+                    const int start, const int end,
+                    const int var_offset, const TacsScalar *Adiag,
+                    const TacsScalar omega, const TacsScalar *b, 
+                    const TacsScalar *xext, TacsScalar *x );
+  int sor_nrows, sor_var_offset;
+  const int *sor_rows;
+  const TacsScalar *sor_Adiag, *sor_b, *sor_xext;
+  TacsScalar sor_omega;
+
   // The number of completed rows in the implementation
   int num_completed_rows;
 
@@ -59,6 +59,12 @@ BCSRMatThread::BCSRMatThread( BCSRMatData *_mat ){
   Bmat = NULL;
   input = NULL;
   output = NULL;
+
+  applysor = NULL;
+  sor_nrows = sor_var_offset = 0;
+  sor_rows = NULL;
+  sor_Adiag = sor_b = sor_xext = NULL;
+  sor_omega = 0.0;
   
   int nrows = mat->nrows;
   
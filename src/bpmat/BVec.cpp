@@ -19,6 +19,7 @@
 #include "BVec.h"
 #include "FElibrary.h"
 #include "tacslapack.h"
+#include "pthread.h"
 
 /*
   Code for the block-vector basis class
@@ -44,9 +45,13 @@ TACSBVec::TACSBVec( TACSVarMap *map, int _bsize,
   bsize = _bsize;
   size = bsize*var_map->getDim();
 
-  // Allocate the array of owned unknowns
-  x = new TacsScalar[ size ];
-  memset(x, 0, size*sizeof(TacsScalar));
+  // Allocate the array of owned unknowns from the pool owned by the
+  // map. A new array is first touched here by the threads that
+  // operate on it. An array taken from the free list keeps the page
+  // placement of its previous owner.
+  TACSMemoryPool *pool = var_map->getMemoryPool();
+  x = (TacsScalar*)pool->allocate(size*sizeof(TacsScalar));
+  TACSThreadInfo::zeroArray(getNumOpThreads(), x, size);
 
   // Set the external data
   ext_dist = _ext_dist;
@@ -55,7 +60,7 @@ TACSBVec::TACSBVec( TACSVarMap *map, int _bsize,
     ext_indices = ext_dist->getIndices();
     ext_indices->incref();
     ext_size = bsize*ext_dist->getDim();
-    x_ext = new TacsScalar[ ext_size ];
+    x_ext = (TacsScalar*)pool->allocate(ext_size*sizeof(TacsScalar));
     memset(x_ext, 0, ext_size*sizeof(TacsScalar));
 
     // Create the communicator context
@@ -74,7 +79,7 @@ TACSBVec::TACSBVec( TACSVarMap *map, int _bsize,
   if (dep_nodes){
     dep_nodes->incref();
     dep_size = bsize*dep_nodes->getDepNodes(NULL, NULL, NULL);
-    x_dep = new TacsScalar[ dep_size ];
+    x_dep = (TacsScalar*)pool->allocate(dep_size*sizeof(TacsScalar));
     memset(x_dep, 0, dep_size*sizeof(TacsScalar));
   }
   else {
@@ -98,7 +103,7 @@ TACSBVec::TACSBVec( MPI_Comm _comm, int _size, int _bsize ){
   comm = _comm;
   var_map = NULL;
 
-  x = new TacsScalar[ size ];
+  x = (TacsScalar*)TacsAlignedAlloc(size*sizeof(TacsScalar));
   memset(x, 0, size*sizeof(TacsScalar));
 
   // Zero/NULL the external data
@@ -114,13 +119,20 @@ TACSBVec::TACSBVec( MPI_Comm _comm, int _size, int _bsize ){
 }
 
 TACSBVec::~TACSBVec(){
-  if (var_map){ var_map->decref(); }
-  if (x){ delete [] x; }
-  if (x_ext){ delete [] x_ext; }
+  if (var_map){
+    // Return the arrays to the pool before releasing the map
+    TACSMemoryPool *pool = var_map->getMemoryPool();
+    pool->release(x);
+    pool->release(x_ext);
+    pool->release(x_dep);
+    var_map->decref();
+  }
+  else {
+    TacsAlignedFree(x);
+  }
   if (ext_dist){ ext_dist->decref(); }
   if (ext_indices){ ext_indices->decref(); }
   if (ext_ctx){ ext_ctx->decref(); }
-  if (x_dep){ delete [] x_dep; }
   if (dep_nodes){ dep_nodes->decref(); }
 }
 
@@ -132,30 +144,270 @@ void TACSBVec::getSize( int *_size ){
 }
 
 /*
-  Compute the norm of the vector
+  The vector operations that are applied with applyOp()
 */
-TacsScalar TACSBVec::norm(){
-  // Compute the norm for each processor
-  TacsScalar res, sum;
+enum TACSBVecOpType { TACS_BVEC_ZERO,
+                      TACS_BVEC_SET,
+                      TACS_BVEC_SCALE,
+                      TACS_BVEC_NORM,
+                      TACS_BVEC_DOT,
+                      TACS_BVEC_AXPY,
+                      TACS_BVEC_AXPBY,
+                      TACS_BVEC_COPY };
+
+/*
+  The minimum number of entries operated on by each thread
+*/
+static const int TACS_BVEC_THREAD_MIN_SIZE = 32768;
+
+/*
+  The number of entries in each block of the multiple dot product. All
+  the dot products are accumulated over one block of x before moving
+  to the next, so that the block of x is only loaded once.
+*/
+static const int TACS_BVEC_DOT_BLOCK_SIZE = 1024;
+
+/*
+  The data passed to each thread for the vector operations
+*/
+class TACSBVecOpData {
+ public:
+  int thread, num_threads;
+  int op, size, nvecs;
+  TacsScalar alpha, beta;
+  TacsScalar *x;
+  TacsScalar **y;
+  TacsScalar *result;
+};
+
+/*
+  Compute the (unconjugated) dot product of two arrays
+*/
+static inline TacsScalar TACSBVecDot( int n, const TacsScalar *x,
+                                      const TacsScalar *y ){
 #if defined(TACS_USE_COMPLEX)
-  res = 0.0;
+  TacsScalar res = 0.0;
   int i = 0;
-  int rem = size%4;
-  TacsScalar *y = x;
+  int rem = n%4;
   for ( ; i < rem; i++ ){
-    res += y[0]*y[0];
-    y++;
+    res += x[0]*y[0];
+    x++; y++;
   }
 
-  for ( ; i < size; i += 4 ){
-    res += y[0]*y[0] + y[1]*y[1] + y[2]*y[2] + y[3]*y[3];
+  for ( ; i < n; i += 4 ){
+    res += x[0]*y[0] + x[1]*y[1] + x[2]*y[2] + x[3]*y[3];
+    x += 4;
     y += 4;
   }
+  return res;
 #else
   int one = 1;
-  res = BLASnrm2(&size, x, &one);
-  res *= res;
+  return BLASdot(&n, (TacsScalar*)x, &one, (TacsScalar*)y, &one);
+#endif
+}
+
+/*
+  Apply the operation to the entries [start, end) of the array. The
+  reductions are written to result[0,...,nvecs-1].
+*/
+static void TACSBVecApplyOp( TACSBVecOpData *data, int start, int end ){
+  int n = end - start;
+  int one = 1;
+  TacsScalar *x = &data->x[start];
+  TacsScalar alpha = data->alpha;
+
+  switch (data->op){
+  case TACS_BVEC_ZERO:
+    memset(x, 0, n*sizeof(TacsScalar));
+    break;
+  case TACS_BVEC_SET: {
+    int i = 0;
+    int rem = n % 4;
+    for ( ; i < rem; i++ ){
+      x[0] = alpha;
+      x++;
+    }
+    for ( ; i < n; i += 4 ){
+      x[0] = x[1] = x[2] = x[3] = alpha;
+      x += 4;
+    }
+  } break;
+  case TACS_BVEC_SCALE:
+    BLASscal(&n, &alpha, x, &one);
+    break;
+  case TACS_BVEC_NORM: {
+#if defined(TACS_USE_COMPLEX)
+    data->result[0] = TACSBVecDot(n, x, x);
+#else
+    TacsScalar res = BLASnrm2(&n, x, &one);
+    data->result[0] = res*res;
 #endif
+  } break;
+  case TACS_BVEC_DOT:
+    for ( int k = 0; k < data->nvecs; k++ ){
+      data->result[k] = 0.0;
+    }
+    for ( int i = 0; i < n; i += TACS_BVEC_DOT_BLOCK_SIZE ){
+      int nb = n - i;
+      if (nb > TACS_BVEC_DOT_BLOCK_SIZE){
+        nb = TACS_BVEC_DOT_BLOCK_SIZE;
+      }
+      for ( int k = 0; k < data->nvecs; k++ ){
+        if (data->y[k]){
+          data->result[k] += TACSBVecDot(nb, &x[i], &data->y[k][start+i]);
+        }
+      }
+    }
+    break;
+  case TACS_BVEC_AXPY:
+    BLASaxpy(&n, &alpha, &data->y[0][start], &one, x, &one);
+    break;
+  case TACS_BVEC_AXPBY: {
+    TacsScalar beta = data->beta;
+    TacsScalar *z = &data->y[0][start];
+    int i = 0;
+    int rem = n % 4;
+    for ( ; i < rem; i++ ){
+      x[0] = beta*x[0] + alpha*z[0];
+      x++; z++;
+    }
+    for ( ; i < n; i += 4 ){
+      x[0] = beta*x[0] + alpha*z[0];
+      x[1] = beta*x[1] + alpha*z[1];
+      x[2] = beta*x[2] + alpha*z[2];
+      x[3] = beta*x[3] + alpha*z[3];
+      x += 4;
+      z += 4;
+    }
+  } break;
+  case TACS_BVEC_COPY:
+    BLAScopy(&n, &data->y[0][start], &one, x, &one);
+    break;
+  default:
+    break;
+  }
+}
+
+static void *TACSBVecApplyOp_thread( void *t ){
+  TACSBVecOpData *data = static_cast<TACSBVecOpData*>(t);
+  int start, end;
+  TACSThreadInfo::getThreadRange(data->thread, data->num_threads,
+                                 data->size, &start, &end);
+  TACSBVecApplyOp(data, start, end);
+  pthread_exit(NULL);
+}
+
+/*
+  Get the number of threads used for the operations on this vector.
+
+  Each thread is assigned at least TACS_BVEC_THREAD_MIN_SIZE entries
+  so that the cost of creating the threads is amortized. The number
+  only depends on the size of the vector and the number of threads
+  so that the same static partition is used for the first touch and
+  the subsequent operations.
+*/
+int TACSBVec::getNumOpThreads(){
+  int num_threads = 1;
+  if (var_map && var_map->getThreadInfo()){
+    num_threads = var_map->getThreadInfo()->getNumThreads();
+    if (num_threads > size/TACS_BVEC_THREAD_MIN_SIZE){
+      num_threads = size/TACS_BVEC_THREAD_MIN_SIZE;
+    }
+    if (num_threads < 1){
+      num_threads = 1;
+    }
+  }
+  return num_threads;
+}
+
+/*
+  Apply the operation to the owned entries of the vector
+
+  The reductions from each thread are summed in the order of the
+  threads, so the result is reproducible for a fixed number of
+  threads.
+
+  input:
+  op:      the type of operation
+  alpha:   the first scalar argument
+  beta:    the second scalar argument
+  nvecs:   the number of vector arguments
+  y:       the arrays of the vector arguments
+
+  output:
+  result:  the reductions for each vector (if any)
+*/
+void TACSBVec::applyOp( int op, TacsScalar alpha, TacsScalar beta,
+                        int nvecs, TacsScalar **y, TacsScalar *result ){
+  int num_threads = getNumOpThreads();
+  int nres = (nvecs > 1 ? nvecs : 1);
+
+  if (num_threads <= 1){
+    TACSBVecOpData data;
+    data.thread = 0;
+    data.num_threads = 1;
+    data.op = op;
+    data.size = size;
+    data.nvecs = nvecs;
+    data.alpha = alpha;
+    data.beta = beta;
+    data.x = x;
+    data.y = y;
+    data.result = result;
+    TACSBVecApplyOp(&data, 0, size);
+    return;
+  }
+
+  pthread_t threads[TACSThreadInfo::TACS_MAX_NUM_THREADS];
+  TACSBVecOpData data[TACSThreadInfo::TACS_MAX_NUM_THREADS];
+  TacsScalar *partial = NULL;
+  if (result){
+    partial = new TacsScalar[ num_threads*nres ];
+  }
+
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
+
+  for ( int k = 0; k < num_threads; k++ ){
+    data[k].thread = k;
+    data[k].num_threads = num_threads;
+    data[k].op = op;
+    data[k].size = size;
+    data[k].nvecs = nvecs;
+    data[k].alpha = alpha;
+    data[k].beta = beta;
+    data[k].x = x;
+    data[k].y = y;
+    data[k].result = (partial ? &partial[k*nres] : NULL);
+    pthread_create(&threads[k], &attr,
+                   TACSBVecApplyOp_thread, (void*)&data[k]);
+  }
+
+  for ( int k = 0; k < num_threads; k++ ){
+    pthread_join(threads[k], NULL);
+  }
+
+  pthread_attr_destroy(&attr);
+
+  if (partial){
+    for ( int j = 0; j < nres; j++ ){
+      result[j] = 0.0;
+      for ( int k = 0; k < num_threads; k++ ){
+        result[j] += partial[k*nres + j];
+      }
+    }
+    delete [] partial;
+  }
+}
+
+/*
+  Compute the norm of the vector
+*/
+TacsScalar TACSBVec::norm(){
+  // Compute the norm for each processor
+  TacsScalar res, sum;
+  applyOp(TACS_BVEC_NORM, 0.0, 0.0, 0, NULL, &res);
   TacsAddFlops(2*size);
 
   MPI_Allreduce(&res, &sum, 1, TACS_MPI_TYPE, MPI_SUM, comm);
@@ -167,8 +419,7 @@ TacsScalar TACSBVec::norm(){
   Scale the vector by a scalar
 */
 void TACSBVec::scale( TacsScalar alpha ){
-  int one = 1;
-  BLASscal(&size, &alpha, x, &one);
+  applyOp(TACS_BVEC_SCALE, alpha, 0.0, 0, NULL, NULL);
   TacsAddFlops(size);
 }
 
@@ -185,26 +436,7 @@ TacsScalar TACSBVec::dot( TACSVec *tvec ){
     }
 
     TacsScalar res;
-#if defined(TACS_USE_COMPLEX)
-    res = 0.0;
-    int i = 0;
-    int rem = size%4;
-    TacsScalar *y = x;
-    TacsScalar *z = vec->x;
-    for ( ; i < rem; i++ ){
-      res += y[0]*z[0];
-      y++; z++;
-    }
-
-    for ( ; i < size; i += 4 ){
-      res += y[0]*z[0] + y[1]*z[1] + y[2]*z[2] + y[3]*z[3];
-      y += 4;
-      z += 4;
-    }
-#else
-    int one = 1;
-    res = BLASdot(&size, x, &one, vec->x, &one);
-#endif
+    applyOp(TACS_BVEC_DOT, 0.0, 0.0, 1, &vec->x, &res);
     MPI_Allreduce(&res, &sum, 1, TACS_MPI_TYPE, MPI_SUM, comm);
   }
   else {
@@ -219,11 +451,14 @@ TacsScalar TACSBVec::dot( TACSVec *tvec ){
 /*
   Compute multiple dot products. This is more efficient for parallel
   computations since there are fewer gather operations for the same
-  number of dot products.
+  number of dot products. Each thread accumulates all the dot products
+  over one block of its range at a time, so that the entries of this
+  vector are loaded from memory once for all the dot products.
 */
 void TACSBVec::mdot( TACSVec **tvec, TacsScalar *ans, int nvecs ){
+  TacsScalar **y = new TacsScalar*[ nvecs ];
   for ( int k = 0; k < nvecs; k++ ){
-    ans[k] = 0.0;
+    y[k] = NULL;
 
     TACSBVec *vec = dynamic_cast<TACSBVec*>(tvec[k]);
     if (vec){
@@ -232,35 +467,18 @@ void TACSBVec::mdot( TACSVec **tvec, TacsScalar *ans, int nvecs ){
                 "TACSBVec::dot Error, the sizes must be the same\n");
         continue;
       }
-
-#if defined(TACS_USE_COMPLEX)
-      TacsScalar res = 0.0;
-      int i = 0;
-      int rem = size % 4;
-      TacsScalar *y = x;
-      TacsScalar *z = vec->x;
-      for ( ; i < rem; i++ ){
-        res += y[0]*z[0];
-        y++; z++;
-      }
-
-      for ( ; i < size; i += 4 ){
-        res += y[0]*z[0] + y[1]*z[1] + y[2]*z[2] + y[3]*z[3];
-        y += 4;
-        z += 4;
-      }
-
-      ans[k] = res;
-#else
-      int one = 1;
-      ans[k] = BLASdot(&size, x, &one, vec->x, &one);
-#endif
+      y[k] = vec->x;
     }
     else {
       fprintf(stderr, "TACSBVec type error: Input must be TACSBVec\n");
     }
   }
 
+  if (nvecs > 0){
+    applyOp(TACS_BVEC_DOT, 0.0, 0.0, nvecs, y, ans);
+  }
+  delete [] y;
+
   TacsAddFlops(2*nvecs*size);
 
   MPI_Allreduce(MPI_IN_PLACE, ans, nvecs, TACS_MPI_TYPE, MPI_SUM, comm);
@@ -278,8 +496,7 @@ void TACSBVec::axpy( TacsScalar alpha, TACSVec *tvec ){
       return;
     }
 
-    int one = 1;
-    BLASaxpy(&size, &alpha, vec->x, &one, x, &one);
+    applyOp(TACS_BVEC_AXPY, alpha, 0.0, 1, &vec->x, NULL);
   }
   else {
     fprintf(stderr, "TACSBVec type error: Input must be TACSBVec\n");
@@ -300,24 +517,7 @@ void TACSBVec::axpby( TacsScalar alpha, TacsScalar beta, TACSVec *tvec ){
       return;
     }
 
-    int i = 0;
-    int rem = size % 4;
-    TacsScalar *y = x;
-    TacsScalar *z = vec->x;
-
-    for ( ; i < rem; i++ ){
-      y[0] = beta*y[0] + alpha*z[0];
-      y++; z++;
-    }
-
-    for ( ; i < size; i += 4 ){
-      y[0] = beta*y[0] + alpha*z[0];
-      y[1] = beta*y[1] + alpha*z[1];
-      y[2] = beta*y[2] + alpha*z[2];
-      y[3] = beta*y[3] + alpha*z[3];
-      y += 4;
-      z += 4;
-    }
+    applyOp(TACS_BVEC_AXPBY, alpha, beta, 1, &vec->x, NULL);
   }
   else {
     fprintf(stderr, "TACSBVec type error: Input must be TACSBVec\n");
@@ -339,11 +539,11 @@ void TACSBVec::copyValues( TACSVec *tvec ){
       return;
     }
 
-    int one = 1;
-    BLAScopy(&size, vec->x, &one, x, &one);
+    applyOp(TACS_BVEC_COPY, 0.0, 0.0, 1, &vec->x, NULL);
 
     // Copy the external nodes and dependent nodes only if this
     // vector and the source share the same objects
+    int one = 1;
     if (x_ext && vec->x_ext && ext_dist == vec->ext_dist){
       BLAScopy(&ext_size, vec->x_ext, &one, x_ext, &one);
     }
@@ -359,7 +559,7 @@ void TACSBVec::copyValues( TACSVec *tvec ){
   Zero all the entries in the vector
 */
 void TACSBVec::zeroEntries(){
-  memset(x, 0, size*sizeof(TacsScalar));
+  applyOp(TACS_BVEC_ZERO, 0.0, 0.0, 0, NULL, NULL);
 
   // Also zero the external and dependent nodes
   if (x_ext){
@@ -374,19 +574,7 @@ void TACSBVec::zeroEntries(){
   Set all the entries in the vector to val
 */
 void TACSBVec::set( TacsScalar val ){
-  int i = 0;
-  int rem = size % 4;
-  TacsScalar *y = x;
-
-  for ( ; i < rem; i++ ){
-    y[0] = val;
-    y++;
-  }
-
-  for ( ; i < size; i += 4 ){
-    y[0] = y[1] = y[2] = y[3] = val;
-    y += 4;
-  }
+  applyOp(TACS_BVEC_SET, val, 0.0, 0, NULL, NULL);
 }
 
 /*
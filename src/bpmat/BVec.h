@@ -178,6 +178,12 @@ class TACSBVec : public TACSVec {
   // Pointer to the dependent node data
   TACSBVecDepNodes *dep_nodes;
 
+  // Apply an operation to the owned entries using the threads from
+  // the variable map (if any) with a static partition of the array
+  int getNumOpThreads();
+  void applyOp( int op, TacsScalar alpha, TacsScalar beta,
+                int nvecs, TacsScalar **y, TacsScalar *result );
+
   // Name for the vector
   static const char *vecName;
 };
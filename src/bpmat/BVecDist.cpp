@@ -18,6 +18,8 @@
 
 #include "BVecDist.h"
 #include "FElibrary.h"
+#include "TACSProfiler.h"
+#include "pthread.h"
 
 /*
   Distribute/collect block-vector code
@@ -54,10 +56,19 @@ TACSVarMap::TACSVarMap( MPI_Comm _comm, int _N ){
   for ( int i = 0; i < mpiSize; i++ ){
     ownerRange[i+1] += ownerRange[i];
   }
+
+  // No thread information by default
+  thread_info = NULL;
+
+  // Create the pool for the vectors that use this map
+  pool = new TACSMemoryPool();
+  pool->incref();
 }
 
 TACSVarMap::~TACSVarMap(){
   delete [] ownerRange;
+  if (thread_info){ thread_info->decref(); }
+  pool->decref();
 }
 
 /*
@@ -79,6 +90,40 @@ void TACSVarMap::getOwnerRange( const int **_ownerRange ){
   *_ownerRange = ownerRange;
 }
 
+/*
+  Set the thread information used by the vectors and distribution
+  objects that share this map. The arrays cached in the memory pool
+  were first touched with the previous partition, so they are freed.
+  Vectors allocated after this call are then first touched with the
+  same partition used for their operations.
+*/
+void TACSVarMap::setThreadInfo( TACSThreadInfo *_thread_info ){
+  if (_thread_info){
+    _thread_info->incref();
+  }
+  if (thread_info){
+    thread_info->decref();
+  }
+  thread_info = _thread_info;
+  pool->freeCachedMemory();
+}
+
+/*
+  Get the thread information (or NULL if it is not set)
+*/
+TACSThreadInfo *TACSVarMap::getThreadInfo(){
+  return thread_info;
+}
+
+/*
+  Get the memory pool for the storage of the vectors that use this
+  map. Since each array is keyed by its length, vectors with the same
+  block size share the same arrays.
+*/
+TACSMemoryPool *TACSVarMap::getMemoryPool(){
+  return pool;
+}
+
 /*
   Get the owner of this processor. If the node number is out of range,
   then return -1;
@@ -671,6 +716,8 @@ void TACSBVecDistribute::beginForward( TACSBVecDistCtx *ctx,
                                        TacsScalar *global,
                                        TacsScalar *local,
                                        const int node_offset ){
+  TACSProfileTimer timer(TACSProfiler::VEC_SCATTER);
+
   if (this != ctx->me){
     fprintf(stderr, "TACSBVecDistribute: Inconsistent context\n");
     return;
@@ -698,8 +745,8 @@ void TACSBVecDistribute::beginForward( TACSBVecDistCtx *ctx,
   int lower = bsize*(owner_range[mpi_rank] + node_offset);
 
   // Copy the global values to their requesters
-  bgetvars(bsize, req_ptr[n_req_proc], req_vars, lower,
-           global, reqvals, TACS_INSERT_VALUES);
+  getVars(bsize, req_ptr[n_req_proc], req_vars, lower,
+          global, reqvals);
 
   for ( int i = 0; i < n_req_proc; i++ ){
     // Initiate the sends and receives
@@ -710,10 +757,16 @@ void TACSBVecDistribute::beginForward( TACSBVecDistCtx *ctx,
               ctx->ctx_tag, comm, &sends[i]);
   }
 
+  // Record the messages and the number of bytes sent
+  TACSProfiler::addCount(TACSProfiler::MESSAGE_COUNT, n_req_proc);
+  TACSProfiler::addCount(TACSProfiler::BYTE_COUNT, 
+                         1.0*bsize*(req_ptr[n_req_proc] - req_ptr[0])*
+                         sizeof(TacsScalar));
+
   if (sorted_flag){
     // Copy over the local values
-    bgetvars(bsize, ext_self_count, &ext_vars[ext_self_ptr], lower,
-             global, &local[bsize*ext_self_ptr], TACS_INSERT_VALUES);
+    getVars(bsize, ext_self_count, &ext_vars[ext_self_ptr], lower,
+            global, &local[bsize*ext_self_ptr]);
 
     // If the receiving array is sorted, it can be placed directly
     // into local array
@@ -728,8 +781,8 @@ void TACSBVecDistribute::beginForward( TACSBVecDistCtx *ctx,
   }
   else {
     // Copy the local values first
-    bgetvars(bsize, ext_self_count, &ext_vars[ext_self_ptr], lower,
-             global, &ext_sorted_vals[bsize*ext_self_ptr], TACS_INSERT_VALUES);
+    getVars(bsize, ext_self_count, &ext_vars[ext_self_ptr], lower,
+            global, &ext_sorted_vals[bsize*ext_self_ptr]);
 
     // If the receiving array is not sorted, the data must
     // first be placed in a receiving array
@@ -751,6 +804,8 @@ void TACSBVecDistribute::endForward( TACSBVecDistCtx *ctx,
                                      TacsScalar *global,
                                      TacsScalar *local,
                                      const int node_offset ){
+  TACSProfileTimer timer(TACSProfiler::VEC_SCATTER);
+
   if (this != ctx->me){
     fprintf(stderr, "TACSBVecDistribute: Inconsistent context\n");
     return;
@@ -765,8 +820,8 @@ void TACSBVecDistribute::endForward( TACSBVecDistCtx *ctx,
     initImpl(ctx->bsize);
 
     // Copy over the values from the sorted to the unsorted array
-    bgetvars(ctx->bsize, nvars_unsorted, ext_unsorted_index, 0,
-             ctx->ext_sorted_vals, local, TACS_INSERT_VALUES);
+    getVars(ctx->bsize, nvars_unsorted, ext_unsorted_index, 0,
+            ctx->ext_sorted_vals, local);
   }
 }
 
@@ -783,6 +838,8 @@ void TACSBVecDistribute::beginReverse( TACSBVecDistCtx *ctx,
                                        TacsScalar *local,
                                        TacsScalar *global,
                                        TACSBVecOperation op ){
+  TACSProfileTimer timer(TACSProfiler::VEC_SCATTER);
+
   if (this != ctx->me){
     fprintf(stderr, "TACSBVecDistribute: Inconsistent context\n");
     return;
@@ -833,6 +890,17 @@ void TACSBVecDistribute::beginReverse( TACSBVecDistCtx *ctx,
               dest, ctx->ctx_tag, comm, &recvs[i]);
   }
 
+  // Record the messages and the number of bytes sent
+  if (TACSProfiler::isEnabled()){
+    double count = 0.0;
+    for ( int i = 0; i < n_ext_proc; i++ ){
+      count += ext_count[i];
+    }
+    TACSProfiler::addCount(TACSProfiler::MESSAGE_COUNT, n_ext_proc);
+    TACSProfiler::addCount(TACSProfiler::BYTE_COUNT, 
+                           bsize*count*sizeof(TacsScalar));
+  }
+
   for ( int i = 0; i < n_req_proc; i++ ){
     int dest = req_proc[i];
     int start = bsize*req_ptr[i];
@@ -850,6 +918,8 @@ void TACSBVecDistribute::endReverse( TACSBVecDistCtx *ctx,
                                      TacsScalar *local,
                                      TacsScalar *global,
                                      TACSBVecOperation op ){
+  TACSProfileTimer timer(TACSProfiler::VEC_SCATTER);
+
   if (this != ctx->me){
     fprintf(stderr, "TACSBVecDistribute: Inconsistent context\n");
     return;
@@ -916,6 +986,89 @@ void TACSBVecDistribute::initImpl( int bsize ){
   }
 }
 
+/*
+  The minimum number of variables gathered by each thread
+*/
+static const int TACS_BVEC_DIST_THREAD_MIN_VARS = 4096;
+
+/*
+  The data passed to each thread for the threaded gather
+*/
+class TACSBVecDistGetData {
+ public:
+  int thread, num_threads;
+  void (*getvars)( int bsize, int nvars, const int *vars, int lower,
+                   TacsScalar *x, TacsScalar *y, TACSBVecOperation op );
+  int bsize, nvars, lower;
+  const int *vars;
+  TacsScalar *x, *y;
+};
+
+static void *TACSBVecDistGetVars_thread( void *t ){
+  TACSBVecDistGetData *data = static_cast<TACSBVecDistGetData*>(t);
+  int start, end;
+  TACSThreadInfo::getThreadRange(data->thread, data->num_threads,
+                                 data->nvars, &start, &end);
+  data->getvars(data->bsize, end - start, &data->vars[start], data->lower,
+                data->x, &data->y[data->bsize*start], TACS_INSERT_VALUES);
+  pthread_exit(NULL);
+}
+
+/*
+  Gather the variables y[i] = x[vars[i] - lower] into the buffer.
+
+  This is used to pack the send buffers and to copy the locally owned
+  values. Each variable in the list is written once, so the list is
+  split between the threads from the TACSVarMap when it is long
+  enough to amortize the cost of creating the threads. The scatter
+  with addition in the reverse direction is not threaded since the
+  same variable may appear more than once.
+*/
+void TACSBVecDistribute::getVars( int bsize, int nvars, const int *vars,
+                                  int lower, TacsScalar *x,
+                                  TacsScalar *y ){
+  int num_threads = 1;
+  TACSThreadInfo *thread_info = rmap->getThreadInfo();
+  if (thread_info){
+    num_threads = thread_info->getNumThreads();
+    if (num_threads > nvars/TACS_BVEC_DIST_THREAD_MIN_VARS){
+      num_threads = nvars/TACS_BVEC_DIST_THREAD_MIN_VARS;
+    }
+  }
+
+  if (num_threads <= 1){
+    bgetvars(bsize, nvars, vars, lower, x, y, TACS_INSERT_VALUES);
+    return;
+  }
+
+  pthread_t threads[TACSThreadInfo::TACS_MAX_NUM_THREADS];
+  TACSBVecDistGetData data[TACSThreadInfo::TACS_MAX_NUM_THREADS];
+
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
+
+  for ( int k = 0; k < num_threads; k++ ){
+    data[k].thread = k;
+    data[k].num_threads = num_threads;
+    data[k].getvars = bgetvars;
+    data[k].bsize = bsize;
+    data[k].nvars = nvars;
+    data[k].lower = lower;
+    data[k].vars = vars;
+    data[k].x = x;
+    data[k].y = y;
+    pthread_create(&threads[k], &attr,
+                   TACSBVecDistGetVars_thread, (void*)&data[k]);
+  }
+
+  for ( int k = 0; k < num_threads; k++ ){
+    pthread_join(threads[k], NULL);
+  }
+
+  pthread_attr_destroy(&attr);
+}
+
 /*
   Block-specific implementations that should run slightly faster
 */
@@ -38,7 +38,10 @@ class TACSBVecDistCtx;
   Variable map for the parallel distribution of a vector
 
   This class defines the mapping between the variables and processors
-  and should be instantiated once for each analysis model.
+  and should be instantiated once for each analysis model. The map may
+  also hold the thread information that is used by the vectors and
+  distribution objects that share it. The map owns a memory pool so
+  that the storage of the vectors created with this map is reused.
 */
 class TACSVarMap : public TACSObject {
  public:
@@ -50,11 +53,20 @@ class TACSVarMap : public TACSObject {
   void getOwnerRange( const int **_ownerRange );
   int getOwner( int node );
 
+  // Set/get the thread information for the objects using this map
+  void setThreadInfo( TACSThreadInfo *_thread_info );
+  TACSThreadInfo *getThreadInfo();
+
+  // Get the pool for the vector storage
+  TACSMemoryPool *getMemoryPool();
+
  private:
   MPI_Comm comm; // The MPI communicator
   int mpiSize, mpiRank; // The size/rank of the processor
   int *ownerRange; // The ownership range of the variables
   int N; // Number of nodes on this processor
+  TACSThreadInfo *thread_info; // The thread info (may be NULL)
+  TACSMemoryPool *pool; // The pool for the vector storage
 };
 
 /*
@@ -163,6 +175,10 @@ class TACSBVecDistribute : public TACSObject {
 		    TacsScalar *x, TacsScalar *y, 
 		    TACSBVecOperation op );
 
+  // Threaded gather of the variables into the send/receive buffers
+  void getVars( int bsize, int nvars, const int *vars, int lower,
+                TacsScalar *x, TacsScalar *y );
+
   // The communicator and the MPI data
   MPI_Comm comm;
 
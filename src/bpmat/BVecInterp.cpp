@@ -32,70 +32,40 @@ void BVecInterpMultAddGen( int bsize, int nrows,
                            const int *rowp, const int *cols,
                            const TacsScalar *weights,
                            const TacsScalar *x, TacsScalar *y );
-void BVecInterpMultTransposeAddGen( int bsize, int nrows, 
-                                    const int *rowp, 
-                                    const int *cols,
-                                    const TacsScalar *weights,
-                                    const TacsScalar *x, 
-                                    TacsScalar *y );
 
 void BVecInterpMultAdd1( int bsize, int nrows, 
                          const int *rowp, const int *cols,
                          const TacsScalar *weights,
                          const TacsScalar *x, TacsScalar *y );
-void BVecInterpMultTransposeAdd1( int bsize, int nrows, 
-                                  const int *rowp, const int *cols,
-                                  const TacsScalar *weights,
-                                  const TacsScalar *x, 
-                                  TacsScalar *y );
 
 void BVecInterpMultAdd2( int bsize, int nrows, 
                          const int *rowp, const int *cols,
                          const TacsScalar *weights,
                          const TacsScalar *x, TacsScalar *y );
-void BVecInterpMultTransposeAdd2( int bsize, int nrows, 
-                                  const int *rowp, const int *cols,
-                                  const TacsScalar *weights,
-                                  const TacsScalar *x, 
-                                  TacsScalar *y );
 
 void BVecInterpMultAdd3( int bsize, int nrows, 
                          const int *rowp, const int *cols,
                          const TacsScalar *weights,
                          const TacsScalar *x, TacsScalar *y );
-void BVecInterpMultTransposeAdd3( int bsize, int nrows, 
-                                  const int *rowp, const int *cols,
-                                  const TacsScalar *weights,
-                                  const TacsScalar *x, 
-                                  TacsScalar *y );
 void BVecInterpMultAdd4( int bsize, int nrows, 
                          const int *rowp, const int *cols,
                          const TacsScalar *weights,
                          const TacsScalar *x, TacsScalar *y );
-void BVecInterpMultTransposeAdd4( int bsize, int nrows, 
-                                  const int *rowp, const int *cols,
-                                  const TacsScalar *weights,
-                                  const TacsScalar *x, 
-                                  TacsScalar *y );
 void BVecInterpMultAdd5( int bsize, int nrows, 
                          const int *rowp, const int *cols,
                          const TacsScalar *weights,
                          const TacsScalar *x, TacsScalar *y );
-void BVecInterpMultTransposeAdd5( int bsize, int nrows, 
-                                  const int *rowp, const int *cols,
-                                  const TacsScalar *weights,
-                                  const TacsScalar *x, 
-                                  TacsScalar *y );
 
 void BVecInterpMultAdd6( int bsize, int nrows, 
                          const int *rowp, const int *cols,
                          const TacsScalar *weights,
                          const TacsScalar *x, TacsScalar *y );
-void BVecInterpMultTransposeAdd6( int bsize, int nrows, 
-                                  const int *rowp, const int *cols,
-                                  const TacsScalar *weights,
-                                  const TacsScalar *x, 
-                                  TacsScalar *y );
+
+/*
+  The number of rows taken by each thread at a time in the threaded
+  products
+*/
+static const int BVEC_INTERP_THREAD_GROUP_SIZE = 256;
 
 /*
   This object represents a matrix that interpolates between
@@ -132,6 +102,9 @@ TACSBVecInterp::TACSBVecInterp( TACSAssembler *_inTacs,
   outTacs->incref();
   init(inTacs->getVarMap(), outTacs->getVarMap(), 
        inTacs->getVarsPerNode());
+
+  // Use the threads from the output TACSAssembler object
+  setThreadInfo(outTacs->getThreadInfo());
 }
 
 /*
@@ -205,35 +178,45 @@ or congruent. Cannot form interpolant.\n");
   // NULL the transpose weight vector
   transpose_weights = NULL;
 
+  // The transpose of the weights is formed in initialize()
+  trowp = NULL;
+  tcols = NULL;
+  tweights = NULL;
+  ext_trowp = NULL;
+  ext_tcols = NULL;
+  ext_tweights = NULL;
+
+  // Use a single thread until the thread information is set
+  thread_info = NULL;
+  pthread_mutex_init(&thread_mutex, NULL);
+
+  // The data for the residual is allocated when first required
+  res_mat = NULL;
+  res_ctx = NULL;
+  res_ext = NULL;
+
   // Initialize the implementation
   multadd = BVecInterpMultAddGen;
-  multtransadd = BVecInterpMultTransposeAddGen;
 
   // Initialize the block-specific implementations
   switch (bsize) {
   case 1:
     multadd = BVecInterpMultAdd1;
-    multtransadd = BVecInterpMultTransposeAdd1;
     break;
   case 2:
     multadd = BVecInterpMultAdd2;
-    multtransadd = BVecInterpMultTransposeAdd2;
     break;
   case 3:
     multadd = BVecInterpMultAdd3;
-    multtransadd = BVecInterpMultTransposeAdd3;
     break;
   case 4:
     multadd = BVecInterpMultAdd4;
-    multtransadd = BVecInterpMultTransposeAdd4;
     break;
   case 5:
     multadd = BVecInterpMultAdd5;
-    multtransadd = BVecInterpMultTransposeAdd5;
     break;
   case 6:
     multadd = BVecInterpMultAdd6;
-    multtransadd = BVecInterpMultTransposeAdd6;
     break;
   default:
     break;
@@ -272,6 +255,84 @@ TACSBVecInterp::~TACSBVecInterp(){
   if (ext_cols){ delete [] ext_cols; }
   if (ext_weights){ delete [] ext_weights; }
   if (transpose_weights){ delete [] transpose_weights; }
+  if (trowp){ delete [] trowp; }
+  if (tcols){ delete [] tcols; }
+  if (tweights){ delete [] tweights; }
+  if (ext_trowp){ delete [] ext_trowp; }
+  if (ext_tcols){ delete [] ext_tcols; }
+  if (ext_tweights){ delete [] ext_tweights; }
+
+  if (thread_info){ thread_info->decref(); }
+  pthread_mutex_destroy(&thread_mutex);
+
+  // Deallocate data allocated in multTransposeResidual()
+  if (res_mat){ res_mat->decref(); }
+  if (res_ctx){ res_ctx->decref(); }
+  if (res_ext){ delete [] res_ext; }
+}
+
+/*
+  Set the thread information object used for the products. When the
+  object is NULL, or there is a single thread, the products are
+  computed on the calling thread.
+*/
+void TACSBVecInterp::setThreadInfo( TACSThreadInfo *_thread_info ){
+  if (_thread_info){
+    _thread_info->incref();
+  }
+  if (thread_info){
+    thread_info->decref();
+  }
+  thread_info = _thread_info;
+}
+
+/*
+  Compute the transpose of a CSR matrix with nrows rows and ncols
+  columns. The column indices within each row of the transpose are
+  in ascending order.
+
+  output:
+  _trowp:     the pointer into each row of the transpose
+  _tcols:     the column indices of the transpose
+  _tweights:  the entries of the transpose
+*/
+static void BVecInterpComputeTranspose( int nrows, int ncols,
+                                        const int *rowp, const int *cols,
+                                        const TacsScalar *weights,
+                                        int **_trowp, int **_tcols,
+                                        TacsScalar **_tweights ){
+  int nnz = rowp[nrows];
+  int *trowp = new int[ ncols+1 ];
+  int *tcols = new int[ nnz ];
+  TacsScalar *tweights = new TacsScalar[ nnz ];
+
+  // Count the number of entries in each column
+  memset(trowp, 0, (ncols+1)*sizeof(int));
+  for ( int jp = 0; jp < nnz; jp++ ){
+    trowp[cols[jp]+1]++;
+  }
+  for ( int i = 0; i < ncols; i++ ){
+    trowp[i+1] += trowp[i];
+  }
+
+  // Place the entries, using the row pointer as the insertion
+  // location and then shifting it back afterwards
+  for ( int i = 0; i < nrows; i++ ){
+    for ( int jp = rowp[i]; jp < rowp[i+1]; jp++ ){
+      int kp = trowp[cols[jp]];
+      tcols[kp] = i;
+      tweights[kp] = weights[jp];
+      trowp[cols[jp]]++;
+    }
+  }
+  for ( int i = ncols; i > 0; i-- ){
+    trowp[i] = trowp[i-1];
+  }
+  trowp[0] = 0;
+
+  *_trowp = trowp;
+  *_tcols = tcols;
+  *_tweights = tweights;
 }
 
 /*
@@ -1036,6 +1097,100 @@ void TACSBVecInterp::initialize(){
   
   // Zero the external vector
   memset(x_ext, 0, bsize*num_ext_vars*sizeof(TacsScalar));
+
+  // Form the transpose of the normalized local and external weights
+  // so that the transpose products are computed row-by-row
+  BVecInterpComputeTranspose(N, M, rowp, cols, weights,
+                             &trowp, &tcols, &tweights);
+  BVecInterpComputeTranspose(N, num_ext_vars, ext_rowp, ext_cols,
+                             ext_weights, &ext_trowp, &ext_tcols,
+                             &ext_tweights);
+}
+
+/*
+  Compute y += A*x where A is one of the CSR weight matrices with
+  nrows rows. When more than one thread is available, the rows are
+  divided into groups that are taken by the threads in turn. Each
+  row of y is written by a single thread.
+*/
+void TACSBVecInterp::multAddRows( int nrows, const int *_rowp,
+                                  const int *_cols,
+                                  const TacsScalar *_weights,
+                                  const TacsScalar *x, TacsScalar *y ){
+  // Use the threads only when there is enough work for each thread
+  int num_threads = 1;
+  if (thread_info){
+    num_threads = thread_info->getNumThreads();
+  }
+  if (num_threads > nrows/BVEC_INTERP_THREAD_GROUP_SIZE){
+    num_threads = nrows/BVEC_INTERP_THREAD_GROUP_SIZE;
+  }
+
+  if (num_threads > 1){
+    thread_nrows = nrows;
+    thread_next_row = 0;
+    thread_rowp = _rowp;
+    thread_cols = _cols;
+    thread_weights = _weights;
+    thread_x = x;
+    thread_y = y;
+
+    // Create the joinable attribute
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
+
+    for ( int k = 0; k < num_threads; k++ ){
+      pthread_create(&threads[k], &attr,
+                     TACSBVecInterp::multAddRows_thread, (void*)this);
+    }
+
+    // Join all the threads
+    for ( int k = 0; k < num_threads; k++ ){
+      pthread_join(threads[k], NULL);
+    }
+
+    // Destroy the attribute
+    pthread_attr_destroy(&attr);
+  }
+  else {
+    multadd(bsize, nrows, _rowp, _cols, _weights, x, y);
+  }
+}
+
+/*
+  The thread function for multAddRows(). Each thread takes the next
+  group of rows until all the rows are complete.
+*/
+void *TACSBVecInterp::multAddRows_thread( void *t ){
+  TACSBVecInterp *interp = static_cast<TACSBVecInterp*>(t);
+  const int nrows = interp->thread_nrows;
+  const int bsize = interp->bsize;
+  const int *rowp = interp->thread_rowp;
+
+  while (1){
+    // Get the next group of rows
+    pthread_mutex_lock(&interp->thread_mutex);
+    int row = interp->thread_next_row;
+    interp->thread_next_row += BVEC_INTERP_THREAD_GROUP_SIZE;
+    pthread_mutex_unlock(&interp->thread_mutex);
+
+    if (row >= nrows){
+      break;
+    }
+    int size = BVEC_INTERP_THREAD_GROUP_SIZE;
+    if (row + size > nrows){
+      size = nrows - row;
+    }
+
+    // The kernels read the weights in order from the first entry
+    // in the first row of the group
+    interp->multadd(bsize, size, &rowp[row], interp->thread_cols,
+                    &interp->thread_weights[rowp[row]],
+                    interp->thread_x, &interp->thread_y[bsize*row]);
+  }
+
+  pthread_exit(NULL);
 }
 
 /*
@@ -1069,13 +1224,13 @@ void TACSBVecInterp::mult( TACSBVec *inVec, TACSBVec *outVec ){
   vecDist->beginForward(ctx, in, x_ext);
 
   // Multiply the on-processor part
-  multadd(bsize, N, rowp, cols, weights, in, out);
+  multAddRows(N, rowp, cols, weights, in, out);
 
   // Finish the off-processor communication
   vecDist->endForward(ctx, in, x_ext);
 
   // Multiply the off-processor part
-  multadd(bsize, N, ext_rowp, ext_cols, ext_weights, x_ext, out);
+  multAddRows(N, ext_rowp, ext_cols, ext_weights, x_ext, out);
 }
 
 /*
@@ -1114,13 +1269,13 @@ void TACSBVecInterp::multAdd( TACSBVec *inVec, TACSBVec *addVec,
   vecDist->beginForward(ctx, in, x_ext);
 
   // Multiply the on-processor part
-  multadd(bsize, N, rowp, cols, weights, in, out);
+  multAddRows(N, rowp, cols, weights, in, out);
 
   // Finish the off-processo communication
   vecDist->endForward(ctx, in, x_ext);
 
   // Multiply the off-processor part
-  multadd(bsize, N, ext_rowp, ext_cols, ext_weights, x_ext, out);
+  multAddRows(N, ext_rowp, ext_cols, ext_weights, x_ext, out);
 }
 
 /*
@@ -1153,13 +1308,14 @@ void TACSBVecInterp::multTranspose( TACSBVec *inVec, TACSBVec *outVec ){
   memset(x_ext, 0, bsize*num_ext_vars*sizeof(TacsScalar));
 
   // Multiply the off-processor part first
-  multtransadd(bsize, N, ext_rowp, ext_cols, ext_weights, in, x_ext);
+  multAddRows(num_ext_vars, ext_trowp, ext_tcols, ext_tweights,
+              in, x_ext);
 
   // Initialize communication to the off-processor part
   vecDist->beginReverse(ctx, x_ext, out, TACS_ADD_VALUES);
 
   // Multiply the on-processor part
-  multtransadd(bsize, N, rowp, cols, weights, in, out);
+  multAddRows(M, trowp, tcols, tweights, in, out);
   
   // Finalize the communication to the off-processor part
   vecDist->endReverse(ctx, x_ext, out, TACS_ADD_VALUES);
@@ -1200,13 +1356,14 @@ void TACSBVecInterp::multTransposeAdd( TACSBVec *inVec, TACSBVec *addVec,
   memset(x_ext, 0, bsize*num_ext_vars*sizeof(TacsScalar));
 
   // Multiply the off-processor part first
-  multtransadd(bsize, N, ext_rowp, ext_cols, ext_weights, in, x_ext);
+  multAddRows(num_ext_vars, ext_trowp, ext_tcols, ext_tweights,
+              in, x_ext);
 
   // Initialize communication to the off-processor part
   vecDist->beginReverse(ctx, x_ext, out, TACS_ADD_VALUES);
 
   // Multiply the on-processor part
-  multtransadd(bsize, N, rowp, cols, weights, in, out);
+  multAddRows(M, trowp, tcols, tweights, in, out);
   
   // Finalize the communication to the off-processor part
   vecDist->endReverse(ctx, x_ext, out, TACS_ADD_VALUES);
@@ -1240,6 +1397,261 @@ void TACSBVecInterp::multWeightTranspose( TACSBVec *inVec,
   }
 }
 
+/*
+  Compute the residual r = b - A*x for the rows [start, end) of the
+  matrix and add the restricted residual Interp^{T}*r to the local and
+  external output arrays. The block size is a template parameter so
+  that the block products are unrolled for the common block sizes.
+*/
+template <int bsize>
+static void BVecInterpResidualRows( int start, int end, int var_offset,
+                                    const int *arowp, const int *acols,
+                                    const TacsScalar *avals,
+                                    const int *browp, const int *bcols,
+                                    const TacsScalar *bvals,
+                                    const TacsScalar *b,
+                                    const TacsScalar *x,
+                                    const TacsScalar *xext,
+                                    const int *rowp, const int *cols,
+                                    const TacsScalar *weights,
+                                    const int *ext_rowp, const int *ext_cols,
+                                    const TacsScalar *ext_weights,
+                                    TacsScalar *out, TacsScalar *out_ext ){
+  const int b2 = bsize*bsize;
+  for ( int i = start; i < end; i++ ){
+    TacsScalar r[bsize];
+    for ( int k = 0; k < bsize; k++ ){
+      r[k] = b[bsize*i + k];
+    }
+
+    // Subtract the product with the local part of the matrix
+    for ( int jp = arowp[i]; jp < arowp[i+1]; jp++ ){
+      const TacsScalar *a = &avals[b2*jp];
+      const TacsScalar *xj = &x[bsize*acols[jp]];
+      for ( int k = 0; k < bsize; k++, a += bsize ){
+        for ( int m = 0; m < bsize; m++ ){
+          r[k] -= a[m]*xj[m];
+        }
+      }
+    }
+
+    // Subtract the product with the external part of the matrix
+    if (i >= var_offset){
+      int ib = i - var_offset;
+      for ( int jp = browp[ib]; jp < browp[ib+1]; jp++ ){
+        const TacsScalar *a = &bvals[b2*jp];
+        const TacsScalar *xj = &xext[bsize*bcols[jp]];
+        for ( int k = 0; k < bsize; k++, a += bsize ){
+          for ( int m = 0; m < bsize; m++ ){
+            r[k] -= a[m]*xj[m];
+          }
+        }
+      }
+    }
+
+    // Add the restricted residual to the on and off-processor parts
+    for ( int jp = rowp[i]; jp < rowp[i+1]; jp++ ){
+      TacsScalar *y = &out[bsize*cols[jp]];
+      for ( int k = 0; k < bsize; k++ ){
+        y[k] += weights[jp]*r[k];
+      }
+    }
+    for ( int jp = ext_rowp[i]; jp < ext_rowp[i+1]; jp++ ){
+      TacsScalar *y = &out_ext[bsize*ext_cols[jp]];
+      for ( int k = 0; k < bsize; k++ ){
+        y[k] += ext_weights[jp]*r[k];
+      }
+    }
+  }
+}
+
+/*
+  Compute the residual and restriction for a range of rows of the
+  matrix, using the block-specific code where it is available
+*/
+void TACSBVecInterp::residualRows( int start, int end, int var_offset,
+                                   const int *arowp, const int *acols,
+                                   const TacsScalar *avals,
+                                   const int *browp, const int *bcols,
+                                   const TacsScalar *bvals,
+                                   const TacsScalar *b, const TacsScalar *x,
+                                   TacsScalar *out ){
+  switch (bsize){
+  case 1:
+    BVecInterpResidualRows<1>(start, end, var_offset,
+                              arowp, acols, avals, browp, bcols, bvals,
+                              b, x, res_ext, rowp, cols, weights,
+                              ext_rowp, ext_cols, ext_weights, out, x_ext);
+    break;
+  case 2:
+    BVecInterpResidualRows<2>(start, end, var_offset,
+                              arowp, acols, avals, browp, bcols, bvals,
+                              b, x, res_ext, rowp, cols, weights,
+                              ext_rowp, ext_cols, ext_weights, out, x_ext);
+    break;
+  case 3:
+    BVecInterpResidualRows<3>(start, end, var_offset,
+                              arowp, acols, avals, browp, bcols, bvals,
+                              b, x, res_ext, rowp, cols, weights,
+                              ext_rowp, ext_cols, ext_weights, out, x_ext);
+    break;
+  case 4:
+    BVecInterpResidualRows<4>(start, end, var_offset,
+                              arowp, acols, avals, browp, bcols, bvals,
+                              b, x, res_ext, rowp, cols, weights,
+                              ext_rowp, ext_cols, ext_weights, out, x_ext);
+    break;
+  case 5:
+    BVecInterpResidualRows<5>(start, end, var_offset,
+                              arowp, acols, avals, browp, bcols, bvals,
+                              b, x, res_ext, rowp, cols, weights,
+                              ext_rowp, ext_cols, ext_weights, out, x_ext);
+    break;
+  case 6:
+    BVecInterpResidualRows<6>(start, end, var_offset,
+                              arowp, acols, avals, browp, bcols, bvals,
+                              b, x, res_ext, rowp, cols, weights,
+                              ext_rowp, ext_cols, ext_weights, out, x_ext);
+    break;
+  default: {
+    // Use the generic code for the remaining block sizes
+    const int b2 = bsize*bsize;
+    TacsScalar *r = new TacsScalar[ bsize ];
+    for ( int i = start; i < end; i++ ){
+      for ( int k = 0; k < bsize; k++ ){
+        r[k] = b[bsize*i + k];
+      }
+      for ( int jp = arowp[i]; jp < arowp[i+1]; jp++ ){
+        const TacsScalar *a = &avals[b2*jp];
+        const TacsScalar *xj = &x[bsize*acols[jp]];
+        for ( int k = 0; k < bsize; k++, a += bsize ){
+          for ( int m = 0; m < bsize; m++ ){
+            r[k] -= a[m]*xj[m];
+          }
+        }
+      }
+      if (i >= var_offset){
+        int ib = i - var_offset;
+        for ( int jp = browp[ib]; jp < browp[ib+1]; jp++ ){
+          const TacsScalar *a = &bvals[b2*jp];
+          const TacsScalar *xj = &res_ext[bsize*bcols[jp]];
+          for ( int k = 0; k < bsize; k++, a += bsize ){
+            for ( int m = 0; m < bsize; m++ ){
+              r[k] -= a[m]*xj[m];
+            }
+          }
+        }
+      }
+      for ( int jp = rowp[i]; jp < rowp[i+1]; jp++ ){
+        TacsScalar *y = &out[bsize*cols[jp]];
+        for ( int k = 0; k < bsize; k++ ){
+          y[k] += weights[jp]*r[k];
+        }
+      }
+      for ( int jp = ext_rowp[i]; jp < ext_rowp[i+1]; jp++ ){
+        TacsScalar *y = &x_ext[bsize*ext_cols[jp]];
+        for ( int k = 0; k < bsize; k++ ){
+          y[k] += ext_weights[jp]*r[k];
+        }
+      }
+    }
+    delete [] r;
+  } break;
+  }
+}
+
+/*
+  Compute the restriction of the residual of the matrix
+
+  outVec <- Interp^{T}*(bvec - mat*xvec)
+
+  The residual of each row of the matrix is computed and restricted
+  immediately, in a single pass through the rows of the matrix and
+  without forming the residual vector. The external values of xvec
+  are communicated while the rows without external coupling are
+  processed. This requires that the local rows of the matrix are the
+  output variables of the interpolation.
+
+  input:
+  mat:     the matrix
+  bvec:    the right-hand-side
+  xvec:    the solution vector
+
+  output:
+  outVec:  the restricted residual
+*/
+void TACSBVecInterp::multTransposeResidual( TACSPMat *mat, 
+                                            TACSBVec *bvec,
+                                            TACSBVec *xvec, 
+                                            TACSBVec *outVec ){
+  if (!vecDist){
+    fprintf(stderr, 
+            "Must call initialize() before using TACSBVecInterp object\n");
+    return;
+  }
+
+  // Check that the matrix rows match the interpolation
+  int mat_bsize, mat_N, mat_Nc;
+  mat->getRowMap(&mat_bsize, &mat_N, &mat_Nc);
+  if (mat_bsize != bsize || mat_N != N){
+    fprintf(stderr, "TACSBVecInterp: Matrix and interpolation "
+            "dimensions do not match\n");
+    return;
+  }
+
+  // Retrieve the external column map
+  TACSBVecDistribute *ext_dist;
+  mat->getExtColMap(&ext_dist);
+
+  // Allocate the context for the external values of the matrix
+  if (mat != res_mat){
+    mat->incref();
+    if (res_mat){ res_mat->decref(); }
+    if (res_ctx){ res_ctx->decref(); }
+    if (res_ext){ delete [] res_ext; }
+    res_mat = mat;
+    res_ctx = ext_dist->createCtx(bsize);
+    res_ctx->incref();
+    res_ext = new TacsScalar[ bsize*ext_dist->getDim() ];
+  }
+
+  // Get the local and external parts of the matrix
+  BCSRMat *Aloc, *Bext;
+  mat->getBCSRMat(&Aloc, &Bext);
+  const int *arowp, *acols, *browp, *bcols;
+  TacsScalar *avals, *bvals;
+  Aloc->getArrays(NULL, NULL, NULL, &arowp, &acols, &avals);
+  Bext->getArrays(NULL, NULL, NULL, &browp, &bcols, &bvals);
+
+  // Get the local arrays
+  TacsScalar *b, *x, *out;
+  bvec->getArray(&b);
+  xvec->getArray(&x);
+  outVec->getArray(&out);
+
+  // Zero the output and the off-processor contributions
+  outVec->zeroEntries();
+  memset(x_ext, 0, bsize*num_ext_vars*sizeof(TacsScalar));
+
+  // Begin sending the external values of x
+  ext_dist->beginForward(res_ctx, x, res_ext);
+
+  const int var_offset = mat_N - mat_Nc;
+
+  // Compute the rows without external coupling while the
+  // external values are communicated
+  int mid = (var_offset < N ? var_offset : N);
+  residualRows(0, mid, var_offset, arowp, acols, avals,
+               browp, bcols, bvals, b, x, out);
+  ext_dist->endForward(res_ctx, x, res_ext);
+  residualRows(mid, N, var_offset, arowp, acols, avals,
+               browp, bcols, bvals, b, x, out);
+
+  // Add the off-processor contributions
+  vecDist->beginReverse(ctx, x_ext, out, TACS_ADD_VALUES);
+  vecDist->endReverse(ctx, x_ext, out, TACS_ADD_VALUES);
+}
+
 /*
   Print the weights to the specified file name
 */
@@ -1259,6 +1671,764 @@ void TACSBVecInterp::printInterp( const char *filename ){
   }
 }
 
+/*
+  Retrieve the interpolation weights with the global input variable
+  numbers.
+
+  The rows are the local output variables and the columns are the
+  global input variables, including those from other processors. The
+  arrays are allocated by this function and must be freed by the
+  caller. This must be called after initialize().
+
+  output:
+  _rowp:     pointer into the rows of the interpolation
+  _cols:     the global input variable numbers
+  _weights:  the interpolation weights
+
+  returns:   the number of local rows
+*/
+int TACSBVecInterp::getGlobalWeights( int **_rowp, int **_cols,
+                                      TacsScalar **_weights ){
+  int mpi_rank;
+  MPI_Comm_rank(comm, &mpi_rank);
+
+  *_rowp = NULL;
+  *_cols = NULL;
+  *_weights = NULL;
+  if (!rowp){
+    fprintf(stderr, "[%d] TACSBVecInterp: Cannot retrieve weights before "
+            "initialize()\n", mpi_rank);
+    return 0;
+  }
+
+  const int *inOwnerRange;
+  inMap->getOwnerRange(&inOwnerRange);
+
+  // Get the global numbers of the external variables
+  const int *ext_vars = NULL;
+  if (vecDist){
+    vecDist->getIndices()->getIndices(&ext_vars);
+  }
+
+  int *prowp = new int[ N+1 ];
+  prowp[0] = 0;
+  for ( int i = 0; i < N; i++ ){
+    prowp[i+1] = prowp[i] + (rowp[i+1] - rowp[i]);
+    if (ext_rowp){
+      prowp[i+1] += ext_rowp[i+1] - ext_rowp[i];
+    }
+  }
+
+  int *pcols = new int[ prowp[N] ];
+  TacsScalar *pweights = new TacsScalar[ prowp[N] ];
+  for ( int i = 0, k = 0; i < N; i++ ){
+    for ( int j = rowp[i]; j < rowp[i+1]; j++, k++ ){
+      pcols[k] = cols[j] + inOwnerRange[mpi_rank];
+      pweights[k] = weights[j];
+    }
+    if (ext_rowp){
+      for ( int j = ext_rowp[i]; j < ext_rowp[i+1]; j++, k++ ){
+        pcols[k] = ext_vars[ext_cols[j]];
+        pweights[k] = ext_weights[j];
+      }
+    }
+  }
+
+  *_rowp = prowp;
+  *_cols = pcols;
+  *_weights = pweights;
+  return N;
+}
+
+/*
+  Set up the Galerkin product P^{T}*A*P
+
+  This computes the non-zero pattern of the product and the
+  communication pattern. The values of the product are computed by
+  computeProduct(). The non-zero pattern of A must not be modified
+  after this object is created.
+
+  input:
+  interp:  the interpolation from the coarse to the fine variables
+  mat:     the fine matrix
+*/
+TACSGalerkinProduct::TACSGalerkinProduct( TACSBVecInterp *_interp,
+                                          TACSPMat *_mat ){
+  interp = _interp;
+  interp->incref();
+  mat = _mat;
+  mat->incref();
+  coarse_map = interp->getInputMap();
+  coarse_map->incref();
+  comm = coarse_map->getMPIComm();
+
+  int mpi_rank, mpi_size;
+  MPI_Comm_rank(comm, &mpi_rank);
+  MPI_Comm_size(comm, &mpi_size);
+
+  // Get the layout of the fine matrix
+  BCSRMat *A, *B;
+  mat->getBCSRMat(&A, &B);
+  int N, Nc;
+  mat->getRowMap(&bsize, &N, &Nc);
+
+  // Retrieve the rows of P for the local rows of A
+  nrows = interp->getGlobalWeights(&prowp, &pcols, &pweights);
+  if (!prowp){
+    prowp = new int[ 1 ];
+    pcols = new int[ 1 ];
+    pweights = new TacsScalar[ 1 ];
+    prowp[0] = 0;
+  }
+  if (nrows != N){
+    fprintf(stderr, "[%d] TACSGalerkinProduct: Interpolation and matrix "
+            "dimensions do not match\n", mpi_rank);
+    if (N < nrows){
+      nrows = N;
+    }
+  }
+
+  // Retrieve the external columns of A. These are sorted.
+  TACSBVecDistribute *ext_dist;
+  mat->getExtColMap(&ext_dist);
+  const int *ext_vars;
+  next = ext_dist->getIndices()->getIndices(&ext_vars);
+
+  // Determine the processors that own the external variables
+  const int *fineRange;
+  mat->getRowMap()->getOwnerRange(&fineRange);
+  int *ext_ptr = new int[ mpi_size+1 ];
+  int *ext_count = new int[ mpi_size ];
+  FElibrary::matchIntervals(mpi_size, fineRange, next, ext_vars, ext_ptr);
+  for ( int k = 0; k < mpi_size; k++ ){
+    ext_count[k] = ext_ptr[k+1] - ext_ptr[k];
+  }
+
+  // Send the requested rows of P to their owners
+  int *req_count = new int[ mpi_size ];
+  int *req_ptr = new int[ mpi_size+1 ];
+  MPI_Alltoall(ext_count, 1, MPI_INT, req_count, 1, MPI_INT, comm);
+  req_ptr[0] = 0;
+  for ( int k = 0; k < mpi_size; k++ ){
+    req_ptr[k+1] = req_ptr[k] + req_count[k];
+  }
+  int *req_vars = new int[ req_ptr[mpi_size] ];
+  MPI_Alltoallv((int*)ext_vars, ext_count, ext_ptr, MPI_INT,
+                req_vars, req_count, req_ptr, MPI_INT, comm);
+
+  // Find the length of each of the requested rows
+  int *req_len = new int[ req_ptr[mpi_size] ];
+  int *req_wcount = new int[ mpi_size ];
+  int *req_wptr = new int[ mpi_size+1 ];
+  req_wptr[0] = 0;
+  for ( int k = 0; k < mpi_size; k++ ){
+    req_wcount[k] = 0;
+    for ( int j = req_ptr[k]; j < req_ptr[k+1]; j++ ){
+      int row = req_vars[j] - fineRange[mpi_rank];
+      req_len[j] = 0;
+      if (row >= 0 && row < nrows){
+        req_len[j] = prowp[row+1] - prowp[row];
+      }
+      req_wcount[k] += req_len[j];
+    }
+    req_wptr[k+1] = req_wptr[k] + req_wcount[k];
+  }
+
+  int *ext_len = new int[ next ];
+  MPI_Alltoallv(req_len, req_count, req_ptr, MPI_INT,
+                ext_len, ext_count, ext_ptr, MPI_INT, comm);
+
+  // Pack the requested rows of P
+  int *req_cols = new int[ req_wptr[mpi_size] ];
+  TacsScalar *req_weights = new TacsScalar[ req_wptr[mpi_size] ];
+  for ( int j = 0, n = 0; j < req_ptr[mpi_size]; j++ ){
+    if (req_len[j] > 0){
+      int row = req_vars[j] - fineRange[mpi_rank];
+      memcpy(&req_cols[n], &pcols[prowp[row]], req_len[j]*sizeof(int));
+      memcpy(&req_weights[n], &pweights[prowp[row]],
+             req_len[j]*sizeof(TacsScalar));
+      n += req_len[j];
+    }
+  }
+
+  // Receive the rows of P for the external columns of A
+  erowp = new int[ next+1 ];
+  erowp[0] = 0;
+  for ( int j = 0; j < next; j++ ){
+    erowp[j+1] = erowp[j] + ext_len[j];
+  }
+  int *ext_wcount = new int[ mpi_size ];
+  int *ext_wptr = new int[ mpi_size+1 ];
+  for ( int k = 0; k <= mpi_size; k++ ){
+    ext_wptr[k] = erowp[ext_ptr[k]];
+  }
+  for ( int k = 0; k < mpi_size; k++ ){
+    ext_wcount[k] = ext_wptr[k+1] - ext_wptr[k];
+  }
+  ecols = new int[ erowp[next] ];
+  eweights = new TacsScalar[ erowp[next] ];
+  MPI_Alltoallv(req_cols, req_wcount, req_wptr, MPI_INT,
+                ecols, ext_wcount, ext_wptr, MPI_INT, comm);
+  MPI_Alltoallv(req_weights, req_wcount, req_wptr, TACS_MPI_TYPE,
+                eweights, ext_wcount, ext_wptr, TACS_MPI_TYPE, comm);
+
+  delete [] ext_ptr;
+  delete [] ext_count;
+  delete [] req_count;
+  delete [] req_ptr;
+  delete [] req_vars;
+  delete [] req_len;
+  delete [] req_wcount;
+  delete [] req_wptr;
+  delete [] ext_len;
+  delete [] req_cols;
+  delete [] req_weights;
+  delete [] ext_wcount;
+  delete [] ext_wptr;
+
+  // Find the coarse rows with contributions from this processor
+  crows = new int[ prowp[nrows] ];
+  memcpy(crows, pcols, prowp[nrows]*sizeof(int));
+  ncrows = FElibrary::uniqueSort(crows, prowp[nrows]);
+
+  pindex = new int[ prowp[nrows] ];
+  for ( int k = 0; k < prowp[nrows]; k++ ){
+    int *item = (int*)bsearch(&pcols[k], crows, ncrows,
+                              sizeof(int), FElibrary::comparator);
+    pindex[k] = item - crows;
+  }
+
+  // Find the maximum size of the coarse pattern of a fine row
+  const int *arowp, *acols, *browp, *bcols;
+  A->getArrays(NULL, NULL, NULL, &arowp, &acols, NULL);
+  B->getArrays(NULL, NULL, NULL, &browp, &bcols, NULL);
+  int Np = N - Nc;
+  max_pattern_size = 1;
+  for ( int i = 0; i < nrows; i++ ){
+    int size = 0;
+    for ( int jp = arowp[i]; jp < arowp[i+1]; jp++ ){
+      int j = acols[jp];
+      size += prowp[j+1] - prowp[j];
+    }
+    if (i >= Np){
+      for ( int jp = browp[i-Np]; jp < browp[i-Np+1]; jp++ ){
+        int j = bcols[jp];
+        size += erowp[j+1] - erowp[j];
+      }
+    }
+    if (size > max_pattern_size){
+      max_pattern_size = size;
+    }
+  }
+  pattern = new int[ max_pattern_size ];
+
+  // Count up the size of each coarse row, including duplicates
+  // from different fine rows
+  crowp = new int[ ncrows+1 ];
+  memset(crowp, 0, (ncrows+1)*sizeof(int));
+  for ( int i = 0; i < nrows; i++ ){
+    int size = getFineRowPattern(i, pattern);
+    for ( int k = prowp[i]; k < prowp[i+1]; k++ ){
+      crowp[pindex[k]+1] += size;
+    }
+  }
+  for ( int r = 0; r < ncrows; r++ ){
+    crowp[r+1] += crowp[r];
+  }
+
+  // Add the columns and remove the duplicates
+  ccols = new int[ crowp[ncrows] ];
+  for ( int i = 0; i < nrows; i++ ){
+    int size = getFineRowPattern(i, pattern);
+    for ( int k = prowp[i]; k < prowp[i+1]; k++ ){
+      int r = pindex[k];
+      memcpy(&ccols[crowp[r]], pattern, size*sizeof(int));
+      crowp[r] += size;
+    }
+  }
+  for ( int r = ncrows; r > 0; r-- ){
+    crowp[r] = crowp[r-1];
+  }
+  crowp[0] = 0;
+  matutils::SortAndUniquifyCSR(ncrows, crowp, ccols);
+  cvals = new TacsScalar[ bsize*bsize*crowp[ncrows] ];
+
+  // Determine the owners of the coarse rows
+  const int *coarseRange;
+  coarse_map->getOwnerRange(&coarseRange);
+  send_ptr = new int[ mpi_size+1 ];
+  FElibrary::matchIntervals(mpi_size, coarseRange, ncrows, crows, send_ptr);
+
+  // Send the rows that are not owned by this processor
+  int *send_count = new int[ mpi_size ];
+  int *recv_count = new int[ mpi_size ];
+  for ( int k = 0; k < mpi_size; k++ ){
+    send_count[k] = send_ptr[k+1] - send_ptr[k];
+    if (k == mpi_rank){
+      send_count[k] = 0;
+    }
+  }
+  MPI_Alltoall(send_count, 1, MPI_INT, recv_count, 1, MPI_INT, comm);
+  recv_ptr = new int[ mpi_size+1 ];
+  recv_ptr[0] = 0;
+  for ( int k = 0; k < mpi_size; k++ ){
+    recv_ptr[k+1] = recv_ptr[k] + recv_count[k];
+  }
+
+  int nrecv = recv_ptr[mpi_size];
+  recv_rows = new int[ nrecv ];
+  MPI_Alltoallv(crows, send_count, send_ptr, MPI_INT,
+                recv_rows, recv_count, recv_ptr, MPI_INT, comm);
+
+  // Send the length of each of the rows
+  int *row_len = new int[ ncrows ];
+  int *recv_len = new int[ nrecv ];
+  for ( int r = 0; r < ncrows; r++ ){
+    row_len[r] = crowp[r+1] - crowp[r];
+  }
+  MPI_Alltoallv(row_len, send_count, send_ptr, MPI_INT,
+                recv_len, recv_count, recv_ptr, MPI_INT, comm);
+  recv_rowp = new int[ nrecv+1 ];
+  recv_rowp[0] = 0;
+  for ( int r = 0; r < nrecv; r++ ){
+    recv_rowp[r+1] = recv_rowp[r] + recv_len[r];
+  }
+
+  // Send the column indices of each of the rows
+  int *send_disp = new int[ mpi_size ];
+  int *recv_disp = new int[ mpi_size ];
+  for ( int k = 0; k < mpi_size; k++ ){
+    send_disp[k] = crowp[send_ptr[k]];
+    send_count[k] = crowp[send_ptr[k+1]] - crowp[send_ptr[k]];
+    if (k == mpi_rank){
+      send_count[k] = 0;
+    }
+    recv_disp[k] = recv_rowp[recv_ptr[k]];
+    recv_count[k] = recv_rowp[recv_ptr[k+1]] - recv_rowp[recv_ptr[k]];
+  }
+  recv_cols = new int[ recv_rowp[nrecv] ];
+  MPI_Alltoallv(ccols, send_count, send_disp, MPI_INT,
+                recv_cols, recv_count, recv_disp, MPI_INT, comm);
+  recv_vals = new TacsScalar[ bsize*bsize*recv_rowp[nrecv] ];
+
+  delete [] send_count;
+  delete [] recv_count;
+  delete [] send_disp;
+  delete [] recv_disp;
+  delete [] row_len;
+  delete [] recv_len;
+
+  // Allocate space for a single row of the coarse matrix
+  max_row_size = 1;
+  for ( int r = send_ptr[mpi_rank]; r < send_ptr[mpi_rank+1]; r++ ){
+    if (crowp[r+1] - crowp[r] > max_row_size){
+      max_row_size = crowp[r+1] - crowp[r];
+    }
+  }
+  for ( int r = 0; r < nrecv; r++ ){
+    if (recv_rowp[r+1] - recv_rowp[r] > max_row_size){
+      max_row_size = recv_rowp[r+1] - recv_rowp[r];
+    }
+  }
+  row_vals = new TacsScalar[ bsize*bsize*max_row_size ];
+}
+
+/*
+  Free the data for the Galerkin product
+*/
+TACSGalerkinProduct::~TACSGalerkinProduct(){
+  interp->decref();
+  mat->decref();
+  coarse_map->decref();
+
+  delete [] prowp;
+  delete [] pcols;
+  delete [] pweights;
+  delete [] pindex;
+  delete [] erowp;
+  delete [] ecols;
+  delete [] eweights;
+  delete [] crows;
+  delete [] crowp;
+  delete [] ccols;
+  delete [] cvals;
+  delete [] send_ptr;
+  delete [] recv_ptr;
+  delete [] recv_rows;
+  delete [] recv_rowp;
+  delete [] recv_cols;
+  delete [] recv_vals;
+  delete [] pattern;
+  delete [] row_vals;
+}
+
+/*
+  Compute the sorted coarse columns coupled to the given fine row
+  through A*P
+
+  input:
+  row:      the local fine row of A
+
+  output:
+  pattern:  the sorted list of global coarse columns
+
+  returns:  the number of coarse columns
+*/
+int TACSGalerkinProduct::getFineRowPattern( int row, int *pattern ){
+  BCSRMat *A, *B;
+  mat->getBCSRMat(&A, &B);
+  int N, Nc;
+  mat->getRowMap(NULL, &N, &Nc);
+  int Np = N - Nc;
+
+  const int *arowp, *acols;
+  A->getArrays(NULL, NULL, NULL, &arowp, &acols, NULL);
+
+  int size = 0;
+  for ( int jp = arowp[row]; jp < arowp[row+1]; jp++ ){
+    int j = acols[jp];
+    for ( int k = prowp[j]; k < prowp[j+1]; k++, size++ ){
+      pattern[size] = pcols[k];
+    }
+  }
+  if (row >= Np){
+    const int *browp, *bcols;
+    B->getArrays(NULL, NULL, NULL, &browp, &bcols, NULL);
+    for ( int jp = browp[row-Np]; jp < browp[row-Np+1]; jp++ ){
+      int j = bcols[jp];
+      for ( int k = erowp[j]; k < erowp[j+1]; k++, size++ ){
+        pattern[size] = ecols[k];
+      }
+    }
+  }
+
+  return FElibrary::uniqueSort(pattern, size);
+}
+
+/*
+  Compute the non-zero pattern of the coarse rows owned by this
+  processor.
+
+  The pattern is returned in a local CSR format. The variables
+  consist of the owned coarse variables and all variables coupled to
+  them. The diagonal entry is always included.
+
+  output:
+  _vars:   the sorted global variable numbers
+  _rowp:   pointer into the rows of the local CSR structure
+  _cols:   the local column indices
+
+  returns: the number of local variables
+*/
+int TACSGalerkinProduct::getCoarsePattern( int **_vars, int **_rowp,
+                                           int **_cols ){
+  int mpi_rank;
+  MPI_Comm_rank(comm, &mpi_rank);
+  const int *coarseRange;
+  coarse_map->getOwnerRange(&coarseRange);
+  int lower = coarseRange[mpi_rank];
+  int nowned = coarseRange[mpi_rank+1] - lower;
+  int mpi_size;
+  MPI_Comm_size(comm, &mpi_size);
+  int nrecv = recv_ptr[mpi_size];
+
+  // Count up the entries in each owned row, including duplicates
+  int *growp = new int[ nowned+1 ];
+  for ( int i = 0; i <= nowned; i++ ){
+    growp[i] = (i > 0 ? 1 : 0);
+  }
+  for ( int r = send_ptr[mpi_rank]; r < send_ptr[mpi_rank+1]; r++ ){
+    growp[crows[r] - lower + 1] += crowp[r+1] - crowp[r];
+  }
+  for ( int r = 0; r < nrecv; r++ ){
+    growp[recv_rows[r] - lower + 1] += recv_rowp[r+1] - recv_rowp[r];
+  }
+  for ( int i = 0; i < nowned; i++ ){
+    growp[i+1] += growp[i];
+  }
+
+  // Add the global column indices to each row
+  int *gcols = new int[ growp[nowned] ];
+  for ( int i = 0; i < nowned; i++ ){
+    gcols[growp[i]] = lower + i;
+    growp[i]++;
+  }
+  for ( int r = send_ptr[mpi_rank]; r < send_ptr[mpi_rank+1]; r++ ){
+    int i = crows[r] - lower;
+    int size = crowp[r+1] - crowp[r];
+    memcpy(&gcols[growp[i]], &ccols[crowp[r]], size*sizeof(int));
+    growp[i] += size;
+  }
+  for ( int r = 0; r < nrecv; r++ ){
+    int i = recv_rows[r] - lower;
+    int size = recv_rowp[r+1] - recv_rowp[r];
+    memcpy(&gcols[growp[i]], &recv_cols[recv_rowp[r]], size*sizeof(int));
+    growp[i] += size;
+  }
+  for ( int i = nowned; i > 0; i-- ){
+    growp[i] = growp[i-1];
+  }
+  growp[0] = 0;
+  matutils::SortAndUniquifyCSR(nowned, growp, gcols);
+
+  // Find all the variables referenced by the owned rows
+  int *vars = new int[ nowned + growp[nowned] ];
+  for ( int i = 0; i < nowned; i++ ){
+    vars[i] = lower + i;
+  }
+  memcpy(&vars[nowned], gcols, growp[nowned]*sizeof(int));
+  int nvars = FElibrary::uniqueSort(vars, nowned + growp[nowned]);
+
+  // Create the local CSR data structure. The rows for variables
+  // that are not owned by this processor are empty.
+  int *item = (int*)bsearch(&lower, vars, nvars, sizeof(int),
+                            FElibrary::comparator);
+  int start = (item ? item - vars : 0);
+
+  int *rowp = new int[ nvars+1 ];
+  int *cols = new int[ growp[nowned] ];
+  rowp[0] = 0;
+  for ( int i = 0; i < nvars; i++ ){
+    rowp[i+1] = rowp[i];
+    if (i >= start && i < start + nowned){
+      int row = i - start;
+      for ( int jp = growp[row]; jp < growp[row+1]; jp++ ){
+        item = (int*)bsearch(&gcols[jp], vars, nvars, sizeof(int),
+                             FElibrary::comparator);
+        cols[rowp[i+1]] = item - vars;
+        rowp[i+1]++;
+      }
+    }
+  }
+
+  delete [] growp;
+  delete [] gcols;
+
+  *_vars = vars;
+  *_rowp = rowp;
+  *_cols = cols;
+  return nvars;
+}
+
+/*
+  Create a TACSDistMat with the non-zero pattern of the product
+
+  input:
+  thread_info:  the thread information for the matrix
+
+  returns:      the new matrix
+*/
+TACSDistMat *TACSGalerkinProduct::createMat( TACSThreadInfo *thread_info ){
+  int *vars, *rowp, *cols;
+  int nvars = getCoarsePattern(&vars, &rowp, &cols);
+
+  TACSBVecIndices *bindex = new TACSBVecIndices(&vars, nvars);
+  bindex->incref();
+  TACSDistMat *dmat = new TACSDistMat(thread_info, coarse_map, bsize,
+                                      nvars, rowp, cols, bindex);
+  bindex->decref();
+
+  delete [] rowp;
+  delete [] cols;
+
+  return dmat;
+}
+
+/*
+  Create an FEMat with the non-zero pattern of the product.
+
+  All of the variables are placed in the Schur complement (the
+  C-matrix) so that the full coarse operator is factored by the
+  parallel dense solver within PcScMat.
+
+  input:
+  thread_info:  the thread information for the matrix
+
+  returns:      the new matrix
+*/
+FEMat *TACSGalerkinProduct::createFEMat( TACSThreadInfo *thread_info ){
+  int *vars, *rowp, *cols;
+  int nvars = getCoarsePattern(&vars, &rowp, &cols);
+
+  // Create the empty B-index set and the C-index set
+  int *bvars = new int[ 1 ];
+  int *bglobal = new int[ 1 ];
+  int *cvars = new int[ nvars ];
+  for ( int i = 0; i < nvars; i++ ){
+    cvars[i] = i;
+  }
+
+  TACSBVecIndices *b_local = new TACSBVecIndices(&bvars, 0);
+  TACSBVecIndices *c_local = new TACSBVecIndices(&cvars, nvars);
+  b_local->incref();
+  c_local->incref();
+
+  TACSBVecIndices *b_global = new TACSBVecIndices(&bglobal, 0);
+  TACSBVecIndices *c_global = new TACSBVecIndices(&vars, nvars);
+  TACSBVecDistribute *b_map = new TACSBVecDistribute(coarse_map, b_global);
+  TACSBVecDistribute *c_map = new TACSBVecDistribute(coarse_map, c_global);
+  b_map->incref();
+  c_map->incref();
+
+  FEMat *fmat = new FEMat(thread_info, coarse_map, bsize, nvars,
+                          rowp, cols, b_local, b_map, c_local, c_map);
+
+  b_local->decref();
+  c_local->decref();
+  b_map->decref();
+  c_map->decref();
+
+  delete [] rowp;
+  delete [] cols;
+
+  return fmat;
+}
+
+/*
+  Compute the product P^{T}*A*P with the current values of A and set
+  the result into the coarse matrix.
+
+  The coarse matrix must be created by createMat() or createFEMat(),
+  or have a non-zero pattern that contains the product. This call is
+  collective on the communicator. Boundary conditions are not applied
+  to the coarse matrix.
+
+  input:
+  coarse:   the coarse matrix
+*/
+void TACSGalerkinProduct::computeProduct( TACSMat *coarse ){
+  int mpi_rank, mpi_size;
+  MPI_Comm_rank(comm, &mpi_rank);
+  MPI_Comm_size(comm, &mpi_size);
+
+  BCSRMat *A, *B;
+  mat->getBCSRMat(&A, &B);
+  int N, Nc;
+  mat->getRowMap(NULL, &N, &Nc);
+  int Np = N - Nc;
+
+  const int *arowp, *acols, *browp, *bcols;
+  TacsScalar *avals, *bvals;
+  A->getArrays(NULL, NULL, NULL, &arowp, &acols, &avals);
+  B->getArrays(NULL, NULL, NULL, &browp, &bcols, &bvals);
+
+  // Add the contributions from each block A_{ij} to the coarse
+  // blocks C_{IJ} += P_{iI}*A_{ij}*P_{jJ}
+  const int b2 = bsize*bsize;
+  memset(cvals, 0, b2*crowp[ncrows]*sizeof(TacsScalar));
+
+  for ( int i = 0; i < nrows; i++ ){
+    int nblocks = arowp[i+1] - arowp[i];
+    if (i >= Np){
+      nblocks += browp[i-Np+1] - browp[i-Np];
+    }
+
+    for ( int jj = 0; jj < nblocks; jj++ ){
+      // Get the block and the associated row of P
+      const TacsScalar *a;
+      const int *pc;
+      const TacsScalar *pw;
+      int plen;
+      if (jj < arowp[i+1] - arowp[i]){
+        int jp = arowp[i] + jj;
+        int j = acols[jp];
+        a = &avals[b2*jp];
+        pc = &pcols[prowp[j]];
+        pw = &pweights[prowp[j]];
+        plen = prowp[j+1] - prowp[j];
+      }
+      else {
+        int jp = browp[i-Np] + jj - (arowp[i+1] - arowp[i]);
+        int j = bcols[jp];
+        a = &bvals[b2*jp];
+        pc = &ecols[erowp[j]];
+        pw = &eweights[erowp[j]];
+        plen = erowp[j+1] - erowp[j];
+      }
+
+      for ( int k = prowp[i]; k < prowp[i+1]; k++ ){
+        int r = pindex[k];
+        const int *rcols = &ccols[crowp[r]];
+        int rsize = crowp[r+1] - crowp[r];
+        TacsScalar *rvals = &cvals[b2*crowp[r]];
+
+        for ( int l = 0; l < plen; l++ ){
+          int *item = (int*)bsearch(&pc[l], rcols, rsize, sizeof(int),
+                                    FElibrary::comparator);
+          if (item){
+            TacsScalar alpha = pweights[k]*pw[l];
+            TacsScalar *c = &rvals[b2*(item - rcols)];
+            for ( int m = 0; m < b2; m++ ){
+              c[m] += alpha*a[m];
+            }
+          }
+        }
+      }
+    }
+  }
+
+  // Send the rows owned by other processors
+  int *send_count = new int[ mpi_size ];
+  int *send_disp = new int[ mpi_size ];
+  int *recv_count = new int[ mpi_size ];
+  int *recv_disp = new int[ mpi_size ];
+  for ( int k = 0; k < mpi_size; k++ ){
+    send_disp[k] = b2*crowp[send_ptr[k]];
+    send_count[k] = b2*(crowp[send_ptr[k+1]] - crowp[send_ptr[k]]);
+    if (k == mpi_rank){
+      send_count[k] = 0;
+    }
+    recv_disp[k] = b2*recv_rowp[recv_ptr[k]];
+    recv_count[k] = b2*(recv_rowp[recv_ptr[k+1]] - recv_rowp[recv_ptr[k]]);
+  }
+  MPI_Alltoallv(cvals, send_count, send_disp, TACS_MPI_TYPE,
+                recv_vals, recv_count, recv_disp, TACS_MPI_TYPE, comm);
+  delete [] send_count;
+  delete [] send_disp;
+  delete [] recv_count;
+  delete [] recv_disp;
+
+  // Add the owned rows to the coarse matrix
+  coarse->zeroEntries();
+  for ( int r = send_ptr[mpi_rank]; r < send_ptr[mpi_rank+1]; r++ ){
+    addCoarseRow(coarse, crows[r], crowp[r+1] - crowp[r],
+                 &ccols[crowp[r]], &cvals[b2*crowp[r]]);
+  }
+  for ( int r = 0; r < recv_ptr[mpi_size]; r++ ){
+    addCoarseRow(coarse, recv_rows[r], recv_rowp[r+1] - recv_rowp[r],
+                 &recv_cols[recv_rowp[r]], &recv_vals[b2*recv_rowp[r]]);
+  }
+  coarse->beginAssembly();
+  coarse->endAssembly();
+}
+
+/*
+  Add a row of blocks to the coarse matrix. The blocks are stored
+  consecutively and are converted to the dense row-major format
+  required by addValues().
+
+  input:
+  coarse:  the coarse matrix
+  row:     the global row index
+  ncols:   the number of blocks in the row
+  cols:    the global column indices
+  vals:    the block values
+*/
+void TACSGalerkinProduct::addCoarseRow( TACSMat *coarse, int row,
+                                        int ncols, const int *cols,
+                                        const TacsScalar *vals ){
+  const int b2 = bsize*bsize;
+  const int mv = bsize*ncols;
+  for ( int j = 0; j < ncols; j++ ){
+    for ( int ii = 0; ii < bsize; ii++ ){
+      for ( int jj = 0; jj < bsize; jj++ ){
+        row_vals[mv*ii + bsize*j + jj] = vals[b2*j + bsize*ii + jj];
+      }
+    }
+  }
+  coarse->addValues(1, &row, ncols, cols, bsize, mv, row_vals);
+}
+
 /*
   The following are the block-specific and generic code for the
   matrix-vector multiplications required within the BVecInterp class.
@@ -1288,26 +2458,6 @@ void BVecInterpMultAddGen( int bsize, int nrows,
   }
 }
 
-/*
-  Compute the matrix-vector transpose product for generic bsize
-*/
-void BVecInterpMultTransposeAddGen( int bsize, int nrows, 
-                                    const int *rowp, const int *cols,
-                                    const TacsScalar *w,
-                                    const TacsScalar *x, TacsScalar *y ){
-  for ( int i = 0; i < nrows; i++ ){
-    int j = rowp[i];
-    int end = rowp[i+1];
-
-    for (; j < end; j++ ){
-      for ( int k = 0; k < bsize; k++ ){
-        y[bsize*cols[j]+k] += w[0]*x[bsize*i+k];
-      }
-      w++;
-    }
-  }
-}
-
 /*
   Compute a matrix-vector product for bsize = 1
 */
@@ -1326,24 +2476,6 @@ void BVecInterpMultAdd1( int bsize, int nrows,
   }
 }
 
-/*
-  Compute the matrix-vector transpose product for bsize = 1
-*/
-void BVecInterpMultTransposeAdd1( int bsize, int nrows, 
-                                  const int *rowp, const int *cols,
-                                  const TacsScalar *w,
-                                  const TacsScalar *x, TacsScalar *y ){
-  for ( int i = 0; i < nrows; i++ ){
-    int j = rowp[i];
-    int end = rowp[i+1];
-
-    for (; j < end; j++ ){
-      y[cols[j]] += w[0]*x[i];
-      w++;
-    }
-  }
-}
-
 /*
   Compute a matrix-vector product for bsize = 2
 */
@@ -1363,64 +2495,37 @@ void BVecInterpMultAdd2( int bsize, int nrows,
   }
 }
 
-/*
-  Compute the matrix-vector transpose product for bsize = 2
-*/
-void BVecInterpMultTransposeAdd2( int bsize, int nrows, 
-                                  const int *rowp, const int *cols,
-                                  const TacsScalar *w,
-                                  const TacsScalar *x, TacsScalar *y ){
-  for ( int i = 0; i < nrows; i++ ){
-    int j = rowp[i];
-    int end = rowp[i+1];
-
-    for (; j < end; j++ ){
-      y[2*cols[j]]   += w[0]*x[2*i];
-      y[2*cols[j]+1] += w[0]*x[2*i+1];
-      w++;
-    }
-  }
-}
-
 /*
   Compute a matrix-vector product for bsize = 3
+
+  The products for each row are accumulated in local variables and
+  added to y once the row is complete. This avoids storing to y for
+  each entry in the row, and allows the compiler to compute the
+  components of the block with packed (SIMD) operations.
 */
 void BVecInterpMultAdd3( int bsize, int nrows, 
                          const int *rowp, const int *cols,
                          const TacsScalar *w,
                          const TacsScalar *x, TacsScalar *y ){
-  for ( int i = 0; i < nrows; i++ ){
-    int j = rowp[i];
-    int end = rowp[i+1];
-    
-    for (; j < end; j++ ){
-      y[3*i]   += w[0]*x[3*cols[j]];
-      y[3*i+1] += w[0]*x[3*cols[j]+1];
-      y[3*i+2] += w[0]*x[3*cols[j]+2];
-      w++;
-    }
-  }
-}
-
-/*
-  Compute the matrix-vector transpose product for bsize = 3
-*/
-void BVecInterpMultTransposeAdd3( int bsize, int nrows, 
-                                  const int *rowp, const int *cols,
-                                  const TacsScalar *w,
-                                  const TacsScalar *x, TacsScalar *y ){
-  for ( int i = 0; i < nrows; i++ ){
+  for ( int i = 0; i < nrows; i++, y += 3 ){
     int j = rowp[i];
     int end = rowp[i+1];
 
+    TacsScalar y0 = 0.0, y1 = 0.0, y2 = 0.0;
     for (; j < end; j++ ){
-      y[3*cols[j]]   += w[0]*x[3*i];
-      y[3*cols[j]+1] += w[0]*x[3*i+1];
-      y[3*cols[j]+2] += w[0]*x[3*i+2];
+      const TacsScalar *xj = &x[3*cols[j]];
+      y0 += w[0]*xj[0];
+      y1 += w[0]*xj[1];
+      y2 += w[0]*xj[2];
       w++;
     }
+
+    y[0] += y0;
+    y[1] += y1;
+    y[2] += y2;
   }
 }
+
 /*
   Compute a matrix-vector product for bsize = 4
 */
@@ -1442,26 +2547,6 @@ void BVecInterpMultAdd4( int bsize, int nrows,
   }
 }
 
-/*
-  Compute the matrix-vector transpose product for bsize = 4
-*/
-void BVecInterpMultTransposeAdd4( int bsize, int nrows, 
-                                  const int *rowp, const int *cols,
-                                  const TacsScalar *w,
-                                  const TacsScalar *x, TacsScalar *y ){
-  for ( int i = 0; i < nrows; i++ ){
-    int j = rowp[i];
-    int end = rowp[i+1];
-
-    for (; j < end; j++ ){
-      y[4*cols[j]]   += w[0]*x[4*i];
-      y[4*cols[j]+1] += w[0]*x[4*i+1];
-      y[4*cols[j]+2] += w[0]*x[4*i+2];
-      y[4*cols[j]+3] += w[0]*x[4*i+3];
-      w++;
-    }
-  }
-}
 /*
   Compute a matrix-vector product for bsize = 5
 */
@@ -1485,69 +2570,37 @@ void BVecInterpMultAdd5( int bsize, int nrows,
 }
 
 /*
-  Compute the matrix-vector transpose product for bsize = 5
-*/
-void BVecInterpMultTransposeAdd5( int bsize, int nrows, 
-                                  const int *rowp, const int *cols,
-                                  const TacsScalar *w,
-                                  const TacsScalar *x, TacsScalar *y ){
-  for ( int i = 0; i < nrows; i++ ){
-    int j = rowp[i];
-    int end = rowp[i+1];
-
-    for (; j < end; j++ ){
-      y[5*cols[j]]   += w[0]*x[5*i];
-      y[5*cols[j]+1] += w[0]*x[5*i+1];
-      y[5*cols[j]+2] += w[0]*x[5*i+2];
-      y[5*cols[j]+3] += w[0]*x[5*i+3];
-      y[5*cols[j]+4] += w[0]*x[5*i+4];
-      w++;
-    }
-  }
-}
+  Compute a matrix-vector product for bsize = 6
 
-/*
-  Compute a matrix-vector product for bsize = 5
+  As in the bsize = 3 case, the row is accumulated in local variables
+  so that the six components can be computed with packed operations.
 */
 void BVecInterpMultAdd6( int bsize, int nrows, 
                          const int *rowp, const int *cols,
                          const TacsScalar *w,
                          const TacsScalar *x, TacsScalar *y ){
-  for ( int i = 0; i < nrows; i++ ){
-    int j = rowp[i];
-    int end = rowp[i+1];
-    
-    for (; j < end; j++ ){
-      y[6*i]   += w[0]*x[6*cols[j]];
-      y[6*i+1] += w[0]*x[6*cols[j]+1];
-      y[6*i+2] += w[0]*x[6*cols[j]+2];
-      y[6*i+3] += w[0]*x[6*cols[j]+3];
-      y[6*i+4] += w[0]*x[6*cols[j]+4];
-      y[6*i+5] += w[0]*x[6*cols[j]+5];
-      w++;
-    }
-  }
-}
-
-/*
-  Compute the matrix-vector transpose product for bsize = 6
-*/
-void BVecInterpMultTransposeAdd6( int bsize, int nrows, 
-                                  const int *rowp, const int *cols,
-                                  const TacsScalar *w,
-                                  const TacsScalar *x, TacsScalar *y ){
-  for ( int i = 0; i < nrows; i++ ){
+  for ( int i = 0; i < nrows; i++, y += 6 ){
     int j = rowp[i];
     int end = rowp[i+1];
 
+    TacsScalar y0 = 0.0, y1 = 0.0, y2 = 0.0;
+    TacsScalar y3 = 0.0, y4 = 0.0, y5 = 0.0;
     for (; j < end; j++ ){
-      y[6*cols[j]]   += w[0]*x[6*i];
-      y[6*cols[j]+1] += w[0]*x[6*i+1];
-      y[6*cols[j]+2] += w[0]*x[6*i+2];
-      y[6*cols[j]+3] += w[0]*x[6*i+3];
-      y[6*cols[j]+4] += w[0]*x[6*i+4];
-      y[6*cols[j]+5] += w[0]*x[6*i+5];
+      const TacsScalar *xj = &x[6*cols[j]];
+      y0 += w[0]*xj[0];
+      y1 += w[0]*xj[1];
+      y2 += w[0]*xj[2];
+      y3 += w[0]*xj[3];
+      y4 += w[0]*xj[4];
+      y5 += w[0]*xj[5];
       w++;
     }
+
+    y[0] += y0;
+    y[1] += y1;
+    y[2] += y2;
+    y[3] += y3;
+    y[4] += y4;
+    y[5] += y5;
   }
 }
@@ -58,6 +58,14 @@
 
   This class is used extensively in the TACS implementation of
   multigrid.
+
+  The transpose of the local and external weights is stored in CSR
+  format when the interpolation is initialized. As a result, the
+  transpose operations gather the contributions to each output row,
+  rather than scattering the contributions from each input row. Both
+  the forward and transpose products are then computed row-by-row
+  and are threaded using the TACSThreadInfo object from the output
+  TACSAssembler object, or the object set with setThreadInfo().
 */
 class TACSBVecInterp : public TACSObject {
  public:
@@ -70,6 +78,10 @@ class TACSBVecInterp : public TACSObject {
   void addInterp( int vNum, TacsScalar weights[], int inNums[], int size );
   void initialize();
 
+  // Set the thread information used for the products
+  // ------------------------------------------------
+  void setThreadInfo( TACSThreadInfo *_thread_info );
+
   // Perform the foward interpolation
   // --------------------------------
   void mult( TACSBVec *in, TACSBVec *out );
@@ -84,10 +96,22 @@ class TACSBVecInterp : public TACSObject {
   // --------------------------------------------
   void multWeightTranspose( TACSBVec *in, TACSBVec *out );
 
+  // Restrict the residual of a matrix in a single pass
+  // --------------------------------------------------
+  void multTransposeResidual( TACSPMat *mat, TACSBVec *bvec, 
+                              TACSBVec *xvec, TACSBVec *out );
+
   // Print the interpolation
   // -----------------------
   void printInterp( const char *filename );
 
+  // Access the variable maps and the interpolation weights
+  // ------------------------------------------------------
+  TACSVarMap *getInputMap(){ return inMap; }
+  TACSVarMap *getOutputMap(){ return outMap; }
+  int getGlobalWeights( int **_rowp, int **_cols, 
+                        TacsScalar **_weights );
+
  private:
   // The MPI communicator
   MPI_Comm comm;
@@ -95,14 +119,26 @@ class TACSBVecInterp : public TACSObject {
   // Initialize the distribution object
   void init( TACSVarMap *_inMap, TACSVarMap *_outMap, int _bsize );
 
+  // Compute the residual and its restriction for a range of rows
+  void residualRows( int start, int end, int var_offset,
+                     const int *arowp, const int *acols,
+                     const TacsScalar *avals,
+                     const int *browp, const int *bcols,
+                     const TacsScalar *bvals,
+                     const TacsScalar *b, const TacsScalar *x,
+                     TacsScalar *out );
+
+  // Compute y += A*x for the CSR weight matrix A, using threads
+  // when the thread information is set
+  void multAddRows( int nrows, const int *_rowp, const int *_cols,
+                    const TacsScalar *_weights,
+                    const TacsScalar *x, TacsScalar *y );
+  static void *multAddRows_thread( void *t );
+
   void (*multadd)( int bsize, int nrows, 
                    const int *rowp, const int *cols,
                    const TacsScalar *weights,
                    const TacsScalar *x, TacsScalar *y );
-  void (*multtransadd)( int bsize, int nrows, 
-                        const int *rowp, const int *cols,
-                        const TacsScalar *weights,
-                        const TacsScalar *x, TacsScalar *y );
 
   // The on and off-processor parts of the interpolation
   // These are dynamically expanded if they are not large enough
@@ -125,6 +161,24 @@ class TACSBVecInterp : public TACSObject {
   int num_ext_vars; // The number of external variables
   TacsScalar *x_ext; // Variable values from other processors
 
+  // The transpose of the local weights (M rows) and the external
+  // weights (num_ext_vars rows)
+  int *trowp, *tcols;
+  TacsScalar *tweights;
+  int *ext_trowp, *ext_tcols;
+  TacsScalar *ext_tweights;
+
+  // The pthread data for the products
+  TACSThreadInfo *thread_info;
+  pthread_t threads[TACSThreadInfo::TACS_MAX_NUM_THREADS];
+  pthread_mutex_t thread_mutex;
+
+  // The arguments for the threaded product and the next row
+  int thread_nrows, thread_next_row;
+  const int *thread_rowp, *thread_cols;
+  const TacsScalar *thread_weights, *thread_x;
+  TacsScalar *thread_y;
+
   // The number of local rows from outMap
   int N, M, bsize;
   TACSVarMap *inMap, *outMap;
@@ -139,6 +193,91 @@ class TACSBVecInterp : public TACSObject {
   // external variables
   TACSBVecDistribute *vecDist;
   TACSBVecDistCtx *ctx;
+
+  // The matrix and external values used to compute the residual
+  TACSPMat *res_mat;
+  TACSBVecDistCtx *res_ctx;
+  TacsScalar *res_ext;
+};
+
+/*
+  Compute the Galerkin product P^{T}*A*P
+
+  The TACSGalerkinProduct class forms the coarse operator P^{T}*A*P
+  from the interpolation P, stored in a TACSBVecInterp object, and a
+  fine matrix A in the TACSPMat format. This is used to form the
+  coarse operators within multigrid without assembling a
+  finite-element model on each coarse level.
+
+  The non-zero pattern of the product and the communication pattern
+  are computed once in the constructor. This requires the rows of
+  the interpolation associated with the external columns of A, which
+  are collected from the processors that own them. Each processor
+  computes the contributions to P^{T}*A*P from its local rows of A.
+  The rows of the product owned by other processors are sent to their
+  owners and added to the coarse matrix there.
+
+  Coarse matrices with the non-zero pattern of the product are
+  created with createMat() or createFEMat(). The FEMat places all the
+  variables in the Schur complement so that PcScMat factors the full
+  coarse operator with the parallel PDMat solver.
+*/
+class TACSGalerkinProduct : public TACSObject {
+ public:
+  TACSGalerkinProduct( TACSBVecInterp *_interp, TACSPMat *_mat );
+  ~TACSGalerkinProduct();
+
+  // Create matrices with the non-zero pattern of the product
+  // --------------------------------------------------------
+  TACSDistMat *createMat( TACSThreadInfo *thread_info );
+  FEMat *createFEMat( TACSThreadInfo *thread_info );
+
+  // Compute the product and set the values in the coarse matrix
+  // -----------------------------------------------------------
+  void computeProduct( TACSMat *coarse );
+
+ private:
+  // Compute the coarse columns coupled to a fine row of A
+  int getFineRowPattern( int row, int *pattern );
+
+  // Compute the pattern of the coarse rows owned by this processor
+  int getCoarsePattern( int **_vars, int **_rowp, int **_cols );
+
+  // Add a row of the product to the coarse matrix
+  void addCoarseRow( TACSMat *coarse, int row, int ncols,
+                     const int *cols, const TacsScalar *vals );
+
+  // The communicator and the matrix/interpolation objects
+  MPI_Comm comm;
+  TACSBVecInterp *interp;
+  TACSPMat *mat;
+  TACSVarMap *coarse_map;
+  int bsize;
+
+  // The rows of P associated with the local rows of A. The entries
+  // in pindex store the location of each column in crows.
+  int nrows, *prowp, *pcols, *pindex;
+  TacsScalar *pweights;
+
+  // The rows of P associated with the external columns of A
+  int next, *erowp, *ecols;
+  TacsScalar *eweights;
+
+  // The coarse rows with contributions from this processor
+  int ncrows, *crows, *crowp, *ccols;
+  TacsScalar *cvals;
+
+  // The range of crows sent to each processor
+  int *send_ptr;
+
+  // The coarse rows received from other processors
+  int *recv_ptr, *recv_rows, *recv_rowp, *recv_cols;
+  TacsScalar *recv_vals;
+
+  // Temporary storage for the fine rows and the coarse values
+  int max_pattern_size, *pattern;
+  int max_row_size;
+  TacsScalar *row_vals;
 };
 
 #endif // TACS_BVEC_INTERP_H
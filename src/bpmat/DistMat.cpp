@@ -73,6 +73,11 @@ TACSDistMat::TACSDistMat( TACSThreadInfo *thread_info,
                           TACSBVecIndices *bindex ){
   comm = map->getMPIComm();
 
+  // No element assembly map by default
+  elem_map_size = 0;
+  elem_map_ptr = NULL;
+  elem_map = NULL;
+
   int mpiRank, mpiSize;
   MPI_Comm_rank(comm, &mpiRank);
   MPI_Comm_size(comm, &mpiSize);
@@ -319,6 +324,9 @@ TACSDistMat::~TACSDistMat(){
 
   delete [] in_A;
   delete [] ext_A;
+
+  if (elem_map_ptr){ delete [] elem_map_ptr; }
+  if (elem_map){ delete [] elem_map; }
   
   if (nsends > 0){
     delete [] sends;
@@ -818,6 +826,170 @@ void TACSDistMat::addValues( int nrow, const int *row,
   if (temp){ delete [] temp; }
 }
 
+/*
+  Pre-compute the location of each element matrix block
+
+  For each element, the map stores the destination of every block
+  within either the diagonal matrix (Aloc), the off-diagonal matrix
+  (Bext) or the values destined for other processors (ext_A). This
+  avoids the searches in addValues() during repeated assembly with the
+  same connectivity. Elements with dependent nodes (negative node
+  numbers), or with entries outside the non-zero pattern, are not
+  included in the map and must be added with addValues() or
+  addWeightValues().
+
+  input:
+  num_elements:  the number of elements
+  elem_ptr:      pointer into the connectivity for each element
+  elem_conn:     the global node numbers for each element
+*/
+void TACSDistMat::initElementMap( int num_elements, const int *elem_ptr,
+                                  const int *elem_conn ){
+  if (elem_map_ptr){ delete [] elem_map_ptr; }
+  if (elem_map){ delete [] elem_map; }
+
+  int mpiRank;
+  MPI_Comm_rank(comm, &mpiRank);
+
+  const int *ownerRange;
+  rmap->getOwnerRange(&ownerRange);
+
+  // The lower/upper variable ranges
+  int lower = ownerRange[mpiRank];
+  int upper = ownerRange[mpiRank+1];
+
+  // Find the size of the map and the largest element
+  int max_nodes = 0, size = 0;
+  for ( int i = 0; i < num_elements; i++ ){
+    int n = elem_ptr[i+1] - elem_ptr[i];
+    if (n > max_nodes){ max_nodes = n; }
+    size += n*n;
+  }
+
+  elem_map_size = num_elements;
+  elem_map_ptr = new int[ num_elements+1 ];
+  elem_map = new int[ size ];
+  int *acols = new int[ 2*max_nodes ];
+  int *bcols = &acols[max_nodes];
+
+  elem_map_ptr[0] = 0;
+  for ( int elem = 0; elem < num_elements; elem++ ){
+    const int *nodes = &elem_conn[elem_ptr[elem]];
+    int n = elem_ptr[elem+1] - elem_ptr[elem];
+    int *emap = &elem_map[elem_map_ptr[elem]];
+
+    // Convert the columns to the local/off-diagonal indices
+    int fail = 0;
+    for ( int j = 0; j < n; j++ ){
+      int c = nodes[j];
+      acols[j] = bcols[j] = -1;
+      if (c >= lower && c < upper){
+        acols[j] = c - lower;
+      }
+      else if (c >= 0){
+        int *item = (int*)bsearch(&c, col_map_vars, col_map_size,
+                                  sizeof(int), FElibrary::comparator);
+        if (item){
+          bcols[j] = item - col_map_vars;
+        }
+        else {
+          fail = 1;
+        }
+      }
+      else {
+        fail = 1;
+      }
+    }
+
+    // Find the destination of each block in the element matrix
+    for ( int i = 0; i < n && !fail; i++ ){
+      int r = nodes[i];
+      if (r >= lower && r < upper){
+        r = r - lower;
+        for ( int j = 0; j < n; j++, emap++ ){
+          int k = -1;
+          if (acols[j] >= 0){
+            k = Aloc->findBlock(r, acols[j]);
+            emap[0] = 4*k;
+          }
+          else if (r - Np >= 0){
+            k = Bext->findBlock(r - Np, bcols[j]);
+            emap[0] = 4*k + 1;
+          }
+          if (k < 0){
+            fail = 1;
+            break;
+          }
+        }
+      }
+      else {
+        int *item = (int*)bsearch(&r, ext_rows, next_rows,
+                                  sizeof(int), FElibrary::comparator);
+        if (item){
+          int r_ext = item - ext_rows;
+          int start = ext_rowp[r_ext];
+          int row_size = ext_rowp[r_ext+1] - start;
+
+          for ( int j = 0; j < n; j++, emap++ ){
+            item = (int*)bsearch(&nodes[j], &ext_cols[start], row_size,
+                                 sizeof(int), FElibrary::comparator);
+            if (item){
+              emap[0] = 4*(item - ext_cols) + 2;
+            }
+            else {
+              fail = 1;
+              break;
+            }
+          }
+        }
+        else {
+          fail = 1;
+        }
+      }
+    }
+
+    // Leave the element out of the map if it could not be found
+    elem_map_ptr[elem+1] = elem_map_ptr[elem];
+    if (!fail){
+      elem_map_ptr[elem+1] += n*n;
+    }
+  }
+
+  delete [] acols;
+}
+
+/*
+  Add the element matrix using the pre-computed assembly map
+
+  input:
+  elem:    the element index used in initElementMap()
+  nv:      the number of rows/columns in the element matrix
+  values:  the element matrix
+  matOr:   the orientation of the element matrix
+
+  returns: 1 if the values were added, 0 if the element is not in
+  the map
+*/
+int TACSDistMat::addElementValues( int elem, int nv,
+                                   const TacsScalar *values,
+                                   MatrixOrientation matOr ){
+  if (elem >= 0 && elem < elem_map_size){
+    int bsize = Aloc->getBlockSize();
+    int nnodes = nv/bsize;
+    int ptr = elem_map_ptr[elem];
+    if (nnodes > 0 && elem_map_ptr[elem+1] - ptr == nnodes*nnodes){
+      TacsScalar *A[3];
+      Aloc->getArrays(NULL, NULL, NULL, NULL, NULL, &A[0]);
+      Bext->getArrays(NULL, NULL, NULL, NULL, NULL, &A[1]);
+      A[2] = ext_A;
+      BCSRMat::addElementBlocks(bsize, nnodes, &elem_map[ptr], A,
+                                nv, values, matOr);
+      return 1;
+    }
+  }
+  return 0;
+}
+
 /*
   Add a weighted sum of the dense input matrix.
 
@@ -47,6 +47,10 @@ class TACSDistMat : public TACSPMat {
                         const TacsScalar *weights,
                         int nv, int mv, const TacsScalar *values,
                         MatrixOrientation matOr=NORMAL );
+  void initElementMap( int num_elements, const int *elem_ptr,
+                       const int *elem_conn );
+  int addElementValues( int elem, int nv, const TacsScalar *values,
+                        MatrixOrientation matOr=NORMAL );
   void beginAssembly();
   void endAssembly();
   
@@ -98,6 +102,11 @@ class TACSDistMat : public TACSPMat {
   // Pointer to incoming data
   TacsScalar *in_A; 
 
+  // The pre-computed element assembly map
+  // -------------------------------------
+  int elem_map_size;
+  int *elem_map_ptr, *elem_map;
+
   // Information for the persistent communication set up
   // ---------------------------------------------------
   int nsends, nreceives;
@@ -91,6 +91,11 @@ FEMat::FEMat( TACSThreadInfo *thread_info, TACSVarMap *_rmap,
               const int *rowp, const int *cols,
               TACSBVecIndices *b_local_indices, TACSBVecDistribute *_b_map,
               TACSBVecIndices *c_local_indices, TACSBVecDistribute *_c_map ){
+  // No element assembly map by default
+  elem_map_size = 0;
+  elem_map_ptr = NULL;
+  elem_map = NULL;
+
   // Get the block size
   int rank;
   MPI_Comm_rank(_rmap->getMPIComm(), &rank);
@@ -297,7 +302,10 @@ FEMat::FEMat( TACSThreadInfo *thread_info, TACSVarMap *_rmap,
   init(_rmap, _B, _E, _F, _C, _b_map, _c_map);
 }
 
-FEMat::~FEMat(){}
+FEMat::~FEMat(){
+  if (elem_map_ptr){ delete [] elem_map_ptr; }
+  if (elem_map){ delete [] elem_map; }
+}
 
 /*!
   Add the values into the appropriate block matrix.
@@ -395,6 +403,134 @@ void FEMat::addValues( int nrow, const int *row,
   if (temp){ delete [] temp; }
 }
 
+/*
+  Pre-compute the location of each element matrix block
+
+  For each element, the map stores the destination of every block
+  within one of the B, E, F or C matrices. This avoids the index
+  look-ups and searches in addValues() during repeated assembly with
+  the same connectivity. Elements with dependent nodes (negative node
+  numbers), or with entries outside the non-zero pattern, are not
+  included in the map and must be added with addValues() or
+  addWeightValues().
+
+  input:
+  num_elements:  the number of elements
+  elem_ptr:      pointer into the connectivity for each element
+  elem_conn:     the global node numbers for each element
+*/
+void FEMat::initElementMap( int num_elements, const int *elem_ptr,
+                            const int *elem_conn ){
+  if (elem_map_ptr){ delete [] elem_map_ptr; }
+  if (elem_map){ delete [] elem_map; }
+
+  TACSBVecIndices *bindx = b_map->getIndices();
+  TACSBVecIndices *cindx = c_map->getIndices();
+
+  // Find the size of the map and the largest element
+  int max_nodes = 0, size = 0;
+  for ( int i = 0; i < num_elements; i++ ){
+    int n = elem_ptr[i+1] - elem_ptr[i];
+    if (n > max_nodes){ max_nodes = n; }
+    size += n*n;
+  }
+
+  elem_map_size = num_elements;
+  elem_map_ptr = new int[ num_elements+1 ];
+  elem_map = new int[ size ];
+  int *bvars = new int[ 2*max_nodes ];
+  int *cvars = &bvars[max_nodes];
+
+  elem_map_ptr[0] = 0;
+  for ( int elem = 0; elem < num_elements; elem++ ){
+    const int *nodes = &elem_conn[elem_ptr[elem]];
+    int n = elem_ptr[elem+1] - elem_ptr[elem];
+    int *emap = &elem_map[elem_map_ptr[elem]];
+
+    // Convert the nodes to the local B/C indices
+    int fail = 0;
+    for ( int j = 0; j < n; j++ ){
+      bvars[j] = cvars[j] = -1;
+      if (nodes[j] >= 0){
+        bvars[j] = bindx->findIndex(nodes[j]);
+        if (bvars[j] < 0){
+          cvars[j] = cindx->findIndex(nodes[j]);
+        }
+      }
+      if (bvars[j] < 0 && cvars[j] < 0){
+        fail = 1;
+      }
+    }
+
+    // Find the destination of each block in the element matrix
+    for ( int i = 0; i < n && !fail; i++ ){
+      for ( int j = 0; j < n; j++, emap++ ){
+        int k = -1;
+        if (bvars[i] >= 0 && bvars[j] >= 0){
+          k = B->findBlock(bvars[i], bvars[j]);
+          emap[0] = 4*k;
+        }
+        else if (bvars[i] >= 0){
+          k = E->findBlock(bvars[i], cvars[j]);
+          emap[0] = 4*k + 1;
+        }
+        else if (bvars[j] >= 0){
+          k = F->findBlock(cvars[i], bvars[j]);
+          emap[0] = 4*k + 2;
+        }
+        else {
+          k = C->findBlock(cvars[i], cvars[j]);
+          emap[0] = 4*k + 3;
+        }
+        if (k < 0){
+          fail = 1;
+          break;
+        }
+      }
+    }
+
+    // Leave the element out of the map if it could not be found
+    elem_map_ptr[elem+1] = elem_map_ptr[elem];
+    if (!fail){
+      elem_map_ptr[elem+1] += n*n;
+    }
+  }
+
+  delete [] bvars;
+}
+
+/*
+  Add the element matrix using the pre-computed assembly map
+
+  input:
+  elem:    the element index used in initElementMap()
+  nv:      the number of rows/columns in the element matrix
+  values:  the element matrix
+  matOr:   the orientation of the element matrix
+
+  returns: 1 if the values were added, 0 if the element is not in
+  the map
+*/
+int FEMat::addElementValues( int elem, int nv, const TacsScalar *values,
+                             MatrixOrientation matOr ){
+  if (elem >= 0 && elem < elem_map_size){
+    int bsize = B->getBlockSize();
+    int nnodes = nv/bsize;
+    int ptr = elem_map_ptr[elem];
+    if (nnodes > 0 && elem_map_ptr[elem+1] - ptr == nnodes*nnodes){
+      TacsScalar *A[4];
+      B->getArrays(NULL, NULL, NULL, NULL, NULL, &A[0]);
+      E->getArrays(NULL, NULL, NULL, NULL, NULL, &A[1]);
+      F->getArrays(NULL, NULL, NULL, NULL, NULL, &A[2]);
+      C->getArrays(NULL, NULL, NULL, NULL, NULL, &A[3]);
+      BCSRMat::addElementBlocks(bsize, nnodes, &elem_map[ptr], A,
+                                nv, values, matOr);
+      return 1;
+    }
+  }
+  return 0;
+}
+
 /*
   Add a weighted sum of the dense input matrix.
 
@@ -65,8 +65,17 @@ class FEMat : public ScMat {
                         const TacsScalar *weights,
                         int nv, int mv, const TacsScalar *values,
                         MatrixOrientation matOr=NORMAL );
+  void initElementMap( int num_elements, const int *elem_ptr,
+                       const int *elem_conn );
+  int addElementValues( int elem, int nv, const TacsScalar *values,
+                        MatrixOrientation matOr=NORMAL );
   void applyBCs( TACSBcMap *bcmap );
   TACSVec *createVec();
+
+ private:
+  // The pre-computed element assembly map
+  int elem_map_size;
+  int *elem_map_ptr, *elem_map;
 };
 
 #endif // TACS_FE_MATRIX_H
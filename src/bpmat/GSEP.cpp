@@ -175,6 +175,16 @@ TacsScalar EPGeneralizedShiftInvert::dot( TACSVec *x, TACSVec *y ){
   return temp->dot(x); 
 }
 
+/*
+  Compute ans[i] = <x,y[i]> = x^{T} inner y[i] using a single product
+  with the inner product matrix
+*/
+void EPGeneralizedShiftInvert::mdot( TACSVec *x, TACSVec **y,
+                                     TacsScalar *ans, int m ){
+  inner->mult(x, temp);
+  temp->mdot(y, ans, m);
+}
+
 /*
   Compute ||B*x|| - this is used to compute the eigenvalue error
 */
@@ -241,6 +251,13 @@ TacsScalar EPBucklingShiftInvert::dot( TACSVec *x, TACSVec *y ){
   return temp->dot(x); 
 }
 
+// Compute ans[i] = <x,y[i]> = x^{T} inner y[i]
+void EPBucklingShiftInvert::mdot( TACSVec *x, TACSVec **y,
+                                  TacsScalar *ans, int m ){
+  inner->mult(x, temp);
+  temp->mdot(y, ans, m);
+}
+
 // Compute || B * x || - this is used to compute the eigenvalue error
 TacsScalar EPBucklingShiftInvert::errorNorm( TACSVec *x ){ 
   inner->mult(x, temp); 
@@ -384,6 +401,39 @@ static void ComputeEigsTriDiag( int n,
   delete [] upper;
 }
 
+/*
+  Orthogonalize the vector w against the first n vectors in Q using
+  classical Gram-Schmidt with one round of re-orthogonalization. The
+  projection coefficients are added to h. Each pass requires a single
+  multiple inner product so that the number of reductions does not
+  grow with the size of the subspace.
+
+  input:
+  Op:     the eigenproblem operator that defines the inner product
+  Q:      the orthonormal vectors
+  w:      the vector to orthogonalize
+  n:      the number of vectors in Q
+  h:      the projection coefficients (added to the values on input)
+  work:   temporary array of length n
+
+  returns: the norm of the orthogonalized vector
+*/
+static TacsScalar OrthogonalizeVec( EPOperator *Op, TACSVec **Q,
+                                    TACSVec *w, int n, double *h,
+                                    TacsScalar *work ){
+  for ( int pass = 0; pass < 2; pass++ ){
+    if (n > 0){
+      Op->mdot(w, Q, work, n);
+    }
+    for ( int i = 0; i < n; i++ ){
+      w->axpy(-work[i], Q[i]);
+      h[i] += TacsRealPart(work[i]);
+    }
+  }
+
+  return sqrt(Op->dot(w, w));
+}
+
 /*
   Create the symmetric eigenvalue problem solver
 
@@ -437,6 +487,21 @@ SEP::SEP( EPOperator *_Op, int _max_iters, OrthoType _ortho_type,
     Q[i] = Op->createVec();
     Q[i]->incref();      
   }
+
+  // By default, the Krylov-Schur method is not used
+  block_size = 1;
+  max_restarts = 0;
+  nlocked = 0;
+  W = NULL;
+  H = NULL;
+  ritzvals = NULL;
+  ritzvecs = NULL;
+  rwork = NULL;
+  ritzerr = NULL;
+
+  // By default, the eigenvectors are not recycled
+  nrecycle = 0;
+  R = NULL;
 }
 
 /*
@@ -444,11 +509,30 @@ SEP::SEP( EPOperator *_Op, int _max_iters, OrthoType _ortho_type,
 */
 SEP::~SEP(){
   Op->decref();
-  for ( int i = 0; i < max_iters+1; i++ ){
+  for ( int i = 0; i < max_iters+block_size; i++ ){
     Q[i]->decref();
   }
   delete [] Q;
 
+  if (W){
+    for ( int i = 0; i < max_iters-block_size; i++ ){
+      W[i]->decref();
+    }
+    delete [] W;
+    delete [] H;
+    delete [] ritzvals;
+    delete [] ritzvecs;
+    delete [] rwork;
+    delete [] ritzerr;
+  }
+
+  if (R){
+    for ( int i = 0; i < nrecycle; i++ ){
+      R[i]->decref();
+    }
+    delete [] R;
+  }
+
   if (bcs){ bcs->decref(); }
   
   delete [] Alpha;
@@ -465,6 +549,236 @@ void SEP::setOrthoType( enum OrthoType _ortho_type ){
   ortho_type = _ortho_type;
 }
 
+/*
+  Use a block Lanczos method with thick (Krylov-Schur) restarts
+
+  The subspace of size max_iters is expanded by block_size vectors at
+  a time. Once the subspace is full, the Ritz vectors closest to the
+  desired end of the spectrum are retained and the remainder are
+  discarded. Converged Ritz vectors are locked so that they are no
+  longer updated, but all new vectors are orthogonalized against them.
+
+  input:
+  block_size:    the number of vectors in each block
+  max_restarts:  the maximum number of restarts
+*/
+void SEP::setKrylovSchur( int _block_size, int _max_restarts ){
+  if (_block_size < 1){
+    _block_size = 1;
+  }
+  if (2*_block_size > max_iters){
+    fprintf(stderr, "SEP: Block size %d too large for subspace size %d\n",
+            _block_size, max_iters);
+    _block_size = max_iters/2;
+    if (_block_size < 1){ _block_size = 1; }
+  }
+
+  // Free the existing restart data
+  if (W){
+    for ( int i = 0; i < max_iters-block_size; i++ ){
+      W[i]->decref();
+    }
+    delete [] W;
+    delete [] H;
+    delete [] ritzvals;
+    delete [] ritzvecs;
+    delete [] rwork;
+    delete [] ritzerr;
+  }
+
+  // Re-size the subspace so that it can store max_iters vectors
+  // and the extra residual block
+  TACSVec **Qnew = new TACSVec*[ max_iters+_block_size ];
+  for ( int i = 0; i < max_iters+_block_size; i++ ){
+    if (i < max_iters+block_size){
+      Qnew[i] = Q[i];
+    }
+    else {
+      Qnew[i] = Op->createVec();
+      Qnew[i]->incref();
+    }
+  }
+  for ( int i = max_iters+_block_size; i < max_iters+block_size; i++ ){
+    Q[i]->decref();
+  }
+  delete [] Q;
+  Q = Qnew;
+
+  block_size = _block_size;
+  max_restarts = _max_restarts;
+
+  // Allocate the vectors used to form the retained Ritz vectors
+  W = new TACSVec*[ max_iters-block_size ];
+  for ( int i = 0; i < max_iters-block_size; i++ ){
+    W[i] = Op->createVec();
+    W[i]->incref();
+  }
+
+  // Allocate the data for the projected problem
+  H = new double[ (max_iters+block_size)*max_iters ];
+  ritzvals = new double[ max_iters ];
+  ritzvecs = new double[ max_iters*max_iters ];
+  rwork = new double[ 4*max_iters ];
+  ritzerr = new TacsScalar[ max_iters ];
+}
+
+/*
+  Set the number of eigenvectors from the previous solve that are
+  used to start the next solve.
+
+  This is useful when a sequence of closely related eigenproblems is
+  solved, for instance during a design optimization. The previous
+  eigenvectors are extracted at the start of the next solve. With the
+  Lanczos method the starting vector is their sum. With the block
+  Krylov-Schur method, a Rayleigh-Ritz step with the new operator is
+  performed on the previous eigenvectors and the resulting Ritz
+  vectors are distributed between the vectors of the starting block.
+
+  input:
+  nrecycle:  the number of eigenvectors to recycle
+*/
+void SEP::setRecycle( int _nrecycle ){
+  if (_nrecycle > max_iters){
+    _nrecycle = max_iters;
+  }
+  if (_nrecycle < 0){
+    _nrecycle = 0;
+  }
+
+  // Free the existing vectors
+  if (R){
+    for ( int i = 0; i < nrecycle; i++ ){
+      R[i]->decref();
+    }
+    delete [] R;
+    R = NULL;
+  }
+
+  nrecycle = _nrecycle;
+  if (nrecycle > 0){
+    R = new TACSVec*[ nrecycle ];
+    for ( int i = 0; i < nrecycle; i++ ){
+      R[i] = Op->createVec();
+      R[i]->incref();
+    }
+  }
+}
+
+/*
+  Set the initial vectors in Q[0],...,Q[p-1] from the eigenvectors of
+  the previous solve. The vectors are not orthonormalized.
+
+  input:
+  p:  the number of initial vectors required
+
+  returns: the number of initial vectors that were set
+*/
+int SEP::initSubspace( int p ){
+  if (nrecycle <= 0 || niters <= 0){
+    return 0;
+  }
+
+  // Extract the previous eigenvectors in the order of the spectrum
+  int nr = (nrecycle < niters ? nrecycle : niters);
+  for ( int i = 0; i < nr; i++ ){
+    TacsScalar error;
+    extractEigenvector(i, R[i], &error);
+    if (bcs){
+      R[i]->applyBCs(bcs);
+    }
+  }
+
+  if (p == 1){
+    // Start from the sum of the normalized eigenvectors
+    Q[0]->zeroEntries();
+    for ( int i = 0; i < nr; i++ ){
+      TacsScalar rnorm = sqrt(Op->dot(R[i], R[i]));
+      if (TacsRealPart(rnorm) > 0.0){
+        Q[0]->axpy(1.0/rnorm, R[i]);
+      }
+    }
+    return 1;
+  }
+  else if (nr <= p || !W){
+    for ( int i = 0; i < nr && i < p; i++ ){
+      Q[i]->copyValues(R[i]);
+    }
+    return (nr < p ? nr : p);
+  }
+
+  // Orthonormalize the previous eigenvectors, discarding any that
+  // are linearly dependent. The number retained is limited by the
+  // number of vectors in W.
+  int nw = max_iters - block_size;
+  TacsScalar *work = new TacsScalar[ nr ];
+  double *hwork = new double[ nr ];
+  int n = 0;
+  for ( int i = 0; i < nr && n < nw; i++ ){
+    TacsScalar rnorm = sqrt(Op->dot(R[i], R[i]));
+    TacsScalar norm = OrthogonalizeVec(Op, R, R[i], n, hwork, work);
+    if (TacsRealPart(norm) > 1e-8*TacsRealPart(rnorm)){
+      R[i]->scale(1.0/norm);
+      TACSVec *t = R[n];
+      R[n] = R[i];
+      R[i] = t;
+      n++;
+    }
+  }
+
+  // Form the projected matrix T = R^{T}*B*A*R with the new operator
+  Op->multBlock(n, R, W);
+  for ( int j = 0; j < n; j++ ){
+    if (bcs){
+      W[j]->applyBCs(bcs);
+    }
+    Op->mdot(W[j], R, work, j+1);
+    for ( int i = 0; i <= j; i++ ){
+      ritzvecs[i + n*j] = TacsRealPart(work[i]);
+    }
+  }
+
+  // Compute the Ritz values and vectors
+  int info;
+  int lwork = 4*max_iters;
+  const char *jobz = "V", *uplo = "U";
+  LAPACKdsyev(jobz, uplo, &n, ritzvecs, &n, ritzvals,
+              rwork, &lwork, &info);
+  if (info != 0){
+    fprintf(stderr, "SEP: Error encountered in LAPACK function dsyev\n");
+  }
+
+  // Select the best Ritz vectors for the desired spectrum
+  for ( int i = 0; i < n; i++ ){
+    eigs[i] = ritzvals[i];
+  }
+  sortEigenvalues(eigs, n, perm);
+
+  // Distribute the Ritz vectors between the vectors in the starting
+  // block so that the block spans all of them in a few iterations
+  int ninit = (n < p ? n : p);
+  for ( int q = 0; q < ninit; q++ ){
+    for ( int j = 0; j < n; j++ ){
+      hwork[j] = 0.0;
+    }
+    for ( int i = q; i < n; i += p ){
+      const double *y = &ritzvecs[n*perm[i]];
+      for ( int j = 0; j < n; j++ ){
+        hwork[j] += y[j];
+      }
+    }
+
+    Q[q]->zeroEntries();
+    for ( int j = 0; j < n; j++ ){
+      Q[q]->axpy(hwork[j], R[j]);
+    }
+  }
+
+  delete [] work;
+  delete [] hwork;
+
+  return ninit;
+}
+
 /*
   Set the tolerances to use, the desired spectrum, and the number of
   eigenvalues that are requested in the solve
@@ -494,8 +808,16 @@ void SEP::setOperator( EPOperator *_Op ){
   series or orthonormal vectors with respect to a given inner product.
 */
 void SEP::solve( KSMPrint *ksm_print, KSMPrint *ksm_file ){
-  // Select the initial vector randomly
-  Q[0]->setRand();
+  if (W){
+    solveKrylovSchur(ksm_print, ksm_file);
+    return;
+  }
+
+  // Select the initial vector from the previous eigenvectors if they
+  // are recycled, otherwise select it randomly
+  if (!initSubspace(1)){
+    Q[0]->setRand();
+  }
   if (bcs){
     Q[0]->applyBCs(bcs);
   }
@@ -618,6 +940,12 @@ TacsScalar SEP::extractEigenvalue( int n, TacsScalar *error ){
   }
 
   n = perm[n];
+
+  // The Ritz vectors are stored explicitly by the Krylov-Schur method
+  if (W){
+    *error = ritzerr[n];
+    return Op->convertEigenvalue(eigs[n]);
+  }
   
   TacsScalar er = Op->errorNorm(Q[niters]);
   *error = fabs(TacsRealPart(Beta[niters-1]*eigvecs[n*niters + (niters-1)]*er));
@@ -642,6 +970,13 @@ TacsScalar SEP::extractEigenvector( int n, TACSVec *ans,
   }
 
   n = perm[n];
+
+  // The Ritz vectors are stored explicitly by the Krylov-Schur method
+  if (W){
+    ans->copyValues(Q[n]);
+    *error = ritzerr[n];
+    return Op->convertEigenvalue(eigs[n]);
+  }
   
   ans->zeroEntries();
   for ( int i = 0; i < niters; i++ ){
@@ -714,13 +1049,18 @@ void SEP::sortEigenvalues( TacsScalar *values, int neigs, int *p ){
   int use_abs = (spectrum == SMALLEST_MAGNITUDE || 
                  spectrum == LARGEST_MAGNITUDE);
   int sort_ascending = (spectrum == SMALLEST_MAGNITUDE ||
-                        spectrum == SMALLEST);
+                        spectrum == SMALLEST ||
+                        spectrum == SMALLEST_TRANSFORMED);
+  int use_transformed = (spectrum == SMALLEST_TRANSFORMED);
 
   // Sort the array using insertion sort
   for ( int i = 0; i < neigs; i++ ){
     // Convert the transformed eigenvalue into the correct
     // range
-    TacsScalar eig_new = Op->convertEigenvalue(values[p[i]]);
+    TacsScalar eig_new = values[p[i]];
+    if (!use_transformed){
+      eig_new = Op->convertEigenvalue(eig_new);
+    }
     
     // Take the absolute value of the eigenvalue
     if (use_abs){
@@ -734,7 +1074,10 @@ void SEP::sortEigenvalues( TacsScalar *values, int neigs, int *p ){
     int j = i-1;
     for ( ; j >= 0; j-- ){
       // Convert the j-th eigenvalue
-      TacsScalar eig_j = Op->convertEigenvalue(values[p[j]]);
+      TacsScalar eig_j = values[p[j]];
+      if (!use_transformed){
+        eig_j = Op->convertEigenvalue(eig_j);
+      }
       if (use_abs){ 
         if (TacsRealPart(eig_j) < 0.0){
           eig_j *= -1.0;
@@ -800,3 +1143,277 @@ int SEP::checkConverged( TacsScalar *A, TacsScalar *B, int n ){
 
   return is_converged;
 }
+
+/*
+  Solve the eigenvalue problem using a block Lanczos method with
+  thick restarts (the Krylov-Schur method) and locking.
+
+  The basis Q[0], ..., Q[m-1] with m = max_iters satisfies
+
+  A*Q_{m} = Q_{m}*H_{m} + Q_{r}*B_{r}
+
+  where Q_{r} is the block of block_size residual vectors. The matrix
+  H_{m} is symmetric with respect to the inner product defined by the
+  operator, but is not tridiagonal after a restart. The Rayleigh-Ritz
+  procedure is applied to the active (unlocked) part of the projected
+  matrix after each new block to check for convergence. Once the
+  basis is filled, converged Ritz vectors at the desired end of the
+  spectrum are locked, and the best Ritz vectors are retained,
+  together with the residual block, to restart the method.
+
+  The projected matrix is stored in H (column-major) with leading
+  dimension m + block_size. The operator is applied to a full block
+  at once using EPOperator::multBlock().
+*/
+void SEP::solveKrylovSchur( KSMPrint *ksm_print, KSMPrint *ksm_file ){
+  // The subspace size is a multiple of the block size
+  const int p = block_size;
+  const int m = p*(max_iters/p);
+  const int ldh = m + p;
+
+  // Set the number of vectors to retain after each restart. The
+  // number of new vectors m - nkeep must be a multiple of the block
+  // size.
+  int nkeep = (neigvals + m - p)/2;
+  nkeep = m - p*((m - nkeep + p - 1)/p);
+  if (nkeep < neigvals){
+    nkeep += p;
+  }
+  if (nkeep > m - p){
+    fprintf(stderr, "SEP: Subspace size %d too small for %d eigenvalues "
+            "with block size %d\n", m, neigvals, p);
+    nkeep = m - p;
+  }
+
+  // Allocate temporary arrays
+  TacsScalar *work = new TacsScalar[ ldh ];
+  double *hwork = new double[ ldh ];
+  double *aerr = new double[ m ];
+  double *coupling = new double[ p*m ];
+  int lwork = 4*m;
+
+  // Zero the projected matrix
+  memset(H, 0, ldh*m*sizeof(double));
+  nlocked = 0;
+
+  // Select the initial block from the previous eigenvectors if they
+  // are recycled and fill the remainder randomly
+  int ninit = initSubspace(p);
+  for ( int i = 0; i < p; i++ ){
+    if (i >= ninit){
+      Q[i]->setRand();
+    }
+    if (bcs){
+      Q[i]->applyBCs(bcs);
+    }
+    TacsScalar norm = OrthogonalizeVec(Op, Q, Q[i], i, hwork, work);
+    Q[i]->scale(1.0/norm);
+  }
+
+  // The number of columns of H that have been computed
+  int ncols = 0;
+  int restart = 0, nops = 0;
+
+  // The number of retained Ritz vectors that are not locked
+  int nk = 0;
+
+  while (1){
+    // Expand the subspace by one block
+    if (ncols < m){
+      int j = ncols + p;
+      Op->multBlock(p, &Q[ncols], &Q[j]);
+      nops += p;
+
+      for ( int q = 0; q < p; q++ ){
+        int col = ncols + q;
+        TACSVec *w = Q[j+q];
+        if (bcs){
+          w->applyBCs(bcs);
+        }
+
+        // Orthogonalize against all previous vectors in the basis,
+        // including the locked vectors and the current block
+        double *h = &H[ldh*col];
+        TacsScalar norm = OrthogonalizeVec(Op, Q, w, j+q, h, work);
+
+        // Check for an invariant subspace
+        double hnorm = TacsRealPart(norm)*TacsRealPart(norm);
+        for ( int i = 0; i < j+q; i++ ){
+          hnorm += h[i]*h[i];
+        }
+        if (TacsRealPart(norm) <= 1e-12*sqrt(hnorm)){
+          // Replace the vector with a random vector orthogonal to
+          // the existing basis
+          w->setRand();
+          if (bcs){
+            w->applyBCs(bcs);
+          }
+          norm = OrthogonalizeVec(Op, Q, w, j+q, hwork, work);
+          H[j+q + ldh*col] = 0.0;
+        }
+        else {
+          H[j+q + ldh*col] = TacsRealPart(norm);
+        }
+        w->scale(1.0/norm);
+      }
+      ncols += p;
+    }
+
+    // Check for convergence after each block once the subspace is
+    // large enough. This terminates early when the starting block is
+    // a good approximation of the desired eigenvectors.
+    if (ncols < m && ncols < neigvals){
+      continue;
+    }
+
+    // Compute the Ritz values and vectors of the active part of the
+    // projected matrix. Only the upper triangular part is used.
+    int na = ncols - nlocked;
+    for ( int s = 0; s < na; s++ ){
+      for ( int r = 0; r <= s; r++ ){
+        ritzvecs[r + na*s] = H[(nlocked + r) + ldh*(nlocked + s)];
+      }
+    }
+
+    int info;
+    const char *jobz = "V", *uplo = "U";
+    LAPACKdsyev(jobz, uplo, &na, ritzvecs, &na, ritzvals,
+                rwork, &lwork, &info);
+    if (info != 0){
+      fprintf(stderr, "SEP: Error encountered in LAPACK function dsyev\n");
+    }
+
+    // Compute the norm of the residual block in the inner product
+    double er = 0.0;
+    for ( int q = 0; q < p; q++ ){
+      double e = TacsRealPart(Op->errorNorm(Q[ncols+q]));
+      if (e > er){ er = e; }
+    }
+
+    // Compute the coupling between the Ritz vectors and the residual
+    // block and the corresponding error estimate
+    for ( int i = 0; i < na; i++ ){
+      double r2 = 0.0;
+      for ( int q = 0; q < p; q++ ){
+        double c = 0.0;
+        for ( int s = 0; s < na; s++ ){
+          c += H[(ncols + q) + ldh*(nlocked + s)]*ritzvecs[s + na*i];
+        }
+        coupling[q + p*i] = c;
+        r2 += c*c;
+      }
+      aerr[i] = sqrt(r2)*er;
+      eigs[i] = ritzvals[i];
+    }
+
+    // Sort the Ritz values by the desired spectrum
+    sortEigenvalues(eigs, na, perm);
+
+    // Count the number of newly converged Ritz vectors at the
+    // desired end of the spectrum
+    int nnew = 0;
+    while (nnew < na && nlocked + nnew < neigvals &&
+           aerr[perm[nnew]] <= tol){
+      nnew++;
+    }
+
+    int converged = (nlocked + nnew >= neigvals);
+    if (!converged && ncols < m){
+      continue;
+    }
+    int finished = (converged || restart >= max_restarts);
+
+    // Form the retained Ritz vectors
+    nk = nkeep - nlocked;
+    if (nk > na){
+      nk = na;
+    }
+    for ( int r = 0; r < nk; r++ ){
+      const double *y = &ritzvecs[na*perm[r]];
+      W[r]->zeroEntries();
+      for ( int s = 0; s < na; s++ ){
+        W[r]->axpy(y[s], Q[nlocked + s]);
+      }
+    }
+    for ( int r = 0; r < nk; r++ ){
+      TACSVec *t = Q[nlocked + r];
+      Q[nlocked + r] = W[r];
+      W[r] = t;
+
+      ritzerr[nlocked + r] = aerr[perm[r]];
+    }
+
+    if (finished){
+      // Set the projected matrix for the retained vectors so that the
+      // diagonal entries contain the Ritz values
+      for ( int r = 0; r < nk; r++ ){
+        H[(nlocked + r)*(ldh + 1)] = ritzvals[perm[r]];
+      }
+      break;
+    }
+
+    // Zero the active columns of the projected matrix
+    memset(&H[ldh*nlocked], 0, ldh*(m - nlocked)*sizeof(double));
+
+    // Set the diagonal and the coupling with the residual block. The
+    // newly locked vectors are decoupled from the residual block.
+    for ( int r = 0; r < nk; r++ ){
+      int col = nlocked + r;
+      H[col*(ldh + 1)] = ritzvals[perm[r]];
+      if (r >= nnew){
+        for ( int q = 0; q < p; q++ ){
+          H[(nkeep + q) + ldh*col] = coupling[q + p*perm[r]];
+        }
+      }
+    }
+
+    // Move the residual block to follow the retained vectors
+    for ( int q = 0; q < p; q++ ){
+      TACSVec *t = Q[nkeep + q];
+      Q[nkeep + q] = Q[m + q];
+      Q[m + q] = t;
+    }
+
+    nlocked += nnew;
+    ncols = nkeep;
+    restart++;
+  }
+
+  // Set the converged eigenvalues and sort them
+  niters = nlocked + nk;
+  for ( int i = 0; i < niters; i++ ){
+    eigs[i] = H[i*(ldh + 1)];
+  }
+  sortEigenvalues(eigs, niters, perm);
+
+  // Print out a summary of the eigenvalues and errors
+  if (ksm_print){
+    char line[256];
+    sprintf(line, "Krylov-Schur: %d restarts, %d operator applications\n",
+            restart, nops);
+    ksm_print->print(line);
+    sprintf(line, "%3s %18s %18s %10s\n",
+            " ", "eigenvalue", "shift-invert eig", "error");
+    ksm_print->print(line);
+
+    for ( int i = 0; i < niters; i++ ){
+      int index = perm[i];
+      sprintf(line, "%3d %18.10e %18.10e %10.3e\n",
+              i, TacsRealPart(Op->convertEigenvalue(eigs[index])),
+              TacsRealPart(eigs[index]),
+              TacsRealPart(ritzerr[index]));
+      ksm_print->print(line);
+    }
+  }
+  // Print the number of operator applications to file
+  if (ksm_file){
+    char line[256];
+    sprintf(line, "%2d\n", nops);
+    ksm_file->print(line);
+  }
+
+  delete [] work;
+  delete [] hwork;
+  delete [] aerr;
+  delete [] coupling;
+}
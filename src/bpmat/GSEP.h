@@ -51,10 +51,22 @@ class EPOperator : public TACSObject {
   // -----------------
   virtual void mult( TACSVec *x, TACSVec *y ) = 0;
 
+  // Compute y[i] = A*x[i] for a block of vectors
+  // --------------------------------------------
+  virtual void multBlock( int n, TACSVec **x, TACSVec **y ){
+    for ( int i = 0; i < n; i++ ){ mult(x[i], y[i]); }
+  }
+
   // Compute the inner product <x,y>
   // -------------------------------
   virtual TacsScalar dot( TACSVec *x, TACSVec *y ){ return x->dot(y); }
 
+  // Compute the inner products ans[i] = <x,y[i]>
+  // --------------------------------------------
+  virtual void mdot( TACSVec *x, TACSVec **y, TacsScalar *ans, int m ){
+    x->mdot(y, ans, m);
+  }
+
   // Compute || B *x || - this is used to compute the eigenvalue error
   // ------------------------------------------------------------------
   virtual TacsScalar errorNorm( TACSVec *x ){ return 1.0; }
@@ -122,6 +134,7 @@ class EPGeneralizedShiftInvert : public EPOperator {
   TACSVec *createVec();
   void mult( TACSVec *x, TACSVec *y ); // Compute y = (A - sigma B)^{-1}*inner*x
   TacsScalar dot( TACSVec *x, TACSVec *y ); // Compute <x,y> = x^{T}*inner*y
+  void mdot( TACSVec *x, TACSVec **y, TacsScalar *ans, int m );
   TacsScalar errorNorm( TACSVec *x );
   TacsScalar convertEigenvalue( TacsScalar value );
 
@@ -154,6 +167,7 @@ class EPBucklingShiftInvert : public EPOperator {
   TACSVec *createVec();
   void mult( TACSVec *x, TACSVec *y ); // Compute y = (A - sigma B)^{-1}*inner*x
   TacsScalar dot( TACSVec *x, TACSVec *y ); // Compute <x,y> = x^{T}*inner*y
+  void mdot( TACSVec *x, TACSVec **y, TacsScalar *ans, int m );
   TacsScalar errorNorm( TACSVec *x );
   TacsScalar convertEigenvalue( TacsScalar value );
 
@@ -175,13 +189,23 @@ class EPBucklingShiftInvert : public EPOperator {
   Note that the full orthogonalization is suggested (and is the
   default) since this has better numerical properties. The Lanczos
   vectors lose orthogonality as the eigenvalues converge.
+
+  When setKrylovSchur() is called, the solver instead uses a block
+  Lanczos method with thick (Krylov-Schur) restarts and locking of
+  converged Ritz vectors. In this case max_iters is the size of the
+  subspace that is retained between restarts, not the total number of
+  operator applications.
 */
 class SEP : public TACSObject {
  public:
   // Set the type of orthogonalization to use
   enum OrthoType { FULL, LOCAL };
+  // Note: SMALLEST_TRANSFORMED sorts by the transformed eigenvalues
+  // of the operator, which selects the eigenvalues immediately below
+  // the shift for a shift and invert operator
   enum EigenSpectrum { SMALLEST, LARGEST, 
-                       SMALLEST_MAGNITUDE, LARGEST_MAGNITUDE };
+                       SMALLEST_MAGNITUDE, LARGEST_MAGNITUDE,
+                       SMALLEST_TRANSFORMED };
 
   SEP( EPOperator *_Op, int _max_iters, 
        OrthoType _ortho_type=FULL, TACSBcMap *_bcs=NULL );
@@ -190,6 +214,12 @@ class SEP : public TACSObject {
   // Set the orthogonalization strategy
   void setOrthoType( OrthoType _ortho_type );
 
+  // Use a block Krylov-Schur method with restarts
+  void setKrylovSchur( int _block_size, int _max_restarts );
+
+  // Start from the eigenvectors of the previous solve
+  void setRecycle( int _nrecycle );
+
   // Set the solution tolerances, type of spectrum and number of eigenvalues
   void setTolerances( double _tol, 
                       EigenSpectrum _spectrum, int _neigvals );
@@ -214,6 +244,12 @@ class SEP : public TACSObject {
 
   // Check whether the right eigenvalues have converged
   int checkConverged( TacsScalar *A, TacsScalar *B, int n );                    
+
+  // Solve the eigenproblem using the block Krylov-Schur method
+  void solveKrylovSchur( KSMPrint *ksm_print, KSMPrint *ksm_file );
+
+  // Set the initial vectors from the previous eigenvectors
+  int initSubspace( int p );
   
   // Data used to determine which spectrum to use and when
   // enough eigenvalues are converged
@@ -243,6 +279,18 @@ class SEP : public TACSObject {
   int max_iters;
   TACSVec **Q; // The Vectors for the eigenvalue problem...
 
+  // Data for the block Krylov-Schur method
+  int block_size, max_restarts;
+  int nlocked; // The number of locked Ritz vectors
+  TACSVec **W; // Temporary vectors used to restart the subspace
+  double *H; // The projected matrix (max_iters+block_size x max_iters)
+  double *ritzvals, *ritzvecs, *rwork; // Data for the Rayleigh-Ritz step
+  TacsScalar *ritzerr; // The error estimate for each Ritz vector
+
+  // Data for recycling the eigenvectors between solves
+  int nrecycle;
+  TACSVec **R;
+
   // Boundary conditions that are applied
   TACSBcMap *bcs;
 };
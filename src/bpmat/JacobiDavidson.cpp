@@ -28,6 +28,10 @@ TACSJDFrequencyOperator::TACSJDFrequencyOperator( TACSAssembler *_tacs,
   pc = _pc;  pc->incref();
   work = tacs->createVec();
   work->incref();
+
+  // Refactor on every new estimate by default
+  reuse_factor = 0;
+  has_factor = 0;
 }
 
 TACSJDFrequencyOperator::~TACSJDFrequencyOperator(){
@@ -47,6 +51,42 @@ TACSVec *TACSJDFrequencyOperator::createVec(){
 // Set the eigenvalue estimate (and reset the factorization)
 // pc = K in this case
 void TACSJDFrequencyOperator::setEigenvalueEstimate( double estimate ){
+  // When the factorization is re-used, only factor the
+  // preconditioner the first time. The existing factorization
+  // remains an effective preconditioner when the estimate or the
+  // matrices change by a small amount between solves.
+  if (!reuse_factor || !has_factor){
+    factorPc(estimate);
+  }
+}
+
+/*
+  Set the flag that indicates whether to re-use the factorization.
+
+  When set, the preconditioner is only refactored on the first call
+  to setEigenvalueEstimate() and when the Jacobi-Davidson solver
+  requests a new factorization because the convergence has stalled.
+*/
+void TACSJDFrequencyOperator::setFactorReuse( int _reuse_factor ){
+  reuse_factor = _reuse_factor;
+}
+
+/*
+  Refactor the preconditioner with a new estimate if the
+  factorization is being re-used.
+*/
+int TACSJDFrequencyOperator::refactor( double estimate ){
+  if (reuse_factor){
+    factorPc(estimate);
+    return 1;
+  }
+  return 0;
+}
+
+/*
+  Form the matrix K - estimate*M and factor the preconditioner
+*/
+void TACSJDFrequencyOperator::factorPc( double estimate ){
   pc_mat->zeroEntries();
   pc_mat->copyValues(kmat);
   if (estimate != 0.0){
@@ -54,6 +94,7 @@ void TACSJDFrequencyOperator::setEigenvalueEstimate( double estimate ){
   }
   tacs->applyBCs(pc_mat);
   pc->factor();
+  has_factor = 1;
 }
 
 // Apply the preconditioner
@@ -124,6 +165,13 @@ TACSJacobiDavidson::TACSJacobiDavidson( TACSJacobiDavidsonOperator *_oper,
   // The eigen tolerance
   eigtol = 1e-9;
 
+  // Add a single correction vector per iteration by default
+  block_size = 1;
+
+  // Do not refactor the preconditioner during the solve by default
+  stall_iters = 0;
+  stall_rtol = 0.5;
+
   // The residual tolerances for the GMRES iterations
   rtol = 1e-9;
   atol = 1e-30;
@@ -399,7 +447,22 @@ void TACSJacobiDavidson::solve( KSMPrint *ksm_print,
   // Reset the number of converged eigenvectors/eigenvalues
   nconverged = 0;
 
+  // The number of correction vectors stored after V[k] that have not
+  // yet been added to the subspace
+  int pending = 0;
+
+  // Data used to detect when the convergence has stalled
+  int stall_count = 0;
+  double stall_ref = -1.0;
+
   for ( int k = kstart; k < m; k++ ){
+    // Record the norm of the additional correction vectors so that
+    // linearly dependent vectors can be discarded
+    TacsScalar vnorm0 = 0.0;
+    if (pending > 0){
+      vnorm0 = sqrt(oper->dot(V[k], V[k]));
+    }
+
     // Orthogonalize against converged eigenvectors as well (if any)...
     for ( int i = 0; i < nconverged; i++ ){
       TacsScalar h = oper->dot(V[k], Q[i]);
@@ -419,6 +482,20 @@ void TACSJacobiDavidson::solve( KSMPrint *ksm_print,
 
     // Normalize the vector so that it is orthonormal
     TacsScalar vnorm = sqrt(oper->dot(V[k], V[k]));
+
+    // Discard an additional correction vector that lies in the
+    // current subspace by moving it behind the remaining vectors
+    if (pending > 0 && 
+        TacsRealPart(vnorm) <= 1e-8*TacsRealPart(vnorm0)){
+      TACSVec *t = V[k];
+      for ( int i = k; i < k+pending; i++ ){
+        V[i] = V[i+1];
+      }
+      V[k+pending] = t;
+      pending--;
+      k--;
+      continue;
+    }
     V[k]->scale(1.0/vnorm);
 
     // Compute work = A*V[k]
@@ -431,6 +508,13 @@ void TACSJacobiDavidson::solve( KSMPrint *ksm_print,
       M[i*m + k] = M[k*m + i];
     }
 
+    // Add the remaining correction vectors before computing the
+    // new Ritz values
+    if (pending > 0){
+      pending--;
+      continue;
+    }
+
     // Compute the eigenvalues/eigenvectors of the M matrix. Copy over
     // the values from the M matrix into the ritzvecs array.
     for ( int j = 0; j <= k; j++ ){
@@ -457,6 +541,9 @@ void TACSJacobiDavidson::solve( KSMPrint *ksm_print,
     // has not yet converged
     double theta = ritzvals[0];
 
+    // The residual norm of the first unconverged Ritz pair
+    double res_norm = 0.0;
+
     int num_new_eigvals = 0;
     for ( int i = 0; i < k+1 && nconverged < max_eigen_vectors; 
           i++, num_new_eigvals++ ){
@@ -483,6 +570,7 @@ void TACSJacobiDavidson::solve( KSMPrint *ksm_print,
       oper->applyBCs(work);
       
       TacsScalar w_norm = work->norm();
+      res_norm = TacsRealPart(w_norm);
       if (ksm_print){
         char line[256];
         sprintf(line, "JD Residual[%2d]: %15.5e  Eigenvalue[%2d]: %20.10e\n", 
@@ -556,10 +644,60 @@ void TACSJacobiDavidson::solve( KSMPrint *ksm_print,
       }
       k = max_new_vecs-2;
 
+      // Reset the stall detection for the next eigenvalue
+      stall_count = 0;
+      stall_ref = -1.0;
+
       // Reset the iteration loop and continue
       continue;
     }
 
+    // Refactor the preconditioner with the current Ritz value if the
+    // residual has not been reduced over the last stall_iters
+    // iterations. This only has an effect if the operator re-uses
+    // its factorization.
+    if (stall_iters > 0){
+      if (stall_ref < 0.0 || res_norm < stall_rtol*stall_ref){
+        stall_ref = res_norm;
+        stall_count = 0;
+      }
+      else {
+        stall_count++;
+        if (stall_count >= stall_iters){
+          if (oper->refactor(theta) && ksm_print){
+            char line[256];
+            sprintf(line, "JD refactor at Eigenvalue[%2d]: %20.10e\n", 
+                    nconverged, theta);
+            ksm_print->print(line);
+          }
+          stall_ref = res_norm;
+          stall_count = 0;
+        }
+      }
+    }
+
+    // Set the number of correction vectors to add to the subspace:
+    // one from the correction equation for the current Ritz pair and
+    // block_size-1 from the preconditioned residuals of the next Ritz
+    // pairs. The vector from the correction equation is stored last
+    // in V[k+nb], after the additional vectors in V[k+1],...
+    int nb = block_size;
+    if (nb > m-1-k){
+      nb = m-1-k;
+    }
+    if (nb > k+1){
+      nb = k+1;
+    }
+    if (nb > max_eigen_vectors - nconverged){
+      nb = max_eigen_vectors - nconverged;
+    }
+    if (nb > max_gmres_size+1){
+      nb = max_gmres_size+1;
+    }
+    if (nb < 1){
+      nb = 1;
+    }
+
     // Now solve the system (K - theta*M)*t = -work
     // Keep track of the number of iterations in GMRES
     int niters = 0;
@@ -660,19 +798,56 @@ void TACSJacobiDavidson::solve( KSMPrint *ksm_print,
     }
 
     // Compute the next basis vector for the outer Jacobi--Davidson basis
-    V[k+1]->zeroEntries();
+    V[k+nb]->zeroEntries();
     for ( int i = 0; i < niters; i++ ){
-      V[k+1]->axpy(-res[i], Z[i]);
+      V[k+nb]->axpy(-res[i], Z[i]);
     }
   
     // Compute the product to test the error
     // (1 - P*Q^{T})*(A - theta*B)*(1 - Q*P^{T})
-    W[0]->copyValues(V[k+1]);
+    W[0]->copyValues(V[k+nb]);
     for ( int j = 0; j <= nconverged; j++ ){
       TacsScalar h = W[0]->dot(P[j]);
       W[0]->axpy(-h, Q[j]);
     }
 
+    if (nb > 1){
+      // Compute the residuals of the next Ritz pairs and store them
+      // in W[1],...,W[nb-1]
+      for ( int i = 1; i < nb; i++ ){
+        Z[0]->zeroEntries();
+        for ( int j = 0; j <= k; j++ ){
+          Z[0]->axpy(ritzvecs[i*(k+1) + j], V[j]);
+        }
+        oper->applyBCs(Z[0]);
+
+        TacsScalar znorm = sqrt(oper->dot(Z[0], Z[0]));
+        Z[0]->scale(1.0/znorm);
+
+        // W[i] = A*z - theta_i*B*z
+        oper->multA(Z[0], W[i]);
+        oper->multB(Z[0], work);
+        W[i]->axpy(-ritzvals[i], work);
+        oper->applyBCs(W[i]);
+      }
+
+      // Apply the preconditioner to all residuals at once
+      oper->applyFactorBlock(nb-1, &W[1], &V[k+1]);
+
+      // Project out the converged eigenvectors and the current
+      // eigenvector estimate: t = (I - Q*P^{T})*t
+      for ( int i = 1; i < nb; i++ ){
+        for ( int j = 0; j <= nconverged; j++ ){
+          TacsScalar h = V[k+i]->dot(P[j]);
+          V[k+i]->axpy(-h, Q[j]);
+        }
+      }
+
+      // Add these vectors to the subspace before the correction
+      // vector V[k+nb]
+      pending = nb-1;
+    }
+
     iteration++;
   }
 
@@ -719,3 +894,40 @@ void TACSJacobiDavidson::setRecycle( int _recycle,
   recycle = _recycle;
   recycle_type = _recycle_type;  
 }
+
+/*
+  Set the number of vectors added to the search space per iteration.
+
+  The first vector is the solution of the correction equation for the
+  current Ritz pair. The remaining vectors are the preconditioned
+  residuals of the next Ritz pairs, which are computed using a single
+  multiple right-hand-side application of the preconditioner.
+
+  input:
+  block_size: the number of correction vectors per iteration
+*/
+void TACSJacobiDavidson::setBlockSize( int _block_size ){
+  block_size = _block_size;
+  if (block_size < 1){
+    block_size = 1;
+  }
+}
+
+/*
+  Set the policy used to refactor the preconditioner when the
+  operator re-uses its factorization.
+
+  The preconditioner is refactored with the current Ritz value when
+  the residual of the current Ritz pair has not been reduced by a
+  factor of stall_rtol within stall_iters iterations. A value of
+  stall_iters <= 0 disables refactoring within the solve.
+
+  input:
+  stall_iters: the number of iterations without sufficient progress
+  stall_rtol:  the required relative reduction in the residual
+*/
+void TACSJacobiDavidson::setRefactorPolicy( int _stall_iters,
+                                            double _stall_rtol ){
+  stall_iters = _stall_iters;
+  stall_rtol = _stall_rtol;
+}
@@ -41,6 +41,17 @@ class TACSJacobiDavidsonOperator : public TACSObject {
   // Apply the preconditioner
   virtual void applyFactor( TACSVec *x, TACSVec *y ) = 0;
 
+  // Apply the preconditioner to multiple right-hand-sides
+  virtual void applyFactorBlock( int n, TACSVec **x, TACSVec **y ){
+    for ( int i = 0; i < n; i++ ){
+      applyFactor(x[i], y[i]);
+    }
+  }
+
+  // Update a re-used factorization with a new eigenvalue estimate.
+  // Returns 1 if the preconditioner was refactored, 0 otherwise.
+  virtual int refactor( double estimate ){ return 0; }
+
   // Apply boundary conditions associated with the matrix
   virtual void applyBCs( TACSVec *x ){}
 
@@ -74,6 +85,10 @@ class TACSJDFrequencyOperator : public TACSJacobiDavidsonOperator {
   // pc = K in this case
   void setEigenvalueEstimate( double estimate );
 
+  // Re-use the factorization until the solver requests an update
+  void setFactorReuse( int _reuse_factor );
+  int refactor( double estimate );
+
   // Apply the preconditioner
   void applyFactor( TACSVec *x, TACSVec *y );
 
@@ -93,6 +108,12 @@ class TACSJDFrequencyOperator : public TACSJacobiDavidsonOperator {
   TACSMat *kmat, *mmat, *pc_mat;
   TACSPc *pc;
   TACSVec *work;
+
+  // Data for re-using the factorization
+  int reuse_factor, has_factor;
+
+  // Assemble and factor the preconditioner
+  void factorPc( double estimate );
 };
 
 /*
@@ -117,6 +138,10 @@ class TACSJacobiDavidson : public TACSObject {
   void setTolerances( double _eigtol, double _rtol, double _atol );
   // Set the number of vectors to recycle
   void setRecycle( int _recycle, JDRecycleType _recycle_type );
+  // Set the number of correction vectors added per iteration
+  void setBlockSize( int _block_size );
+  // Refactor the preconditioner when the convergence stalls
+  void setRefactorPolicy( int _stall_iters, double _stall_rtol );
 
  private:
   // The operator class that defines the eigenproblem
@@ -135,6 +160,13 @@ class TACSJacobiDavidson : public TACSObject {
   int max_eigen_vectors;
   double eigtol;
 
+  // The number of correction vectors added per iteration
+  int block_size;
+
+  // The convergence stall criteria used to refactor the preconditioner
+  int stall_iters;
+  double stall_rtol;
+
   // The matrix of variables
   TacsScalar *M;
   double *ritzvecs, *ritzvals;
@@ -19,6 +19,7 @@
 #include <stdio.h>
 #include <math.h>
 #include "KSM.h"
+#include "TACSProfiler.h"
 
 /*
   Implementation of various Krylov-subspace methods
@@ -391,6 +392,11 @@ void PCG::setTolerances( double _rtol, double _atol ){
   atol = _atol;
 }
 
+void PCG::getTolerances( double *_rtol, double *_atol ){
+  if (_rtol){ *_rtol = rtol; }
+  if (_atol){ *_atol = atol; }
+}
+
 void PCG::setMonitor( KSMPrint *_monitor ){
   _monitor->incref();
   if (monitor){
@@ -410,6 +416,8 @@ void PCG::setMonitor( KSMPrint *_monitor ){
   zero_guess: flag to indicate whether to start with x = 0
 */
 void PCG::solve( TACSVec *b, TACSVec *x, int zero_guess ){
+  TACSProfileTimer timer(TACSProfiler::KSM_SOLVE);
+
   int solve_flag = 0;
   TacsScalar rhs_norm = 0.0;
   // R, Z and P are work-vectors
@@ -688,6 +696,14 @@ void GMRES::setTolerances( double _rtol, double _atol ){
   atol = _atol;
 }
 
+/*
+  Get the relative and absolute tolerances
+*/
+void GMRES::getTolerances( double *_rtol, double *_atol ){
+  if (_rtol){ *_rtol = rtol; }
+  if (_atol){ *_atol = atol; }
+}
+
 /*
   Set the object to control how the convergence history is displayed
   (if at all)
@@ -744,6 +760,8 @@ const char *GMRES::gmresName = "GMRES";
   zero_guess: flag to indicate whether to zero entries of x before solution
 */
 void GMRES::solve( TACSVec *b, TACSVec *x, int zero_guess ){
+  TACSProfileTimer timer(TACSProfiler::KSM_SOLVE);
+
   TacsScalar rhs_norm = 0.0;
   int solve_flag = 0; 
 
@@ -1101,6 +1119,14 @@ void GCROT::setTolerances( double _rtol, double _atol ){
   atol = _atol;
 }
 
+/*
+  Get the relative and absolute tolerances
+*/
+void GCROT::getTolerances( double *_rtol, double *_atol ){
+  if (_rtol){ *_rtol = rtol; }
+  if (_atol){ *_atol = atol; }
+}
+
 /*
   Set the residual/solution monitor object
 */
@@ -1128,6 +1154,8 @@ const char *GCROT::gcrotName = "GCROT";
   zero_guess: flag to treat x as an initial guess or zero
 */
 void GCROT::solve( TACSVec *b, TACSVec *x, int zero_guess ){
+  TACSProfileTimer timer(TACSProfiler::KSM_SOLVE);
+
   TacsScalar rhs_norm = 0.0;
   int solve_flag = 0; 
   int mat_iters = 0;
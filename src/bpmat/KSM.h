@@ -123,6 +123,13 @@ class TACSVec : public TACSObject {
   addValues(): Adds a small, dense matrix to the rows set in row[] and
   the columns set in col[].
 
+  initElementMap(): Pre-compute the location of each block of the
+  element matrices within the matrix for the given element-to-node
+  connectivity. After this call, addElementValues() adds an element
+  matrix without searching the non-zero pattern. Matrices that do not
+  support this return 0 from addElementValues(), in which case
+  addValues() must be used instead.
+
   applyBCs(): Applies the Dirichlet boundary conditions to the matrix
   by settin the associated diagonal elements to 1.
 
@@ -158,6 +165,12 @@ class TACSMat : public TACSObject {
                                 const TacsScalar *weights,
                                 int nv, int mv, const TacsScalar *values,
                                 MatrixOrientation matOr=NORMAL ){}
+  virtual void initElementMap( int num_elements, const int *elem_ptr,
+                               const int *elem_conn ){}
+  virtual int addElementValues( int elem, int nv, const TacsScalar *values,
+                                MatrixOrientation matOr=NORMAL ){
+    return 0;
+  }
   virtual void applyBCs( TACSBcMap *bcmap ){}
   virtual void beginAssembly(){}
   virtual void endAssembly(){}
@@ -191,6 +204,12 @@ class TACSMat : public TACSObject {
 
   factor(): Factor the preconditioner based on values in the matrix
   associated with the preconditioner
+
+  applySmoother(): Apply the preconditioner as a smoother for A*y = x
+  where y is used as the initial guess, or is zero on input when
+  zero_guess is set. Smoothers that compute the residual x - A*y as a
+  by-product of the last sweep store it in res (if res is not NULL)
+  and return 1. The default applies the preconditioner and returns 0.
 */
 class TACSPc : public TACSObject {
  public:
@@ -200,6 +219,14 @@ class TACSPc : public TACSObject {
   // -------------------------------------------
   virtual void applyFactor( TACSVec *x, TACSVec *y ) = 0;
 
+  // Apply a smoothing step and (optionally) compute the residual
+  // ------------------------------------------------------------
+  virtual int applySmoother( TACSVec *x, TACSVec *y, TACSVec *res,
+                             int zero_guess ){
+    applyFactor(x, y);
+    return 0;
+  }
+
   // Factor (or set up) the preconditioner 
   // -------------------------------------
   virtual void factor() = 0;
@@ -209,6 +236,11 @@ class TACSPc : public TACSObject {
     *_mat = NULL;
   }
 
+  // Get the number of negative eigenvalues of the factored matrix
+  // (or -1 if the preconditioner is not an exact factorization)
+  // -------------------------------------------------------------
+  virtual int getNumNegEigs(){ return -1; }
+
   // Retrieve the object name
   // ------------------------
   const char *TACSObjectName();
@@ -254,6 +286,10 @@ class KSMPrint : public TACSObject {
   setTolerances(rtol, atol): Set the relative and absolute stopping
   tolerances for the method
 
+  getTolerances(rtol, atol): Get the relative and absolute stopping
+  tolerances. The values are not modified by methods that do not use
+  stopping tolerances.
+
   setMonitor(): Set the monitor - possibly NULL - that will be used
  */
 class TACSKsm : public TACSObject {
@@ -265,6 +301,7 @@ class TACSKsm : public TACSObject {
   virtual void getOperators( TACSMat **_mat, TACSPc **_pc ) = 0;
   virtual void solve( TACSVec *b, TACSVec *x, int zero_guess = 1 ) = 0;
   virtual void setTolerances( double _rtol, double _atol ) = 0;
+  virtual void getTolerances( double *_rtol, double *_atol ){}
   virtual void setMonitor( KSMPrint *_monitor ) = 0;
   const char *TACSObjectName();
 
@@ -322,6 +359,7 @@ class PCG : public TACSKsm {
   void setOperators( TACSMat *_mat, TACSPc *_pc );
   void getOperators( TACSMat **_mat, TACSPc **_pc );
   void setTolerances( double _rtol, double _atol );
+  void getTolerances( double *_rtol, double *_atol );
   void setMonitor( KSMPrint *_print );
 
  private:
@@ -387,6 +425,7 @@ class GMRES : public TACSKsm {
   void setOperators( TACSMat *_mat, TACSPc *_pc );
   void getOperators( TACSMat **_mat, TACSPc **_pc );
   void setTolerances( double _rtol, double _atol );
+  void getTolerances( double *_rtol, double *_atol );
   void setMonitor( KSMPrint *_monitor );
   void setOrthoType( enum OrthoType otype );
   void setTimeMonitor();
@@ -454,6 +493,7 @@ class GCROT : public TACSKsm {
   void setOperators( TACSMat *_mat, TACSPc *_pc );
   void getOperators( TACSMat **_mat, TACSPc **_pc );
   void setTolerances( double _rtol, double _atol );
+  void getTolerances( double *_rtol, double *_atol );
   void setMonitor( KSMPrint *_monitor );
 
   const char *TACSObjectName();
@@ -18,6 +18,7 @@
 
 #include "FElibrary.h"
 #include "MatUtils.h"
+#include "tacslapack.h"
 
 TACS_BEGIN_NAMESPACE(matutils)
 
@@ -267,4 +268,49 @@ int ComputeSerialMultiColor( const int nvars, const int *rowp,
   return num_colors;
 }
 
+/*
+  Count the number of negative eigenvalues of the symmetric part of a
+  small, dense n x n block.
+
+  This is used to compute the inertia of a matrix from the diagonal
+  blocks of its block LU factorization. Only the real part of the
+  matrix is used.
+
+  input:
+  n:   the dimension of the block
+  A:   the block entries
+
+  returns: the number of negative eigenvalues
+*/
+int CountNegativeEigs( int n, const TacsScalar *A ){
+  double *S = new double[ n*n ];
+  double *eigs = new double[ n ];
+  int lwork = 4*n;
+  double *work = new double[ lwork ];
+
+  // Form the symmetric part of the matrix
+  for ( int i = 0; i < n; i++ ){
+    for ( int j = 0; j < n; j++ ){
+      S[i + n*j] = 0.5*TacsRealPart(A[i + n*j] + A[j + n*i]);
+    }
+  }
+
+  int info;
+  const char *jobz = "N", *uplo = "U";
+  LAPACKdsyev(jobz, uplo, &n, S, &n, eigs, work, &lwork, &info);
+
+  int nneg = 0;
+  for ( int i = 0; i < n; i++ ){
+    if (eigs[i] < 0.0){
+      nneg++;
+    }
+  }
+
+  delete [] S;
+  delete [] eigs;
+  delete [] work;
+
+  return nneg;
+}
+
 TACS_END_NAMESPACE
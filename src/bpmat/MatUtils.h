@@ -61,6 +61,12 @@ int ComputeSerialMultiColor( const int nvars, const int *rowp,
                              const int *cols, int *colors, 
                              int *new_vars );
 
+/*
+  Count the number of negative eigenvalues of the symmetric part of a
+  small dense block
+*/
+int CountNegativeEigs( int n, const TacsScalar *A );
+
 TACS_END_NAMESPACE
 
 #endif
@@ -21,6 +21,7 @@
 #include "tacslapack.h"
 #include "FElibrary.h"
 #include "MatUtils.h"
+#include "TACSProfiler.h"
 
 #ifdef TACS_HAS_AMD_LIBRARY
 #include "amd.h"
@@ -72,8 +73,25 @@ PDMat::PDMat( MPI_Comm _comm, int csr_m, int csr_n,
               int max_grid_size ){
   comm = _comm;
   monitor_factor = 0;
+  thread_info = NULL;
   perm = iperm = orig_bptr = NULL;
 
+  // Low-rank compression is disabled by default
+  lr_tol = 0.0;
+  lrank = urank = NULL;
+  lr_temp = NULL;
+  lval_dense_offset = uval_dense_offset = NULL;
+
+  // No persistent plan for adding values exists yet
+  plan_bsize = plan_nlocal = plan_nrecv = 0;
+  plan_nsend_procs = plan_nrecv_procs = 0;
+  plan_local = plan_ld = NULL;
+  plan_array = plan_offset = NULL;
+  plan_send_procs = plan_send_ptr = plan_send_index = NULL;
+  plan_recv_procs = plan_recv_ptr = NULL;
+  plan_send_vals = plan_recv_vals = NULL;
+  plan_send_req = plan_recv_req = NULL;
+
   int rank = 0, size = 0;
   MPI_Comm_size(comm, &size);
   MPI_Comm_rank(comm, &rank);
@@ -191,8 +209,25 @@ PDMat::PDMat( MPI_Comm _comm, int csr_m, int csr_n,
 PDMat::PDMat( MPI_Comm _comm, int _nrows, int _ncols ){
   comm = _comm;
   monitor_factor = 0;
+  thread_info = NULL;
   perm = iperm = orig_bptr = NULL;
 
+  // Low-rank compression is disabled by default
+  lr_tol = 0.0;
+  lrank = urank = NULL;
+  lr_temp = NULL;
+  lval_dense_offset = uval_dense_offset = NULL;
+
+  // No persistent plan for adding values exists yet
+  plan_bsize = plan_nlocal = plan_nrecv = 0;
+  plan_nsend_procs = plan_nrecv_procs = 0;
+  plan_local = plan_ld = NULL;
+  plan_array = plan_offset = NULL;
+  plan_send_procs = plan_send_ptr = plan_send_index = NULL;
+  plan_recv_procs = plan_recv_ptr = NULL;
+  plan_send_vals = plan_recv_vals = NULL;
+  plan_send_req = plan_recv_req = NULL;
+
   int rank = 0, size = 0;
   MPI_Comm_size(comm, &size);
   MPI_Comm_rank(comm, &rank);
@@ -289,6 +324,9 @@ PDMat::PDMat( MPI_Comm _comm, int _nrows, int _ncols ){
 }
 
 PDMat::~PDMat(){
+  if (thread_info){ thread_info->decref(); }
+  clear_add_values_plan();
+
   // Delete the process grid information
   delete [] proc_grid;
 
@@ -321,6 +359,15 @@ PDMat::~PDMat(){
   delete [] lval_offset;
   delete [] Lvals;
 
+  // Delete the ranks of the low-rank blocks
+  delete [] lrank;
+  delete [] urank;
+  delete [] lr_temp;
+  if (lval_dense_offset){
+    delete [] lval_dense_offset;
+    delete [] uval_dense_offset;
+  }
+
   // Delete arrays for the back-solves
   if (lower_row_sum_count){
     delete [] lower_row_sum_count;
@@ -825,6 +872,69 @@ void PDMat::setMonitorFactorFlag( int flag ){
   monitor_factor = flag;
 }
 
+/*
+  Set the thread information used for the trailing updates within the
+  factorization
+*/
+void PDMat::setThreadInfo( TACSThreadInfo *_thread_info ){
+  if (_thread_info){
+    _thread_info->incref();
+  }
+  if (thread_info){
+    thread_info->decref();
+  }
+  thread_info = _thread_info;
+}
+
+/*
+  Set the tolerance for the low-rank compression of the off-diagonal
+  blocks in the factorization.
+
+  When the tolerance is positive, each block of L and U is compressed
+  once it is computed within the factorization. A rank-revealing QR
+  factorization with column pivoting, A*P = Q*R, is truncated at the
+  first diagonal entry of R with |R[k,k]| <= tol*||A||, and the
+  block is stored as the product X*Y^{T} with X = Q[:,0:k] and
+  Y = P*R[0:k,:]^{T} in place of the dense block. A block is only
+  compressed if this requires less storage than the dense block. The
+  compressed blocks are sent in their compressed form and are used in
+  compressed form in the trailing updates and the back-solves, which
+  reduces the computational cost and the message sizes. Once the
+  factorization is complete, the compressed blocks are copied to
+  compact arrays and the dense L/U storage is freed, so the factor
+  only occupies the compressed size while it is applied. The dense
+  storage is allocated again when the matrix is next assembled, so
+  the peak storage during assembly and factorization is not reduced.
+
+  The truncation is relative to the matrix, not to each block. The
+  norm ||A|| is the largest Frobenius norm of the diagonal blocks of
+  the assembled matrix. Since the blocks of L are L[j,i] =
+  A[j,i]*U[i,i]^{-1}, their tolerance is also divided by the norm of
+  the diagonal block U[i,i]. This way, the error in each block of the
+  product L*U is bounded relative to ||A||.
+
+  The factorization is then approximate, with an error that is
+  controlled by the tolerance. This is intended for use within a
+  preconditioner. The compression is not available in complex mode
+  since the truncation would destroy the complex-step derivative.
+
+  This must be called with the same tolerance on all processes.
+
+  input:
+  tol:  the relative tolerance for the compression (zero to disable)
+*/
+void PDMat::setLowRankTolerance( double tol ){
+#ifdef TACS_USE_COMPLEX
+  if (tol > 0.0){
+    fprintf(stderr, "PDMat: Low-rank compression not available "
+            "in complex mode\n");
+  }
+  lr_tol = 0.0;
+#else
+  lr_tol = (tol > 0.0 ? tol : 0.0);
+#endif // TACS_USE_COMPLEX
+}
+
 /*
   This function performs several initialization tasks, including
   determining the number of matrix elements that are stored locally,
@@ -927,12 +1037,24 @@ void PDMat::init_nz_arrays(){
 
   max_lbuff_size = max_buff_all[0];
   max_ubuff_size = max_buff_all[1];
+
+  // Allocate the ranks of the blocks - all blocks are initially dense
+  lrank = new int[ Lcolp[ncols]+1 ];
+  urank = new int[ Urowp[nrows]+1 ];
+  for ( int k = 0; k <= Lcolp[ncols]; k++ ){
+    lrank[k] = -1;
+  }
+  for ( int k = 0; k <= Urowp[nrows]; k++ ){
+    urank[k] = -1;
+  }
+  lr_temp = new TacsScalar[ max_bsize ];
 }
 
 /*
   Zero all the matrix entries.
 */
 void PDMat::zeroEntries(){
+  expand_storage();
   memset(Dvals, 0, dval_size*sizeof(TacsScalar));
   memset(Lvals, 0, lval_size*sizeof(TacsScalar));
   memset(Uvals, 0, uval_size*sizeof(TacsScalar));
@@ -955,6 +1077,9 @@ void PDMat::addAllValues( int csr_bsize, int nvars, const int *vars,
   MPI_Comm_rank(comm, &rank);
   MPI_Comm_size(comm, &size);
 
+  // Restore the dense storage if the factor was compacted
+  expand_storage();
+
   int b2 = csr_bsize*csr_bsize;
 
   // Count up the number of recvs for each processor
@@ -1158,6 +1283,9 @@ void PDMat::addAlltoallValues( int csr_bsize, int nvars, const int *vars,
   MPI_Comm_rank(comm, &rank);
   MPI_Comm_size(comm, &size);
 
+  // Restore the dense storage if the factor was compacted
+  expand_storage();
+
   int b2 = csr_bsize*csr_bsize;
 
   // Count up the number of recvs for each processor
@@ -1347,6 +1475,350 @@ void PDMat::addAlltoallValues( int csr_bsize, int nvars, const int *vars,
   delete [] recv_ptr;
 }
 
+/*
+  Set up a persistent plan for adding values into the matrix from a
+  CSR pattern that does not change between calls. This function is
+  collective on all PDMat processes.
+
+  The destination of each on-process block is located once, and the
+  (i, j) indices of the off-process blocks are exchanged once. The
+  processor that receives each block stores its destination. Each
+  subsequent call to addPlanValues() only packs, sends and adds the
+  numerical values, and only communicates with the processors that
+  share blocks with this processor.
+
+  The send and receive buffers are kept with the plan, so the memory
+  required is similar to addAlltoallValues().
+
+  input:
+  csr_bsize:  the block size of the CSR matrix
+  nvars:      the number of block rows in the CSR matrix
+  vars:       the global variable number of each block row/column
+  csr_rowp:   the pointer into each row of the CSR matrix
+  csr_cols:   the column indices of the CSR matrix
+*/
+void PDMat::initAddValuesPlan( int csr_bsize, int nvars, const int *vars,
+                               const int *csr_rowp, const int *csr_cols ){
+  clear_add_values_plan();
+
+  int rank, size;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
+
+  int csr_size = csr_rowp[nvars];
+  int *owner = new int[ csr_size ];
+
+  int *send_counts = new int[ size ];
+  int *recv_counts = new int[ size ];
+  int *send_ptr = new int[ size+1 ];
+  int *recv_ptr = new int[ size+1 ];
+  memset(send_counts, 0, size*sizeof(int));
+
+  // Determine the owner of each block and count the local blocks
+  plan_nlocal = 0;
+  for ( int ip = 0; ip < nvars; ip++ ){
+    int ib, ioff;
+    get_csr_block_index(csr_bsize*vars[ip], &ib, &ioff);
+
+    for ( int jp = csr_rowp[ip]; jp < csr_rowp[ip+1]; jp++ ){
+      int jb, joff;
+      get_csr_block_index(csr_bsize*vars[csr_cols[jp]], &jb, &joff);
+
+      owner[jp] = get_block_owner(ib, jb);
+      if (owner[jp] == rank){
+        plan_nlocal++;
+      }
+      else {
+        send_counts[owner[jp]]++;
+      }
+    }
+  }
+
+  // Exchange the number of blocks sent to each processor
+  MPI_Alltoall(send_counts, 1, MPI_INT, recv_counts, 1, MPI_INT, comm);
+
+  send_ptr[0] = 0;
+  recv_ptr[0] = 0;
+  plan_nsend_procs = 0;
+  plan_nrecv_procs = 0;
+  for ( int k = 0; k < size; k++ ){
+    send_ptr[k+1] = send_ptr[k] + send_counts[k];
+    recv_ptr[k+1] = recv_ptr[k] + recv_counts[k];
+    if (send_counts[k] > 0){ plan_nsend_procs++; }
+    if (recv_counts[k] > 0){ plan_nrecv_procs++; }
+  }
+  plan_nrecv = recv_ptr[size];
+
+  // Set the CSR index of each local block and each block to send,
+  // and the global (i, j) indices of the blocks to send
+  plan_local = new int[ plan_nlocal ];
+  plan_send_index = new int[ send_ptr[size] ];
+  int *send_ij = new int[ 2*send_ptr[size] ];
+  memset(send_counts, 0, size*sizeof(int));
+
+  for ( int ip = 0, n = 0; ip < nvars; ip++ ){
+    for ( int jp = csr_rowp[ip]; jp < csr_rowp[ip+1]; jp++ ){
+      if (owner[jp] == rank){
+        plan_local[n] = jp;
+        n++;
+      }
+      else {
+        int k = owner[jp];
+        int sc = send_ptr[k] + send_counts[k];
+        send_counts[k]++;
+        plan_send_index[sc] = jp;
+        send_ij[2*sc] = csr_bsize*vars[ip];
+        send_ij[2*sc+1] = csr_bsize*vars[csr_cols[jp]];
+      }
+    }
+  }
+
+  // Send the (i, j) indices of the blocks to the owners
+  int *send_counts2 = new int[ size ];
+  int *send_ptr2 = new int[ size ];
+  int *recv_counts2 = new int[ size ];
+  int *recv_ptr2 = new int[ size ];
+  for ( int k = 0; k < size; k++ ){
+    send_counts2[k] = 2*send_counts[k];
+    send_ptr2[k] = 2*send_ptr[k];
+    recv_counts2[k] = 2*recv_counts[k];
+    recv_ptr2[k] = 2*recv_ptr[k];
+  }
+
+  int *recv_ij = new int[ 2*plan_nrecv ];
+  MPI_Alltoallv(send_ij, send_counts2, send_ptr2, MPI_INT,
+                recv_ij, recv_counts2, recv_ptr2, MPI_INT, comm);
+
+  delete [] send_counts2;
+  delete [] send_ptr2;
+  delete [] recv_counts2;
+  delete [] recv_ptr2;
+  delete [] send_ij;
+
+  // Locate the destination of the local and received blocks. The
+  // offsets are stored, rather than pointers, since the dense L/U
+  // storage is re-allocated after a compressed factorization.
+  expand_storage();
+  plan_array = new int[ plan_nlocal + plan_nrecv ];
+  plan_offset = new int[ plan_nlocal + plan_nrecv ];
+  plan_ld = new int[ plan_nlocal + plan_nrecv ];
+  for ( int ip = 0, n = 0; ip < nvars; ip++ ){
+    for ( int jp = csr_rowp[ip]; jp < csr_rowp[ip+1]; jp++ ){
+      if (owner[jp] == rank){
+        plan_offset[n] =
+          get_csr_block_offset(rank, csr_bsize,
+                               csr_bsize*vars[ip],
+                               csr_bsize*vars[csr_cols[jp]],
+                               &plan_array[n], &plan_ld[n]);
+        n++;
+      }
+    }
+  }
+  for ( int n = 0; n < plan_nrecv; n++ ){
+    int m = plan_nlocal + n;
+    plan_offset[m] =
+      get_csr_block_offset(rank, csr_bsize,
+                           recv_ij[2*n], recv_ij[2*n+1],
+                           &plan_array[m], &plan_ld[m]);
+  }
+  delete [] recv_ij;
+  delete [] owner;
+
+  // Compress the processor lists to the neighbouring processors
+  plan_send_procs = new int[ plan_nsend_procs ];
+  plan_send_ptr = new int[ plan_nsend_procs+1 ];
+  plan_recv_procs = new int[ plan_nrecv_procs ];
+  plan_recv_ptr = new int[ plan_nrecv_procs+1 ];
+  plan_send_ptr[0] = 0;
+  plan_recv_ptr[0] = 0;
+  for ( int k = 0, ns = 0, nr = 0; k < size; k++ ){
+    if (send_counts[k] > 0){
+      plan_send_procs[ns] = k;
+      plan_send_ptr[ns+1] = send_ptr[k+1];
+      ns++;
+    }
+    if (recv_counts[k] > 0){
+      plan_recv_procs[nr] = k;
+      plan_recv_ptr[nr+1] = recv_ptr[k+1];
+      nr++;
+    }
+  }
+
+  delete [] send_counts;
+  delete [] recv_counts;
+  delete [] send_ptr;
+  delete [] recv_ptr;
+
+  // Allocate the message buffers and requests
+  int b2 = csr_bsize*csr_bsize;
+  plan_send_vals = new TacsScalar[ b2*plan_send_ptr[plan_nsend_procs] ];
+  plan_recv_vals = new TacsScalar[ b2*plan_nrecv ];
+  plan_send_req = new MPI_Request[ plan_nsend_procs ];
+  plan_recv_req = new MPI_Request[ plan_nrecv_procs ];
+
+  plan_bsize = csr_bsize;
+}
+
+/*
+  Add values into the matrix using the plan from
+  initAddValuesPlan(). This function is collective on all PDMat
+  processes.
+
+  The receives are posted first, then the off-process blocks are
+  packed and sent. The on-process blocks are added while the
+  messages are in transit, and each incoming message is added as
+  soon as it arrives.
+
+  input:
+  vals:  the block values in the CSR pattern used to create the plan
+*/
+void PDMat::addPlanValues( TacsScalar *vals ){
+  if (plan_bsize <= 0){
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+    fprintf(stderr, "[%d] PDMat: Error, no plan for adding values\n",
+            rank);
+    return;
+  }
+
+  const int bsize = plan_bsize;
+  const int b2 = bsize*bsize;
+  const int tag = 0;
+
+  // Restore the dense storage if the factor was compacted
+  expand_storage();
+  TacsScalar *vals_array[3] = {Dvals, Lvals, Uvals};
+
+  // Post the receives for the off-process contributions
+  for ( int k = 0; k < plan_nrecv_procs; k++ ){
+    int start = plan_recv_ptr[k];
+    int count = plan_recv_ptr[k+1] - start;
+    MPI_Irecv(&plan_recv_vals[b2*start], b2*count, TACS_MPI_TYPE,
+              plan_recv_procs[k], tag, comm, &plan_recv_req[k]);
+  }
+
+  // Pack and send the blocks owned by other processors
+  for ( int k = 0; k < plan_nsend_procs; k++ ){
+    int start = plan_send_ptr[k];
+    int end = plan_send_ptr[k+1];
+    for ( int n = start; n < end; n++ ){
+      memcpy(&plan_send_vals[b2*n], &vals[b2*plan_send_index[n]],
+             b2*sizeof(TacsScalar));
+    }
+    MPI_Isend(&plan_send_vals[b2*start], b2*(end - start), TACS_MPI_TYPE,
+              plan_send_procs[k], tag, comm, &plan_send_req[k]);
+  }
+
+  // Add the on-process blocks. The input blocks are stored in
+  // row-major order, while the destination is column-major.
+  for ( int n = 0; n < plan_nlocal; n++ ){
+    if (plan_offset[n] >= 0){
+      TacsScalar *A = &vals_array[plan_array[n]][plan_offset[n]];
+      const TacsScalar *a = &vals[b2*plan_local[n]];
+      int ld = plan_ld[n];
+      for ( int m = 0; m < bsize; m++ ){
+        for ( int p = 0; p < bsize; p++ ){
+          A[m + ld*p] += a[bsize*m + p];
+        }
+      }
+    }
+  }
+
+  // Add the contributions from each processor as they arrive
+  for ( int k = 0; k < plan_nrecv_procs; k++ ){
+    int index;
+    MPI_Waitany(plan_nrecv_procs, plan_recv_req, &index, MPI_STATUS_IGNORE);
+
+    for ( int n = plan_recv_ptr[index]; n < plan_recv_ptr[index+1]; n++ ){
+      int np = plan_nlocal + n;
+      if (plan_offset[np] >= 0){
+        TacsScalar *A = &vals_array[plan_array[np]][plan_offset[np]];
+        const TacsScalar *a = &plan_recv_vals[b2*n];
+        int ld = plan_ld[np];
+        for ( int m = 0; m < bsize; m++ ){
+          for ( int p = 0; p < bsize; p++ ){
+            A[m + ld*p] += a[bsize*m + p];
+          }
+        }
+      }
+    }
+  }
+
+  MPI_Waitall(plan_nsend_procs, plan_send_req, MPI_STATUSES_IGNORE);
+}
+
+/*
+  Free the data associated with the plan for adding values
+*/
+void PDMat::clear_add_values_plan(){
+  if (plan_local){ delete [] plan_local; }
+  if (plan_array){ delete [] plan_array; }
+  if (plan_offset){ delete [] plan_offset; }
+  if (plan_ld){ delete [] plan_ld; }
+  if (plan_send_procs){ delete [] plan_send_procs; }
+  if (plan_send_ptr){ delete [] plan_send_ptr; }
+  if (plan_send_index){ delete [] plan_send_index; }
+  if (plan_recv_procs){ delete [] plan_recv_procs; }
+  if (plan_recv_ptr){ delete [] plan_recv_ptr; }
+  if (plan_send_vals){ delete [] plan_send_vals; }
+  if (plan_recv_vals){ delete [] plan_recv_vals; }
+  if (plan_send_req){ delete [] plan_send_req; }
+  if (plan_recv_req){ delete [] plan_recv_req; }
+
+  plan_bsize = plan_nlocal = plan_nrecv = 0;
+  plan_nsend_procs = plan_nrecv_procs = 0;
+  plan_local = plan_ld = NULL;
+  plan_array = plan_offset = NULL;
+  plan_send_procs = plan_send_ptr = plan_send_index = NULL;
+  plan_recv_procs = plan_recv_ptr = NULL;
+  plan_send_vals = plan_recv_vals = NULL;
+  plan_send_req = plan_recv_req = NULL;
+}
+
+/*
+  Find the block and the offset within the block for the given
+  variable in the CSR input, accounting for any block reordering
+*/
+void PDMat::get_csr_block_index( int var, int *ib, int *ioff ){
+  if (orig_bptr){
+    int b = get_block_num(var, orig_bptr);
+    *ioff = var - orig_bptr[b];
+    *ib = iperm[b];
+  }
+  else {
+    *ib = get_block_num(var, bptr);
+    *ioff = var - bptr[*ib];
+  }
+}
+
+/*
+  Get the location of the CSR block with the global variables (i, j)
+  within the locally stored blocks, and the leading dimension of the
+  block. The location is given as the array (0 = D, 1 = L, 2 = U)
+  and the offset within that array. Returns -1 if the CSR block does
+  not lie within the non-zero pattern.
+*/
+int PDMat::get_csr_block_offset( int rank, int csr_bsize,
+                                 int i, int j, int *array, int *ld ){
+  int ib, jb, ioff, joff;
+  get_csr_block_index(i, &ib, &ioff);
+  get_csr_block_index(j, &jb, &joff);
+
+  int offset = get_block_offset(rank, ib, jb, array);
+  int bi = bptr[ib+1] - bptr[ib];
+  int bj = bptr[jb+1] - bptr[jb];
+  *ld = bi;
+
+  if (offset >= 0 && (ioff >= 0 && ioff + csr_bsize <= bi) &&
+      (joff >= 0 && joff + csr_bsize <= bj)){
+    return offset + ioff + bi*joff;
+  }
+
+  fprintf(stderr, "[%d] PDMat: Error, (%d, %d) not in nz-pattern\n",
+          rank, ib, jb);
+  return -1;
+}
+
 /*
   Determine the block number i such that var is within the interval:
 
@@ -1431,6 +1903,7 @@ int PDMat::add_values( int rank, int i, int j,
 void PDMat::setRand(){
   int rank;
   MPI_Comm_rank(comm, &rank);
+  expand_storage();
 
   // Fill the matrix with randomly generated entries
   for ( int i = 0; i < nrows; i++ ){
@@ -1506,6 +1979,12 @@ void PDMat::mult( TacsScalar *x, TacsScalar *y ){
   int rank;
   MPI_Comm_rank(comm, &rank);
 
+  if (lval_dense_offset){
+    fprintf(stderr, "[%d] PDMat: Error, cannot multiply by the "
+            "compressed factor\n", rank);
+    return;
+  }
+
   // Get the location of rank on the process grid
   int proc_row = -1, proc_col = -1;
   get_proc_row_column(rank, &proc_row, &proc_col);
@@ -1846,6 +2325,8 @@ void PDMat::init_row_counts(){
   .     send x[i] to the j-th columns
 */
 void PDMat::applyFactor( TacsScalar *x ){
+  TACSProfileTimer timer(TACSProfiler::DENSE_APPLY_FACTOR);
+
   int rank;
   MPI_Comm_rank(comm, &rank);
 
@@ -2103,12 +2584,8 @@ void PDMat::lower_column_update( int col,
         xp = &x[dj];
       }
       
-      TacsScalar alpha = 1.0, beta = 1.0;
-      int one = 1;
       // xsum[i] = xsum[i] + L[i,j]*x[j] for
-      BLASgemv("N", &bi, &bj, &alpha, L, &bi,
-               xp, &one, &beta, &xsum[ni], &one);
-      TacsAddFlops(2*bi*bj);
+      add_block_product(L, bi, bj, lrank[jp], xp, &xsum[ni]);
 
       // Update row_sum_count[row]
       row_sum_count[row]++;
@@ -2279,12 +2756,8 @@ void PDMat::upper_column_update( int col,
           xp = &x[dj];
         }
         
-        TacsScalar alpha = 1.0, beta = 1.0;
-        int one = 1;
         // xsum[i] <-- xsum[i] + U[i,j]*x[j] for
-        BLASgemv("N", &bi, &bj, &alpha, U, &bi,
-                 xp, &one, &beta, &xsum[ni], &one);
-        TacsAddFlops(2*bi*bj);
+        add_block_product(U, bi, bj, urank[jp], xp, &xsum[ni]);
 
         // Update row_sum_count[row]
         row_sum_count[row]++;
@@ -2407,7 +2880,29 @@ void PDMat::add_upper_row_sum( int row,
   rows/column indices are sorted.
 */
 TacsScalar *PDMat::get_block( int rank, int i, int j ){
-  TacsScalar *A = NULL;
+  int array;
+  int offset = get_block_offset(rank, i, j, &array);
+  if (offset >= 0){
+    if (array == 0){
+      return &Dvals[offset];
+    }
+    else if (array == 1){
+      return &Lvals[offset];
+    }
+    return &Uvals[offset];
+  }
+
+  return NULL;
+}
+
+/*
+  Retrieve the location of the (i,j) block as the array (0 = D, 1 = L,
+  2 = U) and the offset within the array. If the block is not owned
+  by this process or if the block is not in the non-zero pattern,
+  return -1.
+*/
+int PDMat::get_block_offset( int rank, int i, int j, int *array ){
+  *array = -1;
 
   if (rank == get_block_owner(i, j)){
     if (i > j){ // L
@@ -2419,11 +2914,13 @@ TacsScalar *PDMat::get_block( int rank, int i, int j ){
                                  sizeof(int), FElibrary::comparator);
       if (item){
         lp = lp + (item - &Lrows[lp]);
-        A = &Lvals[lval_offset[lp]];
+        *array = 1;
+        return lval_offset[lp];
       }
     }
     else if (i == j){ // D
-      A = &Dvals[dval_offset[i]];
+      *array = 0;
+      return dval_offset[i];
     }
     else { // i < j : U
       int up = Urowp[i];
@@ -2434,12 +2931,13 @@ TacsScalar *PDMat::get_block( int rank, int i, int j ){
                                  sizeof(int), FElibrary::comparator);
       if (item){
         up = up + (item - &Ucols[up]);
-        A = &Uvals[uval_offset[up]];
+        *array = 2;
+        return uval_offset[up];
       }
     }
   }
 
-  return A;
+  return -1;
 }
 
 /*
@@ -2479,299 +2977,1162 @@ TacsScalar *PDMat::get_block( int rank, int i, int j ){
   2. Compute L[i+1:n,i] = A[i+1:n,i]*U[i,i]^{-1}
   3. Compute the update
   A[i+1:n,i+1:n] <-- A[i+1:n,i+1:n] - L[i+1:n,i]*U[i,i+1:n]
+
+  The factorization uses a look-ahead of one step. After the L/U
+  blocks for step i are received, the blocks in row and column i+1
+  are updated first. The panel for step i+1 (steps 1 and 2 and the
+  transfer of the L/U blocks) is then started while the remaining
+  trailing update for step i is performed. When thread information
+  is set, the remaining update is split by rows between the threads
+  and the panel is computed by the main thread, which then joins the
+  update. All MPI calls are made from the main thread.
+
+  The update for each block row is batched into GEMMs that span
+  multiple consecutive blocks of U[i,i+1:n] up to
+  PDMAT_UPDATE_MAX_COLS columns.
+
+  When the low-rank tolerance is set, the blocks of L[i+1:n,i] and
+  U[i,i+1:n] are compressed in step 2, before they are sent. The
+  messages then contain the rank of each block followed by the
+  blocks in their compressed form. The update uses the low-rank
+  factors directly, so that for L = Xl*Yl^{T} and U = Xu*Yu^{T} the
+  update is computed as Xl*((Yl^{T}*Xu)*Yu^{T}). Once the
+  factorization is complete, the compressed blocks are moved to
+  compact storage and the dense L/U storage is freed.
 */
+
+/*
+  The maximum number of columns in each of the batched GEMM updates
+*/
+static const int PDMAT_UPDATE_MAX_COLS = 256;
+
+/*
+  The data used within the factorization. The receive buffers and
+  requests are duplicated so that the L/U blocks for step i+1 can be
+  received while the update for step i is still using the blocks
+  from step i.
+*/
+class PDMatFactorCtx {
+ public:
+  PDMat *mat;
+  int rank, proc_row, proc_col;
+
+  // Temporary data for the diagonal factorization
+  int *temp_piv;
+  TacsScalar *temp_diag, *temp_block, *work;
+  int lwork;
+
+  // The receive buffers and the requests for each step
+  TacsScalar *Ubuff[2], *Lbuff[2];
+  MPI_Request *U_send_request[2], *L_send_request[2];
+  MPI_Request U_recv_request[2], L_recv_request[2];
+
+  // The local rows of the trailing update, their L blocks and ranks
+  int step, skip;
+  int nupdate;
+  int *update_rows;
+  TacsScalar **update_L;
+  int *update_lrank;
+
+  // The locally owned columns of U[i,:], their blocks and ranks
+  int nucols;
+  int *U_cols;
+  TacsScalar **U_ptr;
+  int *U_rank;
+
+  // Data for the low-rank compression and the compressed messages
+  int ubuff_len, lbuff_len;
+  TacsScalar *Usend[2], *Lsend[2];
+  TacsScalar *lr_Q, *lr_Y, *lr_tau;
+  int *lr_jpvt;
+  int lr_blocks, lr_compressed;
+  double lr_size, lr_dense_size;
+  double lr_scale;
+
+  // Data for the threads
+  int num_threads;
+  int next_row, next_thread;
+  int wsize;
+  TacsScalar *W;
+  int n_gemm;
+  pthread_mutex_t mutex;
+
+  // Timing information
+  double t_update, t_recv_wait, t_send_wait;
+};
+
 void PDMat::factor(){
+  TACSProfileTimer timer(TACSProfiler::DENSE_FACTOR);
+
   int rank;
   MPI_Comm_rank(comm, &rank);
 
+  // The factorization requires the dense storage
+  expand_storage();
+
+  // With the low-rank compression, the blocks are truncated relative
+  // to a norm of the whole matrix: the largest Frobenius norm of the
+  // diagonal blocks on all processes
+  double lr_scale = 0.0;
+  if (lr_tol > 0.0){
+    double dmax = 0.0;
+    for ( int i = 0; i < nrows; i++ ){
+      double dnorm = 0.0;
+      for ( int k = dval_offset[i]; k < dval_offset[i+1]; k++ ){
+        dnorm += TacsRealPart(Dvals[k])*TacsRealPart(Dvals[k]);
+      }
+      if (dnorm > dmax){
+        dmax = dnorm;
+      }
+    }
+    MPI_Allreduce(&dmax, &lr_scale, 1, MPI_DOUBLE, MPI_MAX, comm);
+    lr_scale = sqrt(lr_scale);
+  }
+
   int proc_row, proc_col; // Get the location of rank on the process grid
   if (!get_proc_row_column(rank, &proc_row, &proc_col)){
     // This process is not on the process grid - does not participate
     return;
   }
 
-  int *temp_piv = new int[max_bsize];
-  TacsScalar *temp_diag = new TacsScalar[max_bsize*max_bsize];
-  TacsScalar *temp_block = new TacsScalar[max_bsize*max_bsize];
-  int lwork = 128*max_bsize;
-  TacsScalar *work = new TacsScalar[lwork];
+  PDMatFactorCtx ctx;
+  ctx.mat = this;
+  ctx.rank = rank;
+  ctx.proc_row = proc_row;
+  ctx.proc_col = proc_col;
+
+  ctx.temp_piv = new int[max_bsize];
+  ctx.temp_diag = new TacsScalar[max_bsize*max_bsize+1];
+  ctx.temp_block = new TacsScalar[max_bsize*max_bsize+1];
+  ctx.lwork = 128*max_bsize;
+  ctx.work = new TacsScalar[ctx.lwork];
+
+  // With the low-rank compression, the messages contain the rank of
+  // each block followed by the compressed blocks
+  ctx.ubuff_len = max_ubuff_size;
+  ctx.lbuff_len = max_lbuff_size;
+  if (lr_tol > 0.0){
+    ctx.ubuff_len += ncols;
+    ctx.lbuff_len += nrows;
+  }
 
   // Buffers to handle the recieves information
-  TacsScalar *Ubuff = new TacsScalar[max_ubuff_size];
-  TacsScalar *Lbuff = new TacsScalar[max_lbuff_size];
-
-  // Send information for rows owning U
-  MPI_Request *U_send_request = new MPI_Request[nprows-1];
-  MPI_Status *U_send_status = new MPI_Status[nprows-1];
+  for ( int k = 0; k < 2; k++ ){
+    ctx.Ubuff[k] = new TacsScalar[ctx.ubuff_len];
+    ctx.Lbuff[k] = new TacsScalar[ctx.lbuff_len];
+    ctx.U_send_request[k] = new MPI_Request[nprows-1];
+    ctx.L_send_request[k] = new MPI_Request[npcols-1];
+    ctx.Usend[k] = ctx.Lsend[k] = NULL;
+  }
 
-  // Send information for columns owning L
-  MPI_Request *L_send_request = new MPI_Request[npcols-1];
-  MPI_Status *L_send_status = new MPI_Status[npcols-1];
+  // Allocate the data for the low-rank compression. All blocks are
+  // dense at the start of the factorization.
+  ctx.lr_Q = ctx.lr_Y = ctx.lr_tau = NULL;
+  ctx.lr_jpvt = NULL;
+  ctx.lr_blocks = ctx.lr_compressed = 0;
+  ctx.lr_size = ctx.lr_dense_size = 0.0;
+  ctx.lr_scale = lr_scale;
+  if (lr_tol > 0.0){
+    for ( int k = 0; k < 2; k++ ){
+      ctx.Usend[k] = new TacsScalar[ctx.ubuff_len];
+      ctx.Lsend[k] = new TacsScalar[ctx.lbuff_len];
+    }
+    ctx.lr_Q = new TacsScalar[max_bsize*max_bsize];
+    ctx.lr_Y = new TacsScalar[max_bsize*max_bsize];
+    ctx.lr_tau = new TacsScalar[max_bsize];
+    ctx.lr_jpvt = new int[max_bsize];
+  }
+  for ( int k = 0; k < Lcolp[ncols]; k++ ){
+    lrank[k] = -1;
+  }
+  for ( int k = 0; k < Urowp[nrows]; k++ ){
+    urank[k] = -1;
+  }
 
-  double t_update = 0.0;
-  double t_recv_wait = 0.0;
-  double t_send_wait = 0.0;
-  int n_gemm = 0;
+  // Allocate space for the rows and columns in the trailing update
+  int max_lcol = 0, max_urow = 0;
+  for ( int i = 0; i < nrows; i++ ){
+    if (Lcolp[i+1] - Lcolp[i] > max_lcol){
+      max_lcol = Lcolp[i+1] - Lcolp[i];
+    }
+    if (Urowp[i+1] - Urowp[i] > max_urow){
+      max_urow = Urowp[i+1] - Urowp[i];
+    }
+  }
+  ctx.nupdate = 0;
+  ctx.update_rows = new int[ max_lcol+1 ];
+  ctx.update_L = new TacsScalar*[ max_lcol+1 ];
+  ctx.update_lrank = new int[ max_lcol+1 ];
+  ctx.nucols = 0;
+  ctx.U_cols = new int[ max_urow+1 ];
+  ctx.U_ptr = new TacsScalar*[ max_urow+1 ];
+  ctx.U_rank = new int[ max_urow+1 ];
+
+  // Set up the threads and their work arrays
+  ctx.num_threads = 1;
+  if (thread_info){
+    ctx.num_threads = thread_info->getNumThreads();
+  }
+  ctx.wsize = max_bsize*(PDMAT_UPDATE_MAX_COLS + 2*max_bsize);
+  ctx.W = new TacsScalar[ ctx.num_threads*ctx.wsize ];
+  ctx.n_gemm = 0;
+  pthread_mutex_init(&ctx.mutex, NULL);
+
+  ctx.t_update = 0.0;
+  ctx.t_recv_wait = 0.0;
+  ctx.t_send_wait = 0.0;
+
+  pthread_t threads[TACSThreadInfo::TACS_MAX_NUM_THREADS];
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
+
+  // Factor the first panel
+  if (nrows > 0){
+    factor_panel_begin(0, &ctx);
+    factor_panel_end(0, &ctx);
+  }
 
   for ( int i = 0; i < nrows; i++ ){
-    int bi = bptr[i+1] - bptr[i];
+    if (monitor_factor){
+      ctx.t_update -= MPI_Wtime();
+    }
 
-    // The diagonal factor of A and its pivot
-    TacsScalar *d_diag = NULL;
-    int diag_owner = get_block_owner(i, i);
-
-    // Get the owner for the diagonal block
-    if (rank == diag_owner){
-      // Determine the address of the diagonal block
-      int nd = dval_offset[i];
-      d_diag = &Dvals[nd];
-
-      // Compute the inverse of the diagonal block
-      int info;
-      LAPACKgetrf(&bi, &bi, d_diag, &bi,
-                  temp_piv, &info);
-      LAPACKgetri(&bi, d_diag, &bi, temp_piv,
-                  work, &lwork, &info);
-      // Add flops from the inversion
-      TacsAddFlops(1.333333*bi*bi*bi);
-
-      // Send the factor to the column processes
-      for ( int p = 0; p < nprows; p++ ){
-        int dest = proc_grid[proc_col + p*npcols];
-        if (rank != dest){
-          MPI_Send(d_diag, bi*bi, TACS_MPI_TYPE,
-                   dest, p, comm);
+    // Update the blocks in row and column i+1 that are required for
+    // the next panel
+    factor_init_update(i, &ctx);
+    if (i+1 < nrows){
+      for ( int r = 0; r < ctx.nupdate; r++ ){
+        int ii = ctx.update_rows[r];
+        if (ii == i+1){
+          ctx.n_gemm += update_row(&ctx, r, -1, -1, ctx.W);
+        }
+        else if (get_proc_column(i+1) == proc_col){
+          ctx.n_gemm += update_row(&ctx, r, -1, i+1, ctx.W);
         }
       }
     }
 
-    // Receive U[i,i]^{-1}
-    if (rank != diag_owner && proc_col == get_proc_column(i)){
-      MPI_Status status;
-      MPI_Recv(temp_diag, bi*bi, TACS_MPI_TYPE,
-               diag_owner, proc_row, comm, &status);
-      d_diag = temp_diag;
+    // Start the remaining update on the threads
+    ctx.skip = i+1;
+    ctx.next_row = 0;
+    ctx.next_thread = 0;
+    for ( int k = 1; k < ctx.num_threads; k++ ){
+      pthread_create(&threads[k], &attr,
+                     PDMat::factor_update_thread, (void*)&ctx);
+    }
+
+    if (monitor_factor){
+      ctx.t_update += MPI_Wtime();
     }
 
-    // Before computing the entries for L[i:n,i], post all the recieve
-    // information for U and L.
+    // Compute the next panel while the threads perform the update
+    if (i+1 < nrows){
+      factor_panel_begin(i+1, &ctx);
+    }
 
-    // Determine the size of the incoming/outgoing U
-    int ubuff_size = 0;
-    for ( int jp = Urowp[i]; jp < Urowp[i+1]; jp++ ){
-      int j = Ucols[jp];
-      int bj = bptr[j+1] - bptr[j];
+    if (monitor_factor){
+      ctx.t_update -= MPI_Wtime();
+    }
 
-      if (get_proc_column(j) == proc_col){
-        ubuff_size += bi*bj;
+    // Join the remaining update and wait for the threads
+    factor_update_rows(&ctx);
+    for ( int k = 1; k < ctx.num_threads; k++ ){
+      pthread_join(threads[k], NULL);
+    }
+
+    if (monitor_factor){
+      ctx.t_update += MPI_Wtime();
+    }
+
+    // Complete the transfer of the L/U blocks for the next panel
+    if (i+1 < nrows){
+      factor_panel_end(i+1, &ctx);
+    }
+  }
+
+  pthread_attr_destroy(&attr);
+
+  if (monitor_factor){
+    printf("[%d] Number of GEMM updates: %d\n", rank, ctx.n_gemm);
+    printf("[%d] Update time:      %15.8f\n", rank, ctx.t_update);
+    printf("[%d] Recv wait time:   %15.8f\n", rank, ctx.t_recv_wait);
+    printf("[%d] Send wait time:   %15.8f\n", rank, ctx.t_send_wait);
+    if (lr_tol > 0.0){
+      printf("[%d] Low-rank blocks:  %d of %d\n", rank,
+             ctx.lr_compressed, ctx.lr_blocks);
+      printf("[%d] Low-rank storage: %15.8f\n", rank,
+             (ctx.lr_dense_size > 0.0 ?
+              ctx.lr_size/ctx.lr_dense_size : 1.0));
+    }
+  }
+
+  // Remove memory for the block factorization
+  delete [] ctx.temp_piv;
+  delete [] ctx.temp_diag;
+  delete [] ctx.temp_block;
+  delete [] ctx.work;
+
+  // Release memory for the data transfer
+  for ( int k = 0; k < 2; k++ ){
+    delete [] ctx.Ubuff[k];
+    delete [] ctx.Lbuff[k];
+    delete [] ctx.U_send_request[k];
+    delete [] ctx.L_send_request[k];
+    if (ctx.Usend[k]){ delete [] ctx.Usend[k]; }
+    if (ctx.Lsend[k]){ delete [] ctx.Lsend[k]; }
+  }
+
+  // Release memory for the low-rank compression
+  if (ctx.lr_Q){ delete [] ctx.lr_Q; }
+  if (ctx.lr_Y){ delete [] ctx.lr_Y; }
+  if (ctx.lr_tau){ delete [] ctx.lr_tau; }
+  if (ctx.lr_jpvt){ delete [] ctx.lr_jpvt; }
+
+  // Release memory for the update
+  delete [] ctx.update_rows;
+  delete [] ctx.update_L;
+  delete [] ctx.update_lrank;
+  delete [] ctx.U_cols;
+  delete [] ctx.U_ptr;
+  delete [] ctx.U_rank;
+  delete [] ctx.W;
+  pthread_mutex_destroy(&ctx.mutex);
+
+  // Store the compressed factor in compact form
+  if (lr_tol > 0.0){
+    compact_factor();
+  }
+}
+
+/*
+  Start the factorization of the panel for step i.
+
+  This computes the inverse of the diagonal block, sends it to the
+  processes in the column, computes L[i+1:n,i] = A[i+1:n,i]*U[i,i]^{-1}
+  and posts the sends/receives for the L and U blocks. The buffers and
+  requests for step i are selected by i % 2.
+*/
+void PDMat::factor_panel_begin( int i, PDMatFactorCtx *ctx ){
+  int rank = ctx->rank;
+  int proc_row = ctx->proc_row;
+  int proc_col = ctx->proc_col;
+  int b = i % 2;
+  int bi = bptr[i+1] - bptr[i];
+
+  // The diagonal factor of A and its pivot
+  TacsScalar *d_diag = NULL;
+  int diag_owner = get_block_owner(i, i);
+
+  // With the low-rank compression, the Frobenius norm of the diagonal
+  // block is sent after its inverse
+  int dsize = (lr_tol > 0.0 ? bi*bi+1 : bi*bi);
+  double d_norm = 0.0;
+
+  // Get the owner for the diagonal block
+  if (rank == diag_owner){
+    // Determine the address of the diagonal block
+    int nd = dval_offset[i];
+    d_diag = &Dvals[nd];
+    if (lr_tol > 0.0){
+      for ( int k = 0; k < bi*bi; k++ ){
+        d_norm += TacsRealPart(d_diag[k])*TacsRealPart(d_diag[k]);
       }
+      d_norm = sqrt(d_norm);
     }
 
-    // Set the U values to the row processes that need it
-    MPI_Request U_recv_request;
-    int source_proc_row = get_proc_row(i);
-    if (source_proc_row == proc_row){
-      // The sending processes
-      int offset = uval_offset[Urowp[i]];
-      for ( int p = 0, k = 0; p < nprows; p++ ){
-        int dest = proc_grid[proc_col + p*npcols];
-        if (rank != dest){
-          int tag = 2*i;
-          MPI_Isend(&Uvals[offset], ubuff_size, TACS_MPI_TYPE,
-                    dest, tag, comm, &U_send_request[k]);
-          k++;
+    // Compute the inverse of the diagonal block
+    int info;
+    LAPACKgetrf(&bi, &bi, d_diag, &bi,
+                ctx->temp_piv, &info);
+    LAPACKgetri(&bi, d_diag, &bi, ctx->temp_piv,
+                ctx->work, &ctx->lwork, &info);
+    // Add flops from the inversion
+    TacsAddFlops(1.333333*bi*bi*bi);
+
+    // Send the factor to the column processes
+    TacsScalar *dsend = d_diag;
+    if (lr_tol > 0.0){
+      dsend = ctx->temp_diag;
+      memcpy(dsend, d_diag, bi*bi*sizeof(TacsScalar));
+      dsend[bi*bi] = d_norm;
+    }
+    for ( int p = 0; p < nprows; p++ ){
+      int dest = proc_grid[proc_col + p*npcols];
+      if (rank != dest){
+        MPI_Send(dsend, dsize, TACS_MPI_TYPE,
+                 dest, p, comm);
+      }
+    }
+  }
+
+  // Receive U[i,i]^{-1}
+  if (rank != diag_owner && proc_col == get_proc_column(i)){
+    MPI_Status status;
+    MPI_Recv(ctx->temp_diag, dsize, TACS_MPI_TYPE,
+             diag_owner, proc_row, comm, &status);
+    d_diag = ctx->temp_diag;
+    if (lr_tol > 0.0){
+      d_norm = TacsRealPart(ctx->temp_diag[bi*bi]);
+    }
+  }
+
+  // Before computing the entries for L[i:n,i], post all the recieve
+  // information for U and L.
+
+  // Determine the size of the incoming/outgoing U
+  int ubuff_size = 0;
+  for ( int jp = Urowp[i]; jp < Urowp[i+1]; jp++ ){
+    int j = Ucols[jp];
+    int bj = bptr[j+1] - bptr[j];
+
+    if (get_proc_column(j) == proc_col){
+      ubuff_size += bi*bj;
+    }
+  }
+
+  // Set the U values to the row processes that need it
+  int source_proc_row = get_proc_row(i);
+  if (source_proc_row == proc_row){
+    // The sending processes
+    TacsScalar *usend = &Uvals[uval_offset[Urowp[i]]];
+    int usend_size = ubuff_size;
+
+    if (lr_tol > 0.0){
+      // Compress the blocks of U[i,:] and pack the ranks followed by
+      // the compressed blocks
+      usend = ctx->Usend[b];
+      usend_size = 0;
+      for ( int jp = Urowp[i]; jp < Urowp[i+1]; jp++ ){
+        if (get_proc_column(Ucols[jp]) == proc_col){
+          usend_size++;
+        }
+      }
+
+      for ( int jp = Urowp[i], n = 0; jp < Urowp[i+1]; jp++ ){
+        int j = Ucols[jp];
+        if (get_proc_column(j) == proc_col){
+          int bj = bptr[j+1] - bptr[j];
+          TacsScalar *A = &Uvals[uval_offset[jp]];
+          urank[jp] = compress_block(bi, bj, A, 
+                                     lr_tol*ctx->lr_scale, ctx);
+
+          int size = bi*bj;
+          if (urank[jp] >= 0){
+            size = urank[jp]*(bi + bj);
+          }
+          usend[n] = urank[jp];
+          memcpy(&usend[usend_size], A, size*sizeof(TacsScalar));
+          usend_size += size;
+          n++;
         }
       }
     }
-    else {
-      // The receiving processes
-      int source = proc_grid[proc_col + source_proc_row*npcols];
-      int tag = 2*i;
-      MPI_Irecv(Ubuff, ubuff_size, TACS_MPI_TYPE,
-                source, tag, comm, &U_recv_request);
+
+    for ( int p = 0, k = 0; p < nprows; p++ ){
+      int dest = proc_grid[proc_col + p*npcols];
+      if (rank != dest){
+        int tag = 2*i;
+        MPI_Isend(usend, usend_size, TACS_MPI_TYPE,
+                  dest, tag, comm, &ctx->U_send_request[b][k]);
+        k++;
+      }
     }
+  }
+  else {
+    // The receiving processes. The size of the compressed blocks is
+    // not known in advance.
+    int source = proc_grid[proc_col + source_proc_row*npcols];
+    int tag = 2*i;
+    int size = (lr_tol > 0.0 ? ctx->ubuff_len : ubuff_size);
+    MPI_Irecv(ctx->Ubuff[b], size, TACS_MPI_TYPE,
+              source, tag, comm, &ctx->U_recv_request[b]);
+  }
 
-    // Determine the size of the incoming/outgoing L
-    int lbuff_size = 0;
+  // Determine the size of the incoming/outgoing L
+  int lbuff_size = 0;
+  for ( int jp = Lcolp[i]; jp < Lcolp[i+1]; jp++ ){
+    int j = Lrows[jp];
+    int bj = bptr[j+1] - bptr[j];
+
+    if (get_proc_row(j) == proc_row){
+      lbuff_size += bi*bj;
+    }
+  }
+
+  // Compute L[i+1:n,i] = A[i+1:n,i]*U[i,i]^{-1} and send the results to
+  // the destination immediately
+  int n_gemm = 0;
+  if (proc_col == get_proc_column(i)){
     for ( int jp = Lcolp[i]; jp < Lcolp[i+1]; jp++ ){
       int j = Lrows[jp];
       int bj = bptr[j+1] - bptr[j];
 
-      if (get_proc_row(j) == proc_row){
-        lbuff_size += bi*bj;
+      if (rank == get_block_owner(j, i)){
+        int np = lval_offset[jp];
+
+        // Compute L[i+1:n,i] = A[i+1:n,i]*U[i,i]^{-1}
+        // L in bj x bi
+        // A in bj x bi
+        // U^{-1} in bi x bi
+        TacsScalar alpha = 1.0, beta = 0.0;
+        BLASgemm("N", "N", &bj, &bi, &bi,
+                 &alpha, &Lvals[np], &bj,
+                 d_diag, &bi, &beta, ctx->temp_block, &bj);
+        n_gemm++;
+        TacsAddFlops(2*bi*bi*bj);
+
+        memcpy(&Lvals[np], ctx->temp_block, bi*bj*sizeof(TacsScalar));
+
+        // Compress L[j,i]. Since A[j,i] = L[j,i]*U[i,i], the
+        // tolerance is divided by the norm of the diagonal block so
+        // that the error in A[j,i] is relative to the matrix norm.
+        if (lr_tol > 0.0){
+          double tol = lr_tol*ctx->lr_scale;
+          if (d_norm > 0.0){
+            tol = tol/d_norm;
+          }
+          lrank[jp] = compress_block(bj, bi, &Lvals[np], tol, ctx);
+        }
       }
     }
+  }
 
-    // Compute L[i+1:n,i] = A[i+1:n,i]*U[i,i]^{-1} and send the results to
-    // the destination immediately
-    if (proc_col == get_proc_column(i)){
+  // The threads may be updating the count concurrently
+  pthread_mutex_lock(&ctx->mutex);
+  ctx->n_gemm += n_gemm;
+  pthread_mutex_unlock(&ctx->mutex);
+
+  // Set the L values to the row processes that need it
+  int source_proc_column = get_proc_column(i);
+  if (source_proc_column == proc_col){
+    TacsScalar *lsend = &Lvals[lval_offset[Lcolp[i]]];
+    int lsend_size = lbuff_size;
+
+    if (lr_tol > 0.0){
+      // Pack the ranks followed by the compressed blocks
+      lsend = ctx->Lsend[b];
+      lsend_size = 0;
       for ( int jp = Lcolp[i]; jp < Lcolp[i+1]; jp++ ){
+        if (get_proc_row(Lrows[jp]) == proc_row){
+          lsend_size++;
+        }
+      }
+
+      for ( int jp = Lcolp[i], n = 0; jp < Lcolp[i+1]; jp++ ){
         int j = Lrows[jp];
-        int bj = bptr[j+1] - bptr[j];
-
-        if (rank == get_block_owner(j, i)){
-          int np = lval_offset[jp];
-
-          // Compute L[i+1:n,i] = A[i+1:n,i]*U[i,i]^{-1}
-          // L in bj x bi
-          // A in bj x bi
-          // U^{-1} in bi x bi
-          TacsScalar alpha = 1.0, beta = 0.0;
-          BLASgemm("N", "N", &bj, &bi, &bi,
-                   &alpha, &Lvals[np], &bj,
-                   d_diag, &bi, &beta, temp_block, &bj);
-          n_gemm++;
-          TacsAddFlops(2*bi*bi*bj);
-
-          memcpy(&Lvals[np], temp_block, bi*bj*sizeof(TacsScalar));
+        if (get_proc_row(j) == proc_row){
+          int bj = bptr[j+1] - bptr[j];
+          int size = bi*bj;
+          if (lrank[jp] >= 0){
+            size = lrank[jp]*(bi + bj);
+          }
+          lsend[n] = lrank[jp];
+          memcpy(&lsend[lsend_size], &Lvals[lval_offset[jp]],
+                 size*sizeof(TacsScalar));
+          lsend_size += size;
+          n++;
         }
       }
     }
 
-    // Set the L values to the row processes that need it
-    MPI_Request L_recv_request;
-    int source_proc_column = get_proc_column(i);
-    if (source_proc_column == proc_col){
-      // Send the proc_rows requiring everything
-      for ( int p = 0, k = 0; p < npcols; p++ ){
-        int dest = proc_grid[p + proc_row*npcols];
-        if (rank != dest){
-          int tag = 2*i+1;
-          int offset = lval_offset[Lcolp[i]];
-          MPI_Isend(&Lvals[offset], lbuff_size, TACS_MPI_TYPE,
-                    dest, tag, comm, &L_send_request[k]);
-          k++;
-        }
+    // Send the proc_rows requiring everything
+    for ( int p = 0, k = 0; p < npcols; p++ ){
+      int dest = proc_grid[p + proc_row*npcols];
+      if (rank != dest){
+        int tag = 2*i+1;
+        MPI_Isend(lsend, lsend_size, TACS_MPI_TYPE,
+                  dest, tag, comm, &ctx->L_send_request[b][k]);
+        k++;
       }
     }
-    else {
-      // The receiving processes
-      int source = proc_grid[source_proc_column + proc_row*npcols];
-      int tag = 2*i+1;
-      MPI_Irecv(Lbuff, lbuff_size, TACS_MPI_TYPE,
-                source, tag, comm, &L_recv_request);
-    }
-
-    // There are four cases:
-    // 1. The processor owns both the row and column elements required.
-    // This is true of only the root processor.
-    // 2. The processor owns the column but not the row and must wait for
-    // any of the U_recv requests.
-    // 3. The processor owns the row but not the column and must wait for
-    // any of the L_recv requests.
-    // 4. The processor owns neither the column or the row and must wait
-    // for combinations of requests to begin.
+  }
+  else {
+    // The receiving processes
+    int source = proc_grid[source_proc_column + proc_row*npcols];
+    int tag = 2*i+1;
+    int size = (lr_tol > 0.0 ? ctx->lbuff_len : lbuff_size);
+    MPI_Irecv(ctx->Lbuff[b], size, TACS_MPI_TYPE,
+              source, tag, comm, &ctx->L_recv_request[b]);
+  }
+}
 
-    if (monitor_factor){
-      t_send_wait -= MPI_Wtime();
+/*
+  Complete the transfer of the L/U blocks for the panel at step i
+*/
+void PDMat::factor_panel_end( int i, PDMatFactorCtx *ctx ){
+  int b = i % 2;
+  int source_proc_row = get_proc_row(i);
+  int source_proc_column = get_proc_column(i);
+
+  if (monitor_factor){
+    ctx->t_send_wait -= MPI_Wtime();
+  }
+
+  // Wait for the remaining sends to complete
+  if (source_proc_row == ctx->proc_row){
+    MPI_Waitall(nprows-1, ctx->U_send_request[b], MPI_STATUSES_IGNORE);
+  }
+  if (source_proc_column == ctx->proc_col){
+    MPI_Waitall(npcols-1, ctx->L_send_request[b], MPI_STATUSES_IGNORE);
+  }
+
+  if (monitor_factor){
+    ctx->t_send_wait += MPI_Wtime();
+    ctx->t_recv_wait -= MPI_Wtime();
+  }
+
+  // Wait for the receives to complete
+  if (source_proc_column != ctx->proc_col){
+    MPI_Wait(&ctx->L_recv_request[b], MPI_STATUS_IGNORE);
+  }
+  if (source_proc_row != ctx->proc_row){
+    MPI_Wait(&ctx->U_recv_request[b], MPI_STATUS_IGNORE);
+  }
+
+  if (monitor_factor){
+    ctx->t_recv_wait += MPI_Wtime();
+  }
+}
+
+/*
+  Set the locally owned rows of the trailing update for step i with
+  the pointers to their L blocks, and the locally owned columns of
+  U[i,:] with the pointers to their blocks.
+
+  There are four cases:
+  1. The processor owns both the row and column elements required.
+  This is true of only the root processor.
+  2. The processor owns the column but not the row and uses the
+  received U blocks.
+  3. The processor owns the row but not the column and uses the
+  received L blocks.
+  4. The processor owns neither the column or the row and uses both
+  received blocks.
+
+  The received blocks are stored consecutively. With the low-rank
+  compression, the received buffers start with the rank of each block.
+*/
+void PDMat::factor_init_update( int i, PDMatFactorCtx *ctx ){
+  int b = i % 2;
+  int bi = bptr[i+1] - bptr[i];
+  int owns_column = (get_proc_column(i) == ctx->proc_col);
+  int owns_row = (get_proc_row(i) == ctx->proc_row);
+  ctx->step = i;
+
+  // Set the locally owned columns of U[i,:]
+  ctx->nucols = 0;
+  int nu = 0;
+  for ( int jjp = Urowp[i]; jjp < Urowp[i+1]; jjp++ ){
+    int jj = Ucols[jjp];
+    if (get_proc_column(jj) == ctx->proc_col){
+      ctx->U_cols[ctx->nucols] = jj;
+      if (owns_row){
+        ctx->U_ptr[ctx->nucols] = &Uvals[uval_offset[jjp]];
+        ctx->U_rank[ctx->nucols] = urank[jjp];
+      }
+      ctx->nucols++;
+      nu += bptr[jj+1] - bptr[jj];
     }
+  }
 
-    // Wait for the remaining sends to complete
-    if (source_proc_row == proc_row){
-      MPI_Waitall(nprows-1, U_send_request, U_send_status);
+  if (!owns_row){
+    TacsScalar *U = ctx->Ubuff[b];
+    if (lr_tol > 0.0){
+      for ( int n = 0; n < ctx->nucols; n++ ){
+        ctx->U_rank[n] = (int)TacsRealPart(U[n]);
+      }
+      U += ctx->nucols;
+    }
+    for ( int n = 0; n < ctx->nucols; n++ ){
+      int jj = ctx->U_cols[n];
+      int bjj = bptr[jj+1] - bptr[jj];
+      if (lr_tol <= 0.0){
+        ctx->U_rank[n] = -1;
+      }
+      ctx->U_ptr[n] = U;
+      if (ctx->U_rank[n] >= 0){
+        U += ctx->U_rank[n]*(bi + bjj);
+      }
+      else {
+        U += bi*bjj;
+      }
     }
-    if (source_proc_column == proc_col){
-      MPI_Waitall(npcols-1, L_send_request, L_send_status);
+  }
+
+  // Set the locally owned rows and their L blocks
+  ctx->nupdate = 0;
+  int nl = 0;
+  for ( int iip = Lcolp[i]; iip < Lcolp[i+1]; iip++ ){
+    // Skip rows not locally owned
+    int ii = Lrows[iip];
+    if (get_proc_row(ii) != ctx->proc_row){
+      continue;
     }
 
-    if (monitor_factor){
-      t_send_wait += MPI_Wtime();
-      t_recv_wait -= MPI_Wtime();
+    ctx->update_rows[ctx->nupdate] = ii;
+    if (owns_column){
+      ctx->update_L[ctx->nupdate] = &Lvals[lval_offset[iip]];
+      ctx->update_lrank[ctx->nupdate] = lrank[iip];
     }
+    ctx->nupdate++;
+    nl += bptr[ii+1] - bptr[ii];
+  }
 
-    // Wait for the receive to completex
-    if (source_proc_column != proc_col){
-      MPI_Status L_recv_status;
-      MPI_Wait(&L_recv_request, &L_recv_status);
+  if (!owns_column){
+    TacsScalar *L = ctx->Lbuff[b];
+    if (lr_tol > 0.0){
+      for ( int n = 0; n < ctx->nupdate; n++ ){
+        ctx->update_lrank[n] = (int)TacsRealPart(L[n]);
+      }
+      L += ctx->nupdate;
     }
-    if (source_proc_row != proc_row){
-      MPI_Status U_recv_status;
-      MPI_Wait(&U_recv_request, &U_recv_status);
+    for ( int n = 0; n < ctx->nupdate; n++ ){
+      int ii = ctx->update_rows[n];
+      int bii = bptr[ii+1] - bptr[ii];
+      if (lr_tol <= 0.0){
+        ctx->update_lrank[n] = -1;
+      }
+      ctx->update_L[n] = L;
+      if (ctx->update_lrank[n] >= 0){
+        L += ctx->update_lrank[n]*(bi + bii);
+      }
+      else {
+        L += bi*bii;
+      }
     }
+  }
 
-    // Compute the bi-rank update to the remainder of the matrix
-    // A[i+1:n,i+1:n] = A[i+1:n,i+1:n] - L[i:n,i]*U[i,i:n]
+  TacsAddFlops(2.0*nl*nu*bi);
+}
 
-    if (monitor_factor){
-      t_recv_wait += MPI_Wtime();
-      t_update -= MPI_Wtime();
+/*
+  Perform the trailing update for the rows of the current step that
+  have not been assigned to a thread. The row i+1 has already been
+  updated and is skipped.
+*/
+void PDMat::factor_update_rows( PDMatFactorCtx *ctx ){
+  // Get the work array for this thread
+  pthread_mutex_lock(&ctx->mutex);
+  TacsScalar *W = &ctx->W[ctx->wsize*ctx->next_thread];
+  ctx->next_thread++;
+  pthread_mutex_unlock(&ctx->mutex);
+
+  int n_gemm = 0;
+  while (1){
+    pthread_mutex_lock(&ctx->mutex);
+    int r = ctx->next_row;
+    if (r < ctx->nupdate){
+      ctx->next_row++;
     }
+    pthread_mutex_unlock(&ctx->mutex);
 
-    // Initialize the L-pointer
-    TacsScalar *L = Lbuff;
-    if (source_proc_column == proc_col){
-      L = &Lvals[lval_offset[Lcolp[i]]];
+    if (r >= ctx->nupdate){
+      break;
     }
 
-    for ( int iip = Lcolp[i]; iip < Lcolp[i+1]; iip++ ){
-      // Skip rows not locally owned
-      int ii = Lrows[iip];
-      int bii = bptr[ii+1] - bptr[ii];
-      if (get_proc_row(ii) != proc_row){
-        continue;
-      }
+    if (ctx->update_rows[r] != ctx->skip){
+      n_gemm += update_row(ctx, r, ctx->skip, -1, W);
+    }
+  }
 
-      // Initialize the U-pointer
-      TacsScalar *U = Ubuff;
-      if (source_proc_row == proc_row){
-        U = &Uvals[uval_offset[Urowp[i]]];
-      }
+  pthread_mutex_lock(&ctx->mutex);
+  ctx->n_gemm += n_gemm;
+  pthread_mutex_unlock(&ctx->mutex);
+}
 
-      for ( int jjp = Urowp[i]; jjp < Urowp[i+1]; jjp++ ){
-        // Skip columns not locally owned
-        int jj = Ucols[jjp];
-        int bjj = bptr[jj+1] - bptr[jj];
-        if (get_proc_column(jj) != proc_col){
-          continue;
-        }
+/*
+  The function executed by the threads during the trailing update
+*/
+void *PDMat::factor_update_thread( void *t ){
+  PDMatFactorCtx *ctx = static_cast<PDMatFactorCtx*>(t);
+  ctx->mat->factor_update_rows(ctx);
+  pthread_exit(NULL);
+}
 
-        TacsScalar *A = get_block(rank, ii, jj);
+/*
+  Compute the update A[ii,jj] <-- A[ii,jj] - L[ii,i]*U[i,jj] for the
+  locally owned blocks in row ii = ctx->update_rows[r].
+
+  Consecutive dense blocks of U[i,:] are stored consecutively and form
+  a column-major matrix with leading dimension bi. These blocks are
+  therefore updated with a single GEMM into the work array W which is
+  then subtracted from each block. When L[ii,i] = Xl*Yl^{T} is
+  low-rank, the product Yl^{T}*U[i,batch] is formed instead and
+  Xl times each part is subtracted from the blocks. The low-rank
+  blocks U[i,jj] = Xu*Yu^{T} are updated one at a time, and blocks of
+  rank zero are skipped.
 
+  input:
+  ctx:       the factorization data for the current step
+  r:         the index of the row within the local rows
+  skip:      skip the block column (or -1)
+  only:      only update this block column (or -1 for all)
+  W:         work array of size max_bsize*(PDMAT_UPDATE_MAX_COLS + 2*max_bsize)
+
+  returns:   the number of GEMM calls
+*/
+int PDMat::update_row( PDMatFactorCtx *ctx, int r,
+                       int skip, int only, TacsScalar *W ){
+  int rank = ctx->rank;
+  int i = ctx->step;
+  int ii = ctx->update_rows[r];
+  int bi = bptr[i+1] - bptr[i];
+  int bii = bptr[ii+1] - bptr[ii];
+  int n_gemm = 0;
+
+  // The L[ii,i] block. When kl >= 0, Xl is bii x kl and Yl is bi x kl.
+  TacsScalar *L = ctx->update_L[r];
+  int kl = ctx->update_lrank[r];
+  TacsScalar *Xl = L, *Yl = NULL;
+  if (kl == 0){
+    return 0;
+  }
+  else if (kl > 0){
+    Yl = &L[bii*kl];
+  }
+
+  // The start of the current batch and its number of columns
+  int start = 0, ncols = 0;
+
+  for ( int t = 0; t <= ctx->nucols; t++ ){
+    int select = 0, dense = 0, jj = -1, bjj = 0;
+    if (t < ctx->nucols){
+      jj = ctx->U_cols[t];
+      bjj = bptr[jj+1] - bptr[jj];
+      select = (jj != skip && (only < 0 || jj == only) &&
+                ctx->U_rank[t] != 0);
+      dense = (ctx->U_rank[t] < 0);
+    }
+
+    // Apply the update from the current batch of dense blocks
+    if (ncols > 0 && (!select || !dense ||
+                      ncols + bjj > PDMAT_UPDATE_MAX_COLS)){
+      TacsScalar *U = ctx->U_ptr[start];
+      TacsScalar alpha = 1.0, beta = 0.0;
+      if (kl < 0){
+        // W = L[ii,i]*U[i,batch]
+        // W in bii x ncols
+        // L in bii x bi
+        // U in bi x ncols
+        BLASgemm("N", "N", &bii, &ncols, &bi,
+                 &alpha, L, &bii, U, &bi, &beta, W, &bii);
+      }
+      else {
+        // W = Yl^{T}*U[i,batch] in kl x ncols
+        BLASgemm("T", "N", &kl, &ncols, &bi,
+                 &alpha, Yl, &bi, U, &bi, &beta, W, &kl);
+      }
+      n_gemm++;
+
+      // Subtract the result from each of the blocks
+      TacsScalar *w = W;
+      for ( int kp = start; kp < t; kp++ ){
+        int kk = ctx->U_cols[kp];
+        int bkk = bptr[kk+1] - bptr[kk];
+
+        TacsScalar *A = get_block(rank, ii, kk);
         if (A){
-          // Perform the GEMM update
-          // A[i+1:n,i+1:n] = A[i+1:n,i+1:n] - L[i:n,i]*U[i,i:n]
-          // A in bii x bjj
-          // L in bii x bi
-          // U in bi x bjj
-
-          TacsScalar alpha = -1.0, beta = 1.0;
-          BLASgemm("N", "N", &bii, &bjj, &bi,
-                   &alpha, L, &bii,
-                   U, &bi, &beta, A, &bii);
-          n_gemm++;
-          TacsAddFlops(2*bii*bjj*bi);
+          if (kl < 0){
+            int size = bii*bkk;
+            for ( int k = 0; k < size; k++ ){
+              A[k] -= w[k];
+            }
+          }
+          else {
+            // A = A - Xl*W[:,kk]
+            TacsScalar a = -1.0, b = 1.0;
+            BLASgemm("N", "N", &bii, &bkk, &kl,
+                     &a, Xl, &bii, w, &kl, &b, A, &bii);
+            n_gemm++;
+          }
         }
+        w += (kl < 0 ? bii : kl)*bkk;
+      }
 
-        U += bi*bjj;
+      ncols = 0;
+    }
+
+    if (select && dense){
+      // Add the block to the batch
+      if (ncols == 0){
+        start = t;
       }
+      ncols += bjj;
+    }
+    else if (select){
+      // Update with the low-rank block U[i,jj] = Xu*Yu^{T}
+      int ku = ctx->U_rank[t];
+      TacsScalar *Xu = ctx->U_ptr[t];
+      TacsScalar *Yu = &Xu[bi*ku];
+
+      TacsScalar *A = get_block(rank, ii, jj);
+      if (A){
+        TacsScalar alpha = 1.0, beta = 0.0;
+        TacsScalar a = -1.0, b = 1.0;
+        if (kl < 0){
+          // W = L*Xu in bii x ku, then A = A - W*Yu^{T}
+          BLASgemm("N", "N", &bii, &ku, &bi,
+                   &alpha, L, &bii, Xu, &bi, &beta, W, &bii);
+          BLASgemm("N", "T", &bii, &bjj, &ku,
+                   &a, W, &bii, Yu, &bjj, &b, A, &bii);
+          n_gemm += 2;
+        }
+        else {
+          // W = Yl^{T}*Xu in kl x ku, W2 = W*Yu^{T} in kl x bjj,
+          // then A = A - Xl*W2
+          TacsScalar *W2 = &W[kl*ku];
+          BLASgemm("T", "N", &kl, &ku, &bi,
+                   &alpha, Yl, &bi, Xu, &bi, &beta, W, &kl);
+          BLASgemm("N", "T", &kl, &bjj, &ku,
+                   &alpha, W, &kl, Yu, &bjj, &beta, W2, &kl);
+          BLASgemm("N", "N", &bii, &bjj, &kl,
+                   &a, Xl, &bii, W2, &kl, &b, A, &bii);
+          n_gemm += 3;
+        }
+      }
+    }
+  }
+
+  return n_gemm;
+}
+
+/*
+  Compress the m x n block A (stored in column-major order) to the
+  low-rank form A = X*Y^{T} using a QR factorization with column
+  pivoting. The rank is the number of diagonal entries of R with
+  |R_kk| > tol, where tol is an absolute tolerance set from the norm
+  of the whole matrix. The factor X (m x k) followed by Y (n x k)
+  overwrite A. If the low-rank form would not reduce the storage, A
+  is not modified.
+
+  input:
+  m, n:   the dimensions of the block
+  A:      the block
+  tol:    the absolute truncation tolerance
+  ctx:    the factorization data with the work arrays
 
-      L += bi*bii;
+  returns: the rank k of the block, or -1 if the block is dense
+*/
+int PDMat::compress_block( int m, int n, TacsScalar *A, double tol,
+                           PDMatFactorCtx *ctx ){
+  ctx->lr_blocks++;
+  ctx->lr_dense_size += m*n;
+
+#ifdef TACS_USE_COMPLEX
+  ctx->lr_size += m*n;
+  return -1;
+#else
+  // Compute the factorization A*P = Q*R
+  TacsScalar *Q = ctx->lr_Q;
+  memcpy(Q, A, m*n*sizeof(TacsScalar));
+  memset(ctx->lr_jpvt, 0, n*sizeof(int));
+  int info;
+  LAPACKdgeqp3(&m, &n, Q, &m, ctx->lr_jpvt, ctx->lr_tau,
+               ctx->work, &ctx->lwork, &info);
+
+  // Find the rank from the diagonal of R
+  int kmax = (m < n ? m : n);
+  int k = 0;
+  while (k < kmax && fabs(Q[k + m*k]) > tol){
+    k++;
+  }
+  TacsAddFlops(4.0*m*n*kmax);
+
+  if (k*(m + n) >= m*n){
+    ctx->lr_size += m*n;
+    return -1;
+  }
+
+  // Set Y = P*R[0:k,:]^{T}
+  TacsScalar *Y = ctx->lr_Y;
+  memset(Y, 0, n*k*sizeof(TacsScalar));
+  for ( int j = 0; j < n; j++ ){
+    int p = ctx->lr_jpvt[j]-1;
+    for ( int l = 0; l < k && l <= j; l++ ){
+      Y[p + n*l] = Q[l + m*j];
     }
+  }
 
-    if (monitor_factor){
-      t_update += MPI_Wtime();
+  // Form X = Q[:,0:k]
+  if (k > 0){
+    LAPACKdorgqr(&m, &k, &k, Q, &m, ctx->lr_tau,
+                 ctx->work, &ctx->lwork, &info);
+    TacsAddFlops(4.0*m*k*k);
+  }
+
+  memcpy(A, Q, m*k*sizeof(TacsScalar));
+  memcpy(&A[m*k], Y, n*k*sizeof(TacsScalar));
+
+  ctx->lr_compressed++;
+  ctx->lr_size += k*(m + n);
+  return k;
+#endif // TACS_USE_COMPLEX
+}
+
+/*
+  Compute y <-- y + A*x for the m x n block A with rank k. If k < 0,
+  the block is dense, otherwise A = X*Y^{T} is stored as X (m x k)
+  followed by Y (n x k).
+*/
+void PDMat::add_block_product( TacsScalar *A, int m, int n, int k,
+                               const TacsScalar *x, TacsScalar *y ){
+  TacsScalar alpha = 1.0, beta = 1.0, zero = 0.0;
+  int one = 1;
+  if (k < 0){
+    BLASgemv("N", &m, &n, &alpha, A, &m,
+             (TacsScalar*)x, &one, &beta, y, &one);
+    TacsAddFlops(2*m*n);
+  }
+  else if (k > 0){
+    // t = Y^{T}*x, y = y + X*t
+    BLASgemv("T", &n, &k, &alpha, &A[m*k], &n,
+             (TacsScalar*)x, &one, &zero, lr_temp, &one);
+    BLASgemv("N", &m, &k, &alpha, A, &m,
+             lr_temp, &one, &beta, y, &one);
+    TacsAddFlops(2*k*(m + n));
+  }
+}
+
+/*
+  Copy the compressed L/U blocks of the factor to compact arrays and
+  free the dense storage.
+
+  After the factorization, a compressed block only uses the first
+  k*(m + n) entries of its m x n dense storage. The blocks are copied
+  in order to arrays that only hold these entries, and lval_offset
+  and uval_offset are set to point into the compact arrays. The
+  offsets of the dense blocks are kept so that expand_storage() can
+  restore the dense storage. If no block was compressed, the dense
+  storage is kept.
+*/
+void PDMat::compact_factor(){
+  if (lval_dense_offset){
+    return;
+  }
+
+  // Compute the offsets of the compressed U blocks
+  int *uoffset = new int[ Urowp[nrows]+1 ];
+  uoffset[0] = 0;
+  for ( int i = 0; i < nrows; i++ ){
+    int bi = bptr[i+1] - bptr[i];
+    for ( int jp = Urowp[i]; jp < Urowp[i+1]; jp++ ){
+      int j = Ucols[jp];
+      int bj = bptr[j+1] - bptr[j];
+      int size = uval_offset[jp+1] - uval_offset[jp];
+      if (size > 0 && urank[jp] >= 0){
+        size = urank[jp]*(bi + bj);
+      }
+      uoffset[jp+1] = uoffset[jp] + size;
     }
   }
 
-  if (monitor_factor){
-    printf("[%d] Number of GEMM updates: %d\n", rank, n_gemm);
-    printf("[%d] Update time:      %15.8f\n", rank, t_update);
-    printf("[%d] Recv wait time:   %15.8f\n", rank, t_recv_wait);
-    printf("[%d] Send wait time:   %15.8f\n", rank, t_send_wait);
+  // Compute the offsets of the compressed L blocks
+  int *loffset = new int[ Lcolp[ncols]+1 ];
+  loffset[0] = 0;
+  for ( int j = 0; j < ncols; j++ ){
+    int bj = bptr[j+1] - bptr[j];
+    for ( int ip = Lcolp[j]; ip < Lcolp[j+1]; ip++ ){
+      int i = Lrows[ip];
+      int bi = bptr[i+1] - bptr[i];
+      int size = lval_offset[ip+1] - lval_offset[ip];
+      if (size > 0 && lrank[ip] >= 0){
+        size = lrank[ip]*(bi + bj);
+      }
+      loffset[ip+1] = loffset[ip] + size;
+    }
   }
 
-  // Remove memory for the block factorization
-  delete [] temp_piv;
-  delete [] temp_diag;
-  delete [] temp_block;
-  delete [] work;
+  int usize = uoffset[Urowp[nrows]];
+  int lsize = loffset[Lcolp[ncols]];
+  if (usize == uval_size && lsize == lval_size){
+    delete [] uoffset;
+    delete [] loffset;
+    return;
+  }
 
-  // Release memory for the data transfer
-  delete [] Ubuff;
-  delete [] Lbuff;
+  // Copy the blocks to the compact arrays
+  TacsScalar *U = new TacsScalar[ usize ];
+  for ( int jp = 0; jp < Urowp[nrows]; jp++ ){
+    memcpy(&U[uoffset[jp]], &Uvals[uval_offset[jp]],
+           (uoffset[jp+1] - uoffset[jp])*sizeof(TacsScalar));
+  }
+  delete [] Uvals;
+  Uvals = U;
+  uval_dense_offset = uval_offset;
+  uval_offset = uoffset;
+
+  TacsScalar *L = new TacsScalar[ lsize ];
+  for ( int ip = 0; ip < Lcolp[ncols]; ip++ ){
+    memcpy(&L[loffset[ip]], &Lvals[lval_offset[ip]],
+           (loffset[ip+1] - loffset[ip])*sizeof(TacsScalar));
+  }
+  delete [] Lvals;
+  Lvals = L;
+  lval_dense_offset = lval_offset;
+  lval_offset = loffset;
+}
+
+/*
+  Restore the dense storage of the L/U blocks after compact_factor().
+  The factor is discarded and the entries of the L/U blocks are set
+  to zero. Nothing is done if the storage is already dense.
+*/
+void PDMat::expand_storage(){
+  if (!lval_dense_offset){
+    return;
+  }
+
+  delete [] Uvals;
+  delete [] uval_offset;
+  uval_offset = uval_dense_offset;
+  uval_dense_offset = NULL;
+  Uvals = new TacsScalar[ uval_size ];
+  memset(Uvals, 0, uval_size*sizeof(TacsScalar));
+
+  delete [] Lvals;
+  delete [] lval_offset;
+  lval_offset = lval_dense_offset;
+  lval_dense_offset = NULL;
+  Lvals = new TacsScalar[ lval_size ];
+  memset(Lvals, 0, lval_size*sizeof(TacsScalar));
+
+  // All blocks are dense again
+  for ( int k = 0; k < Lcolp[ncols]; k++ ){
+    lrank[k] = -1;
+  }
+  for ( int k = 0; k < Urowp[nrows]; k++ ){
+    urank[k] = -1;
+  }
+}
+
+/*
+  Count the number of negative eigenvalues of the factored matrix.
+
+  This must be called after factor(). For a symmetric matrix, the
+  block LU factorization without pivoting between blocks is equivalent
+  to a block LDL^{T} factorization, so the inertia of the matrix is
+  the sum of the inertia of the diagonal blocks (which are stored in
+  inverted form). This call is collective on all processors in the
+  communicator.
+*/
+int PDMat::getNumNegEigs(){
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+
+  int nneg = 0;
+  int proc_row, proc_col;
+  if (get_proc_row_column(rank, &proc_row, &proc_col)){
+    for ( int i = 0; i < nrows; i++ ){
+      if (rank == get_block_owner(i, i)){
+        int bi = bptr[i+1] - bptr[i];
+        nneg += matutils::CountNegativeEigs(bi, &Dvals[dval_offset[i]]);
+      }
+    }
+  }
+
+  int nneg_all = 0;
+  MPI_Allreduce(&nneg, &nneg_all, 1, MPI_INT, MPI_SUM, comm);
 
-  delete [] U_send_request;
-  delete [] L_send_request;
-  delete [] U_send_status;
-  delete [] L_send_status;
+  return nneg_all;
 }
@@ -20,6 +20,12 @@
 #define TACS_PD_MAT_H
 
 #include "TACSObject.h"
+#include "pthread.h"
+
+/*
+  The data used within the factorization (defined in PDMat.cpp)
+*/
+class PDMatFactorCtx;
 
 /*!
   Parallel partially dense matrix format.
@@ -28,9 +34,10 @@
   format. The blocks are stored in column-major fortran order. The
   matrix multiplications, and factorizations are performed in
   parallel, and in place using LAPACK/BLAS for all block
-  operations. At present each block matrix is considered fully dense,
-  but a sparse format could be implemented in future to store fewer
-  zero off-diagonal terms.
+  operations. Each block matrix is stored fully dense. Optionally, the
+  off-diagonal blocks of the factor can be compressed to a low-rank
+  form within the factorization and stored in a compact form after
+  the factorization (see setLowRankTolerance()).
 
   The parallelism is based on a 2D block cyclic format. This format is
   more difficult to implement but results in better parallelism for
@@ -91,6 +98,8 @@ class PDMat : public TACSObject {
   void getSize( int *nr, int *nc );
   void getProcessGridSize( int *_nprows, int *_npcols );
   void setMonitorFactorFlag( int flag );
+  void setThreadInfo( TACSThreadInfo *_thread_info );
+  void setLowRankTolerance( double tol );
   int getLocalVecSize(){
     return xbptr[nrows];
   }
@@ -113,11 +122,21 @@ class PDMat : public TACSObject {
                           TacsScalar *vals );
   void setRand();
 
+  // Add values with a persistent plan for a fixed CSR pattern
+  // ---------------------------------------------------------
+  void initAddValuesPlan( int csr_bsize, int nvars, const int *vars,
+                          const int *csr_rowp, const int *csr_cols );
+  void addPlanValues( TacsScalar *vals );
+  int hasAddValuesPlan(){
+    return plan_bsize > 0;
+  }
+
   // Matrix operations - note that factorization is in-place
   // -------------------------------------------------------
   void mult( TacsScalar *x, TacsScalar *y );
   void applyFactor( TacsScalar *x );
   void factor();
+  int getNumNegEigs();
 
   // Given the i/j location within the matrix, determine the owner
   // -------------------------------------------------------------
@@ -140,6 +159,27 @@ class PDMat : public TACSObject {
   int add_values( int rank, int i, int j,
                   int csr_bsize, int csr_i, int csr_j,
                   TacsScalar *b );
+  void get_csr_block_index( int var, int *ib, int *ioff );
+  int get_csr_block_offset( int rank, int csr_bsize,
+                            int i, int j, int *array, int *ld );
+  void clear_add_values_plan();
+
+  // Helper functions for the look-ahead factorization
+  void factor_panel_begin( int i, PDMatFactorCtx *ctx );
+  void factor_panel_end( int i, PDMatFactorCtx *ctx );
+  void factor_init_update( int i, PDMatFactorCtx *ctx );
+  void factor_update_rows( PDMatFactorCtx *ctx );
+  int update_row( PDMatFactorCtx *ctx, int r,
+                  int skip, int only, TacsScalar *W );
+  static void *factor_update_thread( void *t );
+
+  // Helper functions for the low-rank blocks
+  int compress_block( int m, int n, TacsScalar *A, double tol,
+                      PDMatFactorCtx *ctx );
+  void compact_factor();
+  void expand_storage();
+  void add_block_product( TacsScalar *A, int m, int n, int k,
+                          const TacsScalar *x, TacsScalar *y );
 
   // Helper functions for applying the lower-triangular back-solve
   void lower_column_update( int col, TacsScalar *x,
@@ -191,6 +231,7 @@ class PDMat : public TACSObject {
 
   // Retrieve the block matrix at the specified entry
   TacsScalar *get_block( int rank, int i, int j );
+  int get_block_offset( int rank, int i, int j, int *array );
 
   // The communicator for this matrix
   MPI_Comm comm;
@@ -242,6 +283,40 @@ class PDMat : public TACSObject {
   // Monitor the time spent in the factorization process
   int monitor_factor;
 
+  // The threads used for the trailing updates in the factorization
+  TACSThreadInfo *thread_info;
+
+  // The relative tolerance for the low-rank compression of the L/U
+  // blocks (disabled when zero) and the rank of each block. A rank
+  // of -1 indicates a dense block, otherwise the block is stored as
+  // the product X*Y^{T} where X and Y have rank columns.
+  double lr_tol;
+  int *lrank, *urank;
+  TacsScalar *lr_temp; // Temporary vector used in the back-solves
+
+  // After a factorization with compression, Lvals/Uvals only store
+  // the compressed blocks and lval_offset/uval_offset point into the
+  // compact arrays. The offsets of the dense blocks are kept so that
+  // the dense storage can be restored before the next assembly. These
+  // are NULL when the storage is dense.
+  int *lval_dense_offset, *uval_dense_offset;
+
+  // The persistent plan for adding values from a fixed CSR pattern.
+  // The destination of the on-process blocks is stored first,
+  // followed by the destination of the received blocks.
+  int plan_bsize; // The CSR block size (zero if no plan exists)
+  int plan_nlocal, plan_nrecv; // The number of local/received blocks
+  int *plan_local; // The CSR index of each on-process block
+  int *plan_array; // The destination array: 0 = D, 1 = L, 2 = U
+  int *plan_offset; // The destination within the array (-1 if none)
+  int *plan_ld; // The leading dimension of the destination block
+  int plan_nsend_procs, plan_nrecv_procs; // The number of neighbours
+  int *plan_send_procs, *plan_send_ptr; // The destination processors
+  int *plan_send_index; // The CSR index of each block to send
+  int *plan_recv_procs, *plan_recv_ptr; // The source processors
+  TacsScalar *plan_send_vals, *plan_recv_vals; // The message buffers
+  MPI_Request *plan_send_req, *plan_recv_req;
+
   // Store information about the back-solve
   int lower_block_count, upper_block_count;
   int *lower_row_sum_count, *lower_row_sum_recv;
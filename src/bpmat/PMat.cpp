@@ -19,6 +19,7 @@
 #include <stdio.h>
 #include "PMat.h"
 #include "FElibrary.h"
+#include "MatUtils.h"
 #include "tacslapack.h"
 
 /*!
@@ -439,6 +440,12 @@ TACSGaussSeidel::TACSGaussSeidel( TACSPMat *_mat, int _zero_guess,
   iters = _iters;
   symmetric = _symmetric;
   use_l1_gauss_seidel = _use_l1_gauss_seidel;
+
+  // The multicolor ordering is computed in setMultiColor()
+  num_colors = 0;
+  num_local_colors = 0;
+  color_ptr = NULL;
+  color_rows = NULL;
 }
 
 /*
@@ -452,6 +459,130 @@ TACSGaussSeidel::~TACSGaussSeidel(){
   ctx->decref();
   delete [] yext;
   if (bvec){ bvec->decref(); }
+  if (color_ptr){ delete [] color_ptr; }
+  if (color_rows){ delete [] color_rows; }
+}
+
+/*
+  Set whether to use the multicolor ordering for the sweeps.
+
+  The greedy coloring is computed from the non-zero pattern of the
+  local matrix, which must be structurally symmetric. The rows of each
+  color in the ranges [0, N-Nc) and [N-Nc, N) are stored separately,
+  in ascending order, and empty colors are removed.
+*/
+void TACSGaussSeidel::setMultiColor( int flag ){
+  if (color_ptr){ delete [] color_ptr; }
+  if (color_rows){ delete [] color_rows; }
+  num_colors = 0;
+  num_local_colors = 0;
+  color_ptr = NULL;
+  color_rows = NULL;
+
+  if (!flag){
+    return;
+  }
+
+  // Get the number of variables in the row map
+  int bsize, N, Nc;
+  mat->getRowMap(&bsize, &N, &Nc);
+  const int var_offset = N - Nc;
+
+  // Color the graph of the local matrix
+  BCSRMatData *Adata = Aloc->getMatData();
+  int *colors = new int[ N ];
+  int *new_vars = new int[ N ];
+  int ncolors = matutils::ComputeSerialMultiColor(N, Adata->rowp,
+                                                  Adata->cols,
+                                                  colors, new_vars);
+  delete [] new_vars;
+
+  // Count the rows of each color in the two ranges of rows
+  int *count = new int[ 2*ncolors ];
+  memset(count, 0, 2*ncolors*sizeof(int));
+  for ( int i = 0; i < N; i++ ){
+    if (i < var_offset){
+      count[colors[i]]++;
+    }
+    else {
+      count[ncolors + colors[i]]++;
+    }
+  }
+
+  // Set the pointer into the rows of each non-empty color
+  color_ptr = new int[ 2*ncolors+1 ];
+  color_ptr[0] = 0;
+  for ( int k = 0; k < 2*ncolors; k++ ){
+    if (count[k] > 0){
+      color_ptr[num_colors+1] = color_ptr[num_colors] + count[k];
+      count[k] = num_colors;
+      num_colors++;
+      if (k < ncolors){
+        num_local_colors++;
+      }
+    }
+  }
+
+  // Place the rows in order within each color
+  int *ptr = new int[ num_colors ];
+  memcpy(ptr, color_ptr, num_colors*sizeof(int));
+  color_rows = new int[ N ];
+  for ( int i = 0; i < N; i++ ){
+    int k = colors[i];
+    if (i >= var_offset){
+      k += ncolors;
+    }
+    color_rows[ptr[count[k]]] = i;
+    ptr[count[k]]++;
+  }
+
+  delete [] ptr;
+  delete [] count;
+  delete [] colors;
+}
+
+/*
+  Apply a sweep of the smoother to the rows [start, end) in the
+  forward direction, or to the rows [end, start) in the reverse
+  direction when start > end. The ranges are either [0, N-Nc),
+  [N-Nc, N) or [0, N).
+
+  With the multicolor ordering, the colors that cover the range are
+  applied in turn, each as a single threaded update.
+*/
+void TACSGaussSeidel::applySweep( BCSRMat *B, int start, int end,
+                                  TacsScalar *x, TacsScalar *y ){
+  const int offset = ext_offset/Aloc->getBlockSize();
+
+  if (color_ptr){
+    int lo = (start < end ? start : end);
+    int hi = (start < end ? end : start);
+    if (lo >= hi){
+      return;
+    }
+
+    // Find the colors that cover the range of rows
+    int cstart = (lo < offset ? 0 : num_local_colors);
+    int cend = (hi > offset ? num_colors : num_local_colors);
+
+    if (start < end){
+      for ( int k = cstart; k < cend; k++ ){
+        Aloc->applySOR(B, color_ptr[k+1] - color_ptr[k],
+                       &color_rows[color_ptr[k]], offset, omega,
+                       x, yext, y);
+      }
+    }
+    else {
+      for ( int k = cend-1; k >= cstart; k-- ){
+        Aloc->applySOR(B, color_ptr[k+1] - color_ptr[k],
+                       &color_rows[color_ptr[k]], offset, omega,
+                       x, yext, y);
+      }
+    }
+  }
+  else {
+    Aloc->applySOR(B, start, end, offset, omega, x, yext, y);
+  }
 }
 
 /*
@@ -552,6 +683,18 @@ void TACSGaussSeidel::factor(){
   where b = x - Bext * yext
 */
 void TACSGaussSeidel::applyFactor( TACSVec *txvec, TACSVec *tyvec ){
+  applySmoother(txvec, tyvec, NULL, zero_guess);
+}
+
+/*
+  Apply the smoother to the input vector.
+
+  When _zero_guess is set, the first sweep skips the communication of
+  the external values and the products with the initial guess. The
+  residual is not computed, so this returns 0.
+*/
+int TACSGaussSeidel::applySmoother( TACSVec *txvec, TACSVec *tyvec,
+                                    TACSVec *res, int _zero_guess ){
   // Covert to TACSBVec objects
   TACSBVec *xvec, *yvec;
   xvec = dynamic_cast<TACSBVec*>(txvec);
@@ -571,42 +714,40 @@ void TACSGaussSeidel::applyFactor( TACSVec *txvec, TACSVec *tyvec ){
     // Set the start/end values for the A-matrix
     const int start = 0;
     const int end = N - Nc;
-    const int offset = N - Nc;
 
     // Set the start/end values for the B-matrix
     const int bstart = end;
     const int bend = N;
 
     if (symmetric){
-      if (zero_guess){
+      if (_zero_guess){
         yvec->zeroEntries();
-        Aloc->applySOR(x, y, omega, 1);
+        applySweep(NULL, 0, N, x, y);
+
+        // The external values are zero at the start of the sweep
+        memset(yext, 0, bsize*ext_dist->getDim()*sizeof(TacsScalar));
       }
       else {
         // Begin sending the external-interface values
         ext_dist->beginForward(ctx, y, yext);
 
         // Apply the smoother to the local part of the matrix
-        Aloc->applySOR(NULL, start, end, offset, omega,
-                       x, NULL, y);
+        applySweep(NULL, start, end, x, y);
 
         // Finish sending the external-interface unknowns
         ext_dist->endForward(ctx, y, yext);
 
         // Apply the smoother to the local part of the matrix
-        Aloc->applySOR(Bext, bstart, bend, offset, omega,
-                       x, yext, y);
+        applySweep(Bext, bstart, bend, x, y);
       }
 
       // Reverse the smoother
-      Aloc->applySOR(Bext, bend, bstart, offset, omega,
-                     x, yext, y);
+      applySweep(Bext, bend, bstart, x, y);
 
       ext_dist->beginForward(ctx, y, yext);
 
       // Apply the smoother to the local part of the matrix
-      Aloc->applySOR(NULL, end, start, offset, omega,
-                     x, NULL, y);
+      applySweep(NULL, end, start, x, y);
 
       // Finish sending the external-interface unknowns
       ext_dist->endForward(ctx, y, yext);
@@ -616,49 +757,43 @@ void TACSGaussSeidel::applyFactor( TACSVec *txvec, TACSVec *tyvec ){
         ext_dist->beginForward(ctx, y, yext);
 
         // Apply the smoother to the local part of the matrix
-        Aloc->applySOR(NULL, start, end, offset, omega,
-                       x, NULL, y);
+        applySweep(NULL, start, end, x, y);
 
         // Finish sending the external-interface unknowns
         ext_dist->endForward(ctx, y, yext);
 
         // Apply the smoother to the local part of the matrix
-        Aloc->applySOR(Bext, bstart, bend, offset, omega,
-                       x, yext, y);
+        applySweep(Bext, bstart, bend, x, y);
 
         // Reverse the smoother
-        Aloc->applySOR(Bext, bend, bstart, offset, omega,
-                       x, yext, y);
+        applySweep(Bext, bend, bstart, x, y);
 
         ext_dist->beginForward(ctx, y, yext);
 
         // Apply the smoother to the local part of the matrix
-        Aloc->applySOR(NULL, end, start, offset, omega,
-                       x, NULL, y);
+        applySweep(NULL, end, start, x, y);
 
         // Finish sending the external-interface unknowns
         ext_dist->endForward(ctx, y, yext);
       }
     }
     else {
-      if (zero_guess){
+      if (_zero_guess){
         yvec->zeroEntries();
-        Aloc->applySOR(x, y, omega, 1);
+        applySweep(NULL, 0, N, x, y);
       }
       else {
         // Begin sending the external-interface values
         ext_dist->beginForward(ctx, y, yext);
 
         // Apply the smoother to the local part of the matrix
-        Aloc->applySOR(NULL, start, end, offset, omega,
-                       x, NULL, y);
+        applySweep(NULL, start, end, x, y);
 
         // Finish sending the external-interface unknowns
         ext_dist->endForward(ctx, y, yext);
 
         // Apply the smoother to the local part of the matrix
-        Aloc->applySOR(Bext, bstart, bend, offset, omega,
-                       x, yext, y);
+        applySweep(Bext, bstart, bend, x, y);
       }
 
       for ( int i = 1; i < iters; i++ ){
@@ -666,15 +801,13 @@ void TACSGaussSeidel::applyFactor( TACSVec *txvec, TACSVec *tyvec ){
         ext_dist->beginForward(ctx, y, yext);
 
         // Apply the smoother to the local part of the matrix
-        Aloc->applySOR(NULL, start, end, offset, omega,
-                       x, NULL, y);
+        applySweep(NULL, start, end, x, y);
 
         // Finish sending the external-interface unknowns
         ext_dist->endForward(ctx, y, yext);
 
         // Apply the smoother to the local part of the matrix
-        Aloc->applySOR(Bext, bstart, bend, offset, omega,
-                       x, yext, y);
+        applySweep(Bext, bstart, bend, x, y);
       }
     }
   }
@@ -682,6 +815,8 @@ void TACSGaussSeidel::applyFactor( TACSVec *txvec, TACSVec *tyvec ){
     fprintf(stderr,
             "TACSGaussSeidel type error: Input/output must be TACSBVec\n");
   }
+
+  return 0;
 }
 
 /*
@@ -705,14 +840,17 @@ TACSChebyshevSmoother::TACSChebyshevSmoother( TACSPMat *_mat, int _degree,
   TACSVec *tt = mat->createVec();
   TACSVec *ht = mat->createVec();
   TACSVec *rest = mat->createVec();
+  TACSVec *ritzt = mat->createVec();
 
   // Convert the vectors to TACSBVecs
   t = dynamic_cast<TACSBVec*>(tt);
   h = dynamic_cast<TACSBVec*>(ht);
   res = dynamic_cast<TACSBVec*>(rest);
+  ritz = dynamic_cast<TACSBVec*>(ritzt);
   t->incref();
   h->incref();
   res->incref();
+  ritz->incref();
 
   // Set the lower/upper factors
   lower_factor = _lower_factor;
@@ -721,19 +859,25 @@ TACSChebyshevSmoother::TACSChebyshevSmoother( TACSPMat *_mat, int _degree,
   // Set the numger of iterations
   iters = _iters;
 
-  // Compute the order
+  // Set the degree of the polynomial
   degree = _degree;
+  if (degree < 1){
+    degree = 1;
+  }
   alpha = beta = 0.0;
-  r = new double[ degree ];
-  c = new double[ degree+1 ];
+  dinv = NULL;
 
-  // Set default values
-  for ( int i = 0; i < degree; i++ ){
-    r[i] = 0.0;
-  }
-  for ( int i = 0; i < degree+1; i++ ){
-    c[i] = 1.0;
-  }
+  // By default, the spectral radius is estimated in each call to
+  // factor()
+  reuse_tol = 0.0;
+  cached_rho = 0.0;
+
+  // Use the threads from the local part of the matrix
+  BCSRMat *A, *B;
+  mat->getBCSRMat(&A, &B);
+  thread_info = A->getThreadInfo();
+  thread_info->incref();
+  pthread_mutex_init(&thread_mutex, NULL);
 }
 
 /*
@@ -741,57 +885,81 @@ TACSChebyshevSmoother::TACSChebyshevSmoother( TACSPMat *_mat, int _degree,
 */
 TACSChebyshevSmoother::~TACSChebyshevSmoother(){
   mat->decref();
-  delete [] r;
-  delete [] c;
   h->decref();
   t->decref();
   res->decref();
+  ritz->decref();
+  thread_info->decref();
+  pthread_mutex_destroy(&thread_mutex);
 }
 
+/*
+  Set the relative tolerance on the change in the estimate of the
+  largest eigenvalue of D^{-1}*A below which the estimate is reused.
+  A tolerance of zero (the default) estimates the spectral radius in
+  every call to factor().
+*/
+void TACSChebyshevSmoother::setEigenBoundsReuse( double tol ){
+  reuse_tol = tol;
+  cached_rho = 0.0;
+}
+
+/*
+  The number of Arnoldi steps used to estimate the largest eigenvalue
+  of D^{-1}*A
+*/
+static const int TACS_CHEBYSHEV_ARNOLDI_SIZE = 10;
+
 /*
   Factor the smoother.
 
-  This involves first estimating the spectrum of the matrix and
-  then applying the smoother.
+  This involves computing the inverse of the diagonal blocks of the
+  matrix and then estimating the largest eigenvalue of D^{-1}*A. When
+  the estimate from the previous call may be reused, the product of
+  D^{-1}*A with the unit Ritz vector from the last estimate is
+  computed. The estimate is reused if the norm of the product is
+  within the tolerance of the previous estimate, otherwise the
+  estimate is recomputed.
 */
 void TACSChebyshevSmoother::factor(){
+  // Compute the inverse of the diagonal blocks of the local matrix
+  BCSRMat *A, *B;
+  mat->getBCSRMat(&A, &B);
+  A->factorDiag();
+  dinv = A->getDiagInverse();
+
   // Compute the approximate maximum eigenvalue of the matrix
   alpha = 0.0;
   beta = 0.0;
 
-  double rho = gershgorin();
-  // double rho = arnoldi(15);
-
-  // Compute the factor
-  alpha = lower_factor*rho;
-  beta = upper_factor*rho;
-
-  // Compute the roots of the characteristic polynomial
-  for ( int k = 0; k < degree; k++ ){
-    r[k] = cos(M_PI*(0.5 + k)/degree);
-  }
-
-  // Scale the roots from the interval [-1, 1]
-  // to the correct interval [alpha, beta]
-  for ( int k = 0; k < degree; k++ ){
-    r[k] = 0.5*(beta - alpha)*(r[k] + 1.0) + alpha;
+  // Check whether the cached estimate can be reused
+  double rho = 0.0, est = 0.0;
+  if (reuse_tol > 0.0 && cached_rho > 0.0){
+    mat->mult(ritz, t);
+    applyDiagInverse(t, h);
+    est = TacsRealPart(h->norm());
+
+    if (fabs(est - cached_rho) <= reuse_tol*cached_rho){
+      // Take one power step on the Ritz vector for the next check
+      rho = (est > cached_rho ? est : cached_rho);
+      ritz->copyValues(h);
+      ritz->scale(1.0/est);
+    }
   }
 
-  // Compute the coefficients of the polynomial
-  memset(c, 0, (degree+1)*sizeof(double));
-  c[0] = 1.0;
-  for ( int j = 0; j < degree; j++ ){
-    for ( int k = j; k >= 0; k-- ){
-      c[k+1] = c[k+1] - r[j]*c[k];
+  if (rho == 0.0){
+    // Arnoldi under-estimates the largest eigenvalue, so use the
+    // larger of the two estimates
+    rho = arnoldi(TACS_CHEBYSHEV_ARNOLDI_SIZE, ritz);
+    if (est > rho){
+      rho = est;
     }
   }
+  cached_rho = rho;
 
-  // Now scale the coefficients so that q(0) = 1.0
-  // Note that q(A) = 1 - p(A)*A
-  for ( int k = 0; k < degree; k++ ){
-    c[k] = c[k]/c[degree];
-  }
-  c[degree] = 1.0;
+  // Compute the interval of eigenvalues damped by the smoother
+  alpha = lower_factor*rho;
+  beta = upper_factor*rho;
 }
 
 /*
@@ -799,38 +967,104 @@ void TACSChebyshevSmoother::factor(){
 */
 void TACSChebyshevSmoother::applyFactor( TACSVec *tx,
                                          TACSVec *ty ){
+  applySmoother(tx, ty, NULL, 0);
+}
+
+/*
+  Apply the Chebyshev smoother to A*y = x.
+
+  The polynomial in D^{-1}*A is applied with the three-term recurrence
+
+  d_{0} = D^{-1}*r_{0}/theta
+  y_{k+1} = y_{k} + d_{k}
+  r_{k+1} = r_{k} - A*d_{k}
+  d_{k+1} = rho_{k+1}*rho_{k}*d_{k} + 2*rho_{k+1}/delta*D^{-1}*r_{k+1}
+
+  where theta and delta are the center and half-width of the interval
+  [alpha, beta], and rho_{k+1} = 1/(2*theta/delta - rho_{k}) with
+  rho_{0} = delta/theta. The residual is carried through the
+  recurrence, so the residual of the output is obtained from the last
+  step, and the initial product is skipped when y is zero.
+
+  input:
+  tx:          the right-hand-side
+  ty:          the initial guess (ignored if zero_guess is set)
+  zero_guess:  flag to indicate that the initial guess is zero
+
+  output:
+  ty:          the smoothed solution
+  tr:          (optional) the residual tx - A*ty
+
+  returns:     1 if the residual was computed, 0 otherwise
+*/
+int TACSChebyshevSmoother::applySmoother( TACSVec *tx, TACSVec *ty,
+                                          TACSVec *tr, int zero_guess ){
   // Covert to TACSBVec objects
-  TACSBVec *x, *y;
+  TACSBVec *x, *y, *r = res;
   x = dynamic_cast<TACSBVec*>(tx);
   y = dynamic_cast<TACSBVec*>(ty);
+  if (tr){
+    r = dynamic_cast<TACSBVec*>(tr);
+  }
 
-  if (x && y){
-    for ( int i = 0; i < iters; i++ ){
-      // Compute the initial residual
-      // res := x - A*y
-      res->copyValues(x);
-      mat->mult(y, t);
-      res->axpy(-1.0, t);
-
-      // h = c[0]*res
-      h->copyValues(res);
-      h->scale(-c[0]);
-
-      // Compute the polynomial smoother
-      for ( int j = 0; j < degree-1; j++ ){
-        // t = A*h
+  if (!(x && y && r)){
+    fprintf(stderr, "TACSChebyshevSmoother type error: Input/output "
+            "must be TACSBVec\n");
+    return 0;
+  }
+  if (beta <= alpha || !dinv){
+    fprintf(stderr, "TACSChebyshevSmoother error: Must call factor() "
+            "before applying the smoother\n");
+    return 0;
+  }
+
+  // Compute the center and half-width of the interval
+  const double theta = 0.5*(beta + alpha);
+  const double delta = 0.5*(beta - alpha);
+  const double sigma = theta/delta;
+
+  // Compute the initial residual r = x - A*y
+  if (zero_guess){
+    y->zeroEntries();
+    r->copyValues(x);
+  }
+  else {
+    mat->mult(y, r);
+    r->axpby(1.0, -1.0, x);
+  }
+
+  for ( int i = 0; i < iters; i++ ){
+    // Set the initial update d = D^{-1}*r/theta
+    applyDiagInverse(r, h);
+    h->scale(1.0/theta);
+
+    double rho = 1.0/sigma;
+    for ( int k = 0; k < degree; k++ ){
+      // The residual update is skipped on the last step when the
+      // residual is not required
+      if (tr || k < degree-1 || i < iters-1){
         mat->mult(h, t);
 
-        // h = c[j+1]*res + t = c[j+1]*res + A*h
-        h->copyValues(res);
-        h->scale(-c[j+1]);
-        h->axpy(1.0, t);
+        if (k < degree-1){
+          // y <- y + d, r <- r - A*d and
+          // d <- rho_{k+1}*rho_{k}*d + 2*rho_{k+1}/delta*D^{-1}*r
+          double rho_next = 1.0/(2.0*sigma - rho);
+          updateVectors(y, r, h, t, 2.0*rho_next/delta, rho_next*rho, 1);
+          rho = rho_next;
+        }
+        else {
+          // y <- y + d and r <- r - A*d
+          updateVectors(y, r, h, t, 0.0, 0.0, 0);
+        }
+      }
+      else {
+        // y <- y + d
+        y->axpy(1.0, h);
       }
-
-      // y <- y + h
-      y->axpy(1.0, h);
     }
   }
+
+  return (tr ? 1 : 0);
 }
 
 /*
@@ -840,6 +1074,173 @@ void TACSChebyshevSmoother::getMat( TACSMat **_mat ){
   *_mat = mat;
 }
 
+/*
+  Apply the inverse of the diagonal blocks of the local matrix to the
+  vector: y = D^{-1}*x
+*/
+void TACSChebyshevSmoother::applyDiagInverse( TACSBVec *x, TACSBVec *y ){
+  TacsScalar *xvals, *yvals;
+  int size = x->getArray(&xvals);
+  y->getArray(&yvals);
+
+  const int bsize = x->getBlockSize();
+  const int b2 = bsize*bsize;
+  const int nrows = size/bsize;
+
+  const TacsScalar *D = dinv;
+  for ( int i = 0; i < nrows; i++ ){
+    for ( int ii = 0; ii < bsize; ii++ ){
+      TacsScalar val = 0.0;
+      for ( int jj = 0; jj < bsize; jj++ ){
+        val += D[ii*bsize + jj]*xvals[jj];
+      }
+      yvals[ii] = val;
+    }
+    D += b2;
+    xvals += bsize;
+    yvals += bsize;
+  }
+}
+
+/*
+  The number of block rows taken by each thread at a time in the
+  threaded vector updates
+*/
+static const int TACS_CHEBYSHEV_THREAD_GROUP_SIZE = 512;
+
+/*
+  Apply the vector updates for a step of the Chebyshev recurrence to
+  the block rows [start, end)
+*/
+static void TACSChebyshevUpdate( int start, int end, int bsize,
+                                 TacsScalar *y, TacsScalar *r,
+                                 TacsScalar *d, const TacsScalar *ad,
+                                 const TacsScalar *dinv,
+                                 TacsScalar c1, TacsScalar c2,
+                                 int update_dir ){
+  const int b2 = bsize*bsize;
+  for ( int i = start; i < end; i++ ){
+    TacsScalar *yi = &y[bsize*i];
+    TacsScalar *ri = &r[bsize*i];
+    TacsScalar *di = &d[bsize*i];
+    const TacsScalar *adi = &ad[bsize*i];
+    for ( int ii = 0; ii < bsize; ii++ ){
+      yi[ii] += di[ii];
+      ri[ii] -= adi[ii];
+    }
+
+    if (update_dir){
+      const TacsScalar *D = &dinv[b2*i];
+      for ( int ii = 0; ii < bsize; ii++ ){
+        TacsScalar val = 0.0;
+        for ( int jj = 0; jj < bsize; jj++ ){
+          val += D[ii*bsize + jj]*ri[jj];
+        }
+        di[ii] = c1*val + c2*di[ii];
+      }
+    }
+  }
+}
+
+/*
+  Apply the vector updates for a step of the Chebyshev recurrence in
+  a single pass through the vectors:
+
+  y <- y + d
+  r <- r - ad
+  d <- c1*D^{-1}*r + c2*d   (only if update_dir is set)
+
+  where ad = A*d. The block rows are split between the threads when
+  there is enough work for more than one thread.
+*/
+void TACSChebyshevSmoother::updateVectors( TACSBVec *y, TACSBVec *r,
+                                           TACSBVec *d, TACSBVec *ad,
+                                           TacsScalar c1, TacsScalar c2,
+                                           int update_dir ){
+  TacsScalar *yvals, *rvals, *dvals, *advals;
+  int size = y->getArray(&yvals);
+  r->getArray(&rvals);
+  d->getArray(&dvals);
+  ad->getArray(&advals);
+  const int bsize = y->getBlockSize();
+  const int nrows = size/bsize;
+
+  // Use the threads only when there is enough work for each thread
+  int num_threads = thread_info->getNumThreads();
+  if (num_threads > nrows/TACS_CHEBYSHEV_THREAD_GROUP_SIZE){
+    num_threads = nrows/TACS_CHEBYSHEV_THREAD_GROUP_SIZE;
+  }
+
+  if (num_threads > 1){
+    thread_nrows = nrows;
+    thread_bsize = bsize;
+    thread_next = 0;
+    thread_update_dir = update_dir;
+    thread_y = yvals;
+    thread_r = rvals;
+    thread_d = dvals;
+    thread_ad = advals;
+    thread_dinv = dinv;
+    thread_c1 = c1;
+    thread_c2 = c2;
+
+    // Create the joinable attribute
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
+
+    for ( int k = 0; k < num_threads; k++ ){
+      pthread_create(&threads[k], &attr,
+                     TACSChebyshevSmoother::updateVectors_thread,
+                     (void*)this);
+    }
+
+    // Join all the threads
+    for ( int k = 0; k < num_threads; k++ ){
+      pthread_join(threads[k], NULL);
+    }
+
+    // Destroy the attribute
+    pthread_attr_destroy(&attr);
+  }
+  else {
+    TACSChebyshevUpdate(0, nrows, bsize, yvals, rvals, dvals, advals,
+                        dinv, c1, c2, update_dir);
+  }
+}
+
+/*
+  The thread function for updateVectors(). Each thread takes the next
+  group of block rows until all the rows are complete.
+*/
+void *TACSChebyshevSmoother::updateVectors_thread( void *tptr ){
+  TACSChebyshevSmoother *pc = static_cast<TACSChebyshevSmoother*>(tptr);
+  const int nrows = pc->thread_nrows;
+
+  while (1){
+    // Get the next group of rows
+    pthread_mutex_lock(&pc->thread_mutex);
+    int start = pc->thread_next;
+    pc->thread_next += TACS_CHEBYSHEV_THREAD_GROUP_SIZE;
+    pthread_mutex_unlock(&pc->thread_mutex);
+
+    if (start >= nrows){
+      break;
+    }
+    int end = start + TACS_CHEBYSHEV_THREAD_GROUP_SIZE;
+    if (end > nrows){
+      end = nrows;
+    }
+
+    TACSChebyshevUpdate(start, end, pc->thread_bsize, pc->thread_y,
+                        pc->thread_r, pc->thread_d, pc->thread_ad,
+                        pc->thread_dinv, pc->thread_c1, pc->thread_c2,
+                        pc->thread_update_dir);
+  }
+
+  pthread_exit(NULL);
+}
+
 /*
   Estimate the spectral radius using Gershgorin disks
 */
@@ -937,9 +1338,17 @@ double TACSChebyshevSmoother::gershgorin(){
 }
 
 /*
-  Estimate the spectral radius using Arnoldi
+  Estimate the spectral radius of D^{-1}*A using Arnoldi
+
+  input:
+  size:   the number of Arnoldi steps
+
+  output:
+  ritz:   the unit Ritz vector for the largest eigenvalue
+
+  returns: the largest absolute eigenvalue of the Hessenberg matrix
 */
-double TACSChebyshevSmoother::arnoldi( int size ){
+double TACSChebyshevSmoother::arnoldi( int size, TACSBVec *ritz ){
   double *H = new double[ size*(size+1) ];
   memset(H, 0, size*(size+1)*sizeof(double));
 
@@ -957,8 +1366,10 @@ double TACSChebyshevSmoother::arnoldi( int size ){
     W[i+1] = mat->createVec();
     W[i+1]->incref();
 
-    // Multiply by the matrix to get the next vector
-    mat->mult(W[i], W[i+1]);
+    // Multiply by the matrix and the inverse of the diagonal blocks
+    // to get the next vector
+    mat->mult(W[i], t);
+    applyDiagInverse(t, dynamic_cast<TACSBVec*>(W[i+1]));
 
     // Orthogonalize against the existing subspace
     for ( int j = 0; j <= i; j++ ){
@@ -973,9 +1384,11 @@ double TACSChebyshevSmoother::arnoldi( int size ){
     W[i+1]->scale(1.0/H[index]);
   }
 
-  // Allocate space for the real/complex eigenvalue
+  // Allocate space for the real/complex eigenvalue and the
+  // eigenvectors of the Hessenberg matrix
   double *eigreal = new double[ size ];
   double *eigimag = new double[ size ];
+  double *V = new double[ size*size ];
 
   // Compute the eigenspectrum of the Hessenberg matrix
   int lwork = 4*size;
@@ -983,24 +1396,38 @@ double TACSChebyshevSmoother::arnoldi( int size ){
   int ldv = 1;
   int ldh = size+1;
   int info = 0;
-  LAPACKdgeev("N", "N", &size, H, &ldh, eigreal, eigimag,
-              NULL, &ldv, NULL, &ldv, work, &lwork, &info);
+  LAPACKdgeev("N", "V", &size, H, &ldh, eigreal, eigimag,
+              NULL, &ldv, V, &size, work, &lwork, &info);
 
   // Find the maximum absolute eigenvalue
   double rho = 0.0;
+  int kmax = 0;
   for ( int i = 0; i < size; i++ ){
     double val = sqrt(eigreal[i]*eigreal[i] + eigimag[i]*eigimag[i]);
     if (val > rho){
       rho = val;
+      kmax = i;
     }
   }
 
+  // Form the Ritz vector from the real part of the eigenvector. For a
+  // complex pair, the real part is stored in the first column.
+  if (eigimag[kmax] < 0.0 && kmax > 0){
+    kmax--;
+  }
+  ritz->zeroEntries();
+  for ( int i = 0; i < size; i++ ){
+    ritz->axpy(V[i + kmax*size], W[i]);
+  }
+  ritz->scale(1.0/ritz->norm());
+
   for ( int i = 0; i < size+1; i++ ){
     W[i]->decref();
   }
 
   delete [] eigreal;
   delete [] eigimag;
+  delete [] V;
   delete [] work;
   delete [] H;
   delete [] W;
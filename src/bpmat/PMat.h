@@ -118,6 +118,15 @@ class TACSPMat : public TACSMat {
   This uses repeated applications of block Gauss--Seidel. Off-processor 
   updates are delayed, effectively making this a hybrid Jacobi Gauss-Seidel
   method.
+
+  When the multicolor option is set, the local rows are colored so
+  that the rows of each color are not coupled to one another. The
+  rows without external coupling and the rows with external coupling
+  are colored separately so that the communication is still
+  overlapped with the sweep over the local rows. Each color is then
+  updated in parallel using the threads from the matrix. The result
+  does not depend on the number of threads, but differs from the
+  natural-order sweep.
 */
 class TACSGaussSeidel : public TACSPc {
  public:
@@ -128,9 +137,17 @@ class TACSGaussSeidel : public TACSPc {
 
   void factor();
   void applyFactor( TACSVec *xvec, TACSVec *yvec );
+  int applySmoother( TACSVec *xvec, TACSVec *yvec, TACSVec *res,
+                     int _zero_guess );
   void getMat( TACSMat **_mat );
+  void setMultiColor( int flag );
 
  private:
+  // Apply a sweep over the rows [start, end), or in the reverse
+  // order over [end, start) when start > end
+  void applySweep( BCSRMat *B, int start, int end,
+                   TacsScalar *x, TacsScalar *y );
+
   // Parallel matrix pointer
   TACSPMat *mat;
 
@@ -150,10 +167,34 @@ class TACSGaussSeidel : public TACSPc {
   TACSBVecDistCtx *ctx;
   int ext_offset;
   TacsScalar *yext;
+
+  // The multicolor ordering of the rows. The first num_local_colors
+  // colors contain the rows without external coupling.
+  int num_colors, num_local_colors;
+  int *color_ptr, *color_rows;
 };
 
 /*
   Chebyshev Smoother
+
+  The smoother applies a Chebyshev polynomial in D^{-1}*A that damps
+  the error components with eigenvalues in [alpha, beta], where D is
+  the block diagonal of the local matrix, beta is an estimate of the
+  largest eigenvalue of D^{-1}*A scaled by upper_factor and alpha is
+  beta scaled by lower_factor. The polynomial is applied with the
+  three-term recurrence, so that only matrix-vector products, the
+  block-diagonal inverse and vector updates are required. The residual
+  is updated within the recurrence and is available after the last
+  step without an additional product.
+
+  The vector updates for each step of the recurrence are fused into a
+  single pass that is split between the threads from the matrix. The
+  largest eigenvalue is estimated with a few steps of Arnoldi. The
+  estimate can be reused when the smoother is factored again: the
+  unit Ritz vector from the last estimate is multiplied by D^{-1}*A
+  for the new matrix, and the estimate is reused only if the norm of
+  the product is within the relative tolerance set with
+  setEigenBoundsReuse() of the previous estimate.
 */
 class TACSChebyshevSmoother : public TACSPc {
  public:
@@ -164,14 +205,26 @@ class TACSChebyshevSmoother : public TACSPc {
 
   void factor();
   void applyFactor( TACSVec *xvec, TACSVec *yvec );
+  int applySmoother( TACSVec *xvec, TACSVec *yvec, TACSVec *rvec,
+                     int zero_guess );
   void getMat( TACSMat **_mat );
+  void setEigenBoundsReuse( double tol );
 
  private:
+  // Apply the inverse of the block diagonal y = D^{-1}*x
+  void applyDiagInverse( TACSBVec *x, TACSBVec *y );
+
+  // Apply the fused vector updates for a step of the recurrence
+  void updateVectors( TACSBVec *y, TACSBVec *r, TACSBVec *d,
+                      TACSBVec *ad, TacsScalar c1, TacsScalar c2,
+                      int update_dir );
+  static void *updateVectors_thread( void *t );
+
   // Estimate the spectral radius using Gershgorin method
   double gershgorin();
 
-  // Estimate the spectral radius using Arnoldi
-  double arnoldi( int size );
+  // Estimate the spectral radius of D^{-1}*A using Arnoldi
+  double arnoldi( int size, TACSBVec *ritz );
 
   // Parallel matrix pointer
   TACSPMat *mat;
@@ -186,12 +239,31 @@ class TACSChebyshevSmoother : public TACSPc {
   // The number of iterations to apply
   int iters;
 
-  // The degree of the polynomial, the roots and coefficients
+  // The degree of the polynomial
   int degree;
-  double *r, *c;
 
   // Temporary vectors
   TACSBVec *res, *t, *h;
+
+  // The inverse of the diagonal blocks of the local matrix
+  const TacsScalar *dinv;
+
+  // The cached estimate of the spectral radius of D^{-1}*A and the
+  // Ritz vector used to check it
+  double reuse_tol;
+  double cached_rho;
+  TACSBVec *ritz;
+
+  // The pthread data for the vector updates
+  TACSThreadInfo *thread_info;
+  pthread_t threads[TACSThreadInfo::TACS_MAX_NUM_THREADS];
+  pthread_mutex_t thread_mutex;
+
+  // The arguments for the threaded update and the next entry
+  int thread_nrows, thread_bsize, thread_next, thread_update_dir;
+  TacsScalar *thread_y, *thread_r, *thread_d;
+  const TacsScalar *thread_ad, *thread_dinv;
+  TacsScalar thread_c1, thread_c2;
 };
 
 /*
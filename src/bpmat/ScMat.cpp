@@ -359,9 +359,12 @@ void ScMat::getBCSRMat( BCSRMat **_B, BCSRMat **_E,
   levFill: the level of fill to use
   fill:    the expected/best estimate of the fill-in factor
   reorder: flag to indicate whether to re-order the global Schur complement
+  max_grid_procs: (optional) limit the number of processors used for the
+                  global Schur complement, for instance to agglomerate
+                  a small coarse problem onto a subset of processors
 */
 PcScMat::PcScMat( ScMat *_mat, int levFill, double fill,
-                  int reorder_schur_complement ){
+                  int reorder_schur_complement, int max_grid_procs ){
   mat = _mat;
   mat->incref();
 
@@ -376,6 +379,7 @@ PcScMat::PcScMat( ScMat *_mat, int levFill, double fill,
 
   // By default use the less-memory intensive option
   use_pdmat_alltoall = 0;
+  use_pdmat_plan = 0;
 
   // Perform the symbolic factorization of the [ B, E; F, C ] matrix
   int use_full_schur = 1; // Use the exact F * B^{-1} * E
@@ -423,6 +427,9 @@ PcScMat::PcScMat( ScMat *_mat, int levFill, double fill,
       break;
     }
   }
+  if (max_grid_procs > 0 && max_grid_procs < max_grid_size){
+    max_grid_size = max_grid_procs;
+  }
 
   // Get the indices of the global variables
   TACSBVecIndices *c_map_indx = c_map->getIndices();
@@ -510,6 +517,9 @@ PcScMat::PcScMat( ScMat *_mat, int levFill, double fill,
                     reorder_schur_complement, max_grid_size);
   pdmat->incref();
 
+  // Use the threads from the local matrix for the dense factorization
+  pdmat->setThreadInfo(B->getThreadInfo());
+
   // Get the information about the reordering/blocks from the matrix
   int nrows, ncols;
   const int *bptr, *xbptr, *perm, *iperm, *orig_bptr;
@@ -815,6 +825,44 @@ void PcScMat::setAlltoallAssemblyFlag( int flag ){
   use_pdmat_alltoall = flag;
 }
 
+/*
+  Set the flag that controls whether a persistent plan is used for
+  the matrix assembly.
+
+  The non-zero pattern of the local Schur complement is fixed, so the
+  destination of each block in the PDMat matrix and the communication
+  pattern can be computed once, during the first factorization. All
+  subsequent factorizations only send the numerical values to the
+  processors that require them. This is beneficial when the
+  preconditioner is factored many times, for instance within an
+  optimization, but the message buffers are retained between calls.
+  When set, this flag takes precedence over the Alltoall flag.
+
+  input:
+  flag:  the flag value to use for the assembly plan
+*/
+void PcScMat::setAssemblyPlanFlag( int flag ){
+  use_pdmat_plan = flag;
+}
+
+/*
+  Set the tolerance for the low-rank compression of the blocks of the
+  factored global Schur complement.
+
+  The blocks of the Schur complement that couple distant parts of the
+  interface are often numerically low-rank. When the tolerance is
+  positive, these blocks are compressed within the PDMat
+  factorization, and the preconditioner becomes an approximate
+  factorization. This is collective and must be called with the same
+  tolerance on all processes.
+
+  input:
+  tol:  the relative compression tolerance (zero to disable)
+*/
+void PcScMat::setLowRankTolerance( double tol ){
+  pdmat->setLowRankTolerance(tol);
+}
+
 /*
   Factor the Schur-complement based preconditioner
 
@@ -884,10 +932,17 @@ void PcScMat::factor(){
   Sc->getArrays(&bsize, &mlocal, &nlocal,
                 &rowp, &cols, &scvals);
 
-  // Add the values into the global Schur complement matrix
-  // using either the alltoall approach or a sequential add values
-  // approach that uses less memory
-  if (use_pdmat_alltoall){
+  // Add the values into the global Schur complement matrix using
+  // either the persistent plan, the alltoall approach or a sequential
+  // add values approach that uses less memory
+  if (use_pdmat_plan){
+    if (!pdmat->hasAddValuesPlan()){
+      pdmat->initAddValuesPlan(bsize, mlocal, local_schur_vars,
+                               rowp, cols);
+    }
+    pdmat->addPlanValues(scvals);
+  }
+  else if (use_pdmat_alltoall){
     pdmat->addAlltoallValues(bsize, mlocal, local_schur_vars,
                              rowp, cols, scvals);
   }
@@ -1067,3 +1122,22 @@ void PcScMat::applyFactor( TACSVec *tin, TACSVec *tout ){
 void PcScMat::getMat( TACSMat **_mat ){
   *_mat = mat;
 }
+
+/*
+  Count the number of negative eigenvalues of the factored matrix.
+
+  By Sylvester's law of inertia, the inertia of the symmetric matrix
+  is the sum of the inertia of the local B matrices and the inertia of
+  the global Schur complement. This is only exact when the local
+  factorization is complete, i.e. the level of fill is sufficient to
+  retain all the fill-in. This call is collective.
+*/
+int PcScMat::getNumNegEigs(){
+  int nneg = Bpc->getNumNegEigs();
+
+  int nneg_all = 0;
+  MPI_Allreduce(&nneg, &nneg_all, 1, MPI_INT, MPI_SUM,
+                b_map->getMPIComm());
+
+  return nneg_all + pdmat->getNumNegEigs();
+}
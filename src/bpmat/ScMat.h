@@ -132,7 +132,7 @@ class ScMat : public TACSMat {
 class PcScMat : public TACSPc {
  public:
   PcScMat( ScMat *_mat, int levFill, double fill, 
-           int reorder_schur_complement );
+           int reorder_schur_complement, int max_grid_procs=-1 );
   ~PcScMat();
 
   // Functions associated with the factorization
@@ -140,6 +140,7 @@ class PcScMat : public TACSPc {
   void factor();
   void applyFactor( TACSVec *xvec, TACSVec *yvec );
   void getMat( TACSMat **_mat );
+  int getNumNegEigs();
   void testSchurComplement( TACSVec *in, TACSVec *out );
 
   // Monitor the factorization time on each process
@@ -150,6 +151,11 @@ class PcScMat : public TACSPc {
   // Set the type of matrix assembly to use
   // --------------------------------------
   void setAlltoallAssemblyFlag( int flag );
+  void setAssemblyPlanFlag( int flag );
+
+  // Set the tolerance for the low-rank compression in PDMat
+  // -------------------------------------------------------
+  void setLowRankTolerance( double tol );
 
   // Get the underlying precondition representation
   // ----------------------------------------------
@@ -185,6 +191,7 @@ class PcScMat : public TACSPc {
   TACSBVecDistribute *schur_dist; // Map that distributes the Schur complement
   TACSBVecDistCtx *schur_ctx; // The context for the distribution object
   int use_pdmat_alltoall; // Use the Alltoall version for matrix assembly
+  int use_pdmat_plan; // Use a persistent plan for matrix assembly
 
   // This object defines a mapping between the variables in the
   // global vectors (from ScMat - in/out in applyFactor) and the 
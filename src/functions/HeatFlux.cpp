@@ -119,7 +119,7 @@ void HeatFluxIntegral::elementWiseEval( EvaluationType ftype,
                                         const TacsScalar ddvars[],
                                         TACSFunctionCtx *fctx ){
   HeatFluxIntCtx *ctx = dynamic_cast<HeatFluxIntCtx*>(fctx);
-  elem_to_surf_it = elem_to_surf.find(elemNum);
+  std::map<int, int>::iterator elem_to_surf_it = elem_to_surf.find(elemNum);
   int surface = elem_to_surf_it->second;
 
   if (ctx){
@@ -298,7 +298,7 @@ void HeatFluxIntegral::getElementSVSens( double alpha,
                                          const TacsScalar ddvars[],
                                          TACSFunctionCtx *fctx ){
   HeatFluxIntCtx *ctx = dynamic_cast<HeatFluxIntCtx*>(fctx);
-  elem_to_surf_it = elem_to_surf.find(elemNum);
+  std::map<int, int>::iterator elem_to_surf_it = elem_to_surf.find(elemNum);
   int surface = elem_to_surf_it->second;
 
   // Zero the derivative of the function w.r.t. the element state
@@ -482,7 +482,7 @@ void HeatFluxIntegral::addElementDVSens( const double tcoef,
                                          const TacsScalar ddvars[],
                                          TACSFunctionCtx *fctx ){
   HeatFluxIntCtx *ctx = dynamic_cast<HeatFluxIntCtx*>(fctx);
-  elem_to_surf_it = elem_to_surf.find(elemNum);
+  std::map<int, int>::iterator elem_to_surf_it = elem_to_surf.find(elemNum);
   int surface = elem_to_surf_it->second;
   if (ctx){
     const int numDisps = element->numDisplacements();
@@ -105,7 +105,6 @@ class HeatFluxIntegral : public TACSFunction {
   
   int mpi_rank;
   std::map<int, int>elem_to_surf;
-  std::map<int, int>::iterator elem_to_surf_it;
 };
 
 #endif // TACS_HEAT_FLUX_H
@@ -17,6 +17,404 @@
 */
 
 #include "FH5.h"
+#include <math.h>
+
+// The largest magnitude of a 16-bit IEEE float
+static const double FH5_HALF_MAX = 65504.0;
+
+/*
+  Convert a float to a 16-bit IEEE half-precision float (round to
+  nearest)
+*/
+static unsigned short FH5FloatToHalf( float f ){
+  unsigned int x;
+  memcpy(&x, &f, sizeof(float));
+  unsigned int sign = (x >> 16) & 0x8000;
+  int fexp = (x >> 23) & 0xff;
+  unsigned int mant = x & 0x7fffff;
+
+  // Infinity or NaN
+  if (fexp == 0xff){
+    return sign | 0x7c00 | (mant ? 0x200 : 0);
+  }
+
+  int hexp = fexp - 127 + 15;
+  if (hexp >= 31){
+    // Overflow to infinity
+    return sign | 0x7c00;
+  }
+  else if (hexp <= 0){
+    // Subnormal half or underflow to zero
+    if (hexp < -10){
+      return sign;
+    }
+    mant |= 0x800000;
+    int shift = 14 - hexp;
+    unsigned int h = mant >> shift;
+    if ((mant >> (shift-1)) & 1){
+      h++;
+    }
+    return sign | h;
+  }
+
+  unsigned int h = sign | (hexp << 10) | (mant >> 13);
+  if (mant & 0x1000){
+    h++;
+  }
+  return h;
+}
+
+/*
+  Convert a 16-bit IEEE half-precision float to a float
+*/
+static float FH5HalfToFloat( unsigned short h ){
+  unsigned int sign = (h & 0x8000) << 16;
+  int hexp = (h >> 10) & 0x1f;
+  unsigned int mant = h & 0x3ff;
+
+  unsigned int x = 0;
+  if (hexp == 0){
+    // Zero or subnormal half
+    float v = ldexpf(1.0f*mant, -24);
+    return (sign ? -v : v);
+  }
+  else if (hexp == 31){
+    x = sign | 0x7f800000 | (mant << 13);
+  }
+  else {
+    x = sign | ((hexp - 15 + 127) << 23) | (mant << 13);
+  }
+
+  float f;
+  memcpy(&f, &x, sizeof(float));
+  return f;
+}
+
+/*
+  Compress the data by shuffling the bytes of each element (so that
+  the most significant bytes are contiguous) followed by run-length
+  encoding. Each run starts with a control byte c: if c < 128, c+1
+  literal bytes follow, otherwise the next byte is repeated c-125
+  times.
+
+  The output buffer must be of length len + len/128 + 1.
+*/
+static size_t FH5Compress( const unsigned char *in, size_t len,
+                           int elem_size, unsigned char *out ){
+  // Shuffle the bytes
+  unsigned char *buf = new unsigned char[ len+1 ];
+  size_t n = len/elem_size;
+  for ( size_t i = 0; i < n; i++ ){
+    for ( int j = 0; j < elem_size; j++ ){
+      buf[j*n + i] = in[i*elem_size + j];
+    }
+  }
+  memcpy(&buf[n*elem_size], &in[n*elem_size], len - n*elem_size);
+
+  size_t pos = 0, i = 0;
+  while (i < len){
+    // Find the length of the run starting at i
+    size_t run = 1;
+    while (i + run < len && run < 130 && buf[i + run] == buf[i]){
+      run++;
+    }
+
+    if (run >= 3){
+      out[pos] = run + 125;
+      out[pos+1] = buf[i];
+      pos += 2;
+      i += run;
+    }
+    else {
+      // Copy literals until the next run of at least 3 bytes
+      size_t start = i;
+      while (i < len && i - start < 128){
+        if (i + 2 < len && buf[i] == buf[i+1] && buf[i] == buf[i+2]){
+          break;
+        }
+        i++;
+      }
+      out[pos] = i - start - 1;
+      memcpy(&out[pos+1], &buf[start], i - start);
+      pos += 1 + i - start;
+    }
+  }
+
+  delete [] buf;
+  return pos;
+}
+
+/*
+  Decompress the data created by FH5Compress
+
+  returns:
+  1 on success, 0 if the data is corrupted
+*/
+static int FH5Decompress( const unsigned char *in, size_t in_len,
+                          int elem_size, unsigned char *out,
+                          size_t len ){
+  unsigned char *buf = new unsigned char[ len+1 ];
+  size_t pos = 0, i = 0;
+  while (i < in_len){
+    if (in[i] < 128){
+      size_t run = in[i] + 1;
+      if (i + 1 + run > in_len || pos + run > len){
+        break;
+      }
+      memcpy(&buf[pos], &in[i+1], run);
+      pos += run;
+      i += 1 + run;
+    }
+    else {
+      size_t run = in[i] - 125;
+      if (i + 1 >= in_len || pos + run > len){
+        break;
+      }
+      memset(&buf[pos], in[i+1], run);
+      pos += run;
+      i += 2;
+    }
+  }
+
+  int fail = (pos != len || i != in_len);
+  if (!fail){
+    // Unshuffle the bytes
+    size_t n = len/elem_size;
+    for ( size_t k = 0; k < n; k++ ){
+      for ( int j = 0; j < elem_size; j++ ){
+        out[k*elem_size + j] = buf[j*n + k];
+      }
+    }
+    memcpy(&out[n*elem_size], &buf[n*elem_size], len - n*elem_size);
+  }
+
+  delete [] buf;
+  return !fail;
+}
+
+/*
+  Get the size of an element of the data after encoding
+*/
+static int FH5EncodedSize( int dtype, int codec ){
+  int enc = codec & ~FH5File::FH5_LOSSLESS;
+  if (enc == FH5File::FH5_HALF){
+    return sizeof(unsigned short);
+  }
+  else if (enc == FH5File::FH5_QUANTIZE || enc == FH5File::FH5_DELTA){
+    return sizeof(unsigned int);
+  }
+  else if (dtype == FH5File::FH5_INT){
+    return sizeof(int);
+  }
+  else if (dtype == FH5File::FH5_FLOAT){
+    return sizeof(float);
+  }
+  return sizeof(double);
+}
+
+/*
+  Encode the local rows of a zone into a chunk of bytes.
+
+  The chunk consists of the parameters for the encoding (the minimum
+  of each column and the step for quantization) followed by the
+  encoded values. When the lossless compression is used, the
+  uncompressed length of the values is stored before the compressed
+  values.
+*/
+static size_t FH5EncodeChunk( int dtype, int codec, double tol,
+                              void *data, int dim1, int dim2,
+                              unsigned char **chunk ){
+  int enc = codec & ~FH5File::FH5_LOSSLESS;
+  size_t n = (size_t)dim1*dim2;
+  int elem_size = FH5EncodedSize(dtype, codec);
+  size_t param_len = 0;
+  if (enc == FH5File::FH5_QUANTIZE){
+    param_len = (dim2 + 1)*sizeof(double);
+  }
+
+  // Encode the data
+  unsigned char *params = new unsigned char[ param_len+1 ];
+  unsigned char *values = new unsigned char[ n*elem_size+1 ];
+  if (enc == FH5File::FH5_HALF){
+    unsigned short *h = (unsigned short*)values;
+    for ( size_t i = 0; i < n; i++ ){
+      if (dtype == FH5File::FH5_FLOAT){
+        h[i] = FH5FloatToHalf(((float*)data)[i]);
+      }
+      else {
+        h[i] = FH5FloatToHalf(((double*)data)[i]);
+      }
+    }
+  }
+  else if (enc == FH5File::FH5_QUANTIZE){
+    // Find the range of each column
+    double *xmin = (double*)params;
+    double *step = &xmin[dim2];
+    double max_range = 0.0;
+    for ( int j = 0; j < dim2; j++ ){
+      double lb = 0.0, ub = 0.0;
+      for ( int i = 0; i < dim1; i++ ){
+        double x = (dtype == FH5File::FH5_FLOAT ?
+                    ((float*)data)[i*dim2 + j] :
+                    ((double*)data)[i*dim2 + j]);
+        if (i == 0 || x < lb){ lb = x; }
+        if (i == 0 || x > ub){ ub = x; }
+      }
+      xmin[j] = lb;
+      if (ub - lb > max_range){
+        max_range = ub - lb;
+      }
+    }
+
+    // The error is bounded by tol unless the range cannot be
+    // represented with 32-bit integers. Without a tolerance, use
+    // 16-bit resolution of the range.
+    step[0] = 2.0*tol;
+    if (tol <= 0.0){
+      step[0] = max_range/65535.0;
+    }
+    if (max_range > 4294967295.0*step[0]){
+      step[0] = max_range/4294967295.0;
+    }
+
+    unsigned int *q = (unsigned int*)values;
+    for ( int i = 0; i < dim1; i++ ){
+      for ( int j = 0; j < dim2; j++ ){
+        double x = (dtype == FH5File::FH5_FLOAT ?
+                    ((float*)data)[i*dim2 + j] :
+                    ((double*)data)[i*dim2 + j]);
+        q[i*dim2 + j] = 0;
+        if (step[0] > 0.0){
+          q[i*dim2 + j] = (unsigned int)floor((x - xmin[j])/step[0] + 0.5);
+        }
+      }
+    }
+  }
+  else if (enc == FH5File::FH5_DELTA){
+    // Zig-zag encode the difference between consecutive entries
+    unsigned int *z = (unsigned int*)values;
+    int prev = 0;
+    for ( size_t i = 0; i < n; i++ ){
+      int d = ((int*)data)[i] - prev;
+      prev = ((int*)data)[i];
+      z[i] = ((unsigned int)d << 1) ^ (unsigned int)(d >> 31);
+    }
+  }
+  else {
+    memcpy(values, data, n*elem_size);
+  }
+
+  // Assemble the chunk
+  size_t len = 0;
+  if (codec & FH5File::FH5_LOSSLESS){
+    size_t raw_len = n*elem_size;
+    *chunk = new unsigned char[ param_len + sizeof(long long) +
+                                raw_len + raw_len/128 + 1 ];
+    memcpy(*chunk, params, param_len);
+    long long rlen = raw_len;
+    memcpy(&(*chunk)[param_len], &rlen, sizeof(long long));
+    len = param_len + sizeof(long long);
+    len += FH5Compress(values, raw_len, elem_size, &(*chunk)[len]);
+  }
+  else {
+    *chunk = new unsigned char[ param_len + n*elem_size + 1 ];
+    memcpy(*chunk, params, param_len);
+    memcpy(&(*chunk)[param_len], values, n*elem_size);
+    len = param_len + n*elem_size;
+  }
+
+  delete [] params;
+  delete [] values;
+  return len;
+}
+
+/*
+  Decode a chunk of bytes created by FH5EncodeChunk into the output
+  array (float for FH5_HALF, the original type otherwise)
+
+  returns:
+  the number of rows decoded, or -1 if the chunk is corrupted
+*/
+static int FH5DecodeChunk( int dtype, int codec,
+                           const unsigned char *chunk, size_t len,
+                           int dim2, void *out, size_t max_len ){
+  int enc = codec & ~FH5File::FH5_LOSSLESS;
+  int elem_size = FH5EncodedSize(dtype, codec);
+  size_t param_len = 0;
+  if (enc == FH5File::FH5_QUANTIZE){
+    param_len = (dim2 + 1)*sizeof(double);
+  }
+  if (len < param_len){
+    return -1;
+  }
+
+  // Retrieve the encoded values
+  const unsigned char *values = &chunk[param_len];
+  unsigned char *buf = NULL;
+  size_t raw_len = len - param_len;
+  if (codec & FH5File::FH5_LOSSLESS){
+    long long rlen = 0;
+    if (len < param_len + sizeof(long long)){
+      return -1;
+    }
+    memcpy(&rlen, values, sizeof(long long));
+    if (rlen < 0 || (size_t)rlen > max_len*elem_size){
+      return -1;
+    }
+    raw_len = rlen;
+    buf = new unsigned char[ raw_len+1 ];
+    if (!FH5Decompress(&values[sizeof(long long)],
+                       len - param_len - sizeof(long long),
+                       elem_size, buf, raw_len)){
+      delete [] buf;
+      return -1;
+    }
+    values = buf;
+  }
+
+  size_t n = raw_len/elem_size;
+  if (n > max_len || (dim2 > 0 && n % dim2 != 0)){
+    if (buf){ delete [] buf; }
+    return -1;
+  }
+
+  if (enc == FH5File::FH5_HALF){
+    const unsigned short *h = (const unsigned short*)values;
+    for ( size_t i = 0; i < n; i++ ){
+      ((float*)out)[i] = FH5HalfToFloat(h[i]);
+    }
+  }
+  else if (enc == FH5File::FH5_QUANTIZE){
+    const double *xmin = (const double*)chunk;
+    double step = xmin[dim2];
+    const unsigned int *q = (const unsigned int*)values;
+    if (dtype == FH5File::FH5_FLOAT){
+      for ( size_t i = 0; i < n; i++ ){
+        ((float*)out)[i] = xmin[i % dim2] + q[i]*step;
+      }
+    }
+    else {
+      for ( size_t i = 0; i < n; i++ ){
+        ((double*)out)[i] = xmin[i % dim2] + q[i]*step;
+      }
+    }
+  }
+  else if (enc == FH5File::FH5_DELTA){
+    const unsigned int *z = (const unsigned int*)values;
+    int prev = 0;
+    for ( size_t i = 0; i < n; i++ ){
+      int d = (int)(z[i] >> 1) ^ -(int)(z[i] & 1);
+      prev += d;
+      ((int*)out)[i] = prev;
+    }
+  }
+  else {
+    memcpy(out, values, n*elem_size);
+  }
+
+  if (buf){ delete [] buf; }
+  return (dim2 > 0 ? n/dim2 : 0);
+}
 
 /*
   Create the FH5 object with the given communicator
@@ -32,6 +430,8 @@ FH5File::FH5File( MPI_Comm _comm ){
   current = root = tip = NULL;
   num_comp = 0;
   comp_names = NULL;
+  num_steps = 0;
+  steps = NULL;
 }
 
 /*
@@ -40,6 +440,7 @@ FH5File::FH5File( MPI_Comm _comm ){
 FH5File::~FH5File(){
   if (rfp){ fclose(rfp); }
   if (root){ deleteFH5FileInfo(); }
+  if (steps){ delete [] steps; }
 
   if (comp_names){
     for ( int k = 0; k < num_comp; k++ ){
@@ -184,16 +585,76 @@ int FH5File::createFile( const char *file_name,
   data (double) or (int) 
   
   dim1*dim2*sizeof(double)/sizeof(int)
+
+  When the data is encoded, the codec is stored in the upper bits of
+  the data type and the data consists of:
+
+  number of chunks (int)
+  size of each chunk (long long)
+  chunks (one per processor, see FH5EncodeChunk)
+
+  When FH5_HALF is selected and any value on any processor exceeds
+  the largest half-precision float (65504) in magnitude, the zone is
+  written with full precision instead, keeping FH5_LOSSLESS if it was
+  selected. This call is collective on the communicator.
+
+  FH5_QUANTIZE stores each value as a 32-bit integer multiple of 2*tol
+  from the minimum of its column. The decoded values, which have the
+  original type, are within tol of the input, plus the rounding to
+  that type (float or double). The integers are no smaller than the
+  input floats, so FH5_QUANTIZE is always combined with FH5_LOSSLESS.
+
+  input:
+  codec:  the encoding of the data (FH5Codec)
+  tol:    the absolute error bound for FH5_QUANTIZE
 */
 int FH5File::writeZoneData( char *zone_name, 
                             char *var_names,
                             FH5DataType data_name, 
-                            void *data, int dim1, int dim2 ){
+                            void *data, int dim1, int dim2,
+                            int codec, double tol ){
   // Check the file status to ensure that it's open
   if (fp && file_for_writing){
     int rank, size;
     MPI_Comm_rank(comm, &rank);
     MPI_Comm_size(comm, &size);
+
+    // Check that the encoding is consistent with the data type
+    int enc = codec & ~FH5_LOSSLESS;
+    if (((enc == FH5_HALF || enc == FH5_QUANTIZE) && data_name == FH5_INT) ||
+        (enc == FH5_DELTA && data_name != FH5_INT) || enc > FH5_DELTA){
+      if (rank == 0){
+        fprintf(stderr, "[%d] FH5: Codec %d is invalid for zone %s, "
+                "writing raw data\n", rank, codec, zone_name);
+      }
+      codec = FH5_RAW;
+    }
+    else if (enc == FH5_QUANTIZE){
+      codec |= FH5_LOSSLESS;
+    }
+
+    // Values beyond the range of the 16-bit floats would be written
+    // as infinity. In this case, write the zone without the
+    // half-precision encoding on all processors.
+    if (enc == FH5_HALF){
+      int overflow = 0;
+      size_t n = (size_t)dim1*dim2;
+      for ( size_t i = 0; i < n && !overflow; i++ ){
+        double x = (data_name == FH5_FLOAT ? ((float*)data)[i] :
+                    ((double*)data)[i]);
+        if (fabs(x) > FH5_HALF_MAX){
+          overflow = 1;
+        }
+      }
+      MPI_Allreduce(MPI_IN_PLACE, &overflow, 1, MPI_INT, MPI_MAX, comm);
+      if (overflow){
+        codec &= FH5_LOSSLESS;
+      }
+    }
+    if (codec != FH5_RAW){
+      return writeEncodedZoneData(zone_name, var_names, data_name,
+                                  data, dim1, dim2, codec, tol);
+    }
     
     int *dim = new int[ size+1 ];
     dim[0] = 0;
@@ -273,6 +734,92 @@ int FH5File::writeZoneData( char *zone_name,
   return 0;
 }
 
+/*
+  Write the encoded data to a file.
+
+  Each processor encodes its rows independently. The sizes of the
+  encoded chunks are gathered so that the chunks can be written with
+  a single collective call.
+*/
+int FH5File::writeEncodedZoneData( char *zone_name,
+                                   char *var_names,
+                                   FH5DataType data_name,
+                                   void *data, int dim1, int dim2,
+                                   int codec, double tol ){
+  int rank, size;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
+
+  // Find the total dimension of the data
+  int total_dim = 0;
+  MPI_Allreduce(&dim1, &total_dim, 1, MPI_INT, MPI_SUM, comm);
+
+  // Encode the local chunk and gather the sizes of all the chunks
+  unsigned char *chunk = NULL;
+  long long chunk_len = FH5EncodeChunk(data_name, codec, tol,
+                                       data, dim1, dim2, &chunk);
+  long long *chunk_size = new long long[ size ];
+  MPI_Allgather(&chunk_len, 1, MPI_LONG_LONG_INT,
+                chunk_size, 1, MPI_LONG_LONG_INT, comm);
+
+  // Calculate the size of the buffer to use
+  size_t header_len =
+    5*sizeof(int) + strlen(zone_name) + strlen(var_names) + 2 +
+    sizeof(int) + size*sizeof(long long);
+
+  // Write the zone and variable names to the file
+  char datarep[] = "native";
+  MPI_File_set_view(fp, file_offset, MPI_CHAR, MPI_CHAR,
+                    datarep, MPI_INFO_NULL);
+
+  // Write the header and the chunk sizes on the root processor
+  if (rank == 0){
+    char *pre_header = new char[ header_len ];
+    int pre_int[5];
+    pre_int[0] = data_name | (codec << 8);
+    pre_int[1] = total_dim;
+    pre_int[2] = dim2;
+    pre_int[3] = strlen(zone_name)+1;
+    pre_int[4] = strlen(var_names)+1;
+    memcpy(pre_header, pre_int, 5*sizeof(int));
+
+    size_t off = 5*sizeof(int);
+    memcpy(&pre_header[off], zone_name, strlen(zone_name)+1);
+    off += strlen(zone_name)+1;
+    memcpy(&pre_header[off], var_names, strlen(var_names)+1);
+    off += strlen(var_names)+1;
+    memcpy(&pre_header[off], &size, sizeof(int));
+    off += sizeof(int);
+    memcpy(&pre_header[off], chunk_size, size*sizeof(long long));
+
+    MPI_File_write(fp, pre_header, header_len, MPI_CHAR, MPI_STATUS_IGNORE);
+    delete [] pre_header;
+  }
+
+  // Increment the global file-offset to match
+  file_offset += header_len;
+
+  // Write the chunks in order of the processor rank
+  MPI_Offset offset = 0, total_len = 0;
+  for ( int k = 0; k < size; k++ ){
+    if (k < rank){
+      offset += chunk_size[k];
+    }
+    total_len += chunk_size[k];
+  }
+
+  MPI_File_set_view(fp, file_offset, MPI_BYTE, MPI_BYTE,
+                    datarep, MPI_INFO_NULL);
+  MPI_File_write_at_all(fp, offset, chunk, chunk_len, MPI_BYTE,
+                        MPI_STATUS_IGNORE);
+  file_offset += total_len;
+
+  delete [] chunk;
+  delete [] chunk_size;
+
+  return 1;
+}
+
 /*
   Close the file
 */
@@ -285,7 +832,12 @@ void FH5File::close(){
 }
 
 /*
-  Open a file for reading 
+  Open a file for reading
+
+  The headers of all the zones are scanned when the file is opened,
+  but the data is only read on request. Each zone whose name begins
+  with "data" is recorded as a step, so that a time series file can
+  be accessed directly with seekStep().
 */
 int FH5File::openFile( const char *file_name ){
   int rank, size = 0;
@@ -347,6 +899,11 @@ void FH5File::scanFH5File(){
   if (root){
     deleteFH5FileInfo();
   }
+  if (steps){
+    delete [] steps;
+    steps = NULL;
+  }
+  num_steps = 0;
 
   if (comp_names){
     for ( int k = 0; k < num_comp; k++ ){
@@ -417,8 +974,14 @@ void FH5File::scanFH5File(){
       return;
     }
 
-    // Record the type of data - one of the FH5DataNames
-    tip->dtype = header[0];
+    // Record the type of data - one of the FH5DataNames. The codec is
+    // stored in the upper bits.
+    tip->enc_dtype = header[0] & 0xff;
+    tip->codec = header[0] >> 8;
+    tip->dtype = tip->enc_dtype;
+    if ((tip->codec & ~FH5_LOSSLESS) == FH5_HALF){
+      tip->dtype = FH5_FLOAT;
+    }
     tip->dim1 = header[1];
     tip->dim2 = header[2];
 
@@ -430,10 +993,49 @@ void FH5File::scanFH5File(){
       return;
     }
 
+    // Read the sizes of the encoded chunks. The table and the chunks
+    // must lie within the file, and the sizes must be non-negative.
+    if (tip->codec != FH5_RAW){
+      if (fread(&tip->num_chunks, sizeof(int), 1, rfp) != 1 ||
+          tip->num_chunks < 0 ||
+          (size_t)tip->num_chunks*sizeof(long long) >
+          file_size - ftell(rfp)){
+        fprintf(stderr, "FH5: Error reading chunk sizes\n");
+        tip->num_chunks = 0;
+        return;
+      }
+      size_t nchunks = tip->num_chunks;
+      tip->chunk_size = new long long[ nchunks+1 ];
+      if (fread(tip->chunk_size, sizeof(long long),
+                nchunks, rfp) != nchunks){
+        fprintf(stderr, "FH5: Error reading chunk sizes\n");
+        tip->num_chunks = 0;
+        return;
+      }
+
+      size_t remain = file_size - ftell(rfp);
+      size_t total = 0;
+      for ( size_t k = 0; k < nchunks; k++ ){
+        if (tip->chunk_size[k] < 0 ||
+            (size_t)tip->chunk_size[k] > remain - total){
+          fprintf(stderr, "FH5: Invalid chunk sizes for zone %s\n",
+                  tip->zone_name);
+          tip->num_chunks = 0;
+          return;
+        }
+        total += tip->chunk_size[k];
+      }
+    }
+
     // Record the file position
     file_pos = ftell(rfp);
     tip->data_offset = file_pos;
-    if (tip->dtype == FH5_INT){
+    if (tip->codec != FH5_RAW){
+      for ( int k = 0; k < tip->num_chunks; k++ ){
+        file_pos += tip->chunk_size[k];
+      }
+    }
+    else if (tip->dtype == FH5_INT){
       file_pos += sizeof(int)*tip->dim1*tip->dim2;
     }
     else if (tip->dtype == FH5_FLOAT){
@@ -442,6 +1044,23 @@ void FH5File::scanFH5File(){
     else {
       file_pos += sizeof(double)*tip->dim1*tip->dim2;
     }
+
+    // Count the data zones
+    if (strncmp(tip->zone_name, "data", 4) == 0){
+      num_steps++;
+    }
+  }
+
+  // Create the index of the data zones
+  if (num_steps > 0){
+    steps = new FH5FileInfo*[ num_steps ];
+    int k = 0;
+    for ( FH5FileInfo *info = root; info; info = info->next ){
+      if (strncmp(info->zone_name, "data", 4) == 0){
+        steps[k] = info;
+        k++;
+      }
+    }
   }
 }
 
@@ -470,7 +1089,7 @@ void FH5File::firstZone(){
   Set the zone pointer to the next zone in the list
 */
 int FH5File::nextZone(){
-  if (current->next != NULL){
+  if (current && current->next != NULL){
     current = current->next;
     return 1;
   }
@@ -478,6 +1097,94 @@ int FH5File::nextZone(){
   return 0;
 }
 
+/*
+  Get the number of steps (data zones) in the file
+*/
+int FH5File::getNumSteps(){
+  return num_steps;
+}
+
+/*
+  Get the time stamp of the given step
+
+  returns:
+  1 on success, 0 if the step or its time stamp do not exist
+*/
+int FH5File::getStepTime( int step, double *t ){
+  if (step >= 0 && step < num_steps){
+    if (sscanf(steps[step]->zone_name, "data t=%lf", t) == 1){
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/*
+  Set the zone pointer to the data zone of the given step. The
+  subsequent calls to getZoneInfo()/getZoneData() return the data for
+  this step without reading the preceding steps.
+
+  returns:
+  1 on success, 0 if the step does not exist
+*/
+int FH5File::seekStep( int step ){
+  if (step >= 0 && step < num_steps){
+    current = steps[step];
+    return 1;
+  }
+  return 0;
+}
+
+/*
+  Read and decode the data for the current zone
+*/
+int FH5File::readEncodedZoneData( FH5DataType *_dtype, void **data ){
+  size_t len = current->dim1*current->dim2;
+  size_t offset = 0;
+  if (current->dtype == FH5_INT){
+    *_dtype = FH5_INT;
+    *data = new int[ len+1 ];
+  }
+  else if (current->dtype == FH5_FLOAT){
+    *_dtype = FH5_FLOAT;
+    *data = new float[ len+1 ];
+  }
+  else {
+    *_dtype = FH5_DOUBLE;
+    *data = new double[ len+1 ];
+  }
+  size_t elem_size = (current->dtype == FH5_DOUBLE ?
+                      sizeof(double) : sizeof(int));
+
+  // Decode the chunks in order
+  for ( int k = 0; k < current->num_chunks; k++ ){
+    size_t chunk_len = current->chunk_size[k];
+    unsigned char *chunk = new unsigned char[ chunk_len+1 ];
+    int rows = -1;
+    if (fread(chunk, sizeof(unsigned char), chunk_len, rfp) == chunk_len){
+      rows = FH5DecodeChunk(current->enc_dtype, current->codec,
+                            chunk, chunk_len, current->dim2,
+                            &((char*)*data)[offset*elem_size],
+                            len - offset);
+    }
+    delete [] chunk;
+
+    if (rows < 0){
+      fprintf(stderr, "FH5: Error reading encoded data\n");
+      return 0;
+    }
+    offset += rows*current->dim2;
+  }
+
+  // The chunks must account for all the rows of the zone
+  if (offset != len){
+    fprintf(stderr, "FH5: Error reading encoded data\n");
+    return 0;
+  }
+
+  return 1;
+}
+
 /*
   Just get the variable names - if any
 */
@@ -535,7 +1242,10 @@ int FH5File::getZoneData( const char **zone_name,
   *dim2 = current->dim2;
 
   size_t len = current->dim1*current->dim2;
-  if (dtype == FH5_INT){
+  if (current->codec != FH5_RAW){
+    return readEncodedZoneData(_dtype, data);
+  }
+  else if (dtype == FH5_INT){
     *_dtype = FH5_INT;
     *data = new int[ len ];
     if (fread(*data, sizeof(int), len, rfp) != len){
@@ -34,6 +34,16 @@ class FH5File : public TACSObject {
                      FH5_DOUBLE=1,
                      FH5_FLOAT=2 };
 
+  // Encodings for the zone data: One of the encodings may be combined
+  // with FH5_LOSSLESS (bit-wise OR) to compress the encoded data.
+  // FH5_QUANTIZE stores 32-bit integers, which only save space once
+  // compressed, so FH5_LOSSLESS is always added to it.
+  enum FH5Codec { FH5_RAW=0,       // Data written as-is
+                  FH5_HALF=1,      // float/double to 16-bit float
+                  FH5_QUANTIZE=2,  // float/double with an error bound
+                  FH5_DELTA=3,     // Delta-encoded integers
+                  FH5_LOSSLESS=16 }; // Byte-shuffle + run-length
+
   FH5File( MPI_Comm _comm );
   ~FH5File();
 
@@ -45,7 +55,8 @@ class FH5File : public TACSObject {
   int writeZoneData( char *zone_name,
                      char *var_names,
                      FH5DataType data_name,
-                     void *data, int dim1, int dim2 );
+                     void *data, int dim1, int dim2,
+                     int codec=FH5_RAW, double tol=0.0 );
   void close();
 
   // Open a file for reading input
@@ -60,7 +71,13 @@ class FH5File : public TACSObject {
   // Retrieve zone data
   // ------------------
   void firstZone();
-  int nextZone(); 
+  int nextZone();
+
+  // Retrieve the steps in a time series file
+  // ----------------------------------------
+  int getNumSteps();
+  int getStepTime( int step, double *t );
+  int seekStep( int step );
   int getZoneInfo( const char **zone_name, const char **var_names,
                    FH5DataType *_dtype,
                    int *dim1, int *dim2 );
@@ -78,12 +95,21 @@ class FH5File : public TACSObject {
       dtype = -1;
       dim1 = dim2 = 0;
       data_offset = 0;
+      codec = FH5_RAW;
+      enc_dtype = -1;
+      num_chunks = 0;
+      chunk_size = NULL;
     }
     ~FH5FileInfo(){
       if (zone_name){ delete [] zone_name; }
       if (var_names){ delete [] var_names; }
+      if (chunk_size){ delete [] chunk_size; }
     }
     int dtype;
+    int codec; // The encoding of the data
+    int enc_dtype; // The data type before encoding
+    int num_chunks; // The number of encoded chunks
+    long long *chunk_size; // The size of each encoded chunk
     char *zone_name;
     char *var_names;
     int dim1, dim2;
@@ -91,9 +117,20 @@ class FH5File : public TACSObject {
     FH5FileInfo *next;
   } *root, *tip, *current;
 
+  // Write and read data with an encoding
+  int writeEncodedZoneData( char *zone_name, char *var_names,
+                            FH5DataType data_name,
+                            void *data, int dim1, int dim2,
+                            int codec, double tol );
+  int readEncodedZoneData( FH5DataType *_dtype, void **data );
+
   // Scan the file and record the header information
   void scanFH5File();
   void deleteFH5FileInfo();
+
+  // Index of the data zones for each step in the file
+  int num_steps;
+  FH5FileInfo **steps;
   
   int num_comp; // The number of components
   char **comp_names; // The component names
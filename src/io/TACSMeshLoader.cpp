@@ -19,6 +19,11 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "TACSMeshLoader.h"
 #include "FElibrary.h"
@@ -93,13 +98,17 @@ static int compare_arg_sort( const void * a, const void * b ){
   Read a line from the buffer.
 
   Return the number of read characters. Do not exceed the buffer
-  length.
+  length. The remainder of the line buffer is zeroed so that
+  fixed-width fields past the end of a short line are blank. Any
+  carriage return at the end of the line is dropped.
 
   Given the line buffer 'line', and the size of the line buffer line_len
 */
 static int read_buffer_line( char *line, size_t line_len, 
-                             size_t *loc, char *buffer, 
+                             size_t *loc, const char *buffer, 
                              size_t buffer_len ){
+  memset(line, '\0', line_len);
+
   size_t i = 0;
   for ( ; (i < line_len) && (*loc < buffer_len); i++, (*loc)++ ){
     if (buffer[*loc] == '\n'){
@@ -107,7 +116,8 @@ static int read_buffer_line( char *line, size_t line_len,
     }
     line[i] = buffer[*loc];    
   }
-  if (i < line_len){
+  if (i > 0 && line[i-1] == '\r'){
+    i--;
     line[i] = '\0';
   }
 
@@ -121,63 +131,6 @@ static int read_buffer_line( char *line, size_t line_len,
   return i;
 }
 
-/*
-  Reverse look up.
-
-  Given the sorted array list[arg[k]], find k, such that 
-
-  list[arg[k]] = var
-*/
-static int find_index_arg_sorted( int var, int size, 
-                                  const int * list, 
-                                  const int * args ){
-  // Binary search an array to find k such that list[k] = var,
-  // where the array list[args[k]] is sorted in ascending
-  // order
-  int high = size-1;
-  int low = 0;
-  int high_val = list[args[high]];
-  int low_val = list[args[low]];
-
-  // Check if the index is at the end points
-  if (var == low_val){
-    return low;
-  }
-  else if (var < low_val){
-    return -1;
-  }
-
-  if (var == high_val){
-    return high;
-  }
-  else if (var > high_val){
-    return -1;
-  }
-
-  int mid = low + (int)((high - low)/2);
-      
-  // While there are values left in the list
-  while (low != mid){
-    int mid_val = list[args[mid]];
-    if (mid_val == var){
-      return mid;
-    }   
-    
-    if (var < mid_val){
-      high = mid;
-      high_val = mid_val;
-    }
-    else {
-      low = mid;
-      low_val = mid_val;
-    }
-    
-    mid = low + (int)((high - low)/2);
-  }      
-  
-  return -1;
-}
-
 /*
   Convert a Nastran-style number with an exponent to a double.
 */
@@ -221,6 +174,116 @@ static double bdf_atof( char * str ){
   return atof(temp);
 }
 
+/*
+  Parse an integer from a fixed-width field in place. The field ends
+  at the given width or at the end of the line. This is equivalent to
+  atoi() on a copy of the field.
+*/
+static int bdf_parse_int( const char *str, int width ){
+  int i = 0;
+  while (i < width && str[i] == ' '){ i++; }
+
+  int sign = 1;
+  if (i < width && (str[i] == '-' || str[i] == '+')){
+    if (str[i] == '-'){ sign = -1; }
+    i++;
+  }
+
+  int value = 0;
+  for ( ; i < width && str[i] >= '0' && str[i] <= '9'; i++ ){
+    value = 10*value + (str[i] - '0');
+  }
+  return sign*value;
+}
+
+/*
+  Parse a real number from a fixed-width field in place.
+
+  This handles the standard and the Nastran exponent formats (1.5E-3,
+  1.5D-3 and 1.5-3). When the mantissa has at most 15 digits and the
+  exponent is at most 22 in magnitude, the result is computed directly
+  and is correctly rounded. Otherwise, the field is converted with
+  bdf_atof().
+*/
+static double bdf_parse_real( const char *str, int width ){
+  static const double pow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+  int i = 0;
+  while (i < width && str[i] == ' '){ i++; }
+  if (i == width || str[i] == '\0'){
+    return 0.0;
+  }
+
+  int neg = 0;
+  if (str[i] == '-' || str[i] == '+'){
+    neg = (str[i] == '-');
+    i++;
+  }
+
+  // Read the digits of the mantissa
+  unsigned long long mant = 0;
+  int ndigits = 0, exp10 = 0;
+  for ( ; i < width && str[i] >= '0' && str[i] <= '9'; i++ ){
+    if (mant > 0 || str[i] != '0'){ ndigits++; }
+    mant = 10*mant + (str[i] - '0');
+  }
+  if (i < width && str[i] == '.'){
+    for ( i++; i < width && str[i] >= '0' && str[i] <= '9'; i++ ){
+      if (mant > 0 || str[i] != '0'){ ndigits++; }
+      mant = 10*mant + (str[i] - '0');
+      exp10--;
+    }
+  }
+
+  // Read the exponent (if any)
+  int fallback = (ndigits > 15);
+  if (i < width && (str[i] == 'e' || str[i] == 'E' ||
+                    str[i] == 'd' || str[i] == 'D')){
+    i++;
+  }
+  if (i < width && (str[i] == '-' || str[i] == '+' ||
+                    (str[i] >= '0' && str[i] <= '9'))){
+    int esign = 1;
+    if (str[i] == '-' || str[i] == '+'){
+      if (str[i] == '-'){ esign = -1; }
+      i++;
+    }
+    int e = 0;
+    for ( ; i < width && str[i] >= '0' && str[i] <= '9'; i++ ){
+      if (e < 10000){ e = 10*e + (str[i] - '0'); }
+    }
+    exp10 += esign*e;
+  }
+
+  // Anything other than trailing blanks is left to bdf_atof
+  for ( ; i < width && str[i] != '\0'; i++ ){
+    if (str[i] != ' '){
+      fallback = 1;
+    }
+  }
+
+  if (fallback || exp10 < -22 || exp10 > 22){
+    char temp[40];
+    int len = 0;
+    for ( ; len < width && len < 39 && str[len] != '\0'; len++ ){
+      temp[len] = str[len];
+    }
+    temp[len] = '\0';
+    return bdf_atof(temp);
+  }
+
+  double value = mant;
+  if (exp10 < 0){
+    value /= pow10[-exp10];
+  }
+  else {
+    value *= pow10[exp10];
+  }
+  return (neg ? -value : value);
+}
+
 /*
   Parse the long-field format
   
@@ -235,17 +298,10 @@ static double bdf_atof( char * str ){
 */
 static void parse_node_long_field( char *line, char *line2, int *node, 
                                    double *x, double *y, double *z ){
-  char Node[32], X[32], Y[32], Z[32];
-
-  strncpy(Node, &line[8], 16); Node[16] = '\0';
-  strncpy(X, &line[40], 16);   X[16] = '\0';
-  strncpy(Y, &line[56], 16);   Y[16] = '\0';
-  strncpy(Z, &line2[8], 16);   Z[16] = '\0';
-
-  *node = atoi(Node);
-  *x = bdf_atof(X);
-  *y = bdf_atof(Y);
-  *z = bdf_atof(Z);
+  *node = bdf_parse_int(&line[8], 16);
+  *x = bdf_parse_real(&line[40], 16);
+  *y = bdf_parse_real(&line[56], 16);
+  *z = bdf_parse_real(&line2[8], 16);
 }
 
 /*
@@ -282,34 +338,29 @@ static void parse_node_short_free_field( char *line, int *node,
       field[i][flen] = '\0';
       end++;
     }
+
+    *node = atoi(field[0]);
+    *x = bdf_atof(field[2]);
+    *y = bdf_atof(field[3]);
+    *z = bdf_atof(field[4]);
   }
   else { // Short-format, fixed width
-    strncpy(field[0], &line[8], 8);   field[0][8] = '\0';
-    strncpy(field[2], &line[24], 8);  field[2][8] = '\0';
-    strncpy(field[3], &line[32], 8);  field[3][8] = '\0';
-    strncpy(field[4], &line[40], 8);  field[4][8] = '\0';
+    *node = bdf_parse_int(&line[8], 8);
+    *x = bdf_parse_real(&line[24], 8);
+    *y = bdf_parse_real(&line[32], 8);
+    *z = bdf_parse_real(&line[40], 8);
   }
-
-  *node = atoi(field[0]);
-  *x = bdf_atof(field[2]);
-  *y = bdf_atof(field[3]);
-  *z = bdf_atof(field[4]);
 }
 
-static void parse_element_field( char line[], 
+static void parse_element_field( const char line[], 
                                  int * elem_num, int * component_num,
                                  int * node_nums, int num_nodes ){
-  char node[9];
   int entry = 8;
 
-  strncpy(node, &line[entry], 8);
-  node[8] = '\0';
-  *elem_num = atoi(node);
+  *elem_num = bdf_parse_int(&line[entry], 8);
   entry += 8;
   
-  strncpy(node, &line[entry], 8);
-  node[8] = '\0';
-  *component_num = atoi(node);
+  *component_num = bdf_parse_int(&line[entry], 8);
   entry += 8;
   
   if (*component_num <= 0){
@@ -319,18 +370,23 @@ static void parse_element_field( char line[],
   
   for ( int n = 0; n < num_nodes && entry < 80; entry += 8, n++ ){
     // Parse the line containing the entry
-    strncpy(node, &line[entry], 8);
-    node[8] = '\0';
-    node_nums[n] = atoi(node);
+    node_nums[n] = bdf_parse_int(&line[entry], 8);
   }
 }
 
-static void parse_element_field2( char line1[], char line2[],
-                                  int * elem_num, int * component_num,
-                                  int * node_nums, int num_nodes, int width=8 ){
+/*
+  Parse an element that spans two (or three) fixed-width lines. The
+  element and component numbers are read from the first line, followed
+  by the node numbers.
+
+  returns:
+  the number of node numbers that were parsed
+*/
+static int parse_element_field2( char line1[], char line2[],
+                                 int * elem_num, int * component_num,
+                                 int * node_nums, int num_nodes, int width=8 ){
 
   int n = 0; // The number of parsed nodes
-  char node[17];
   for ( int m = 0; m < 2; m++ ){
     int entry = width;
     const char * line = line1;
@@ -339,32 +395,27 @@ static void parse_element_field2( char line1[], char line2[],
     }
 
     if (n == 0){ 
-      strncpy(node, &line[entry], width);
-      node[width] = '\0';
-      *elem_num = atoi(node);
+      *elem_num = bdf_parse_int(&line[entry], width);
       entry += width;
 
-      strncpy(node, &line[entry], width);
-      node[width] = '\0';
-      *component_num = atoi(node);
+      *component_num = bdf_parse_int(&line[entry], width);
       entry += width;
     }
     
     for ( ; n < num_nodes && entry < 72; entry += width, n++ ){
       // Parse the line containing the entry
-      strncpy(node, &line[entry], width);
-      node[width] = '\0';
-      node_nums[n] = atoi(node);
+      node_nums[n] = bdf_parse_int(&line[entry], width);
     }
   }
+
+  return n;
 }
 
 
-static void parse_element_field3( char line1[], char line2[], char line3[],
-                                  int * elem_num, int * component_num,
-                                  int * node_nums, int num_nodes, int width=8 ){  
+static int parse_element_field3( char line1[], char line2[], char line3[],
+                                 int * elem_num, int * component_num,
+                                 int * node_nums, int num_nodes, int width=8 ){
   int n = 0; // The number of parsed nodes
-  char node[17];
 
   for ( int m = 0; m < 3; m++ ){
     int entry = width;
@@ -377,124 +428,601 @@ static void parse_element_field3( char line1[], char line2[], char line3[],
     }
 
     if (n == 0){ 
-      strncpy(node, &line[entry], width);
-      node[width] = '\0';
-      *elem_num = atoi(node);
+      *elem_num = bdf_parse_int(&line[entry], width);
       entry += width;
 
-      strncpy(node, &line[entry], width);
-      node[width] = '\0';
-      *component_num = atoi(node);
+      *component_num = bdf_parse_int(&line[entry], width);
       entry += width;
     }
     
     for ( ; n < num_nodes && entry < 72; entry += width, n++ ){
       // Parse the line containing the entry
-      strncpy(node, &line[entry], width);
-      node[width] = '\0';
-      node_nums[n] = atoi(node);
+      node_nums[n] = bdf_parse_int(&line[entry], width);
     }
   }
+
+  return n;
 }
 
-static void parse_element_field4( char line1[], char line2[], char line3[],
-                                  char line4[],
-                                  int * elem_num, int * component_num,
-                                  int * node_nums, int num_nodes ){  
-  int n = 0; // The number of parsed nodes
-  char node[9];
+/*
+  Converts the connectivity information loaded from BDF file to
+  coordinate ordering used in TACS.
+*/
+static void convert_to_coordinate( int * coord, int * orig ){
+  coord[0] = orig[0];
+  coord[1] = orig[4];
+  coord[2] = orig[1];
 
-  for ( int m = 0; m < 4; m++ ){
-    int entry = 8;
-    const char * line = line1;
-    if (m == 1){
-      line = line2;
+  coord[3] = orig[7];
+  coord[4] = orig[8];
+  coord[5] = orig[5];
+
+  coord[6] = orig[3];
+  coord[7] = orig[6];
+  coord[8] = orig[2];  
+}
+
+/*
+  Extend the length of an array
+*/
+template <class T>
+static void extend_bdf_array( T **array, int old_len, int new_len ){
+  T *temp = new T[ new_len ];
+  if (*array){
+    memcpy(temp, *array, old_len*sizeof(T));
+    delete [] *array;
+  }
+  *array = temp;
+}
+
+/*
+  The records from the bulk data section that are parsed by a single
+  processor
+*/
+class BDFRecords {
+ public:
+  BDFRecords(){
+    num_nodes = max_nodes = 0;
+    node_nums = NULL;
+    Xpts = NULL;
+    num_elements = max_elements = 0;
+    elem_nums = elem_comp = elem_size = NULL;
+    con_size = max_con_size = 0;
+    elem_con = NULL;
+    num_components = 0;
+    component_elems = NULL;
+    num_descript = max_descript = 0;
+    descript = NULL;
+    num_bcs = max_bcs = 0;
+    bc_nodes = bc_size = NULL;
+    bc_vars_size = max_bc_vars_size = 0;
+    bc_vars = NULL;
+    bc_vals = NULL;
+  }
+  ~BDFRecords(){
+    if (node_nums){ delete [] node_nums; }
+    if (Xpts){ delete [] Xpts; }
+    if (elem_nums){ delete [] elem_nums; }
+    if (elem_comp){ delete [] elem_comp; }
+    if (elem_size){ delete [] elem_size; }
+    if (elem_con){ delete [] elem_con; }
+    if (component_elems){ delete [] component_elems; }
+    if (descript){ delete [] descript; }
+    if (bc_nodes){ delete [] bc_nodes; }
+    if (bc_size){ delete [] bc_size; }
+    if (bc_vars){ delete [] bc_vars; }
+    if (bc_vals){ delete [] bc_vals; }
+  }
+
+  // Add a node with the original (C-ordered) node number
+  void addNode( int node, double x, double y, double z ){
+    if (num_nodes >= max_nodes){
+      int new_len = 2*max_nodes + 1024;
+      extend_bdf_array(&node_nums, num_nodes, new_len);
+      extend_bdf_array(&Xpts, 3*num_nodes, 3*new_len);
+      max_nodes = new_len;
     }
-    else if (m == 2){
-      line = line3;
+    node_nums[num_nodes] = node;
+    Xpts[3*num_nodes] = x;
+    Xpts[3*num_nodes+1] = y;
+    Xpts[3*num_nodes+2] = z;
+    num_nodes++;
+  }
+
+  // Add an element with the original (C-ordered) element number,
+  // component number and connectivity
+  void addElement( int elem_num, int comp, const int *conn, int size,
+                   const char *elem_descript ){
+    if (num_elements >= max_elements){
+      int new_len = 2*max_elements + 1024;
+      extend_bdf_array(&elem_nums, num_elements, new_len);
+      extend_bdf_array(&elem_comp, num_elements, new_len);
+      extend_bdf_array(&elem_size, num_elements, new_len);
+      max_elements = new_len;
     }
-    else if (m == 3){
-      line = line4;
+    if (con_size + size > max_con_size){
+      int new_len = 2*max_con_size + size + 4096;
+      extend_bdf_array(&elem_con, con_size, new_len);
+      max_con_size = new_len;
     }
+    elem_nums[num_elements] = elem_num;
+    elem_comp[num_elements] = comp;
+    elem_size[num_elements] = size;
+    memcpy(&elem_con[con_size], conn, size*sizeof(int));
+    con_size += size;
+    num_elements++;
+
+    // Record the first element type for each component
+    if (comp >= 0){
+      if (comp >= num_components){
+        int new_len = comp+1;
+        extend_bdf_array(&component_elems, 9*num_components, 9*new_len);
+        memset(&component_elems[9*num_components], '\0',
+               9*(new_len - num_components)*sizeof(char));
+        num_components = new_len;
+      }
+      if (component_elems[9*comp] == '\0'){
+        strcpy(&component_elems[9*comp], elem_descript);
+      }
+    }
+  }
 
-    if (n == 0){ 
-      strncpy(node, &line[entry], 8);
-      node[8] = '\0';
-      *elem_num = atoi(node);
-      entry += 8;
-
-      strncpy(node, &line[entry], 8);
-      node[8] = '\0';
-      *component_num = atoi(node);
-      entry += 8;
+  // Add the description of the next component
+  void addDescript( const char *comp ){
+    if (num_descript >= max_descript){
+      int new_len = 2*max_descript + 64;
+      extend_bdf_array(&descript, 33*num_descript, 33*new_len);
+      max_descript = new_len;
     }
+    memset(&descript[33*num_descript], '\0', 33*sizeof(char));
+    sscanf(comp, "%32s", &descript[33*num_descript]);
+    num_descript++;
+  }
 
-    for ( ; n < num_nodes && entry < 72; entry += 8, n++ ){
-      // Parse the line containing the entry
-      strncpy(node, &line[entry], 8);
-      node[8] = '\0';
-      node_nums[n] = atoi(node);
+  // Add a boundary condition for the given node
+  void addBC( int node, int nvars, const int *vars, const double *vals ){
+    if (num_bcs >= max_bcs){
+      int new_len = 2*max_bcs + 256;
+      extend_bdf_array(&bc_nodes, num_bcs, new_len);
+      extend_bdf_array(&bc_size, num_bcs, new_len);
+      max_bcs = new_len;
     }
+    if (bc_vars_size + nvars > max_bc_vars_size){
+      int new_len = 2*max_bc_vars_size + nvars + 256;
+      extend_bdf_array(&bc_vars, bc_vars_size, new_len);
+      extend_bdf_array(&bc_vals, bc_vars_size, new_len);
+      max_bc_vars_size = new_len;
+    }
+    bc_nodes[num_bcs] = node;
+    bc_size[num_bcs] = nvars;
+    memcpy(&bc_vars[bc_vars_size], vars, nvars*sizeof(int));
+    memcpy(&bc_vals[bc_vars_size], vals, nvars*sizeof(double));
+    bc_vars_size += nvars;
+    num_bcs++;
+  }
+
+  // The nodes
+  int num_nodes, max_nodes;
+  int *node_nums;
+  double *Xpts;
+
+  // The elements and their connectivity
+  int num_elements, max_elements;
+  int *elem_nums, *elem_comp, *elem_size;
+  int con_size, max_con_size;
+  int *elem_con;
+
+  // The first element type in each component
+  int num_components;
+  char *component_elems;
+
+  // The component descriptions in the order they appear
+  int num_descript, max_descript;
+  char *descript;
+
+  // The boundary conditions
+  int num_bcs, max_bcs;
+  int *bc_nodes, *bc_size;
+  int bc_vars_size, max_bc_vars_size;
+  int *bc_vars;
+  double *bc_vals;
+};
+
+/*
+  Send the records to the processors that own them using an
+  all-to-all exchange.
+
+  input:
+  comm:        the communicator
+  dtype:       the MPI data type of the array
+  factor:      the number of array entries per record
+  send:        the records ordered by the destination processor
+  send_count:  the number of records sent to each processor
+  recv_count:  the number of records received from each processor
+
+  returns:
+  the received records in the order of the source processor
+*/
+template <class T>
+static T *exchange_bdf_array( MPI_Comm comm, MPI_Datatype dtype,
+                              int factor, const T *send,
+                              const int *send_count,
+                              const int *recv_count ){
+  int size;
+  MPI_Comm_size(comm, &size);
+
+  int *send_len = new int[ size ];
+  int *send_ptr = new int[ size ];
+  int *recv_len = new int[ size ];
+  int *recv_ptr = new int[ size ];
+  int send_size = 0, recv_size = 0;
+  for ( int k = 0; k < size; k++ ){
+    send_len[k] = factor*send_count[k];
+    recv_len[k] = factor*recv_count[k];
+    send_ptr[k] = send_size;
+    recv_ptr[k] = recv_size;
+    send_size += send_len[k];
+    recv_size += recv_len[k];
   }
+
+  T *recv = new T[ recv_size ];
+  MPI_Alltoallv((void*)send, send_len, send_ptr, dtype,
+                recv, recv_len, recv_ptr, dtype, comm);
+
+  delete [] send_len;
+  delete [] send_ptr;
+  delete [] recv_len;
+  delete [] recv_ptr;
+
+  return recv;
 }
 
-static void parse_element_field9( char line1[], char line2[], char line3[],
-                                  char line4[], char line5[], char line6[],
-                                  char line7[], char line8[], char line9[],
-                                  int * elem_num, int * component_num,
-                                  int * node_nums, int num_nodes ){  
-  int n = 0; // The number of parsed nodes
-  char node[9];
+/*
+  Find the processor that owns the given BDF node number.
 
-  for ( int m = 0; m < 4; m++ ){
-    int entry = 8;
-    const char * line = line1;
-    if (m == 1){ line = line2; }
-    else if (m == 2){ line = line3; }
-    else if (m == 3){ line = line4; }
-    else if (m == 4){ line = line5; }
-    else if (m == 5){ line = line6; }
-    else if (m == 6){ line = line7; }
-    else if (m == 7){ line = line8; }
-    else if (m == 8){ line = line9; }
-    
-    if (n == 0){ 
-      strncpy(node, &line[entry], 8);
-      node[8] = '\0';
-      *elem_num = atoi(node);
-      entry += 8;
+  The range of node numbers in the file is split evenly between the
+  processors, so the owner does not decrease as the node number
+  increases.
+*/
+static int bdf_node_owner( int node, int node_min, 
+                           long long node_range, int size ){
+  if (node < node_min){
+    return 0;
+  }
+  long long owner = ((node - (long long)node_min)*size)/node_range;
+  return (owner < size ? (int)owner : size-1);
+}
+
+/*
+  Find the new node number corresponding to the BDF node number in
+  the sorted list of BDF node numbers. Returns -1 if the node does not
+  exist.
+*/
+static int find_bdf_node( int node, const int *node_nums, int num_nodes,
+                          const int *new_nums ){
+  const int *item = (const int*)bsearch(&node, node_nums, num_nodes, 
+                                        sizeof(int), FElibrary::comparator);
+  if (item){
+    return new_nums[item - node_nums];
+  }
+  return -1;
+}
+
+/*
+  Find the start of the first card at or after the given position in
+  the buffer.
+
+  A card starts at the beginning of a line with a letter (the keyword)
+  or a '$' (a comment). Continuation lines start with '+', '*', ',' or
+  a blank, so a card is never split at the returned position.
+*/
+static size_t find_card_start( const char *buffer, size_t buffer_len,
+                               size_t pos ){
+  if (pos == 0 || pos >= buffer_len){
+    return (pos == 0 ? 0 : buffer_len);
+  }
+
+  // Move to the beginning of the next line
+  while (pos < buffer_len && buffer[pos-1] != '\n'){
+    pos++;
+  }
 
-      strncpy(node, &line[entry], 8);
-      node[8] = '\0';
-      *component_num = atoi(node);
-      entry += 8;
+  // Skip any continuation lines
+  while (pos < buffer_len){
+    char c = buffer[pos];
+    if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || c == '$'){
+      break;
     }
+    while (pos < buffer_len && buffer[pos] != '\n'){
+      pos++;
+    }
+    pos++;
+  }
 
-    for ( ; n < num_nodes && entry < 72; entry += 8, n++ ){
-      // Parse the line containing the entry
-      strncpy(node, &line[entry], 8);
-      node[8] = '\0';
-      node_nums[n] = atoi(node);
+  return (pos < buffer_len ? pos : buffer_len);
+}
+
+/*
+  Parse a single card from the bulk data section.
+
+  The first line of the card is passed in line[0]. Continuation lines
+  are read from the buffer as required. The nodes, elements, component
+  descriptions and boundary conditions are added to the records.
+
+  returns:
+  1 if a continuation line is missing or an element card is
+  incomplete, 0 otherwise
+*/
+static int parse_bdf_card( char line[][81], size_t *loc,
+                           const char *buffer, size_t buffer_len,
+                           int convertToCoordinate, BDFRecords *rec ){
+  if (strncmp(line[0], "$       Shell", 13) == 0){
+    // A standard icem output - description of each component. This
+    // is very useful for describing what the components actually are
+    // with a string. Again use a fixed width format
+    char comp[33];
+    strncpy(comp, &line[0][41], 32);
+    comp[32] = '\0';
+    rec->addDescript(comp);
+    return 0;
+  }
+  if (line[0][0] == '$'){ // A comment line
+    return 0;
+  }
+
+  int node;
+  double x, y, z;
+  int elem_num = 0, component_num = 0;
+  int nodes[64], conn[64];
+
+  // Check for GRID or GRID*
+  if (strncmp(line[0], "GRID*", 5) == 0){
+    if (!read_buffer_line(line[1], 80, loc, buffer, buffer_len)){
+      return 1;
     }
+    parse_node_long_field(line[0], line[1], &node, &x, &y, &z);
+    rec->addNode(node-1, x, y, z); // Get the C ordering
   }
+  else if (strncmp(line[0], "GRID", 4) == 0){
+    parse_node_short_free_field(line[0], &node, &x, &y, &z);
+    rec->addNode(node-1, x, y, z); // Get the C ordering
+  }
+  else if (strncmp(line[0], "CBAR", 4) == 0){
+    parse_element_field(line[0], &elem_num, &component_num, nodes, 2);
+    conn[0] = nodes[0]-1;
+    conn[1] = nodes[1]-1;
+    rec->addElement(elem_num-1, component_num-1, conn, 2, "CBAR");
+  }
+  else if (strncmp(line[0], "CHEXA*", 6) == 0){
+    for ( int i = 1; i < 3; i++ ){
+      if (!read_buffer_line(line[i], 80, loc, buffer, buffer_len)){
+        return 1;
+      }
+    }
+    if (parse_element_field3(line[0], line[1], line[2],
+                             &elem_num, &component_num, nodes, 8, 16) < 8){
+      return 1;
+    }
+    conn[0] = nodes[0]-1;  conn[1] = nodes[1]-1;
+    conn[2] = nodes[3]-1;  conn[3] = nodes[2]-1;
+    conn[4] = nodes[4]-1;  conn[5] = nodes[5]-1;
+    conn[6] = nodes[7]-1;  conn[7] = nodes[6]-1;
+    rec->addElement(elem_num-1, component_num-1, conn, 8, "CHEXA*");
+  }
+  else if (strncmp(line[0], "CHEXA", 5) == 0){
+    if (!read_buffer_line(line[1], 80, loc, buffer, buffer_len)){
+      return 1;
+    }
+    if (parse_element_field2(line[0], line[1],
+                             &elem_num, &component_num, nodes, 8) < 8){
+      return 1;
+    }
+    conn[0] = nodes[0]-1;  conn[1] = nodes[1]-1;
+    conn[2] = nodes[3]-1;  conn[3] = nodes[2]-1;
+    conn[4] = nodes[4]-1;  conn[5] = nodes[5]-1;
+    conn[6] = nodes[7]-1;  conn[7] = nodes[6]-1;
+    rec->addElement(elem_num-1, component_num-1, conn, 8, "CHEXA");
+  }
+  else if (strncmp(line[0], "CQUAD16", 7) == 0){
+    for ( int i = 1; i < 3; i++ ){
+      if (!read_buffer_line(line[i], 80, loc, buffer, buffer_len)){
+        return 1;
+      }
+    }
+    if (parse_element_field3(line[0], line[1], line[2],
+                             &elem_num, &component_num, nodes, 16) < 16){
+      return 1;
+    }
+    for ( int k = 0; k < 16; k++ ){
+      conn[k] = nodes[k]-1;
+    }
+    rec->addElement(elem_num-1, component_num-1, conn, 16, "CQUAD16");
+  }
+  else if (strncmp(line[0], "CQUAD9", 6) == 0){
+    if (!read_buffer_line(line[1], 80, loc, buffer, buffer_len)){
+      return 1;
+    }
+    if (!convertToCoordinate){
+      if (parse_element_field2(line[0], line[1],
+                               &elem_num, &component_num, nodes, 9) < 9){
+        return 1;
+      }
+    }
+    else {
+      int tmp[9];
+      if (parse_element_field2(line[0], line[1],
+                               &elem_num, &component_num, tmp, 9) < 9){
+        return 1;
+      }
+      // convert to coordinate ordering for gmsh
+      convert_to_coordinate(&nodes[0], &tmp[0]);
+    }
+    for ( int k = 0; k < 9; k++ ){
+      conn[k] = nodes[k]-1;
+    }
+    rec->addElement(elem_num-1, component_num-1, conn, 9, "CQUAD9");
+  }
+  else if (strncmp(line[0], "CQUAD4*", 7) == 0){
+    if (!read_buffer_line(line[1], 80, loc, buffer, buffer_len)){
+      return 1;
+    }
+    if (parse_element_field2(line[0], line[1],
+                             &elem_num, &component_num, nodes, 4, 16) < 4){
+      return 1;
+    }
+    conn[0] = nodes[0]-1;  conn[1] = nodes[1]-1;
+    conn[2] = nodes[3]-1;  conn[3] = nodes[2]-1;
+    rec->addElement(elem_num-1, component_num-1, conn, 4, "CQUAD4");
+  }
+  else if (strncmp(line[0], "CQUAD4", 6) == 0 ||
+           strncmp(line[0], "CQUADR", 6) == 0){
+    parse_element_field(line[0], &elem_num, &component_num, nodes, 4);
+    conn[0] = nodes[0]-1;  conn[1] = nodes[1]-1;
+    conn[2] = nodes[3]-1;  conn[3] = nodes[2]-1;
+    rec->addElement(elem_num-1, component_num-1, conn, 4, "CQUAD4");
+  }
+  else if (strncmp(line[0], "CQUAD", 5) == 0){
+    if (!read_buffer_line(line[1], 80, loc, buffer, buffer_len)){
+      return 1;
+    }
+    if (!convertToCoordinate){
+      if (parse_element_field2(line[0], line[1],
+                               &elem_num, &component_num, nodes, 9) < 9){
+        return 1;
+      }
+    }
+    else {
+      int tmp[9];
+      if (parse_element_field2(line[0], line[1],
+                               &elem_num, &component_num, tmp, 9) < 9){
+        return 1;
+      }
+      // convert to coordinate ordering for gmsh
+      convert_to_coordinate(&nodes[0], &tmp[0]);
+    }
+    conn[0] = nodes[0]-1;  conn[1] = nodes[4]-1;  conn[2] = nodes[1]-1;
+    conn[3] = nodes[7]-1;  conn[4] = nodes[8]-1;  conn[5] = nodes[5]-1;
+    conn[6] = nodes[3]-1;  conn[7] = nodes[6]-1;  conn[8] = nodes[2]-1;
+    rec->addElement(elem_num-1, component_num-1, conn, 9, "CQUAD");
+  }
+  else if (strncmp(line[0], "CTRIA3", 6) == 0){
+    parse_element_field(line[0], &elem_num, &component_num, nodes, 3);
+    conn[0] = nodes[0]-1;
+    conn[1] = nodes[1]-1;
+    conn[2] = nodes[2]-1;
+    rec->addElement(elem_num-1, component_num-1, conn, 3, "CTRIA3");
+  }
+  else if (strncmp(line[0], "SPC", 3) == 0){
+    // This is a variable-length format. Read in grid points until
+    // zero is reached. This is a fixed-width format
+    // SPC SID  G1  C  D
+    int bc_node = bdf_parse_int(&line[0][16], 8)-1;
+    double val = bdf_parse_real(&line[0][32], 8);
+
+    // Read in the dof that will be constrained
+    int nvars = 0;
+    int vars[8];
+    double vals[8];
+    for ( int k = 24; k < 32; k++ ){
+      char dofs[9] = "12345678";
+      for ( int j = 0; j < 8; j++ ){
+        if (dofs[j] == line[0][k]){
+          vars[nvars] = j;
+          vals[nvars] = val;
+          nvars++;
+          break;
+        }
+      }
+    }
+    rec->addBC(bc_node, nvars, vars, vals);
+  }
+  else if (strncmp(line[0], "FFORCE", 6) == 0){
+    // Read in the component number and nodes associated with the
+    // following force
+    parse_element_field(line[0], &elem_num, &component_num, nodes, 1);
+    conn[0] = nodes[0]-1;
+    rec->addElement(elem_num-1, component_num-1, conn, 1, "FFORCE");
+  }
+
+  return 0;
 }
 
 /*
-  Converts the connectivity information loaded from BDF file to
-  coordinate ordering used in TACS.
+  The layout of the binary mesh cache.
+
+  The cache consists of a fixed-size header followed by the sections
+  of mesh data. The header contains the magic string, a version
+  number, a byte-order check, the key of the BDF file the cache was
+  created from, the mesh dimensions and the byte offset of each
+  section. Each section starts on a 64-byte boundary so that the file
+  can be memory-mapped and the sections accessed in place.
 */
-static void convert_to_coordinate( int * coord, int * orig ){
-  coord[0] = orig[0];
-  coord[1] = orig[4];
-  coord[2] = orig[1];
+static const char mesh_cache_magic[8] = "TACSMSH";
+static const long long MESH_CACHE_VERSION = 1;
+static const long long MESH_CACHE_BYTE_ORDER = 0x0102030405060708LL;
+static const long long MESH_CACHE_ALIGN = 64;
+static const int NUM_MESH_CACHE_KEYS = 4;
+
+enum MeshCacheSection { CACHE_XPTS, CACHE_ELEM_PTR, CACHE_ELEM_CONN,
+                        CACHE_ELEM_COMP, CACHE_COMP_ELEMS, 
+                        CACHE_COMP_DESCRIPT, CACHE_BC_NODES, 
+                        CACHE_BC_PTR, CACHE_BC_VARS, CACHE_BC_VALS,
+                        NUM_CACHE_SECTIONS };
+
+enum MeshCacheEntry { CACHE_VERSION, CACHE_BYTE_ORDER, CACHE_KEY,
+                      CACHE_NUM_NODES = CACHE_KEY + NUM_MESH_CACHE_KEYS,
+                      CACHE_NUM_ELEMENTS, CACHE_CONN_SIZE, 
+                      CACHE_NUM_COMPONENTS, CACHE_NUM_BCS, 
+                      CACHE_BC_VARS_SIZE, CACHE_OFFSETS,
+                      NUM_CACHE_ENTRIES = CACHE_OFFSETS + NUM_CACHE_SECTIONS };
 
-  coord[3] = orig[7];
-  coord[4] = orig[8];
-  coord[5] = orig[5];
+/*
+  Compute the key used to check whether a mesh cache corresponds to
+  the BDF file.
 
-  coord[6] = orig[3];
-  coord[7] = orig[6];
-  coord[8] = orig[2];  
+  The key consists of the file size, the modification time, a hash
+  of the file contents and the flags that modify the parsed mesh. The
+  hash is computed in parallel over fixed-size blocks so that it does
+  not depend on the number of processors.
+*/
+static void compute_bdf_key( MPI_Comm comm, const char *buffer,
+                             size_t buffer_len, const struct stat *st,
+                             int convertToCoordinate,
+                             long long key[] ){
+  int rank, size;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
+
+  // Compute the FNV-1a hash of the blocks owned by this processor
+  const size_t block_size = 1 << 20;
+  int num_blocks = (buffer_len + block_size-1)/block_size;
+  unsigned long long *hash = new unsigned long long[ num_blocks+1 ];
+  unsigned long long *all_hash = new unsigned long long[ num_blocks+1 ];
+  memset(hash, 0, (num_blocks+1)*sizeof(unsigned long long));
+  for ( int k = rank; k < num_blocks; k += size ){
+    size_t end = (k+1)*block_size;
+    if (end > buffer_len){ end = buffer_len; }
+    unsigned long long h = 14695981039346656037ULL;
+    for ( size_t i = k*block_size; i < end; i++ ){
+      h = (h ^ (unsigned char)buffer[i])*1099511628211ULL;
+    }
+    hash[k] = h;
+  }
+  MPI_Allreduce(hash, all_hash, num_blocks+1, MPI_UNSIGNED_LONG_LONG,
+                MPI_BOR, comm);
+
+  // Combine the block hashes in order
+  unsigned long long h = 14695981039346656037ULL;
+  for ( int k = 0; k < num_blocks; k++ ){
+    h = (h ^ all_hash[k])*1099511628211ULL;
+  }
+  delete [] hash;
+  delete [] all_hash;
+
+  key[0] = buffer_len;
+  key[1] = st->st_mtime;
+  key[2] = (long long)h;
+  key[3] = convertToCoordinate;
 }
 
 /*
@@ -505,17 +1033,16 @@ static void convert_to_coordinate( int * coord, int * orig ){
   and create the TACSAssembler object.
 
   This constructor simply sets all data to NULL and stores the
-  communicator for later use. Note that the file is only scanned on
-  the root processor.
+  communicator for later use. Note that the file is scanned in
+  parallel and the mesh is stored in blocks on all processors.
 */
 TACSMeshLoader::TACSMeshLoader( MPI_Comm _comm ){
   comm = _comm;
 
   // Initialize everything to zero
   num_nodes = num_elements = 0;
+  num_local_nodes = num_local_elements = 0;
   num_bcs = 0;
-  node_nums = NULL;
-  Xpts_unsorted = NULL;
   elem_node_conn = elem_node_ptr = NULL;
   elem_component = NULL;
   Xpts = NULL;
@@ -529,6 +1056,9 @@ TACSMeshLoader::TACSMeshLoader( MPI_Comm _comm ){
 
   // Set the creator object to NULL
   creator = NULL;
+
+  // No mesh cache by default
+  cache_file = NULL;
   
   // Default is not to convert to coordinate, the supplied BDF is
   // assumed in order
@@ -537,9 +1067,6 @@ TACSMeshLoader::TACSMeshLoader( MPI_Comm _comm ){
 
 /*
   Destroy existing data that may have been allocated
-
-  Note that most of this data will only be allocated on the root
-  processor 
 */
 TACSMeshLoader::~TACSMeshLoader(){
   if (elem_node_conn){ delete [] elem_node_conn; }
@@ -559,8 +1086,8 @@ TACSMeshLoader::~TACSMeshLoader(){
   }
   if (component_elems){ delete [] component_elems; }
   if (component_descript){ delete [] component_descript; }
-  if (Xpts_unsorted){ delete [] Xpts_unsorted;}
-  if (node_nums) {delete [] node_nums;}
+
+  if (cache_file){ delete [] cache_file; }
 
   // Free the creator object
   if (creator){ creator->decref(); }
@@ -616,959 +1143,538 @@ const char *TACSMeshLoader::getElementDescript( int comp_num ){
 }
 
 /*
-  This functions scans a Nastran BDF file - only scanning in
-  information from the bulk data section.
+  Set the file name of the binary mesh cache.
 
-  Only the element types, boundary conditions, connectivitiy and GRID
-  entries are scanned.  Any entries associated with constitutive
-  properties are ignored.
+  When the cache file is set, scanBDFFile() loads the mesh directly
+  from the cache if it was created from the same BDF file. Otherwise,
+  the BDF file is parsed and the cache is (re-)written. Pass NULL to
+  stop using the cache.
 */
-int TACSMeshLoader::scanBDFFile( const char * file_name ){
-  int rank;
-  MPI_Comm_rank(comm, &rank);
-  int fail = 0;
+void TACSMeshLoader::setMeshCache( const char *file_name ){
+  if (cache_file){ delete [] cache_file; }
+  cache_file = NULL;
+  if (file_name){
+    cache_file = new char[ strlen(file_name)+1 ];
+    strcpy(cache_file, file_name);
+  }
+}
 
-  const int root = 0;
-  if (rank == root){
-    FILE * fp = fopen(file_name, "r"); 
-    if (!fp){ 
-      fprintf(stderr, "TACSMeshLoader: Unable to open file %s\n", file_name);
-      fail = 1;
-      MPI_Abort(comm, fail);
-      return fail;
+/*
+  Check that the entries ptr[start], ..., ptr[end] do not decrease
+*/
+static int check_cache_ptr( const int *ptr, int start, int end ){
+  for ( int k = start; k < end; k++ ){
+    if (ptr[k+1] < ptr[k]){
+      return 0;
     }
-    
-    // Count up the number of nodes, elements and size of connectivity data
-    num_nodes = 0;
-    num_elements = 0;
-    num_components = 0;
-    num_bcs = 0;
-
-    // The size of the connectivity arrays
-    int elem_con_size = 0;
-    int bc_vars_size = 0;
+  }
+  return 1;
+}
 
-    // Each line can only be 80 characters long
-    char line[9][80];
+/*
+  Check that lower <= array[k] < upper for start <= k < end
+*/
+static int check_cache_range( const int *array, int start, int end,
+                              long long lower, long long upper ){
+  for ( int k = start; k < end; k++ ){
+    if (array[k] < lower || array[k] >= upper){
+      return 0;
+    }
+  }
+  return 1;
+}
 
-    // Determine the size of the file
-    fseek(fp, 0, SEEK_END);
-    size_t buffer_len = ftell(fp);
-    rewind(fp);
+/*
+  Read this processor's block of the mesh from the cache file.
+
+  The cache is only used if the magic string, version, byte order and
+  key all match, the sections fit within the file and the mesh data
+  is consistent on all processors. The element and boundary condition
+  pointers must start at zero, never decrease and end at the size of
+  the connectivity and variable arrays. The node, component and
+  variable indices must be within range. Otherwise, the cache is
+  ignored and the BDF file is parsed instead. Each processor then copies an even slice of the nodes,
+  elements and boundary conditions out of the memory-mapped file, so
+  only the pages of the cache within the slice are read. This call is
+  collective on all processors.
+
+  input:
+  key:     the key of the BDF file
+
+  returns:
+  1 if the mesh was loaded from the cache, 0 otherwise
+*/
+int TACSMeshLoader::readMeshCache( const long long key[] ){
+  int rank, size;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
+
+  const char *cache = NULL;
+  size_t cache_len = 0;
+  int fd = open(cache_file, O_RDONLY);
+  if (fd >= 0){
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0){
+      cache_len = st.st_size;
+      void *ptr = mmap(NULL, cache_len, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (ptr != MAP_FAILED){
+        cache = (const char*)ptr;
+      }
+    }
+    close(fd);
+  }
 
-    // Allocate enough space to store the entire file
-    char * buffer = new char[buffer_len];
-    if (fread(buffer, 1, buffer_len, fp) != buffer_len){
-      fprintf(stderr, "[%d] TACSMeshLoader: Problem reading file %s\n",
-              rank, file_name);
-      MPI_Abort(comm, 1);
-      return 1;
+  // Check the header
+  long long header[NUM_CACHE_ENTRIES];
+  size_t header_size = sizeof(mesh_cache_magic) + sizeof(header);
+  int valid = (cache && cache_len >= header_size &&
+               memcmp(cache, mesh_cache_magic, 
+                      sizeof(mesh_cache_magic)) == 0);
+  if (valid){
+    memcpy(header, &cache[sizeof(mesh_cache_magic)], sizeof(header));
+    valid = (header[CACHE_VERSION] == MESH_CACHE_VERSION &&
+             header[CACHE_BYTE_ORDER] == MESH_CACHE_BYTE_ORDER);
+    for ( int k = 0; valid && k < NUM_MESH_CACHE_KEYS; k++ ){
+      valid = (header[CACHE_KEY + k] == key[k]);
     }
-    fclose(fp);
-
-    // Keep track of where the current point in the buffer is
-    size_t buffer_loc = 0;
-    read_buffer_line(line[0], sizeof(line[0]), 
-                     &buffer_loc, buffer, buffer_len);
-
-    // Flags which indicate where the bulk data begins
-    int in_bulk = 0;
-    int bulk_start = 0;
-   
-    // Scan the file for the begin bulk location. If none exists, then
-    // the whole file is treated as bulk data.
-    while (buffer_loc < buffer_len){
-      if (strncmp(line[0], "BEGIN BULK", 10) == 0){
-        in_bulk = 1;
-        bulk_start = buffer_loc;
-      }
-      read_buffer_line(line[0], sizeof(line[0]), 
-                       &buffer_loc, buffer, buffer_len);
+  }
+
+  // Check that the sections fit within the file
+  long long nnodes = 0, nelems = 0, conn_size = 0;
+  long long ncomp = 0, nbcs = 0, bc_size = 0;
+  long long section_size[NUM_CACHE_SECTIONS];
+  if (valid){
+    nnodes = header[CACHE_NUM_NODES];
+    nelems = header[CACHE_NUM_ELEMENTS];
+    conn_size = header[CACHE_CONN_SIZE];
+    ncomp = header[CACHE_NUM_COMPONENTS];
+    nbcs = header[CACHE_NUM_BCS];
+    bc_size = header[CACHE_BC_VARS_SIZE];
+    valid = (nnodes >= 0 && nnodes <= INT_MAX && 
+             nelems >= 0 && nelems <= INT_MAX &&
+             conn_size >= 0 && conn_size <= INT_MAX &&
+             ncomp >= 0 && ncomp <= INT_MAX &&
+             nbcs >= 0 && nbcs <= INT_MAX &&
+             bc_size >= 0 && bc_size <= INT_MAX);
+  }
+  if (valid){
+    section_size[CACHE_XPTS] = 3*nnodes*sizeof(double);
+    section_size[CACHE_ELEM_PTR] = (nelems+1)*sizeof(int);
+    section_size[CACHE_ELEM_CONN] = conn_size*sizeof(int);
+    section_size[CACHE_ELEM_COMP] = nelems*sizeof(int);
+    section_size[CACHE_COMP_ELEMS] = 9*ncomp*sizeof(char);
+    section_size[CACHE_COMP_DESCRIPT] = 33*ncomp*sizeof(char);
+    section_size[CACHE_BC_NODES] = nbcs*sizeof(int);
+    section_size[CACHE_BC_PTR] = (nbcs+1)*sizeof(int);
+    section_size[CACHE_BC_VARS] = bc_size*sizeof(int);
+    section_size[CACHE_BC_VALS] = bc_size*sizeof(double);
+
+    for ( int k = 0; valid && k < NUM_CACHE_SECTIONS; k++ ){
+      long long offset = header[CACHE_OFFSETS + k];
+      valid = (offset >= (long long)header_size && 
+               offset + section_size[k] <= (long long)cache_len);
     }
+  }
 
-    // Treat the entire file as bulk data 
-    if (!in_bulk){
-      in_bulk = 1;
+  // Find the slice of the nodes, elements and boundary conditions
+  // that is read on this processor
+  const char *sections[NUM_CACHE_SECTIONS];
+  int n0 = 0, n1 = 0, e0 = 0, e1 = 0, b0 = 0, b1 = 0;
+  int c0 = 0, c1 = 0, v0 = 0, v1 = 0;
+  if (valid){
+    for ( int k = 0; k < NUM_CACHE_SECTIONS; k++ ){
+      sections[k] = &cache[header[CACHE_OFFSETS + k]];
+    }
+    n0 = (rank*nnodes)/size;  n1 = ((rank+1)*nnodes)/size;
+    e0 = (rank*nelems)/size;  e1 = ((rank+1)*nelems)/size;
+    b0 = (rank*nbcs)/size;    b1 = ((rank+1)*nbcs)/size;
+
+    // Check that the pointers start at zero, end at the size of the
+    // arrays and do not decrease within the slice. The slices overlap
+    // at their end points, so together they cover the whole array.
+    const int *ptr = (const int*)sections[CACHE_ELEM_PTR];
+    const int *bc_ptr_all = (const int*)sections[CACHE_BC_PTR];
+    valid = (ptr[0] == 0 && ptr[nelems] == conn_size &&
+             bc_ptr_all[0] == 0 && bc_ptr_all[nbcs] == bc_size &&
+             check_cache_ptr(ptr, e0, e1) &&
+             check_cache_ptr(bc_ptr_all, b0, b1));
+
+    // Check that the node, component and variable indices in the
+    // slice are within range
+    if (valid){
+      c0 = ptr[e0];  c1 = ptr[e1];
+      v0 = bc_ptr_all[b0];  v1 = bc_ptr_all[b1];
+      valid = (check_cache_range((const int*)sections[CACHE_ELEM_CONN],
+                                 c0, c1, 0, nnodes) &&
+               check_cache_range((const int*)sections[CACHE_ELEM_COMP],
+                                 e0, e1, 0, ncomp) &&
+               check_cache_range((const int*)sections[CACHE_BC_NODES],
+                                 b0, b1, 0, nnodes) &&
+               check_cache_range((const int*)sections[CACHE_BC_VARS],
+                                 v0, v1, 0, INT_MAX));
     }
+  }
 
-    // Set the starting location
-    buffer_loc = bulk_start;
+  int all_valid = 0;
+  MPI_Allreduce(&valid, &all_valid, 1, MPI_INT, MPI_MIN, comm);
+  if (!all_valid){
+    if (cache){ munmap((void*)cache, cache_len); }
+    return 0;
+  }
 
-    while (buffer_loc < buffer_len){
-      if (line[0][0] != '$'){ // This is not a comment line
-        int node;
-        double x, y, z;
+  // Copy this processor's slice of the mesh out of the cache
+  num_nodes = nnodes;
+  num_elements = nelems;
+  num_components = ncomp;
+  num_local_nodes = n1 - n0;
+  num_local_elements = e1 - e0;
+  num_bcs = b1 - b0;
+
+  const double *X = (const double*)sections[CACHE_XPTS];
+  Xpts = new TacsScalar[ 3*num_local_nodes ];
+  for ( int k = 0; k < 3*num_local_nodes; k++ ){
+    Xpts[k] = X[3*n0 + k];
+  }
 
-        // Check for GRID or GRID*
-        if (strncmp(line[0], "GRID*", 5) == 0){
-          if (!read_buffer_line(line[1], sizeof(line[1]), 
-                                &buffer_loc, buffer, buffer_len)){
-            fail = 1;
-            break;
-          }
-          parse_node_long_field(line[0], line[1], &node, &x, &y, &z);
-          num_nodes++;
-        }
-        else if (strncmp(line[0], "GRID", 4) == 0){
-          parse_node_short_free_field(line[0], &node, &x, &y, &z);
-          num_nodes++;
-        }
-        else if (strncmp(line[0], "CBAR", 4) == 0){
-          // Read in the component number and nodes associated with
-          // this element
-          int elem_num, component_num;
-          int nodes[2]; // Should have at most four nodes
-          parse_element_field(line[0],
-                              &elem_num, &component_num,
-                              nodes, 2);
-
-          if (component_num > num_components){
-            num_components = component_num;
-          }
-
-          elem_con_size += 2;
-          num_elements++;
-        }
-        
-	else if (strncmp(line[0], "CHEXA*", 6) == 0){
-	  for ( int i = 1; i < 3; i++ ){
-            if (!read_buffer_line(line[i], sizeof(line[i]), 
-                                  &buffer_loc, buffer, buffer_len)){
-              fail = 1; break;
-            }
-          }
-          // Read in the component number and nodes associated with
-          // this element
-          int elem_num, component_num, nodes[8];
-	  parse_element_field3(line[0], line[1], line[2],
-                               &elem_num, &component_num, 
-                               nodes, 8, 16);
-	  if (component_num > num_components){
-            num_components = component_num;
-          }
-	  elem_con_size += 8;
-          num_elements++;
-	}
-        else if (strncmp(line[0], "CHEXA", 5) == 0){
-          if (!read_buffer_line(line[1], sizeof(line[1]), 
-                                &buffer_loc, buffer, buffer_len)){
-            fail = 1; break;
-          }
-
-          // Read in the component number and nodes associated with
-          // this element
-          int elem_num, component_num, nodes[8]; 
-          parse_element_field2(line[0], line[1], 
-                               &elem_num, &component_num, 
-                               nodes, 8);
-
-          if (component_num > num_components){
-            num_components = component_num;
-          }
-
-          elem_con_size += 8;
-          num_elements++;
-        }
-        else if (strncmp(line[0], "CHEXA27", 7) == 0){
-          for ( int i = 1; i < 4; i++ ){
-            if (!read_buffer_line(line[i], sizeof(line[i]), 
-                                  &buffer_loc, buffer, buffer_len)){
-              fail = 1; break;
-            }
-          }
-
-          // Read in the component number and nodes associated with
-          // this element
-          int elem_num, component_num, nodes[27];
-          parse_element_field4(line[0], line[1], line[2], line[3],
-                               &elem_num, &component_num, 
-                               nodes, 27);
-
-          if (component_num > num_components){
-            num_components = component_num;
-          }
-
-          elem_con_size += 27;
-          num_elements++;
-        }
-        else if (strncmp(line[0], "CHEXA64", 7) == 0){
-          for ( int i = 1; i < 9; i++ ){
-            if (!read_buffer_line(line[i], sizeof(line[i]), 
-                                  &buffer_loc, buffer, buffer_len)){
-              fail = 1; break;
-            }
-          }
-
-          // Read in the component number and nodes associated 
-          // with this element
-          int elem_num, component_num, nodes[27];
-          parse_element_field9(line[0], line[1], line[2], line[3], line[4],
-                               line[5], line[6], line[7], line[8],
-                               &elem_num, &component_num, 
-                               nodes, 64);
-
-          if (component_num > num_components){
-            num_components = component_num;
-          }
-
-          elem_con_size += 64;
-          num_elements++;
-        }
-        else if (strncmp(line[0], "CQUAD16", 7) == 0){
-          if (!read_buffer_line(line[1], sizeof(line[1]), 
-                                &buffer_loc, buffer, buffer_len)){
-            fail = 1; break;
-          }
-          if (!read_buffer_line(line[2], sizeof(line[2]), 
-                                &buffer_loc, buffer, buffer_len)){
-            fail = 1; break;
-          }
-
-          // Read in the component number and nodes associated 
-          // with this element
-          int elem_num, component_num;
-          int nodes[16]; // Should have at most four nodes
-          parse_element_field3(line[0], line[1], line[2],
-                               &elem_num, &component_num,
-                               nodes, 16);
-
-          if (component_num > num_components){
-            num_components = component_num;
-          }
-
-          elem_con_size += 16;
-          num_elements++;
-        }
-        else if (strncmp(line[0], "CQUAD9", 6) == 0){
-          if (!read_buffer_line(line[1], sizeof(line[1]), 
-                                &buffer_loc, buffer, buffer_len)){
-            fail = 1; break;
-          }
-
-          // Read in the component number and nodes associated 
-          // with this element
-          int elem_num, component_num;
-          int nodes[9]; // Should have at most 9 nodes          
-          if (!convertToCoordinate) {
-            parse_element_field2(line[0], line[1],
-                                 &elem_num, &component_num,
-                                 nodes, 9);
-          } 
-          else {
-            int tmp[9];
-            parse_element_field2(line[0], line[1],
-                                 &elem_num, &component_num,
-                                 tmp, 9);
-            // convert to coordinate ordering for gmsh
-            convert_to_coordinate(&nodes[0], &tmp[0]);
-          }
-
-          if (component_num > num_components){
-            num_components = component_num;
-          }
-
-          elem_con_size += 9;
-          num_elements++;
-        }
-        else if (strncmp(line[0], "CQUAD4*", 7) == 0 ){
-          // Read in the component number and nodes associated 
-          // with this element
-          int elem_num, component_num;
-          int nodes[4]; // Should have at most four nodes
-          parse_element_field2(line[0], line[1],
-                              &elem_num, &component_num,
-                               nodes, 4, 16);
-
-          if (component_num > num_components){
-            num_components = component_num;
-          }
-
-          elem_con_size += 4;
-          num_elements++;
-        }
-        else if (strncmp(line[0], "CQUAD4", 6) == 0 || 
-                 strncmp(line[0], "CQUADR", 6) == 0){
-          // Read in the component number and nodes associated 
-          // with this element
-          int elem_num, component_num;
-          int nodes[4]; // Should have at most four nodes
-          parse_element_field(line[0],
-                              &elem_num, &component_num,
-                              nodes, 4);
-
-          if (component_num > num_components){
-            num_components = component_num;
-          }
-
-          elem_con_size += 4;
-          num_elements++;
-        }  
-        else if (strncmp(line[0], "CQUAD", 5) == 0){
-          if (!read_buffer_line(line[1], sizeof(line[1]), 
-                                &buffer_loc, buffer, buffer_len)){
-            fail = 1; break;
-          }
-
-          // Read in the component number and nodes associated 
-          // with this element
-          int elem_num, component_num;
-          int nodes[9]; // Should have at most four nodes
-          if (!convertToCoordinate) {
-            parse_element_field2(line[0], line[1],
-                                 &elem_num, &component_num,
-                                 nodes, 9);
-          } 
-          else {
-            int tmp[9];
-            parse_element_field2(line[0], line[1],
-                                 &elem_num, &component_num,
-                                 tmp, 9);
-            // convert to coordinate ordering for gmsh
-            convert_to_coordinate(&nodes[0], &tmp[0]);
-          }
-
-          if (component_num > num_components){
-            num_components = component_num;
-          }
-
-          elem_con_size += 9;
-          num_elements++;
-        }      
-        else if (strncmp(line[0], "CTRIA3", 6) == 0){
-          // Read in the component number and nodes associated 
-          // with this element
-          int elem_num, component_num;
-          int nodes[3]; // Should have at most three nodes
-          parse_element_field(line[0],
-                              &elem_num, &component_num,
-                              nodes, 3);
-
-          if (component_num > num_components){
-            num_components = component_num;
-          }
-
-          elem_con_size += 3;
-          num_elements++;
-        }  
-        else if (strncmp(line[0], "SPC", 3) == 0){
-          bc_vars_size += 8;
-          num_bcs++;
-        }
-        else if (strncmp(line[0], "FFORCE", 6) == 0){     
-          // Read in the component number and nodes associated 
-          // with this element
-          int elem_num, component_num;
-          int nodes[1]; // Should have at most four nodes
-          parse_element_field(line[0],
-                              &elem_num, &component_num,
-                              nodes, 1);
-
-          if (component_num > num_components){
-            num_components = component_num;
-          }
-          elem_con_size += 1;
-          num_elements++;
-        }
-      }
+  const int *ptr = (const int*)sections[CACHE_ELEM_PTR];
+  elem_node_ptr = new int[ num_local_elements+1 ];
+  elem_node_conn = new int[ c1 - c0 ];
+  elem_component = new int[ num_local_elements ];
+  for ( int k = 0; k <= num_local_elements; k++ ){
+    elem_node_ptr[k] = ptr[e0 + k] - c0;
+  }
+  memcpy(elem_node_conn, &((const int*)sections[CACHE_ELEM_CONN])[c0], 
+         (c1 - c0)*sizeof(int));
+  memcpy(elem_component, &((const int*)sections[CACHE_ELEM_COMP])[e0], 
+         num_local_elements*sizeof(int));
+
+  component_elems = new char[ 9*num_components ];
+  component_descript = new char[ 33*num_components ];
+  memcpy(component_elems, sections[CACHE_COMP_ELEMS],
+         section_size[CACHE_COMP_ELEMS]);
+  memcpy(component_descript, sections[CACHE_COMP_DESCRIPT],
+         section_size[CACHE_COMP_DESCRIPT]);
+
+  const int *bc_ptr_all = (const int*)sections[CACHE_BC_PTR];
+  bc_nodes = new int[ num_bcs ];
+  bc_ptr = new int[ num_bcs+1 ];
+  bc_vars = new int[ v1 - v0 ];
+  bc_vals = new TacsScalar[ v1 - v0 ];
+  memcpy(bc_nodes, &((const int*)sections[CACHE_BC_NODES])[b0], 
+         num_bcs*sizeof(int));
+  for ( int k = 0; k <= num_bcs; k++ ){
+    bc_ptr[k] = bc_ptr_all[b0 + k] - v0;
+  }
+  memcpy(bc_vars, &((const int*)sections[CACHE_BC_VARS])[v0], 
+         (v1 - v0)*sizeof(int));
+  const double *vals = (const double*)sections[CACHE_BC_VALS];
+  for ( int k = 0; k < v1 - v0; k++ ){
+    bc_vals[k] = vals[v0 + k];
+  }
 
-      read_buffer_line(line[0], sizeof(line[0]), 
-                       &buffer_loc, buffer, buffer_len);
-    }
-  
-    // Allocate space for everything    
-    node_nums = new int[ num_nodes ];
-    Xpts_unsorted = new double[ 3*num_nodes ];
-    
-    // Element type information
-    int * elem_nums = new int[ num_elements ];
-    int * elem_comp = new int[ num_elements ];
-    
-    // The connectivity information
-    int * elem_con = new int[ elem_con_size ];
-    int * elem_con_ptr = new int[ num_elements+1 ];
-    elem_con_ptr[0] = 0;
-    
-    // Boundary condition information
-    bc_nodes = new int[ num_bcs ];
-    bc_ptr = new int[ num_bcs+1 ];
-    bc_vals = new TacsScalar[ bc_vars_size ];
-    bc_vars = new int[ bc_vars_size ];
-    bc_ptr[0] = 0;
-
-    // Allocate space for storing the component names
-    component_elems = new char[ 9*num_components ];
-    component_descript = new char[ 33*num_components ];
-    memset(component_elems, '\0', 9*num_components*sizeof(char));
-    memset(component_descript, '\0', 33*num_components*sizeof(char));
-
-    // Reset the sizes of the things to be read in
-    num_nodes = 0;
-    num_elements = 0;
-    num_bcs = 0;
-    elem_con_size = 0;
-    bc_vars_size = 0;
-
-    // Rewind to the beginning of the bulk section and allocate everything
-    buffer_loc = bulk_start;
-    read_buffer_line(line[0], sizeof(line[0]), 
-                     &buffer_loc, buffer, buffer_len);
-
-    // Keep track of the component numbers loaded from an
-    // ICEM-generated bdf file
-    int component_counter = 0;
-
-    while (buffer_loc < buffer_len){        
-      int node;
-      double x, y, z;
-
-      if (strncmp(line[0], "$       Shell", 13) == 0){
-        // A standard icem output - description of each
-        // component. This is very useful for describing what the
-        // components actually are with a string.
-        // Again use a fixed width format
-        char comp[33];
-        int comp_num = component_counter; 
-        component_counter++;
-
-        strncpy(comp, &line[0][41], 32);
-        comp[32] = '\0';
-        // Remove white space
-        if (comp_num >= 0 && comp_num < num_components){
-          sscanf(comp, "%s", &component_descript[33*comp_num]);
-        }
-      }
-      if (line[0][0] != '$'){ // A comment line
-        // Check for GRID or GRID*
-        if (strncmp(line[0], "GRID*", 5) == 0){
-          if (!read_buffer_line(line[1], sizeof(line[1]), 
-                                &buffer_loc, buffer, buffer_len)){
-            fail = 1;
-            break;
-          }
-          parse_node_long_field(line[0], line[1], &node, &x, &y, &z);
-          node_nums[num_nodes] = node-1; // Get the C ordering
-          Xpts_unsorted[3*num_nodes]   = x;
-          Xpts_unsorted[3*num_nodes+1] = y;
-          Xpts_unsorted[3*num_nodes+2] = z;
-          num_nodes++;
-        }
-        else if (strncmp(line[0], "GRID", 4) == 0){
-          parse_node_short_free_field(line[0], &node, &x, &y, &z);
-          node_nums[num_nodes] = node-1; // Get the C ordering
-          Xpts_unsorted[3*num_nodes]   = x;
-          Xpts_unsorted[3*num_nodes+1] = y;
-          Xpts_unsorted[3*num_nodes+2] = z;     
-          num_nodes++;
-        }        
-        else if (strncmp(line[0], "CBAR", 4) == 0){
-          // Read in the component number and nodes associated with
-          // this element
-          int elem_num, component_num;
-          int nodes[2]; // Should have at most two nodes
-          parse_element_field(line[0],
-                              &elem_num, &component_num,
-                              nodes, 2);
-
-          elem_nums[num_elements] = elem_num-1;
-          elem_comp[num_elements] = component_num-1;
-
-          elem_con[elem_con_size] = nodes[0]-1;
-          elem_con[elem_con_size+1] = nodes[1]-1;
-
-          elem_con_size += 2;
-          elem_con_ptr[num_elements+1] = elem_con_size;
-          num_elements++;
-
-          if (component_elems[9*(component_num-1)] == '\0'){
-            strcpy(&component_elems[9*(component_num-1)], "CBAR");
-          }
-        }
-        
-	else if (strncmp(line[0], "CHEXA*", 6) == 0){
-	  for ( int i = 1; i < 3; i++ ){
-            if (!read_buffer_line(line[i], sizeof(line[i]), 
-                                  &buffer_loc, buffer, buffer_len)){
-              fail = 1; break;
-            }
-          }
-          // Read in the component number and nodes associated 
-          // with this element
-          int elem_num, component_num, nodes[8]; 
-          parse_element_field3(line[0], line[1], line[2], 
-                               &elem_num, &component_num, 
-                               nodes, 8, 16);
-
-          elem_nums[num_elements] = elem_num-1;
-          elem_comp[num_elements] = component_num-1;
-
-          elem_con[elem_con_size]   = nodes[0]-1;
-          elem_con[elem_con_size+1] = nodes[1]-1;
-          elem_con[elem_con_size+2] = nodes[3]-1;
-          elem_con[elem_con_size+3] = nodes[2]-1;
-          elem_con[elem_con_size+4] = nodes[4]-1;
-          elem_con[elem_con_size+5] = nodes[5]-1;
-          elem_con[elem_con_size+6] = nodes[7]-1;
-          elem_con[elem_con_size+7] = nodes[6]-1;
-	  
-          elem_con_size += 8;
-          elem_con_ptr[num_elements+1] = elem_con_size;
-          num_elements++;
-	  if (component_elems[9*(component_num-1)] == '\0'){
-            strcpy(&component_elems[9*(component_num-1)], "CHEXA*");
-          }
-        }
-        else if (strncmp(line[0], "CHEXA", 5) == 0){
-          if (!read_buffer_line(line[1], sizeof(line[1]), 
-                                &buffer_loc, buffer, buffer_len)){
-            fail = 1; break;
-          }
-
-          // Read in the component number and nodes associated 
-          // with this element
-          int elem_num, component_num, nodes[8]; 
-          parse_element_field2(line[0], line[1], 
-                               &elem_num, &component_num, 
-                               nodes, 8);
-
-          elem_nums[num_elements] = elem_num-1;
-          elem_comp[num_elements] = component_num-1;
-
-          elem_con[elem_con_size]   = nodes[0]-1;
-          elem_con[elem_con_size+1] = nodes[1]-1;
-          elem_con[elem_con_size+2] = nodes[3]-1;
-          elem_con[elem_con_size+3] = nodes[2]-1;
-          elem_con[elem_con_size+4] = nodes[4]-1;
-          elem_con[elem_con_size+5] = nodes[5]-1;
-          elem_con[elem_con_size+6] = nodes[7]-1;
-          elem_con[elem_con_size+7] = nodes[6]-1;
-         
-          elem_con_size += 8;
-          elem_con_ptr[num_elements+1] = elem_con_size;
-          num_elements++;
-
-          if (component_elems[9*(component_num-1)] == '\0'){
-            strcpy(&component_elems[9*(component_num-1)], "CHEXA");
-          }
-        }
-        else if (strncmp(line[0], "CHEXA27", 7) == 0){
-          for ( int i = 1; i < 4; i++ ){
-            if (!read_buffer_line(line[i], sizeof(line[i]), 
-                                  &buffer_loc, buffer, buffer_len)){
-              fail = 1; break;
-            }
-          }
-
-          // Read in the component number and nodes associated
-          // with this element
-          int elem_num, component_num, nodes[27];
-          parse_element_field4(line[0], line[1], line[2], line[3],
-                               &elem_num, &component_num, 
-                               nodes, 27);
-
-          elem_nums[num_elements] = elem_num-1;
-          elem_comp[num_elements] = component_num-1;
-          
-          for ( int k = 0; k < 27; k++ ){
-            elem_con[elem_con_size+k] = nodes[k]-1;
-          }
-
-          elem_con_size += 27;
-          elem_con_ptr[num_elements+1] = elem_con_size;
-          num_elements++;
-
-          if (component_elems[9*(component_num-1)] == '\0'){
-            strcpy(&component_elems[9*(component_num-1)], "CHEXA64");
-          }
-        }
-        else if (strncmp(line[0], "CHEXA64", 7) == 0){
-          for ( int i = 1; i < 9; i++ ){
-            if (!read_buffer_line(line[i], sizeof(line[i]), 
-                                  &buffer_loc, buffer, buffer_len)){
-              fail = 1; break;
-            }
-          }
-
-          // Read in the component number and nodes associated
-          // with this element
-          int elem_num, component_num, nodes[64];
-          parse_element_field9(line[0], line[1], line[2], line[3], line[4],
-                               line[5], line[6], line[7], line[8],
-                               &elem_num, &component_num, 
-                               nodes, 64);
-
-          elem_nums[num_elements] = elem_num-1;
-          elem_comp[num_elements] = component_num-1;
-          
-          for ( int k = 0; k < 64; k++ ){
-            elem_con[elem_con_size+k] = nodes[k]-1;
-          }
-
-          elem_con_size += 64;
-          elem_con_ptr[num_elements+1] = elem_con_size;
-          num_elements++;
-
-          if (component_elems[9*(component_num-1)] == '\0'){
-            strcpy(&component_elems[9*(component_num-1)], "CHEXA64");
-          }
-        }
-        else if (strncmp(line[0], "CQUAD16", 7) == 0){
-          if (!read_buffer_line(line[1], sizeof(line[1]), 
-                                &buffer_loc, buffer, buffer_len)){
-            fail = 1; break;
-          }
-          if (!read_buffer_line(line[2], sizeof(line[2]), 
-                                &buffer_loc, buffer, buffer_len)){
-            fail = 1; break;
-          }
-
-          // Read in the component number and nodes associated 
-          // with this element
-          int elem_num, component_num;
-          int nodes[16]; // Should have at most four nodes
-          parse_element_field3(line[0], line[1], line[2],
-                               &elem_num, &component_num,
-                               nodes, 16);
-
-          elem_nums[num_elements] = elem_num-1;
-          elem_comp[num_elements] = component_num-1;
-          
-          for ( int k = 0; k < 16; k++ ){
-            elem_con[elem_con_size+k] = nodes[k]-1;
-          }
-
-          elem_con_size += 16;
-          elem_con_ptr[num_elements+1] = elem_con_size;
-          num_elements++;
-
-          if (component_elems[9*(component_num-1)] == '\0'){
-            strcpy(&component_elems[9*(component_num-1)], "CQUAD16");
-          }
-        }
-        else if (strncmp(line[0], "CQUAD9", 6) == 0){
-          if (!read_buffer_line(line[1], sizeof(line[1]), 
-                                &buffer_loc, buffer, buffer_len)){
-            fail = 1; break;
-          }
-
-          // Read in the component number and nodes associated
-          // with this element
-          int elem_num, component_num;
-          int nodes[9]; // Should have at most 9 nodes          
-          if (!convertToCoordinate) {
-            parse_element_field2(line[0], line[1],
-                                 &elem_num, &component_num,
-                                 nodes, 9);
-          } 
-          else {
-            int tmp[9];
-            parse_element_field2(line[0], line[1],
-                                 &elem_num, &component_num,
-                                 tmp, 9);
-            // convert to coordinate ordering for gmsh
-            convert_to_coordinate(&nodes[0], &tmp[0]);
-          }
-
-          elem_nums[num_elements] = elem_num-1;
-          elem_comp[num_elements] = component_num-1;
-          
-          for ( int k = 0; k < 9; k++ ){
-            elem_con[elem_con_size+k] = nodes[k]-1;
-          }
-
-          elem_con_size += 9;
-          elem_con_ptr[num_elements+1] = elem_con_size;
-          num_elements++;
-
-          if (component_elems[9*(component_num-1)] == '\0'){
-            strcpy(&component_elems[9*(component_num-1)], "CQUAD9");
-          }
-        }
-        else if (strncmp(line[0], "CQUAD4*", 7) == 0 ){
-          if (!read_buffer_line(line[1], sizeof(line[1]), 
-                                &buffer_loc, buffer, buffer_len)){
-            fail = 1;
-            break;
-          }
-          // Read in the component number and nodes associated
-          // with this element
-          int elem_num, component_num;
-          int nodes[4]; // Should have at most four nodes
-          parse_element_field2(line[0], line[1],
-                               &elem_num, &component_num,
-                               nodes, 4, 16);
-          // Add the element to the connectivity list
-          elem_nums[num_elements] = elem_num-1;
-          elem_comp[num_elements] = component_num-1;
-          elem_con[elem_con_size]   = nodes[0]-1;
-          elem_con[elem_con_size+1] = nodes[1]-1;
-          elem_con[elem_con_size+2] = nodes[3]-1;
-          elem_con[elem_con_size+3] = nodes[2]-1;
-          elem_con_size += 4;
-
-          elem_con_ptr[num_elements+1] = elem_con_size;
-          num_elements++;
-
-          if (component_elems[9*(component_num-1)] == '\0'){
-            strcpy(&component_elems[9*(component_num-1)], "CQUAD4");
-          }
-        }
-        else if (strncmp(line[0], "CQUAD4", 6) == 0 ||
-                 strncmp(line[0], "CQUADR", 6) == 0){
-          // Read in the component number and nodes associated
-          // with this element
-          int elem_num, component_num;
-          int nodes[4]; // Should have at most four nodes
-          parse_element_field(line[0],
-                              &elem_num, &component_num,
-                              nodes, 4);
-          // Add the element to the connectivity list
-          elem_nums[num_elements] = elem_num-1;
-          elem_comp[num_elements] = component_num-1;
-
-          elem_con[elem_con_size]   = nodes[0]-1;
-          elem_con[elem_con_size+1] = nodes[1]-1;
-          elem_con[elem_con_size+2] = nodes[3]-1;
-          elem_con[elem_con_size+3] = nodes[2]-1;
-          elem_con_size += 4;
-
-          elem_con_ptr[num_elements+1] = elem_con_size;
-          num_elements++;
-
-          if (component_elems[9*(component_num-1)] == '\0'){
-            strcpy(&component_elems[9*(component_num-1)], "CQUAD4");
-          }
-        }        
-        else if (strncmp(line[0], "CQUAD", 5) == 0){
-          if (!read_buffer_line(line[1], sizeof(line[1]), 
-                                &buffer_loc, buffer, buffer_len)){
-            fail = 1; break;
-          }
-
-          // Read in the component number and nodes associated 
-          // with this element
-          int elem_num, component_num;
-          int nodes[9]; // Should have at most four nodes
-          if (!convertToCoordinate) {
-            parse_element_field2(line[0], line[1],
-                                 &elem_num, &component_num,
-                                 nodes, 9);
-          } 
-          else {
-            int tmp[9];
-            parse_element_field2(line[0], line[1],
-                                 &elem_num, &component_num,
-                                 tmp, 9);
-            // convert to coordinate ordering for gmsh
-            convert_to_coordinate(&nodes[0], &tmp[0]);
-          }
-
-          elem_nums[num_elements] = elem_num-1;
-          elem_comp[num_elements] = component_num-1;
-          
-          elem_con[elem_con_size] = nodes[0]-1;
-          elem_con[elem_con_size+1] = nodes[4]-1;
-          elem_con[elem_con_size+2] = nodes[1]-1;
-
-          elem_con[elem_con_size+3] = nodes[7]-1;
-          elem_con[elem_con_size+4] = nodes[8]-1;
-          elem_con[elem_con_size+5] = nodes[5]-1;
-
-          elem_con[elem_con_size+6] = nodes[3]-1;
-          elem_con[elem_con_size+7] = nodes[6]-1;
-          elem_con[elem_con_size+8] = nodes[2]-1;          
-
-          elem_con_size += 9;
-          elem_con_ptr[num_elements+1] = elem_con_size;
-          num_elements++;
-
-          if (component_elems[9*(component_num-1)] == '\0'){
-            strcpy(&component_elems[9*(component_num-1)], "CQUAD");
-          }
-        }
-        else if (strncmp(line[0], "CTRIA3", 6) == 0){
-          // Read in the component number and nodes associated
-          // with this element
-          int elem_num, component_num;
-          int nodes[3]; // Should have at most four nodes
-          parse_element_field(line[0],
-                              &elem_num, &component_num,
-                              nodes, 3);
-          
-          // Add the element to the connectivity list
-          elem_nums[num_elements] = elem_num-1;
-          elem_comp[num_elements] = component_num-1;
-
-          elem_con[elem_con_size]   = nodes[0]-1;
-          elem_con[elem_con_size+1] = nodes[1]-1;
-          elem_con[elem_con_size+2] = nodes[2]-1;
-          elem_con_size += 3;
-
-          elem_con_ptr[num_elements+1] = elem_con_size;
-          num_elements++;
-
-          if (component_elems[9*(component_num-1)] == '\0'){
-            strcpy(&component_elems[9*(component_num-1)], "CTRIA3");
-          }
-        }
-        else if (strncmp(line[0], "FFORCE", 6) == 0){
-          // Read in the component number and nodes associated 
-          // with the following force
-          int elem_num, component_num;
-          int nodes[1]; // Should have at most four nodes
-          parse_element_field(line[0], &elem_num, &component_num,
-                              nodes, 1);
-
-          elem_nums[num_elements] = elem_num-1;
-          elem_comp[num_elements] = component_num-1;          
-          elem_con[elem_con_size] = nodes[0]-1;
-
-          elem_con_size++;
-          elem_con_ptr[num_elements+1] = elem_con_size;
-          num_elements++;
-
-          if (component_elems[9*(component_num-1)] == '\0'){
-            strcpy(&component_elems[9*(component_num-1)], "FFORCE");
-          }
-        }
-        else if (strncmp(line[0], "SPC", 3) == 0){
-          // This is a variable-length format. Read in grid points until 
-          // zero is reached. This is a fixed-width format
-          // SPC SID  G1  C  D
-          
-          // Read in the nodal value
-          char node[9];
-          strncpy(node, &line[0][16], 8);
-          node[8] = '\0';
-          bc_nodes[num_bcs] = atoi(node)-1;
-          
-          strncpy(node, &line[0][32], 8);
-          node[8] = '\0';
-          double val = bdf_atof(node);
-          
-          // Read in the dof that will be constrained
-          for ( int k = 24; k < 32; k++ ){
-            char dofs[9] = "12345678";
-            
-            for ( int j = 0; j < 8; j++ ){
-              if (dofs[j] == line[0][k]){
-                bc_vars[bc_vars_size] = j;
-                bc_vals[bc_vars_size] = val;
-                bc_vars_size++;
-                break;
-              }
-            }
-          }
-          
-          bc_ptr[num_bcs+1] = bc_vars_size;
-          num_bcs++;
-        }
-      }
+  munmap((void*)cache, cache_len);
 
-      read_buffer_line(line[0], sizeof(line[0]), 
-                       &buffer_loc, buffer, buffer_len);
-    }
+  return 1;
+}
 
-    delete [] buffer;
+/*
+  Write the data to the file at the given offset.
 
-    if (fail){
-      delete [] elem_nums;
-      delete [] elem_comp;
-      delete [] elem_con;
-      delete [] elem_con_ptr;
-      MPI_Abort(comm, fail);
-      return fail;
+  returns:
+  0 on success, 1 if the data could not be written
+*/
+static int write_cache_data( int fd, long long offset, 
+                             const void *data, size_t len ){
+  const char *ptr = (const char*)data;
+  while (len > 0){
+    ssize_t n = pwrite(fd, ptr, len, offset);
+    if (n <= 0){
+      return 1;
     }
+    ptr += n;
+    offset += n;
+    len -= n;
+  }
+  return 0;
+}
 
-    // Arg sort the list of nodes
-    int *node_args = new int[ num_nodes ]; 
-    for ( int k = 0; k < num_nodes; k++ ){ 
-      node_args[k] = k; 
-    }
+/*
+  Write the mesh to the cache file.
+
+  The root processor writes the header and the component data. Each
+  processor then writes its block of the nodes, elements and boundary
+  conditions directly at its offset within each section, so the mesh
+  is never gathered on a single processor. The cache is first written
+  to a temporary file which is renamed once all processors have
+  finished, so that a partially written cache is never read. This
+  call is collective on all processors.
 
-    arg_sort_list = node_nums;
-    qsort(node_args, num_nodes, sizeof(int), compare_arg_sort);
-    arg_sort_list = NULL;
+  input:
+  key:     the key of the BDF file
+
+  returns:
+  0 on success, 1 if the cache could not be written
+*/
+int TACSMeshLoader::writeMeshCache( const long long key[] ){
+  int rank, size;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
+
+  const int root = 0;
 
-    // Arg sort the list of elements
-    int *elem_args = new int[ num_elements ];
-    for ( int k = 0; k < num_elements; k++ ){
-      elem_args[k] = k;
+  // Find the offsets of the local blocks within the global arrays
+  enum { BLOCK_NODES, BLOCK_ELEMENTS, BLOCK_CONN, 
+         BLOCK_BCS, BLOCK_BC_VARS, NUM_BLOCKS };
+  long long local[NUM_BLOCKS], offset[NUM_BLOCKS], total[NUM_BLOCKS];
+  local[BLOCK_NODES] = num_local_nodes;
+  local[BLOCK_ELEMENTS] = num_local_elements;
+  local[BLOCK_CONN] = elem_node_ptr[num_local_elements];
+  local[BLOCK_BCS] = num_bcs;
+  local[BLOCK_BC_VARS] = bc_ptr[num_bcs];
+  memset(offset, 0, sizeof(offset));
+  MPI_Exscan(local, offset, NUM_BLOCKS, MPI_LONG_LONG_INT, MPI_SUM, comm);
+  if (rank == 0){
+    memset(offset, 0, sizeof(offset));
+  }
+  MPI_Allreduce(local, total, NUM_BLOCKS, MPI_LONG_LONG_INT, MPI_SUM, comm);
+
+  long long section_size[NUM_CACHE_SECTIONS];
+  section_size[CACHE_XPTS] = 3*total[BLOCK_NODES]*sizeof(double);
+  section_size[CACHE_ELEM_PTR] = (total[BLOCK_ELEMENTS]+1)*sizeof(int);
+  section_size[CACHE_ELEM_CONN] = total[BLOCK_CONN]*sizeof(int);
+  section_size[CACHE_ELEM_COMP] = total[BLOCK_ELEMENTS]*sizeof(int);
+  section_size[CACHE_COMP_ELEMS] = 9*num_components*sizeof(char);
+  section_size[CACHE_COMP_DESCRIPT] = 33*num_components*sizeof(char);
+  section_size[CACHE_BC_NODES] = total[BLOCK_BCS]*sizeof(int);
+  section_size[CACHE_BC_PTR] = (total[BLOCK_BCS]+1)*sizeof(int);
+  section_size[CACHE_BC_VARS] = total[BLOCK_BC_VARS]*sizeof(int);
+  section_size[CACHE_BC_VALS] = total[BLOCK_BC_VARS]*sizeof(double);
+
+  // Set the header
+  long long header[NUM_CACHE_ENTRIES];
+  header[CACHE_VERSION] = MESH_CACHE_VERSION;
+  header[CACHE_BYTE_ORDER] = MESH_CACHE_BYTE_ORDER;
+  for ( int k = 0; k < NUM_MESH_CACHE_KEYS; k++ ){
+    header[CACHE_KEY + k] = key[k];
+  }
+  header[CACHE_NUM_NODES] = total[BLOCK_NODES];
+  header[CACHE_NUM_ELEMENTS] = total[BLOCK_ELEMENTS];
+  header[CACHE_CONN_SIZE] = total[BLOCK_CONN];
+  header[CACHE_NUM_COMPONENTS] = num_components;
+  header[CACHE_NUM_BCS] = total[BLOCK_BCS];
+  header[CACHE_BC_VARS_SIZE] = total[BLOCK_BC_VARS];
+
+  long long file_len = sizeof(mesh_cache_magic) + sizeof(header);
+  for ( int k = 0; k < NUM_CACHE_SECTIONS; k++ ){
+    file_len = MESH_CACHE_ALIGN*((file_len + MESH_CACHE_ALIGN-1)/
+                                 MESH_CACHE_ALIGN);
+    header[CACHE_OFFSETS + k] = file_len;
+    file_len += section_size[k];
+  }
+
+  // The name of the temporary file is set on the root processor
+  int pid = (int)getpid();
+  MPI_Bcast(&pid, 1, MPI_INT, root, comm);
+  char *temp_name = new char[ strlen(cache_file) + 32 ];
+  sprintf(temp_name, "%s.tmp%d", cache_file, pid);
+
+  // Write the header, the component data and the last entries of the
+  // pointer arrays on the root processor
+  int fail = 0;
+  int fd = -1;
+  if (rank == root){
+    fd = open(temp_name, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0){
+      fail = 1;
+    }
+    else {
+      int conn_end = total[BLOCK_CONN];
+      int bc_end = total[BLOCK_BC_VARS];
+      fail = (write_cache_data(fd, 0, mesh_cache_magic, 
+                               sizeof(mesh_cache_magic)) ||
+              write_cache_data(fd, sizeof(mesh_cache_magic), 
+                               header, sizeof(header)) ||
+              write_cache_data(fd, header[CACHE_OFFSETS + CACHE_COMP_ELEMS],
+                               component_elems, 
+                               section_size[CACHE_COMP_ELEMS]) ||
+              write_cache_data(fd, 
+                               header[CACHE_OFFSETS + CACHE_COMP_DESCRIPT],
+                               component_descript, 
+                               section_size[CACHE_COMP_DESCRIPT]) ||
+              write_cache_data(fd, header[CACHE_OFFSETS + CACHE_ELEM_PTR] +
+                               total[BLOCK_ELEMENTS]*sizeof(int),
+                               &conn_end, sizeof(int)) ||
+              write_cache_data(fd, header[CACHE_OFFSETS + CACHE_BC_PTR] +
+                               total[BLOCK_BCS]*sizeof(int),
+                               &bc_end, sizeof(int)) ||
+              ftruncate(fd, file_len) != 0);
     }
+  }
+  MPI_Bcast(&fail, 1, MPI_INT, root, comm);
 
-    arg_sort_list = elem_nums;
-    qsort(elem_args, num_elements, sizeof(int), compare_arg_sort);
-    arg_sort_list = NULL;
+  if (!fail && rank != root){
+    fd = open(temp_name, O_WRONLY);
+    if (fd < 0){
+      fail = 1;
+    }
+  }
 
-    // Now node_nums[node_args[k]] and elem_nums[elem_args[k] are sorted.
+  // Write the local blocks of the mesh
+  if (!fail){
+    int nnodes = num_local_nodes;
+    int nelems = num_local_elements;
+    int nvars = local[BLOCK_BC_VARS];
+
+    // Convert the real-valued data to double precision and offset the
+    // pointers to the global arrays
+    double *X = new double[ 3*nnodes ];
+    for ( int k = 0; k < 3*nnodes; k++ ){
+      X[k] = TacsRealPart(Xpts[k]);
+    }
+    double *vals = new double[ nvars ];
+    for ( int k = 0; k < nvars; k++ ){
+      vals[k] = TacsRealPart(bc_vals[k]);
+    }
+    int *ptr = new int[ nelems ];
+    for ( int k = 0; k < nelems; k++ ){
+      ptr[k] = offset[BLOCK_CONN] + elem_node_ptr[k];
+    }
+    int *bptr = new int[ num_bcs ];
+    for ( int k = 0; k < num_bcs; k++ ){
+      bptr[k] = offset[BLOCK_BC_VARS] + bc_ptr[k];
+    }
 
-    // Create the output for the nodes
-    Xpts = new TacsScalar[3*num_nodes];
+    const long long *sec = &header[CACHE_OFFSETS];
+    fail = (write_cache_data(fd, sec[CACHE_XPTS] + 
+                             3*offset[BLOCK_NODES]*sizeof(double),
+                             X, 3*nnodes*sizeof(double)) ||
+            write_cache_data(fd, sec[CACHE_ELEM_PTR] + 
+                             offset[BLOCK_ELEMENTS]*sizeof(int),
+                             ptr, nelems*sizeof(int)) ||
+            write_cache_data(fd, sec[CACHE_ELEM_CONN] + 
+                             offset[BLOCK_CONN]*sizeof(int),
+                             elem_node_conn, 
+                             local[BLOCK_CONN]*sizeof(int)) ||
+            write_cache_data(fd, sec[CACHE_ELEM_COMP] + 
+                             offset[BLOCK_ELEMENTS]*sizeof(int),
+                             elem_component, nelems*sizeof(int)) ||
+            write_cache_data(fd, sec[CACHE_BC_NODES] + 
+                             offset[BLOCK_BCS]*sizeof(int),
+                             bc_nodes, num_bcs*sizeof(int)) ||
+            write_cache_data(fd, sec[CACHE_BC_PTR] + 
+                             offset[BLOCK_BCS]*sizeof(int),
+                             bptr, num_bcs*sizeof(int)) ||
+            write_cache_data(fd, sec[CACHE_BC_VARS] + 
+                             offset[BLOCK_BC_VARS]*sizeof(int),
+                             bc_vars, nvars*sizeof(int)) ||
+            write_cache_data(fd, sec[CACHE_BC_VALS] + 
+                             offset[BLOCK_BC_VARS]*sizeof(double),
+                             vals, nvars*sizeof(double)));
+
+    delete [] X;
+    delete [] vals;
+    delete [] ptr;
+    delete [] bptr;
+  }
+  if (fd >= 0 && close(fd) != 0){
+    fail = 1;
+  }
 
-    for ( int k = 0; k < num_nodes; k++ ){
-      int n = node_args[k];
-      for ( int j = 0; j < 3; j++ ){
-        Xpts[3*k+j] = Xpts_unsorted[3*n+j];
-      }
+  // Rename the file once all processors have written their blocks
+  int any_fail = 0;
+  MPI_Allreduce(&fail, &any_fail, 1, MPI_INT, MPI_MAX, comm);
+  if (rank == root){
+    if (!any_fail && rename(temp_name, cache_file) != 0){
+      any_fail = 1;
+    }
+    if (any_fail){
+      fprintf(stderr, "TACSMeshLoader: Unable to write mesh cache %s\n",
+              cache_file);
+      remove(temp_name);
     }
+  }
+  MPI_Bcast(&any_fail, 1, MPI_INT, root, comm);
 
-    // Read in the connectivity array and store the information
-    elem_node_conn = new int[ elem_con_size ];
-    elem_node_ptr = new int[ num_elements+1 ];
-    elem_component = new int[ num_elements ];
+  delete [] temp_name;
 
-    elem_node_ptr[0] = 0;
-    for ( int k = 0, n = 0; k < num_elements; k++ ){
-      int e = elem_args[k];
+  return any_fail;
+}
 
-      for ( int j = elem_con_ptr[e]; j < elem_con_ptr[e+1]; j++, n++ ){
-        int node_num = elem_con[j];
+/*
+  This functions scans a Nastran BDF file - only scanning in
+  information from the bulk data section.
 
-        // Find node_num in the list
-        int node = find_index_arg_sorted(node_num, num_nodes,
-                                         node_nums, node_args);
-        if (node < 0){
-          elem_node_conn[n] = -1;
-          fail = 1;
-        }
-        else {
-          elem_node_conn[n] = node;
-        }
-      }
+  Only the element types, boundary conditions, connectivitiy and GRID
+  entries are scanned.  Any entries associated with constitutive
+  properties are ignored.
 
-      elem_component[k] = elem_comp[e];
-      elem_node_ptr[k+1] = n;
-    }
+  The file is memory-mapped and parsed in parallel on all
+  processors. If a mesh cache is set and matches the file, the mesh
+  is read from the cache instead. In both cases, each processor
+  stores a contiguous block of the nodes, elements and boundary
+  conditions. This call is collective on all processors.
+*/
+int TACSMeshLoader::scanBDFFile( const char * file_name ){
+  int rank, size;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
+  int fail = 0;
 
-    // Find the boundary condition nodes
-    for ( int k = 0; k < num_bcs; k++ ){
-      int node = find_index_arg_sorted(bc_nodes[k], num_nodes,
-                                       node_nums, node_args);    
-      if (node < 0){
+  // Map the file into memory on all processors
+  const char *buffer = NULL;
+  size_t buffer_len = 0;
+  struct stat st;
+  int fd = open(file_name, O_RDONLY);
+  if (fd < 0){
+    fail = 1;
+  }
+  else {
+    if (fstat(fd, &st) != 0){
+      fail = 1;
+    }
+    else if (st.st_size > 0){
+      buffer_len = st.st_size;
+      void *ptr = mmap(NULL, buffer_len, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (ptr == MAP_FAILED){
         fail = 1;
-        bc_nodes[k] = -1;
       }
       else {
-        bc_nodes[k] = node;
+        buffer = (const char*)ptr;
+        madvise(ptr, buffer_len, MADV_SEQUENTIAL);
       }
     }
+    close(fd);
+  }
+
+  int any_fail = 0;
+  MPI_Allreduce(&fail, &any_fail, 1, MPI_INT, MPI_MAX, comm);
+  if (any_fail){
+    if (fail){
+      fprintf(stderr, "[%d] TACSMeshLoader: Unable to open file %s\n", 
+              rank, file_name);
+    }
+    if (buffer){ munmap((void*)buffer, buffer_len); }
+    MPI_Abort(comm, 1);
+    return 1;
+  }
 
-    // Free data that has been allocated locally
-    delete [] elem_nums;
-    delete [] elem_comp;
-    delete [] elem_con;
-    delete [] elem_con_ptr;
-    delete [] elem_args;
-    delete [] node_args;
+  // Check whether the mesh can be loaded from the cache
+  long long key[NUM_MESH_CACHE_KEYS];
+  int loaded = 0;
+  if (cache_file){
+    compute_bdf_key(comm, buffer, buffer_len, &st, 
+                    convertToCoordinate, key);
+    loaded = readMeshCache(key);
   }
 
-  // Distribute the component numbers and descritpions 
-  MPI_Bcast(&num_components, 1, MPI_INT, root, comm);
-  if (rank != root){
-    component_elems = new char[9*num_components];
-    component_descript = new char[33*num_components];
+  if (!loaded){
+    fail = parseBDFData(file_name, buffer, buffer_len);
+    if (cache_file && !fail){
+      writeMeshCache(key);
+    }
   }
-  MPI_Bcast(component_elems, 9*num_components, MPI_CHAR, root, comm);
-  MPI_Bcast(component_descript, 33*num_components, MPI_CHAR, root, comm);
+
+  if (buffer){ munmap((void*)buffer, buffer_len); }
 
   elements = new TACSElement*[ num_components ];
   for ( int k = 0; k < num_components; k++ ){
@@ -1578,6 +1684,306 @@ int TACSMeshLoader::scanBDFFile( const char * file_name ){
   return fail;
 }
 
+/*
+  Parse the bulk data section of the memory-mapped BDF file.
+
+  The file is split into chunks of roughly equal size that start at
+  the beginning of a card. Each processor parses the cards within its
+  chunk in a single pass. The mesh is not gathered on any processor.
+  Instead, the nodes are sent to the processors that own their range
+  of BDF node numbers and sorted there, such that each processor owns
+  a contiguous block of the new node numbers. The new numbers of the
+  nodes referenced by the local elements and boundary conditions are
+  then requested from the owners. The elements remain in the order in
+  which they appear in the file.
+
+  returns:
+  1 if an element or boundary condition references a node that is
+  not defined in the file, 0 otherwise
+*/
+int TACSMeshLoader::parseBDFData( const char *file_name,
+                                  const char *buffer, 
+                                  size_t buffer_len ){
+  int rank, size;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
+  int fail = 0, any_fail = 0;
+
+  // Find the chunk of the file that will be parsed on this processor
+  size_t start = find_card_start(buffer, buffer_len, 
+                                 (rank*buffer_len)/size);
+  size_t end = find_card_start(buffer, buffer_len, 
+                               ((rank+1)*buffer_len)/size);
+
+  // Scan the chunk for the begin bulk location. If none exists, then
+  // the whole file is treated as bulk data.
+  long long bulk_loc = 0;
+  for ( size_t loc = start; loc < end; ){
+    if (buffer_len - loc >= 10 && 
+        strncmp(&buffer[loc], "BEGIN BULK", 10) == 0){
+      const char *next = (const char*)memchr(&buffer[loc], '\n', 
+                                             buffer_len - loc);
+      bulk_loc = (next ? (next - buffer) + 1 : buffer_len);
+    }
+    const char *next = (const char*)memchr(&buffer[loc], '\n', end - loc);
+    loc = (next ? (next - buffer) + 1 : end);
+  }
+
+  long long bulk_start = 0;
+  MPI_Allreduce(&bulk_loc, &bulk_start, 1, MPI_LONG_LONG_INT, 
+                MPI_MAX, comm);
+  if ((size_t)bulk_start > start){
+    start = bulk_start;
+  }
+
+  // Parse the cards in the chunk. Each line can only be 80
+  // characters long.
+  BDFRecords rec;
+  char line[9][81];
+  memset(line, '\0', sizeof(line));
+
+  size_t buffer_loc = start;
+  while (buffer_loc < end){
+    read_buffer_line(line[0], 80, &buffer_loc, buffer, buffer_len);
+    if (parse_bdf_card(line, &buffer_loc, buffer, buffer_len,
+                       convertToCoordinate, &rec)){
+      fail = 1;
+      break;
+    }
+  }
+
+  MPI_Allreduce(&fail, &any_fail, 1, MPI_INT, MPI_MAX, comm);
+  if (any_fail){
+    if (fail){
+      fprintf(stderr, "[%d] TACSMeshLoader: Problem reading file %s\n",
+              rank, file_name);
+    }
+    MPI_Abort(comm, 1);
+    return 1;
+  }
+
+  // Find the number of components and the element type of each
+  // component from the first processor that encountered it
+  MPI_Allreduce(&rec.num_components, &num_components, 1, MPI_INT,
+                MPI_MAX, comm);
+  char *elems = new char[ 9*num_components ];
+  char *all_elems = new char[ 9*num_components*size ];
+  memset(elems, '\0', 9*num_components*sizeof(char));
+  if (rec.num_components > 0){
+    memcpy(elems, rec.component_elems, 9*rec.num_components*sizeof(char));
+  }
+  MPI_Allgather(elems, 9*num_components, MPI_CHAR,
+                all_elems, 9*num_components, MPI_CHAR, comm);
+
+  component_elems = new char[ 9*num_components ];
+  memset(component_elems, '\0', 9*num_components*sizeof(char));
+  for ( int k = 0; k < size; k++ ){
+    for ( int j = 0; j < num_components; j++ ){
+      if (component_elems[9*j] == '\0'){
+        memcpy(&component_elems[9*j], 
+               &all_elems[9*(num_components*k + j)], 9*sizeof(char));
+      }
+    }
+  }
+  delete [] elems;
+  delete [] all_elems;
+
+  // The component descriptions are numbered in the order in which
+  // they appear in the file
+  int *descript_len = new int[ size ];
+  int *descript_ptr = new int[ size+1 ];
+  int len = 33*rec.num_descript;
+  MPI_Allgather(&len, 1, MPI_INT, descript_len, 1, MPI_INT, comm);
+  descript_ptr[0] = 0;
+  for ( int k = 0; k < size; k++ ){
+    descript_ptr[k+1] = descript_ptr[k] + descript_len[k];
+  }
+  char *all_descript = new char[ descript_ptr[size] ];
+  MPI_Allgatherv(rec.descript, len, MPI_CHAR, all_descript, 
+                 descript_len, descript_ptr, MPI_CHAR, comm);
+
+  int num_descript = descript_ptr[size]/33;
+  if (num_descript > num_components){
+    num_descript = num_components;
+  }
+  component_descript = new char[ 33*num_components ];
+  memset(component_descript, '\0', 33*num_components*sizeof(char));
+  memcpy(component_descript, all_descript, 33*num_descript*sizeof(char));
+  delete [] descript_len;
+  delete [] descript_ptr;
+  delete [] all_descript;
+
+  // Find the range of node numbers in the file
+  int bounds[2] = {INT_MAX, INT_MAX};
+  for ( int k = 0; k < rec.num_nodes; k++ ){
+    if (rec.node_nums[k] < bounds[0]){ bounds[0] = rec.node_nums[k]; }
+    if (-rec.node_nums[k] < bounds[1]){ bounds[1] = -rec.node_nums[k]; }
+  }
+  MPI_Allreduce(MPI_IN_PLACE, bounds, 2, MPI_INT, MPI_MIN, comm);
+  int node_min = bounds[0];
+  long long node_range = 1 - (long long)bounds[1] - node_min;
+  if (node_range < 1){
+    node_range = 1;
+  }
+
+  // Send the nodes to the processors that own their range of BDF
+  // node numbers
+  int *send_count = new int[ size ];
+  int *recv_count = new int[ size ];
+  int *send_ptr = new int[ size+1 ];
+  memset(send_count, 0, size*sizeof(int));
+  for ( int k = 0; k < rec.num_nodes; k++ ){
+    send_count[bdf_node_owner(rec.node_nums[k], node_min, 
+                              node_range, size)]++;
+  }
+  send_ptr[0] = 0;
+  for ( int k = 0; k < size; k++ ){
+    send_ptr[k+1] = send_ptr[k] + send_count[k];
+  }
+
+  int *send_nums = new int[ rec.num_nodes ];
+  double *send_Xpts = new double[ 3*rec.num_nodes ];
+  for ( int k = 0; k < rec.num_nodes; k++ ){
+    int owner = bdf_node_owner(rec.node_nums[k], node_min, 
+                               node_range, size);
+    int n = send_ptr[owner];
+    send_ptr[owner]++;
+    send_nums[n] = rec.node_nums[k];
+    for ( int j = 0; j < 3; j++ ){
+      send_Xpts[3*n+j] = rec.Xpts[3*k+j];
+    }
+  }
+
+  MPI_Alltoall(send_count, 1, MPI_INT, recv_count, 1, MPI_INT, comm);
+  int *recv_nums = exchange_bdf_array(comm, MPI_INT, 1, send_nums,
+                                      send_count, recv_count);
+  double *recv_Xpts = exchange_bdf_array(comm, MPI_DOUBLE, 3, send_Xpts,
+                                         send_count, recv_count);
+  delete [] send_nums;
+  delete [] send_Xpts;
+
+  // Sort the local nodes by their BDF node numbers. The nodes are
+  // numbered in the order of the BDF node numbers, and each processor
+  // owns a contiguous block of the new node numbers.
+  num_local_nodes = 0;
+  for ( int k = 0; k < size; k++ ){
+    num_local_nodes += recv_count[k];
+  }
+  int *node_args = new int[ num_local_nodes ];
+  for ( int k = 0; k < num_local_nodes; k++ ){
+    node_args[k] = k;
+  }
+  arg_sort_list = recv_nums;
+  qsort(node_args, num_local_nodes, sizeof(int), compare_arg_sort);
+  arg_sort_list = NULL;
+
+  int *node_nums = new int[ num_local_nodes ];
+  Xpts = new TacsScalar[ 3*num_local_nodes ];
+  for ( int k = 0; k < num_local_nodes; k++ ){
+    int n = node_args[k];
+    node_nums[k] = recv_nums[n];
+    for ( int j = 0; j < 3; j++ ){
+      Xpts[3*k+j] = recv_Xpts[3*n+j];
+    }
+  }
+  delete [] node_args;
+  delete [] recv_nums;
+  delete [] recv_Xpts;
+
+  int node_offset = 0;
+  MPI_Exscan(&num_local_nodes, &node_offset, 1, MPI_INT, MPI_SUM, comm);
+  if (rank == 0){
+    node_offset = 0;
+  }
+  MPI_Allreduce(&num_local_nodes, &num_nodes, 1, MPI_INT, MPI_SUM, comm);
+
+  // Find the BDF node numbers referenced by the local elements and
+  // boundary conditions and request their new node numbers from the
+  // processors that own them
+  int num_ids = rec.con_size + rec.num_bcs;
+  int *ids = new int[ num_ids ];
+  memcpy(ids, rec.elem_con, rec.con_size*sizeof(int));
+  memcpy(&ids[rec.con_size], rec.bc_nodes, rec.num_bcs*sizeof(int));
+  num_ids = FElibrary::uniqueSort(ids, num_ids);
+
+  memset(send_count, 0, size*sizeof(int));
+  for ( int k = 0; k < num_ids; k++ ){
+    send_count[bdf_node_owner(ids[k], node_min, node_range, size)]++;
+  }
+  MPI_Alltoall(send_count, 1, MPI_INT, recv_count, 1, MPI_INT, comm);
+  int *requests = exchange_bdf_array(comm, MPI_INT, 1, ids,
+                                     send_count, recv_count);
+
+  int num_requests = 0;
+  for ( int k = 0; k < size; k++ ){
+    num_requests += recv_count[k];
+  }
+  for ( int k = 0; k < num_requests; k++ ){
+    const int *item = (const int*)bsearch(&requests[k], node_nums, 
+                                          num_local_nodes, sizeof(int),
+                                          FElibrary::comparator);
+    requests[k] = (item ? node_offset + (item - node_nums) : -1);
+  }
+
+  // Since the ids are sorted, the replies are in the same order
+  int *new_nums = exchange_bdf_array(comm, MPI_INT, 1, requests,
+                                     recv_count, send_count);
+  delete [] requests;
+  delete [] node_nums;
+  delete [] send_count;
+  delete [] recv_count;
+  delete [] send_ptr;
+
+  // Set the local elements in the order in which they appear in the
+  // file. The elements on each processor form a contiguous block of
+  // the global elements.
+  num_local_elements = rec.num_elements;
+  MPI_Allreduce(&num_local_elements, &num_elements, 1, MPI_INT, 
+                MPI_SUM, comm);
+
+  elem_node_ptr = new int[ num_local_elements+1 ];
+  elem_node_conn = new int[ rec.con_size ];
+  elem_component = new int[ num_local_elements ];
+  elem_node_ptr[0] = 0;
+  for ( int k = 0; k < num_local_elements; k++ ){
+    elem_node_ptr[k+1] = elem_node_ptr[k] + rec.elem_size[k];
+    elem_component[k] = rec.elem_comp[k];
+  }
+  for ( int k = 0; k < rec.con_size; k++ ){
+    elem_node_conn[k] = find_bdf_node(rec.elem_con[k], ids, num_ids,
+                                      new_nums);
+    if (elem_node_conn[k] < 0){
+      fail = 1;
+    }
+  }
+
+  // Set the local boundary conditions
+  num_bcs = rec.num_bcs;
+  bc_nodes = new int[ num_bcs ];
+  bc_ptr = new int[ num_bcs+1 ];
+  bc_vars = new int[ rec.bc_vars_size ];
+  bc_vals = new TacsScalar[ rec.bc_vars_size ];
+  bc_ptr[0] = 0;
+  for ( int k = 0; k < num_bcs; k++ ){
+    bc_nodes[k] = find_bdf_node(rec.bc_nodes[k], ids, num_ids, new_nums);
+    if (bc_nodes[k] < 0){
+      fail = 1;
+    }
+    bc_ptr[k+1] = bc_ptr[k] + rec.bc_size[k];
+  }
+  memcpy(bc_vars, rec.bc_vars, rec.bc_vars_size*sizeof(int));
+  for ( int k = 0; k < rec.bc_vars_size; k++ ){
+    bc_vals[k] = rec.bc_vals[k];
+  }
+
+  delete [] ids;
+  delete [] new_nums;
+
+  MPI_Allreduce(&fail, &any_fail, 1, MPI_INT, MPI_MAX, comm);
+
+  return any_fail;
+}
+
 /*
   Retrieve the number of nodes in the model
 */
@@ -1613,47 +2019,39 @@ TACSToFH5 *TACSMeshLoader::createTACSToFH5( TACSAssembler *tacs,
 
 /*
   Create a distributed version of TACS
+
+  The blocks of the mesh stored on each processor are passed directly
+  to the distributed interface of TACSCreator, so the mesh is never
+  gathered on a single processor.
 */
 TACSAssembler *TACSMeshLoader::createTACS( int vars_per_node,
                                            TACSAssembler::OrderingType 
                                            order_type, 
                                            TACSAssembler::MatrixOrderingType 
                                            mat_type ){
-  // Set the root processor
-  const int root = 0;
-
-  // Get the rank of the current processor
-  int rank;
-  MPI_Comm_rank(comm, &rank);
-
   // Allocate the TACS creator
   creator = new TACSCreator(comm, vars_per_node);
   creator->incref();
 
-  if (rank == root){
-    // Set the connectivity
-    creator->setGlobalConnectivity(num_nodes, num_elements,
-                                   elem_node_ptr, elem_node_conn,
-                                   elem_component);
-    
-    // Set the boundary conditions
-    creator->setBoundaryConditions(num_bcs, bc_nodes, 
-                                   bc_ptr, bc_vars, bc_vals);
-    
-    // Set the nodal locations
-    creator->setNodes(Xpts);
-
-    // Free things that are no longer required
-    delete [] elem_node_ptr;   elem_node_ptr = NULL;
-    delete [] elem_node_conn;  elem_node_conn = NULL;
-    delete [] elem_component;  elem_component = NULL;
-
-    // Free the boundary conditions
-    delete [] bc_nodes;   bc_nodes = NULL;
-    delete [] bc_ptr;     bc_ptr = NULL;
-    delete [] bc_vars;    bc_vars = NULL;
-    delete [] bc_vals;    bc_vals = NULL;
-  }
+  // Set the local blocks of the connectivity, boundary conditions
+  // and nodal locations. These calls must occur on all processors.
+  creator->setDistributedConnectivity(num_nodes, num_local_elements,
+                                      elem_node_ptr, elem_node_conn,
+                                      elem_component);
+  creator->setBoundaryConditions(num_bcs, bc_nodes, 
+                                 bc_ptr, bc_vars, bc_vals);
+  creator->setDistributedNodes(num_local_nodes, Xpts);
+
+  // Free things that are no longer required
+  delete [] elem_node_ptr;   elem_node_ptr = NULL;
+  delete [] elem_node_conn;  elem_node_conn = NULL;
+  delete [] elem_component;  elem_component = NULL;
+
+  // Free the boundary conditions
+  delete [] bc_nodes;   bc_nodes = NULL;
+  delete [] bc_ptr;     bc_ptr = NULL;
+  delete [] bc_vars;    bc_vars = NULL;
+  delete [] bc_vals;    bc_vals = NULL;
 
   // This call must occur on all processor
   creator->setElements(elements, num_components);
@@ -1665,7 +2063,7 @@ TACSAssembler *TACSMeshLoader::createTACS( int vars_per_node,
 }
 
 /*
-  Retrieve the number of elements owned by this processes
+  Retrieve the number of elements in the model
 */
 int TACSMeshLoader::getNumElements(){
   return num_elements;
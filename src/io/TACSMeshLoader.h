@@ -25,9 +25,12 @@
   to read in other formats. The class can also be used to distribute
   the mesh over a set of processors. 
 
-  This class could easily be extended to take in the mesh and
-  connectivity from memory on the root processor and then distribute
-  it to other processors.
+  The file is parsed in parallel and the mesh is never gathered on a
+  single processor. Each processor stores a contiguous block of the
+  nodes, numbered in ascending order of the BDF node numbers, and the
+  block of elements and boundary conditions from its part of the
+  file. The blocks are passed to the distributed interface of
+  TACSCreator to create TACS.
   
   The limited capabilities of reading in data from a Nastran file are:
   1. Reading GRID and GRID* entries for the physical locations of the 
@@ -56,6 +59,7 @@ class TACSMeshLoader : public TACSObject {
   // Read a BDF file for input
   // -------------------------
   int scanBDFFile( const char *file_name );
+  void setMeshCache( const char *file_name );
 
   // Get information about the mesh after scanning
   // ---------------------------------------------
@@ -98,13 +102,16 @@ class TACSMeshLoader : public TACSObject {
   void addAuxElement( TACSAuxElements *aux, int component_num,
                       TACSElement *_element );
 
+  // Get the local blocks of the mesh and boundary conditions. The
+  // connectivity and boundary conditions use the global node numbers.
+  // -----------------------------------------------------------------
   void getConnectivity( int *_num_nodes, int *_num_elements,
                         const int **_elem_node_ptr, 
                         const int **_elem_node_conn,
                         const int **_elem_component,
                         const TacsScalar **_Xpts ){
-    if (_num_nodes){ *_num_nodes = num_nodes; }
-    if (_num_elements){ *_num_elements = num_elements; }
+    if (_num_nodes){ *_num_nodes = num_local_nodes; }
+    if (_num_elements){ *_num_elements = num_local_elements; }
     if (_elem_node_ptr){ *_elem_node_ptr = elem_node_ptr; }
     if (_elem_node_conn){ *_elem_node_conn = elem_node_conn; }
     if (_elem_component){ *_elem_component = elem_component; }
@@ -123,23 +130,28 @@ class TACSMeshLoader : public TACSObject {
   // Communicator for all processors
   MPI_Comm comm;
 
+  // Parse the BDF file and read/write the binary mesh cache
+  int parseBDFData( const char *file_name, 
+                    const char *buffer, size_t buffer_len );
+  int readMeshCache( const long long key[] );
+  int writeMeshCache( const long long key[] );
+
   // The underlying creator object
   TACSCreator *creator;
 
+  // The file name of the binary mesh cache
+  char *cache_file;
+
   // The element corresponding to each of the component numbers
   TACSElement **elements;
 
-  // Original BDF mesh information: Note that the original
-  // ordering may not be contiguous. The node numbers associated
-  // with the original ordering are stored in node_nums.
-  int *node_nums;
-  double *Xpts_unsorted; 
-
-  // Reduced set of contiguous nodes 
+  // The local block of nodes
   TacsScalar *Xpts;
 
-  // The mesh and element connectivity
+  // The global number of nodes and elements, the size of the local
+  // blocks and the local element connectivity
   int num_nodes, num_elements;
+  int num_local_nodes, num_local_elements;
   int *elem_node_conn, *elem_node_ptr;
   int *elem_component;
 
@@ -148,7 +160,7 @@ class TACSMeshLoader : public TACSObject {
   char *component_elems;
   char *component_descript;
 
-  // The boundary conditions
+  // The local boundary conditions
   int num_bcs;
   int *bc_nodes, *bc_vars, *bc_ptr;
   TacsScalar *bc_vals;
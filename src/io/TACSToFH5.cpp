@@ -48,6 +48,24 @@ TACSToFH5::TACSToFH5( TACSAssembler *_tacs,
   // 3 coordinates for each of 3 coordinate axes
   ncoordinates = 9;
 
+  // By default, the files are written synchronously
+  async_write = 0;
+  max_queue_size = 0;
+  num_pending = 0;
+  terminate = 0;
+  queue_head = queue_tail = NULL;
+  io_comm = MPI_COMM_NULL;
+
+  // Write the zones without encoding by default
+  data_codec = FH5File::FH5_RAW;
+  data_tol = 0.0;
+  conn_codec = FH5File::FH5_RAW;
+
+  // No time series file is open
+  series_open = 0;
+  series_num_nodes = 0;
+  series = NULL;
+
   // Get the number of displacements/stresses
   ndisplacements = 0;
   nstresses = 0;
@@ -105,6 +123,10 @@ TACSToFH5::TACSToFH5( TACSAssembler *_tacs,
 }
 
 TACSToFH5::~TACSToFH5(){
+  // Close the time series and complete any pending writes
+  closeTimeSeries();
+  stopAsyncWrite();
+
   tacs->decref();
 
   // Deallocate the comma separated list of variable names
@@ -124,6 +146,9 @@ TACSToFH5::~TACSToFH5(){
 */
 void TACSToFH5::setComponentName( int comp_num, const char *group_name ){
   if (comp_num >= 0 && comp_num < num_components){
+    // The names are used by pending writes
+    flush();
+
     // If the name already exists, over-write it
     if (component_names[comp_num]){
       delete [] component_names[comp_num];
@@ -138,42 +163,266 @@ void TACSToFH5::setComponentName( int comp_num, const char *group_name ){
   }
 }
 
+/*
+  Set the encoding of the zones written to the file.
+
+  The data may be written in 16-bit floating point (FH5_HALF) or
+  quantized with the absolute error bound tol (FH5_QUANTIZE), and the
+  components and connectivity may be delta-encoded (FH5_DELTA). Any of
+  these can be combined with lossless compression (FH5_LOSSLESS),
+  which is applied by each processor to its own rows before the
+  collective write. FH5_QUANTIZE is always compressed. Zones with
+  values beyond the range of FH5_HALF (65504 in magnitude) are written
+  with full precision instead.
+
+  input:
+  data_codec:  the codec for the output data
+  data_tol:    the absolute error bound for quantization
+  conn_codec:  the codec for the component numbers and connectivity
+*/
+void TACSToFH5::setOutputEncoding( int _data_codec, double _data_tol,
+                                   int _conn_codec ){
+  // Pending writes use the existing encoding
+  flush();
+  data_codec = _data_codec;
+  data_tol = _data_tol;
+  conn_codec = _conn_codec;
+}
+
+/*
+  Write the files using a background thread.
+
+  The output data is copied into a staging buffer when writeToFile()
+  is called, and the conversion and collective file output are
+  performed by a dedicated writer thread on a duplicate of the
+  communicator. At most max_queue_size snapshots are held in memory:
+  writeToFile() blocks when the queue is full until a pending write
+  completes.
+
+  Note that this requires MPI_THREAD_MULTIPLE support. Otherwise, the
+  files are written synchronously.
+
+  input:
+  max_queue_size:  the max number of pending snapshots (< 1 disables)
+*/
+void TACSToFH5::setAsyncWrite( int _max_queue_size ){
+  // The time series file is bound to the communicator of the writer
+  if (series_open){
+    int rank;
+    MPI_Comm_rank(tacs->getMPIComm(), &rank);
+    if (rank == 0){
+      fprintf(stderr, "[%d] TACSToFH5 error: Cannot change the writer "
+              "while a time series is open\n", rank);
+    }
+    return;
+  }
+
+  // Stop the existing writer thread (if any)
+  stopAsyncWrite();
+  if (_max_queue_size < 1){
+    return;
+  }
+
+  int provided;
+  MPI_Query_thread(&provided);
+  if (provided < MPI_THREAD_MULTIPLE){
+    int rank;
+    MPI_Comm_rank(tacs->getMPIComm(), &rank);
+    if (rank == 0){
+      fprintf(stderr, "TACSToFH5: MPI_THREAD_MULTIPLE not supported, "
+              "using synchronous output\n");
+    }
+    return;
+  }
+
+  // Collective calls from the writer thread use a separate
+  // communicator so that they cannot match calls on the main thread
+  MPI_Comm_dup(tacs->getMPIComm(), &io_comm);
+
+  max_queue_size = _max_queue_size;
+  num_pending = 0;
+  terminate = 0;
+  queue_head = queue_tail = NULL;
+  pthread_mutex_init(&queue_mutex, NULL);
+  pthread_cond_init(&queue_cond, NULL);
+  pthread_create(&writer, NULL, TACSToFH5::writerThread, (void*)this);
+  async_write = 1;
+}
+
+/*
+  Wait until all the pending snapshots have been written
+*/
+void TACSToFH5::flush(){
+  if (async_write){
+    pthread_mutex_lock(&queue_mutex);
+    while (num_pending > 0){
+      pthread_cond_wait(&queue_cond, &queue_mutex);
+    }
+    pthread_mutex_unlock(&queue_mutex);
+  }
+}
+
+/*
+  Write the remaining snapshots and stop the writer thread
+*/
+void TACSToFH5::stopAsyncWrite(){
+  if (async_write){
+    pthread_mutex_lock(&queue_mutex);
+    terminate = 1;
+    pthread_cond_broadcast(&queue_cond);
+    pthread_mutex_unlock(&queue_mutex);
+    pthread_join(writer, NULL);
+
+    pthread_mutex_destroy(&queue_mutex);
+    pthread_cond_destroy(&queue_cond);
+    MPI_Comm_free(&io_comm);
+    io_comm = MPI_COMM_NULL;
+    async_write = 0;
+  }
+}
+
+/*
+  The writer thread: Write the snapshots in the order in which they
+  were queued. Since writeToFile() is collective, the order is the
+  same on all processors.
+*/
+void *TACSToFH5::writerThread( void *_self ){
+  TACSToFH5 *self = static_cast<TACSToFH5*>(_self);
+
+  pthread_mutex_lock(&self->queue_mutex);
+  while (1){
+    while (!self->queue_head && !self->terminate){
+      pthread_cond_wait(&self->queue_cond, &self->queue_mutex);
+    }
+    if (!self->queue_head){
+      break;
+    }
+
+    // Remove the snapshot from the queue
+    FH5Snapshot *snap = self->queue_head;
+    self->queue_head = snap->next;
+    if (!self->queue_head){
+      self->queue_tail = NULL;
+    }
+    pthread_mutex_unlock(&self->queue_mutex);
+
+    // Write the snapshot outside the lock
+    self->writeSnapshot(self->io_comm, snap);
+    delete snap;
+
+    pthread_mutex_lock(&self->queue_mutex);
+    self->num_pending--;
+    pthread_cond_broadcast(&self->queue_cond);
+  }
+  pthread_mutex_unlock(&self->queue_mutex);
+
+  pthread_exit(NULL);
+  return NULL;
+}
+
 /*
   Write the data stored in the TACSAssembler object to a file
 
+  When the asynchronous writer is active, the data is only copied
+  before returning and the file is written in the background.
+
   input:
   filename:  the name of the file to create
 */
 void TACSToFH5::writeToFile( const char *filename ){
-  int rank, size;
-  MPI_Comm_rank(tacs->getMPIComm(), &rank);
-  MPI_Comm_size(tacs->getMPIComm(), &size);
+  submitSnapshot(createSnapshot(FH5_WRITE_FILE, filename));
+}
 
-  // Create the FH5 file object for writting
-  FH5File *file = new FH5File(tacs->getMPIComm());
-  file->incref();
+/*
+  Create a file that contains a time series of the solution.
 
-  // Open the file - if possible for writing
-  int write_err = file->createFile(filename, component_names,
-                                   num_components);
+  The component names and the connectivity are written to the file
+  once. Each subsequent call to writeTimeStep() appends only a data
+  zone with the time stamp of the step. The file remains open until
+  closeTimeSeries() is called, a new series is created, or this object
+  is deleted.
 
-  if (write_err){
-    file->decref();
+  input:
+  filename:  the name of the file to create
+
+  returns:
+  0 on success
+*/
+int TACSToFH5::createTimeSeries( const char *filename ){
+  if (series_open){
+    closeTimeSeries();
+  }
+
+  FH5Snapshot *snap = createSnapshot(FH5_CREATE_SERIES, filename);
+  series_num_nodes = snap->num_nodes;
+  series_open = 1;
+  submitSnapshot(snap);
+
+  return 0;
+}
+
+/*
+  Append the data stored in the TACSAssembler object to the time
+  series as a new step
+*/
+void TACSToFH5::writeTimeStep(){
+  if (!series_open){
+    int rank;
+    MPI_Comm_rank(tacs->getMPIComm(), &rank);
     if (rank == 0){
-      fprintf(stderr, "[%d] TACSToFH5 error: Could not create file\n",
+      fprintf(stderr, "[%d] TACSToFH5 error: No time series file\n",
               rank);
     }
     return;
   }
 
-  // Write the connectivity
-  int *comp_nums = NULL; // The component numbers of each element
-  int *csr = NULL;       // Local segment of the global CSR data structure
-  int *csr_range = NULL; // node/csr range over the number of processes
-  int *node_range = NULL;
-  tacs->getOutputConnectivity(elem_type, &comp_nums,
-                              &csr, &csr_range, &node_range);
+  submitSnapshot(createSnapshot(FH5_APPEND_SERIES, NULL));
+}
+
+/*
+  Close the time series file
+*/
+void TACSToFH5::closeTimeSeries(){
+  if (series_open){
+    submitSnapshot(createSnapshot(FH5_CLOSE_SERIES, NULL));
+    series_open = 0;
+    series_num_nodes = 0;
+  }
+}
+
+/*
+  Write the snapshot immediately or add it to the queue of the
+  writer thread
+*/
+void TACSToFH5::submitSnapshot( FH5Snapshot *snap ){
+  if (async_write){
+    pthread_mutex_lock(&queue_mutex);
+    while (num_pending >= max_queue_size){
+      pthread_cond_wait(&queue_cond, &queue_mutex);
+    }
+
+    // Add the snapshot to the end of the queue
+    if (queue_tail){
+      queue_tail->next = snap;
+    }
+    else {
+      queue_head = snap;
+    }
+    queue_tail = snap;
+    num_pending++;
+    pthread_cond_broadcast(&queue_cond);
+    pthread_mutex_unlock(&queue_mutex);
+  }
+  else {
+    writeSnapshot(tacs->getMPIComm(), snap);
+    delete snap;
+  }
+}
 
+/*
+  Get the number of nodes in the connectivity of each element
+*/
+int TACSToFH5::getConnectivitySize(){
   int con_size = 4;
   if (elem_type == TACS_EULER_BEAM ||
       elem_type == TACS_TIMOSHENKO_BEAM){
@@ -183,55 +432,160 @@ void TACSToFH5::writeToFile( const char *filename ){
            elem_type == TACS_POISSON_3D_ELEMENT){
     con_size = 8;
   }
+  return con_size;
+}
+
+/*
+  Copy the connectivity and the output data from TACSAssembler into a
+  snapshot that can be written to a file at a later time. Only the
+  data required for the type of output operation is copied.
+*/
+TACSToFH5::FH5Snapshot *TACSToFH5::createSnapshot( FH5SnapshotType type,
+                                                   const char *filename ){
+  int rank;
+  MPI_Comm_rank(tacs->getMPIComm(), &rank);
+
+  FH5Snapshot *snap = new FH5Snapshot();
+  snap->type = type;
+  if (filename){
+    snap->filename = new char[ strlen(filename)+1 ];
+    strcpy(snap->filename, filename);
+  }
+  snap->t = tacs->getSimulationTime();
+
+  // Get the connectivity
+  if (type == FH5_WRITE_FILE || type == FH5_CREATE_SERIES){
+    int *csr_range = NULL; // node/csr range over the number of processes
+    int *node_range = NULL;
+    tacs->getOutputConnectivity(elem_type, &snap->comp_nums,
+                                &snap->csr, &csr_range, &node_range);
+    snap->num_elems =
+      (csr_range[rank+1] - csr_range[rank])/getConnectivitySize();
+    snap->num_nodes = node_range[rank+1] - node_range[rank];
+    if (csr_range){ delete [] csr_range; }
+    if (node_range){ delete [] node_range; }
+  }
+  else if (type == FH5_APPEND_SERIES){
+    snap->num_nodes = series_num_nodes;
+  }
+
+  if (type == FH5_WRITE_FILE || type == FH5_APPEND_SERIES){
+    // Allocate space for the output data -
+    // the nodes, displacements, stresses etc.
+    int len = nvals*snap->num_nodes;
+    snap->data = new double[ len ];
+    memset(snap->data, 0, len*sizeof(double));
+
+    // Get the output data from TACS
+    tacs->getOutputData(elem_type, write_flag, snap->data, nvals);
+  }
+
+  return snap;
+}
+
+/*
+  Write the output operation for the snapshot
+
+  input:
+  comm:  the communicator for the file
+  snap:  the snapshot of the data
+*/
+void TACSToFH5::writeSnapshot( MPI_Comm comm, FH5Snapshot *snap ){
+  if (snap->type == FH5_WRITE_FILE){
+    // Create the FH5 file object for writting
+    FH5File *file = new FH5File(comm);
+    file->incref();
+    if (writeTopology(file, snap) == 0){
+      writeData(file, snap);
+      file->close();
+    }
+    file->decref();
+  }
+  else if (snap->type == FH5_CREATE_SERIES){
+    if (series){
+      series->close();
+      series->decref();
+    }
+    series = new FH5File(comm);
+    series->incref();
+    if (writeTopology(series, snap) != 0){
+      series->decref();
+      series = NULL;
+    }
+  }
+  else if (snap->type == FH5_APPEND_SERIES){
+    if (series){
+      writeData(series, snap);
+    }
+  }
+  else if (snap->type == FH5_CLOSE_SERIES){
+    if (series){
+      series->close();
+      series->decref();
+      series = NULL;
+    }
+  }
+}
+
+/*
+  Create the file and write the components and the connectivity
+
+  returns:
+  0 on success
+*/
+int TACSToFH5::writeTopology( FH5File *file, FH5Snapshot *snap ){
+  // Open the file - if possible for writing
+  int write_err = file->createFile(snap->filename, component_names,
+                                   num_components);
+
+  if (write_err){
+    int rank;
+    MPI_Comm_rank(tacs->getMPIComm(), &rank);
+    if (rank == 0){
+      fprintf(stderr, "[%d] TACSToFH5 error: Could not create file\n",
+              rank);
+    }
+    return write_err;
+  }
 
   // Write the component numbers to a zone
-  int dim1 = (csr_range[rank+1] - csr_range[rank])/con_size;
+  int dim1 = snap->num_elems;
   int dim2 = 1;
   char comp_name[] = "components";
   file->writeZoneData(comp_name, comp_name, FH5File::FH5_INT,
-                      comp_nums, dim1, dim2);
-  if (comp_nums){ delete [] comp_nums; }
+                      snap->comp_nums, dim1, dim2, conn_codec);
 
   // Write the data to a zone
-  dim1 = (csr_range[rank+1] - csr_range[rank])/con_size;
-  dim2 = con_size;
+  dim2 = getConnectivitySize();
   char conn_name[] = "connectivity";
   file->writeZoneData(conn_name, conn_name, FH5File::FH5_INT,
-                      csr, dim1, dim2);
-  if (csr){ delete [] csr; }
-  if (csr_range){ delete [] csr_range; }
-
-  // Allocate space for the output data -
-  // the nodes, displacements, stresses etc.
-  int len = nvals*(node_range[rank+1] - node_range[rank]);
-  double *data = new double[ len ];
-  memset(data, 0, len*sizeof(double));
+                      snap->csr, dim1, dim2, conn_codec);
 
-  // Get the output data from TACS
-  tacs->getOutputData(elem_type, write_flag, data, nvals);
+  return 0;
+}
 
+/*
+  Convert the output data to float and write it to a zone with the
+  time stamp of the snapshot
+*/
+void TACSToFH5::writeData( FH5File *file, FH5Snapshot *snap ){
   // Get the dimensions of the data
-  dim1 = node_range[rank+1] - node_range[rank];
-  dim2 = nvals;
+  int dim1 = snap->num_nodes;
+  int dim2 = nvals;
 
   // Convert the data to float
-  float *float_data = new float[ len ];
+  float *float_data = new float[ dim1*dim2 ];
   for ( int i = 0; i < dim1*dim2; i++ ){
-    float_data[i] = data[i];
+    float_data[i] = snap->data[i];
   }
 
   // Write the data with a time stamp from the simulation in TACS
   char data_name[128];
-  double t = tacs->getSimulationTime();
-  sprintf(data_name, "data t=%.10e", t);
+  sprintf(data_name, "data t=%.10e", snap->t);
   file->writeZoneData(data_name, variable_names,
-                      FH5File::FH5_FLOAT, float_data, dim1, dim2);
-  delete [] data;
+                      FH5File::FH5_FLOAT, float_data, dim1, dim2,
+                      data_codec, data_tol);
   delete [] float_data;
-  if (node_range){ delete [] node_range; }
-
-  file->close();
-  file->decref();
 }
 
 /*
@@ -23,6 +23,7 @@
   Create an FH5 file from the TACSAssembler object
 */  
 
+#include "pthread.h"
 #include "FH5.h"
 #include "TACSAssembler.h"
 
@@ -37,11 +38,72 @@ class TACSToFH5 : public TACSObject {
   // --------------------------------
   void setComponentName( int comp_num, const char *group_name );
   
+  // Set the encoding of the zones written to the file
+  // -------------------------------------------------
+  void setOutputEncoding( int _data_codec, double _data_tol=0.0,
+                          int _conn_codec=FH5File::FH5_RAW );
+
   // Write the data to a file
   // ------------------------
   void writeToFile( const char *filename );
 
+  // Write a time series to a single file
+  // ------------------------------------
+  int createTimeSeries( const char *filename );
+  void writeTimeStep();
+  void closeTimeSeries();
+
+  // Write the files from a background thread
+  // ----------------------------------------
+  void setAsyncWrite( int _max_queue_size );
+  void flush();
+
  private:
+  // The type of output operation for a snapshot
+  enum FH5SnapshotType { FH5_WRITE_FILE,
+                         FH5_CREATE_SERIES,
+                         FH5_APPEND_SERIES,
+                         FH5_CLOSE_SERIES };
+
+  // The output data staged for writing
+  class FH5Snapshot {
+  public:
+    FH5Snapshot(){
+      type = FH5_WRITE_FILE;
+      filename = NULL;
+      t = 0.0;
+      num_elems = num_nodes = 0;
+      comp_nums = csr = NULL;
+      data = NULL;
+      next = NULL;
+    }
+    ~FH5Snapshot(){
+      if (filename){ delete [] filename; }
+      if (comp_nums){ delete [] comp_nums; }
+      if (csr){ delete [] csr; }
+      if (data){ delete [] data; }
+    }
+    FH5SnapshotType type;
+    char *filename;
+    double t;
+    int num_elems, num_nodes;
+    int *comp_nums, *csr;
+    double *data;
+    FH5Snapshot *next;
+  };
+
+  // Create the snapshot and write it to a file
+  FH5Snapshot *createSnapshot( FH5SnapshotType type, const char *filename );
+  void submitSnapshot( FH5Snapshot *snap );
+  void writeSnapshot( MPI_Comm comm, FH5Snapshot *snap );
+  int writeTopology( FH5File *file, FH5Snapshot *snap );
+  void writeData( FH5File *file, FH5Snapshot *snap );
+  int getConnectivitySize();
+
+  // Stop the background writer thread
+  void stopAsyncWrite();
+  static void *writerThread( void *_self );
+
   // Get a character string of the variable names
   char *getElementVarNames();
 
@@ -57,6 +119,27 @@ class TACSToFH5 : public TACSObject {
   int num_components; // The number of components in the model
   char **component_names; // The names of each of the components
   char *variable_names; // The names of all the variables
+
+  // The encoding for the output data and connectivity zones
+  int data_codec; // The codec for the data
+  double data_tol; // The error bound for quantized data
+  int conn_codec; // The codec for the components/connectivity
+
+  // Data for the time series output
+  int series_open; // Flag to indicate an open time series
+  int series_num_nodes; // The number of local nodes in the series
+  FH5File *series; // The time series file (used by the writer)
+
+  // Data for the background writer thread
+  int async_write; // Flag to indicate whether the writer is active
+  int max_queue_size; // The max number of snapshots in the queue
+  int num_pending; // Number of snapshots not yet written
+  int terminate; // Flag to terminate the writer thread
+  FH5Snapshot *queue_head, *queue_tail; // The queue of snapshots
+  MPI_Comm io_comm; // Duplicated communicator for the writer thread
+  pthread_t writer;
+  pthread_mutex_t queue_mutex;
+  pthread_cond_t queue_cond;
 };
 
 #endif // TACS_TO_FH5
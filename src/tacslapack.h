@@ -39,6 +39,8 @@
 #define LAPACKzggev zggev_
 #define LAPACKdsygvd dsygvd_
 #define LAPACKdggev dggev_
+#define LAPACKdgeqp3 dgeqp3_
+#define LAPACKdorgqr dorgqr_
 
 #ifdef TACS_USE_COMPLEX
 #define BLASdot     zdotu_
@@ -254,6 +256,16 @@ extern "C" {
                             double *b, int *ldb, double *s, double *rcond,
                             int *rank, double *work, int *lwork, int *info );
 
+  // Compute the QR factorization with column pivoting A*P = Q*R
+  extern void LAPACKdgeqp3( int *m, int *n, double *a, int *lda, int *jpvt,
+                            double *tau, double *work, int *lwork,
+                            int *info );
+
+  // Form the first n columns of Q from the output of dgeqp3
+  extern void LAPACKdorgqr( int *m, int *n, int *k, double *a, int *lda,
+                            double *tau, double *work, int *lwork,
+                            int *info );
+
   // Compute the eigenvalues and optionally the eigenvectors of a
   // symmetric, tridiagonal system
   extern void LAPACKstev( const char * jobz, int * n, TacsScalar * d, 
@@ -86,6 +86,13 @@ cdef extern from "TACSObject.h":
 
     cdef MPI_Datatype TACS_MPI_TYPE
 
+cdef extern from "TACSProfiler.h":
+    void profilerSetEnabled "TACSProfiler::setEnabled"(int)
+    void profilerSetTrace "TACSProfiler::setTrace"(int, int)
+    void profilerReset "TACSProfiler::reset"()
+    void profilerPrintReport "TACSProfiler::printReport"(MPI_Comm)
+    int profilerWriteTrace "TACSProfiler::writeTrace"(MPI_Comm, char*)
+
 cdef extern from "KSM.h":
     cdef cppclass TACSVec(TACSObject):
         TacsScalar norm()
@@ -246,6 +253,10 @@ cdef extern from "TACSMg.h":
         void assembleMatType(ElementMatrixType,
                              MatrixOrientation)
         void setMonitor(KSMPrint*)
+        void setUseGalerkin(int)
+        void setCoarseSolverProcs(int)
+        void setChebyshevSmoother(int, double, double, double)
+        void setMultiColorSmoother(int)
 
 cdef extern from "TACSElement.h":
     void TACSSetElementFDStepSize"TACSElement::setStepSize"(double)
@@ -530,6 +541,7 @@ cdef extern from "TACSMeshLoader.h":
     cdef cppclass TACSMeshLoader(TACSObject):
         TACSMeshLoader(MPI_Comm _comm)
         int scanBDFFile(char *file_name)
+        void setMeshCache(char *file_name)
         int getNumComponents()
         const char *getComponentDescript(int comp_num)
         const char *getElementDescript(int comp_num)
@@ -555,6 +567,11 @@ cdef extern from "TACSMeshLoader.h":
                     const TacsScalar **_bc_vals)
 
 cdef extern from "TACSCreator.h":
+    enum LocalityOrderType"TACSCreator::LocalityOrderType":
+        NO_LOCALITY_ORDER"TACSCreator::NO_LOCALITY_ORDER"
+        HILBERT_ORDER"TACSCreator::HILBERT_ORDER"
+        MORTON_ORDER"TACSCreator::MORTON_ORDER"
+
     cdef cppclass TACSCreator(TACSObject):
         TACSCreator(MPI_Comm comm, int _vars_per_node)
         void setGlobalConnectivity(int _num_nodes, int _num_elements,
@@ -569,8 +586,15 @@ cdef extern from "TACSCreator.h":
                                double *_dep_node_weights )
         void setElements(TACSElement **_elements, int _num_elems)
         void setNodes(TacsScalar *_Xpts)
+        void setDistributedConnectivity(int _num_nodes, int _num_elements,
+                                        int *_elem_node_ptr,
+                                        int *_elem_node_conn,
+                                        int *_elem_id_nums)
+        void setDistributedNodes(int num_local_nodes, TacsScalar *_Xpts)
+        void setPartitionRefinement(int num_sweeps, double imbalance)
         void setReorderingType(OrderingType _order_type,
                                MatrixOrderingType _mat_type)
+        void setLocalityOrdering(LocalityOrderType curve)
         void partitionMesh(int split_size, int *part)
         int getElementPartition(const int **)
         TACSAssembler *createTACS()
@@ -582,6 +606,13 @@ cdef extern from "TACSToFH5.h":
         TACSToFH5(TACSAssembler *_tacs, ElementType _elem_type, int _out_type)
         void setComponentName(int comp_num, char *group_name)
         void writeToFile(char *filename)
+        void setAsyncWrite(int max_queue_size)
+        void setOutputEncoding(int data_codec, double data_tol,
+                               int conn_codec)
+        int createTimeSeries(char *filename)
+        void writeTimeStep()
+        void closeTimeSeries()
+        void flush()
 
 cdef extern from "TACSIntegrator.h":
     # Declare the TACSIntegrator base class
@@ -592,6 +623,9 @@ cdef extern from "TACSIntegrator.h":
         void setMaxNewtonIters(int)
         void setPrintLevel(int level, const_char *filename)
         void setJacAssemblyFreq(int)
+        void setJacobianReuse(int, double)
+        void setEisenstatWalker(int, double)
+        void setAdaptiveTimeStepping(double, double, double, double)
         void setUseLapack(int)
         void setUseFEMat(int,OrderingType)
         void setInitNewtonDeltaFraction(double)
@@ -623,6 +657,7 @@ cdef extern from "TACSIntegrator.h":
         # Configure output
         void setOutputPrefix(const_char *prefix)
         void setOutputFrequency(int write_freq)
+        void setOutputTimeSeries(int time_series)
         void setRigidOutput(TACSToFH5 *_rigidf5)
         void setShellOutput(TACSToFH5 *_shellf5)
         void setBeamOutput(TACSToFH5 *_beamf5)
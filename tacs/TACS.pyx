@@ -79,6 +79,11 @@ PY_APPROXIMATE_SCHUR = APPROXIMATE_SCHUR
 PY_DIRECT_SCHUR = DIRECT_SCHUR
 PY_GAUSS_SEIDEL = GAUSS_SEIDEL
 
+# Import the locality ordering types
+PY_NO_LOCALITY_ORDER = NO_LOCALITY_ORDER
+PY_HILBERT_ORDER = HILBERT_ORDER
+PY_MORTON_ORDER = MORTON_ORDER
+
 # JDRecycleType
 SUM_TWO = JD_SUM_TWO
 NUM_RECYCLE = JD_NUM_RECYCLE
@@ -88,6 +93,37 @@ INSERT_VALUES = TACS_INSERT_VALUES
 ADD_VALUES = TACS_ADD_VALUES
 INSERT_NONZERO_VALUES = TACS_INSERT_NONZERO_VALUES
 
+# Profiling of the main computational phases
+def setProfiling(int flag, int trace=0, int max_records=1000000):
+    '''
+    Enable or disable the profiler and the recording of the trace.
+    The accumulated data is reset when the profiler is enabled.
+    '''
+    profilerSetTrace(trace, max_records)
+    profilerSetEnabled(flag)
+    return
+
+def resetProfile():
+    '''Zero the accumulated profile data and the trace'''
+    profilerReset()
+    return
+
+def printProfile(MPI.Comm comm):
+    '''
+    Print the min/avg/max of the profile data over the processors
+    in the communicator. This call is collective.
+    '''
+    profilerPrintReport(comm.ob_mpi)
+    return
+
+def writeProfileTrace(MPI.Comm comm, fname):
+    '''
+    Write the recorded trace in the Chrome trace-event JSON format.
+    This call is collective.
+    '''
+    cdef char *filename = convert_to_chars(fname)
+    return profilerWriteTrace(comm.ob_mpi, filename)
+
 # A generic wrapper class for the TACSFunction object
 cdef class Function:
     def __cinit__(self):
@@ -616,6 +652,23 @@ cdef class Mg(Pc):
         cdef char *descript = convert_to_chars(_descript)
         self.mg.setMonitor(new KSMPrintStdout(descript, comm.rank, freq))
 
+    def setUseGalerkin(self, int flag):
+        '''Form the coarse matrices with the Galerkin product P^T*A*P'''
+        self.mg.setUseGalerkin(flag)
+
+    def setCoarseSolverProcs(self, int nprocs):
+        '''Set the number of procs used for the coarse direct solve'''
+        self.mg.setCoarseSolverProcs(nprocs)
+
+    def setChebyshevSmoother(self, int degree, double lower=1.0/30.0,
+                             double upper=1.1, double reuse_tol=0.0):
+        '''Use a Chebyshev smoother of the given degree on all levels'''
+        self.mg.setChebyshevSmoother(degree, lower, upper, reuse_tol)
+
+    def setMultiColorSmoother(self, int flag):
+        '''Use multicolor Gauss-Seidel sweeps on all levels'''
+        self.mg.setMultiColorSmoother(flag)
+
 cdef class KSM:
     def __cinit__(self, Mat mat, Pc pc, int m,
                   int nrestart=1, int isFlexible=0):
@@ -1535,6 +1588,13 @@ cdef class ToFH5:
     EXTRAS = 16
     COORDINATES = 32
 
+    # Zone encodings (LOSSLESS may be combined with the others)
+    RAW = 0
+    HALF = 1
+    QUANTIZE = 2
+    DELTA = 3
+    LOSSLESS = 16
+
     cdef TACSToFH5 *ptr
     def __cinit__(self, Assembler tacs, ElementType elem_type,
                   int out_type):
@@ -1569,6 +1629,45 @@ cdef class ToFH5:
         cdef char *filename = convert_to_chars(fname)
         self.ptr.writeToFile(filename)
 
+    def setOutputEncoding(self, int data_codec, double data_tol=0.0,
+                          int conn_codec=0):
+        '''
+        Set the encoding of the output data and connectivity zones
+        '''
+        self.ptr.setOutputEncoding(data_codec, data_tol, conn_codec)
+
+    def createTimeSeries(self, fname):
+        '''
+        Create a file with the topology for a time series
+        '''
+        cdef char *filename = convert_to_chars(fname)
+        return self.ptr.createTimeSeries(filename)
+
+    def writeTimeStep(self):
+        '''
+        Append the current data to the time series file
+        '''
+        self.ptr.writeTimeStep()
+
+    def closeTimeSeries(self):
+        '''
+        Close the time series file
+        '''
+        self.ptr.closeTimeSeries()
+
+    def setAsyncWrite(self, int max_queue_size):
+        '''
+        Write the files from a background thread, holding at most
+        max_queue_size pending snapshots in memory
+        '''
+        self.ptr.setAsyncWrite(max_queue_size)
+
+    def flush(self):
+        '''
+        Wait until all pending files have been written
+        '''
+        self.ptr.flush()
+
 # Wrap the TACSCreator object
 cdef class Creator:
     cdef TACSCreator *ptr
@@ -1640,11 +1739,54 @@ cdef class Creator:
         self.ptr.setNodes(<TacsScalar*>Xpts.data)
         return
 
+    def setDistributedConnectivity(self, int num_nodes,
+                                   np.ndarray[int, ndim=1, mode='c'] node_ptr,
+                                   np.ndarray[int, ndim=1, mode='c'] node_conn,
+                                   np.ndarray[int, ndim=1, mode='c'] id_nums):
+        '''
+        Set the connectivity and element id numbers for the block of
+        elements on this processor. The blocks must be ordered by rank.
+        This call is collective.
+        '''
+        cdef int num_elements = node_ptr.shape[0]-1
+        if num_elements != id_nums.shape[0]:
+            raise ValueError('Connectivity must match number of element ids')
+        self.ptr.setDistributedConnectivity(num_nodes, num_elements,
+                                            <int*>node_ptr.data,
+                                            <int*>node_conn.data,
+                                            <int*>id_nums.data)
+        return
+
+    def setDistributedNodes(self,
+                            np.ndarray[TacsScalar, ndim=1, mode='c'] Xpts):
+        '''
+        Set the locations of the block of nodes on this processor. The
+        blocks must be ordered by rank. This call is collective.
+        '''
+        self.ptr.setDistributedNodes(Xpts.shape[0]//3, <TacsScalar*>Xpts.data)
+        return
+
+    def setPartitionRefinement(self, int num_sweeps, double imbalance=0.05):
+        '''
+        Set the number of refinement sweeps for the parallel partition
+        of a distributed mesh and the allowable load imbalance
+        '''
+        self.ptr.setPartitionRefinement(num_sweeps, imbalance)
+        return
+
     def setReorderingType(self, OrderingType order_type,
                           MatrixOrderingType mat_type):
         self.ptr.setReorderingType(order_type, mat_type)
         return
 
+    def setLocalityOrdering(self, LocalityOrderType curve):
+        '''
+        Order the elements and owned nodes on each processor along a
+        space-filling curve to improve memory locality
+        '''
+        self.ptr.setLocalityOrdering(curve)
+        return
+
     def getElementPartition(self):
         '''Retrieve the element partition'''
         cdef const int *part = NULL
@@ -1709,6 +1851,15 @@ cdef class MeshLoader:
         cdef char *filename = convert_to_chars(fname)
         self.ptr.scanBDFFile(filename)
 
+    def setMeshCache(self, fname):
+        '''
+        Set the binary mesh cache file. The mesh is loaded from the
+        cache by scanBDFFile if it was created from the same BDF file,
+        otherwise the BDF file is scanned and the cache is written.
+        '''
+        cdef char *filename = convert_to_chars(fname)
+        self.ptr.setMeshCache(filename)
+
     def getNumComponents(self):
         '''
         Return the number of components
@@ -1778,7 +1929,8 @@ cdef class MeshLoader:
 
     def getConnectivity(self):
         '''
-        Return the connectivity of the mesh
+        Return the local block of the mesh connectivity and nodes. The
+        connectivity is in terms of the global node numbers.
         '''
         cdef int num_nodes
         cdef int num_elements
@@ -1814,7 +1966,8 @@ cdef class MeshLoader:
 
     def getBCs(self):
         '''
-        Return the boundary conditions associated with the file
+        Return the local block of boundary conditions associated with
+        the file in terms of the global node numbers
         '''
         cdef int num_bcs
         cdef const int *bc_nodes
@@ -2016,6 +2169,31 @@ cdef class Integrator:
         self.ptr.setJacAssemblyFreq(freq)
         return
 
+    def setJacobianReuse(self, int reuse, double max_rate=0.5):
+        '''
+        Reuse the factored Jacobian while the residual contracts by at
+        least max_rate at each Newton iteration
+        '''
+        self.ptr.setJacobianReuse(reuse, max_rate)
+        return
+
+    def setEisenstatWalker(self, int use_ew, double eta_max=0.9):
+        '''
+        Use Eisenstat-Walker forcing terms for the Krylov tolerance
+        '''
+        self.ptr.setEisenstatWalker(use_ew, eta_max)
+        return
+
+    def setAdaptiveTimeStepping(self, double rtol, double atol=0.0,
+                                double hmin=0.0, double hmax=0.0):
+        '''
+        Select the time steps adaptively based on estimates of the
+        local truncation error with the given tolerances. The number
+        of steps set in the constructor sets the initial step size.
+        '''
+        self.ptr.setAdaptiveTimeStepping(rtol, atol, hmin, hmax)
+        return
+
     def setUseLapack(self, int use_lapack):
         '''
         Should TACSIntegrator use lapack for linear solve. This will
@@ -2229,6 +2407,13 @@ cdef class Integrator:
         self.ptr.setOutputFrequency(write_freq)
         return
 
+    def setOutputTimeSeries(self, int time_series=1):
+        '''
+        Write all the output steps to a single file for each body type
+        '''
+        self.ptr.setOutputTimeSeries(time_series)
+        return
+
     def setRigidOutput(self, ToFH5 f5):
         '''
         Configure the export of rigid bodies